@@ -1,5 +1,6 @@
 
 
+// INSTANCED: transform only holds the view projection, the world matrix comes per instance from slot 1
 cbuffer Transform
 {
     matrix transform;
@@ -11,13 +12,24 @@ struct VSOut
     float Offset : TEXCOORD0;
 };
 
-VSOut VSMain(float3 position : Position)
+VSOut VSMain(float3 position : Position
+#ifdef INSTANCED
+    , float4 world0 : InstanceTransform0
+    , float4 world1 : InstanceTransform1
+    , float4 world2 : InstanceTransform2
+    , float4 world3 : InstanceTransform3
+#endif
+    )
 {
     VSOut vs;
     float sinIn1 = position.x;
     float sinIn2 = position.y;
     vs.Offset = (0.7f * sin(18.f  * sinIn1) + 0.5f * sin(24.f * sinIn2) + 0.6f * sin(42.f * sinIn1) + 0.2f * sin(64.f * sinIn2)  + 2.f) / 4.f;
     position += float3(0.f, 0.f, -1.f) * vs.Offset;
+
+#ifdef INSTANCED
+    position = mul(float4(position, 1.f), float4x4(world0, world1, world2, world3)).xyz;
+#endif
     
     vs.Pos = mul(float4(position, 1.f), transform);
     return vs;
@@ -1,63 +1,312 @@
 ﻿#include "App.h"
 
+#include <cassert>
+#include <chrono>
 #include <iostream>
 #include <random>
 #include <sstream>
+#include <string>
 
 #include "Drawable/Box.h"
 
-App::App() : m_Window(800, 600, "RomanceDawn")
+namespace
+{
+    /// @brief  Far plane of the scene projection, also where the render queue's depth bits end
+    constexpr float s_FarPlane = 40.0f;
+    /// @brief  Boxes per job for the per frame passes over every box, enough that a job outweighs taking it
+    constexpr size_t s_BoxesPerJob = 1024u;
+}
+
+#ifdef _WIN32
+App::App() : pWindow(std::make_unique<Window>(800, 600, "RomanceDawn")), m_RenderQueue(s_FarPlane)
+{
+    InitScene();
+}
+#endif
+
+App::App(std::unique_ptr<Graphics> headlessGfx, unsigned int nBoxes, bool bInstanced, std::optional<Terrain::Desc> terrain,
+    std::string boxMesh)
+    : pHeadlessGFX(std::move(headlessGfx)), m_RenderQueue(s_FarPlane), m_NumBoxes(nBoxes), b_Instanced(bInstanced), m_TerrainDesc(terrain),
+      m_BoxMesh(std::move(boxMesh))
+{
+    InitScene();
+}
+
+App::~App()
+{}
+
+void App::InitScene()
 {
     std::mt19937 rng( std::random_device{}() );
     std::uniform_real_distribution<float> adist( 0.0f,3.1415f * 2.0f );
     std::uniform_real_distribution<float> ddist( 0.0f,3.1415f * 2.0f );
     std::uniform_real_distribution<float> odist( 0.0f,3.1415f * 0.3f );
     std::uniform_real_distribution<float> rdist( 6.0f,20.0f );
-    for( auto i = 0; i < 1; i++ )
+    // Everything heavy loads in the background, boxes and terrain show up once theirs is in. The shaders the scene's
+    // drawables create go first, so a cold shader cache compiles them together instead of one by one
+    Graphics& gfx = GFX();
+    m_PendingLoads.push_back(pLoader->Submit([&gfx]
+    {
+        gfx.PrecompileShaders({
+            { ShaderStage::Vertex, L"shaders/VertexShader.hlsl", {} },
+            { ShaderStage::Vertex, L"shaders/VertexShader.hlsl", { { "INSTANCED", "1" } } },
+            { ShaderStage::Pixel, L"shaders/PixelShader.hlsl", {} },
+        });
+    }));
+    m_PendingLoads.push_back(Box::LoadShared(gfx, *pLoader, m_BoxMesh));
+    if (m_TerrainDesc)
+    {
+        m_TerrainLoad = pLoader->Submit([&gfx, desc = *m_TerrainDesc] { return std::make_unique<Terrain>(gfx, desc); });
+    }
+
+    m_Boxes.reserve(m_NumBoxes);
+    for( auto i = 0u; i < m_NumBoxes; i++ )
     {
         m_Boxes.push_back( std::make_unique<Box>(
-            m_Window.GFX(),rng,adist,
+            GFX(),m_BoxAnimation,rng,adist,
             ddist,odist,rdist
         ) );
     }
-    m_Window.GFX().SetProjectionMat( Math::XMMatrixPerspectiveLH( 1.0f,3.0f / 4.0f,0.5f,40.0f ) );
+    GFX().SetProjectionMat( Math::XMMatrixPerspectiveLH( 1.0f,3.0f / 4.0f,0.5f,s_FarPlane ) );
+
+    m_BoxAnimation.ComputeTransforms(*pJobs);
+    // The box bounds are written by the load, so the BVH is built by the first frame that finds them ready
+    m_ViewBoxes.reserve(m_Boxes.size());
     m_elapsedTime.x = 1.f;
-    pTimeUniform = std::make_unique<VertexConstantBuffer<Math::XMFLOAT4>>(m_Window.GFX());
+    pTimeUniform = std::make_unique<VertexFrameConstantBuffer<Math::XMFLOAT4>>();
 }
 
-App::~App()
-{}
-
 int App::Go()
 {
     while (true)
     {
+#ifdef _WIN32
         // Process all messages pending
         if (const auto ecode = Window::ProcessMessages())
         {
             // if return optional has a value, that means its an exit code
             return *ecode;
         }
+#endif
 
         DoFrame();
     }
 }
 
+void App::RunFrames(unsigned int nFrames)
+{
+    for (unsigned int i = 0; i < nFrames; i++)
+    {
+        DoFrame();
+    }
+}
+
+void App::WaitForResources()
+{
+    PollResources(true);
+}
+
+void App::PollResources(bool bWait)
+{
+    const auto IsDone = [bWait](const auto& load)
+    {
+        return bWait || load.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    };
+    // get() waits if it has to, and rethrows on this thread if the load failed
+    std::erase_if(m_PendingLoads, [&IsDone](std::future<void>& load)
+    {
+        if (!IsDone(load))
+        {
+            return false;
+        }
+        load.get();
+        return true;
+    });
+    if (m_TerrainLoad.valid() && IsDone(m_TerrainLoad))
+    {
+        pTerrain = m_TerrainLoad.get();
+    }
+}
+
 void App::DoFrame()
 {
+    PollResources(false);
+
     // Present frame
-    m_Window.GFX().ClearBuffer(.5f, 0.5f, 0.5f);
+    GFX().ClearBuffer(.5f, 0.5f, 0.5f);
 
     const auto dT = m_Timer.Mark();
     m_elapsedTime.x += dT;
     m_elapsedTime.x = 1.f;
-    pTimeUniform->Update(m_Window.GFX(), m_elapsedTime);
-    for (auto &d : m_Boxes)
+    pTimeUniform->Update(GFX(), m_elapsedTime);
+    // Box state lives SoA in the animation store, one pass integrates all of it and rebuilds every transform
+    m_BoxAnimation.Integrate(dT, *pJobs);
+    m_BoxAnimation.ComputeTransforms(*pJobs);
+
+    // The shared bounds are written on the loader's thread, nothing reads them before IsReady says they're in
+    const bool bBoxesReady = !m_Boxes.empty() && m_Boxes.front()->IsReady();
+    if (bBoxesReady)
     {
-        d->Update(dT);
-        pTimeUniform->Bind(m_Window.GFX());
-        d->Draw(m_Window.GFX());
+        // Refit the BVH to wherever the boxes moved, bounds in parallel then one bottom up pass over the tree. The
+        // first ready frame builds it instead
+        m_ViewBoxes.resize(m_Boxes.size());
+        pJobs->ParallelFor(m_Boxes.size(), s_BoxesPerJob, [this](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                m_ViewBoxes[i] = m_Boxes[i]->GetViewBox();
+            }
+        });
+        if (m_Bvh.GetObjectCount() != m_ViewBoxes.size())
+        {
+            m_Bvh.Build(m_ViewBoxes);
+        }
+        else
+        {
+            m_Bvh.Refit(m_ViewBoxes);
+            m_Bvh.RebuildIfDegraded();
+        }
     }
 
-    m_Window.GFX().SwapBuffer();
+#ifdef _WIN32
+    if (pWindow)
+    {
+        while (!pWindow->mouse.IsEmpty())
+        {
+            const auto e = pWindow->mouse.Read();
+            if (e.GetType() == Mouse::Event::Type::LPress)
+            {
+                const auto picked = Pick(e.GetPosX(), e.GetPosY());
+                pWindow->SetTitle(picked ? "RomanceDawn - Picked box " + std::to_string(*picked) : "RomanceDawn");
+            }
+        }
+    }
+#endif
+
+    // Cull against the view frustum (no camera yet, so that's the one of the bare projection)
+    const Frustum frustum = Frustum::FromMatrix(GFX().GetProjectionMat());
+    if (!bBoxesReady)
+    {
+        // Boxes stay out of the frame until their shared binds (and bounds) have loaded
+        m_VisibleIndices.clear();
+    }
+    else if (b_FlatCulling)
+    {
+        // A job fills in its range of spheres and culls just that range (ranges are whole SIMD batches)
+        assert(s_BoxesPerJob % FrustumCuller::GetBatchSize() == 0u);
+        m_Culler.Resize(m_Boxes.size());
+        m_CullRanges.resize((m_Boxes.size() + s_BoxesPerJob - 1u) / s_BoxesPerJob);
+        pJobs->ParallelFor(m_Boxes.size(), s_BoxesPerJob, [this, &frustum](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                m_Culler.Set(static_cast<uint32_t>(i), m_Boxes[i]->GetViewSphere());
+            }
+            m_Culler.Cull(frustum, begin, end, m_CullRanges[begin / s_BoxesPerJob]);
+        });
+        m_VisibleIndices.clear();
+        for (const auto& range : m_CullRanges)
+        {
+            m_VisibleIndices.insert(m_VisibleIndices.end(), range.begin(), range.end());
+        }
+    }
+    else
+    {
+        m_Bvh.Cull(frustum, m_VisibleIndices);
+    }
+    m_VisibleBoxes.resize(m_VisibleIndices.size());
+    for (size_t i = 0; i < m_VisibleIndices.size(); i++)
+    {
+        m_VisibleBoxes[i] = m_Boxes[m_VisibleIndices[i]].get();
+    }
+
+    // Gather everything visible, the queue sorts by state/depth before anything is drawn
+    if (b_Instanced)
+    {
+        Box::SubmitInstanced(m_RenderQueue, m_VisibleBoxes);
+    }
+    else
+    {
+        // Every box gets its own packet slot, so the sort keys can be made in parallel
+        const size_t first = m_RenderQueue.Reserve(m_VisibleBoxes.size());
+        pJobs->ParallelFor(m_VisibleBoxes.size(), s_BoxesPerJob, [this, first](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                m_VisibleBoxes[i]->SubmitAt(m_RenderQueue, first + i);
+            }
+        });
+    }
+    if (pTerrain)
+    {
+        pTerrain->Submit(GFX(), m_RenderQueue);
+    }
+
+    pTimeUniform->Bind(GFX());
+    m_RenderQueue.Execute(GFX(), *pJobs);
+
+    GFX().SwapBuffer();
+}
+
+const Terrain* App::GetTerrain() const noexcept
+{
+    return pTerrain.get();
+}
+
+size_t App::GetVisibleBoxCount() const noexcept
+{
+    return m_VisibleBoxes.size();
+}
+
+size_t App::GetCullNodeCount() const noexcept
+{
+    return b_FlatCulling ? 0u : m_Bvh.GetLastCullNodeCount();
+}
+
+void App::SetAnimated(bool bAnimated) noexcept
+{
+    m_BoxAnimation.SetAnimated(bAnimated);
+}
+
+void App::SetFlatCulling(bool bFlat) noexcept
+{
+    b_FlatCulling = bFlat;
+}
+
+void App::SetThreadCount(unsigned int numThreads)
+{
+    pJobs = std::make_unique<JobSystem>(numThreads);
+}
+
+unsigned int App::GetThreadCount() const noexcept
+{
+    return pJobs->GetThreadCount();
+}
+
+std::optional<size_t> App::Pick(int x, int y)
+{
+    // Pixel center -> NDC -> view space direction through the near plane, the eye sits at the view space origin
+    const Math::XMMATRIX projection = GFX().GetProjectionMat();
+    const float ndcX = 2.f * (float(x) + 0.5f) / float(GFX().GetWidth()) - 1.f;
+    const float ndcY = 1.f - 2.f * (float(y) + 0.5f) / float(GFX().GetHeight());
+
+    Bvh::Ray ray;
+    ray.origin = { 0.f, 0.f, 0.f };
+    ray.direction = { ndcX / Math::XMVectorGetX(projection.r[0]), ndcY / Math::XMVectorGetY(projection.r[1]), 1.f };
+    if (const auto hit = m_Bvh.Raycast(ray))
+    {
+        return hit->object;
+    }
+    return std::nullopt;
+}
+
+Graphics& App::GFX()
+{
+#ifdef _WIN32
+    if (pWindow)
+    {
+        return pWindow->GFX();
+    }
+#endif
+    return *pHeadlessGFX;
 }
@@ -1,24 +1,94 @@
 ﻿#pragma once
 #include "OdaTimer.h"
+#ifdef _WIN32
 #include "Window.h"
+#endif
 #include "Bindable/Buffers/ConstantBuffers.h"
+#include "RenderQueue.h"
+#include "Drawable/BoxAnimation.h"
+#include "Drawable/Terrain.h"
+#include "Utility/AsyncLoader.h"
+#include "Utility/Bvh.h"
+#include "Utility/JobSystem.h"
+#include <future>
+#include <optional>
 
 class App
 {
 public:
+#ifdef _WIN32
     App();
+#endif
+    /// @brief  Headless app, no window or message pump. Renders through whatever backend gfx was created with.
+    ///         terrain adds the chunked LOD version of the plane to the scene, boxMesh loads the boxes' mesh from that
+    ///         MeshFile instead of generating it
+    App(std::unique_ptr<Graphics> headlessGfx, unsigned int nBoxes = 1u, bool bInstanced = true, std::optional<Terrain::Desc> terrain = std::nullopt,
+        std::string boxMesh = {});
     ~App();
     
     /// @brief  Frame / Message loop
     int Go();
 
+    /// @brief  Runs a fixed number of frames back to back, without pumping window messages (benchmarks, CI)
+    void RunFrames(unsigned int nFrames);
+    /// @brief  Blocks until everything the scene loads in the background is in (otherwise it streams in over the
+    ///         first frames), for runs that need the full scene from the first frame on
+    void WaitForResources();
+
+    /// @brief  nullptr unless the scene has a terrain
+    const Terrain* GetTerrain() const noexcept;
+    /// @brief  Boxes that survived frustum culling in the last frame
+    size_t GetVisibleBoxCount() const noexcept;
+    /// @brief  Nodes the BVH looked at culling the last frame (0 with flat culling)
+    size_t GetCullNodeCount() const noexcept;
+    /// @brief  Boxes orbit instead of all sitting in the displaced plane pose
+    void SetAnimated(bool bAnimated) noexcept;
+    /// @brief  Culls every box against the frustum with the SIMD FrustumCuller instead of walking the BVH
+    void SetFlatCulling(bool bFlat) noexcept;
+    /// @brief  Restarts the job system the per frame work fans out on with numThreads (counting the frame loop's
+    ///         own thread), 0 uses every hardware thread
+    void SetThreadCount(unsigned int numThreads);
+    unsigned int GetThreadCount() const noexcept;
+    /// @brief  Index of the nearest box under pixel (x, y), picked against the BVH (so none before the boxes are ready)
+    std::optional<size_t> Pick(int x, int y);
+
 private:
+    void InitScene();
+    /// @brief  Picks up finished background loads, rethrowing whatever they threw. bWait blocks until all are done
+    void PollResources(bool bWait);
     void DoFrame();
+    Graphics& GFX();
 
 private:
-    Window m_Window;
+#ifdef _WIN32
+    std::unique_ptr<Window> pWindow;
+#endif
+    std::unique_ptr<Graphics> pHeadlessGFX;
+    /* Animation, bounds, culling and sort keys of the boxes get split into ranges across this */
+    std::unique_ptr<JobSystem> pJobs = std::make_unique<JobSystem>();
+    /* Mesh generation, shader compiles and resource creation happen here instead of holding up the first frame */
+    std::unique_ptr<AsyncLoader> pLoader = std::make_unique<AsyncLoader>();
+    std::vector<std::future<void>> m_PendingLoads;
+    std::future<std::unique_ptr<Terrain>> m_TerrainLoad;
     OdaTimer m_Timer;
     std::vector<std::unique_ptr<class Box>> m_Boxes;
-    std::unique_ptr<VertexConstantBuffer<Math::XMFLOAT4>> pTimeUniform;
+    BoxAnimation m_BoxAnimation;
+    /* Scene bounds in view space, refit as the boxes move. Drives culling and picking, empty until the boxes are ready */
+    Bvh m_Bvh;
+    std::vector<AABB> m_ViewBoxes;
+    FrustumCuller m_Culler;
+    /* Flat culling results per job range, concatenated in range order so the visible list doesn't depend on timing */
+    std::vector<std::vector<uint32_t>> m_CullRanges;
+    bool b_FlatCulling = false;
+    std::vector<uint32_t> m_VisibleIndices;
+    std::vector<const class Box*> m_VisibleBoxes;
+    RenderQueue m_RenderQueue;
+    unsigned int m_NumBoxes = 1u;
+    /* Draw all boxes with one instanced draw instead of one draw (+ transform cbuffer update) per box */
+    bool b_Instanced = true;
+    std::optional<Terrain::Desc> m_TerrainDesc;
+    std::string m_BoxMesh;
+    std::unique_ptr<Terrain> pTerrain;
+    std::unique_ptr<VertexFrameConstantBuffer<Math::XMFLOAT4>> pTimeUniform;
     Math::XMFLOAT4 m_elapsedTime;
 };
@@ -0,0 +1,208 @@
+﻿#include "CommandList.h"
+
+#include <bit>
+#include <cassert>
+
+/*--------------------------------------------------------------------------------------------------------------
+* RenderBackend defaults
+*--------------------------------------------------------------------------------------------------------------*/
+
+std::unique_ptr<CommandList> RenderBackend::CreateCommandList()
+{
+    return std::make_unique<RecordedCommandList>(*this);
+}
+
+void RenderBackend::ExecuteCommandList(CommandList& list)
+{
+    // Only ever handed back lists made by CreateCommandList above
+    auto& recorded = static_cast<RecordedCommandList&>(list);
+    recorded.Replay(*this);
+    recorded.Reset();
+}
+
+/*--------------------------------------------------------------------------------------------------------------
+* CommandList
+*--------------------------------------------------------------------------------------------------------------*/
+
+CommandList::CommandList(RenderBackend& device) noexcept
+    : m_Device(device)
+{}
+
+void CommandList::Present()
+{
+    assert("Command lists can't present, execute them on the backend instead" && false);
+}
+
+void CommandList::Resize(unsigned int, unsigned int)
+{
+    assert("Command lists can't resize the back buffer" && false);
+}
+
+unsigned int CommandList::GetWidth() const noexcept
+{
+    return m_Device.GetWidth();
+}
+
+unsigned int CommandList::GetHeight() const noexcept
+{
+    return m_Device.GetHeight();
+}
+
+std::unique_ptr<GpuBuffer> CommandList::CreateBuffer(const BufferDesc& desc, const void* pInitialData)
+{
+    return m_Device.CreateBuffer(desc, pInitialData);
+}
+
+std::unique_ptr<GpuShader> CommandList::CreateShader(ShaderStage stage, const std::wstring& path, const std::vector<ShaderMacro>& defines)
+{
+    return m_Device.CreateShader(stage, path, defines);
+}
+
+std::unique_ptr<GpuInputLayout> CommandList::CreateInputLayout(const std::vector<VertexElementDesc>& elements, const GpuShader& vertexShader)
+{
+    return m_Device.CreateInputLayout(elements, vertexShader);
+}
+
+void CommandList::PrecompileShaders(const std::vector<ShaderDesc>& shaders)
+{
+    m_Device.PrecompileShaders(shaders);
+}
+
+void CommandList::UpdateBuffer(GpuBuffer& buffer, const void* pData, size_t size)
+{
+    m_Device.UpdateBuffer(buffer, pData, size);
+}
+
+void* CommandList::MapBuffer(GpuBuffer& buffer, MapMode mode)
+{
+    return m_Device.MapBuffer(buffer, mode);
+}
+
+void CommandList::UnmapBuffer(GpuBuffer& buffer) noexcept
+{
+    m_Device.UnmapBuffer(buffer);
+}
+
+bool CommandList::SupportsConstantBufferOffsets() const noexcept
+{
+    return m_Device.SupportsConstantBufferOffsets();
+}
+
+/*--------------------------------------------------------------------------------------------------------------
+* RecordedCommandList
+*--------------------------------------------------------------------------------------------------------------*/
+
+void RecordedCommandList::Record(Op op, const GpuResource* pResource, unsigned int a0, unsigned int a1, unsigned int a2, unsigned int a3) noexcept
+{
+    m_Commands.push_back({ op, pResource, { a0, a1, a2, a3 } });
+}
+
+void RecordedCommandList::Clear(float r, float g, float b) noexcept
+{
+    Record(Op::Clear, nullptr, std::bit_cast<unsigned int>(r), std::bit_cast<unsigned int>(g), std::bit_cast<unsigned int>(b));
+}
+
+void RecordedCommandList::SetVertexBuffer(unsigned int slot, const GpuBuffer& buffer, unsigned int stride, unsigned int offset) noexcept
+{
+    Record(Op::SetVertexBuffer, &buffer, slot, stride, offset);
+}
+
+void RecordedCommandList::SetIndexBuffer(const GpuBuffer& buffer, IndexFormat format) noexcept
+{
+    Record(Op::SetIndexBuffer, &buffer, static_cast<unsigned int>(format));
+}
+
+void RecordedCommandList::SetConstantBuffer(ShaderStage stage, unsigned int slot, const GpuBuffer& buffer) noexcept
+{
+    Record(Op::SetConstantBuffer, &buffer, static_cast<unsigned int>(stage), slot);
+}
+
+void RecordedCommandList::SetConstantBufferRange(ShaderStage stage, unsigned int slot, const GpuBuffer& buffer, unsigned int firstConstant, unsigned int numConstants) noexcept
+{
+    Record(Op::SetConstantBufferRange, &buffer, static_cast<unsigned int>(stage), slot, firstConstant, numConstants);
+}
+
+void RecordedCommandList::SetShader(const GpuShader& shader) noexcept
+{
+    Record(Op::SetShader, &shader);
+}
+
+void RecordedCommandList::SetInputLayout(const GpuInputLayout& layout) noexcept
+{
+    Record(Op::SetInputLayout, &layout);
+}
+
+void RecordedCommandList::SetTopology(PrimitiveTopology topology) noexcept
+{
+    Record(Op::SetTopology, nullptr, static_cast<unsigned int>(topology));
+}
+
+void RecordedCommandList::BindRenderTarget() noexcept
+{
+    Record(Op::BindRenderTarget, nullptr);
+}
+
+void RecordedCommandList::DrawIndexed(unsigned int count)
+{
+    Record(Op::DrawIndexed, nullptr, count);
+}
+
+void RecordedCommandList::DrawIndexedInstanced(unsigned int count, unsigned int instanceCount)
+{
+    Record(Op::DrawIndexedInstanced, nullptr, count, instanceCount);
+}
+
+void RecordedCommandList::Replay(RenderBackend& target) const
+{
+    for (const Command& command : m_Commands)
+    {
+        const unsigned int* args = command.args;
+        switch (command.op)
+        {
+            case Op::Clear:
+                target.Clear(std::bit_cast<float>(args[0]), std::bit_cast<float>(args[1]), std::bit_cast<float>(args[2]));
+                break;
+            case Op::SetVertexBuffer:
+                target.SetVertexBuffer(args[0], static_cast<const GpuBuffer&>(*command.pResource), args[1], args[2]);
+                break;
+            case Op::SetIndexBuffer:
+                target.SetIndexBuffer(static_cast<const GpuBuffer&>(*command.pResource), static_cast<IndexFormat>(args[0]));
+                break;
+            case Op::SetConstantBuffer:
+                target.SetConstantBuffer(static_cast<ShaderStage>(args[0]), args[1], static_cast<const GpuBuffer&>(*command.pResource));
+                break;
+            case Op::SetConstantBufferRange:
+                target.SetConstantBufferRange(static_cast<ShaderStage>(args[0]), args[1], static_cast<const GpuBuffer&>(*command.pResource), args[2], args[3]);
+                break;
+            case Op::SetShader:
+                target.SetShader(static_cast<const GpuShader&>(*command.pResource));
+                break;
+            case Op::SetInputLayout:
+                target.SetInputLayout(static_cast<const GpuInputLayout&>(*command.pResource));
+                break;
+            case Op::SetTopology:
+                target.SetTopology(static_cast<PrimitiveTopology>(args[0]));
+                break;
+            case Op::BindRenderTarget:
+                target.BindRenderTarget();
+                break;
+            case Op::DrawIndexed:
+                target.DrawIndexed(args[0]);
+                break;
+            case Op::DrawIndexedInstanced:
+                target.DrawIndexedInstanced(args[0], args[1]);
+                break;
+        }
+    }
+}
+
+void RecordedCommandList::Reset() noexcept
+{
+    // Keeps the capacity, the next frame records about as much
+    m_Commands.clear();
+}
+
+size_t RecordedCommandList::GetCommandCount() const noexcept
+{
+    return m_Commands.size();
+}
@@ -0,0 +1,93 @@
+﻿#pragma once
+#include <vector>
+
+#include "RenderBackend.h"
+
+/// @brief  Backend facing interface a worker thread records state and draw calls into, so draw submission can be
+///         split across threads and the lists executed in order on the owning backend
+///         (RenderBackend::ExecuteCommandList).
+///         - Only state/draw calls (and Clear) get recorded. A list starts with nothing bound, it doesn't inherit
+///           the state of the backend or of the list executed before it
+///         - Resource creation goes straight to the device the list came from, buffer writes (Update/Map) too: those
+///           aren't recorded so they have to be done before the list is executed, from the thread owning the device
+///         - Present/Resize aren't allowed
+class CommandList : public RenderBackend
+{
+public:
+    explicit CommandList(RenderBackend& device) noexcept;
+
+    void Present() override;
+    void Resize(unsigned int width, unsigned int height) override;
+    unsigned int GetWidth() const noexcept override;
+    unsigned int GetHeight() const noexcept override;
+
+    std::unique_ptr<GpuBuffer> CreateBuffer(const BufferDesc& desc, const void* pInitialData) override;
+    std::unique_ptr<GpuShader> CreateShader(ShaderStage stage, const std::wstring& path, const std::vector<ShaderMacro>& defines) override;
+    std::unique_ptr<GpuInputLayout> CreateInputLayout(const std::vector<VertexElementDesc>& elements, const GpuShader& vertexShader) override;
+    void PrecompileShaders(const std::vector<ShaderDesc>& shaders) override;
+    void UpdateBuffer(GpuBuffer& buffer, const void* pData, size_t size) override;
+    void* MapBuffer(GpuBuffer& buffer, MapMode mode) override;
+    void UnmapBuffer(GpuBuffer& buffer) noexcept override;
+    bool SupportsConstantBufferOffsets() const noexcept override;
+
+protected:
+    RenderBackend& m_Device;
+};
+
+/// @brief  Portable command list, every call is appended to a flat stream of fixed size commands and Replay calls the
+///         same functions on the target in the same order. What every backend without a native equivalent of
+///         deferred contexts (Null, Software) executes
+class RecordedCommandList : public CommandList
+{
+public:
+    using CommandList::CommandList;
+
+    void Clear(float r, float g, float b) noexcept override;
+
+    void SetVertexBuffer(unsigned int slot, const GpuBuffer& buffer, unsigned int stride, unsigned int offset) noexcept override;
+    void SetIndexBuffer(const GpuBuffer& buffer, IndexFormat format) noexcept override;
+    void SetConstantBuffer(ShaderStage stage, unsigned int slot, const GpuBuffer& buffer) noexcept override;
+    void SetConstantBufferRange(ShaderStage stage, unsigned int slot, const GpuBuffer& buffer, unsigned int firstConstant, unsigned int numConstants) noexcept override;
+    void SetShader(const GpuShader& shader) noexcept override;
+    void SetInputLayout(const GpuInputLayout& layout) noexcept override;
+    void SetTopology(PrimitiveTopology topology) noexcept override;
+    void BindRenderTarget() noexcept override;
+
+    void DrawIndexed(unsigned int count) override;
+    void DrawIndexedInstanced(unsigned int count, unsigned int instanceCount) override;
+
+    /// @brief  Issues every recorded command on target, in recording order
+    void Replay(RenderBackend& target) const;
+    void Reset() noexcept;
+    size_t GetCommandCount() const noexcept;
+
+private:
+    enum class Op : uint8_t
+    {
+        Clear,
+        SetVertexBuffer,
+        SetIndexBuffer,
+        SetConstantBuffer,
+        SetConstantBufferRange,
+        SetShader,
+        SetInputLayout,
+        SetTopology,
+        BindRenderTarget,
+        DrawIndexed,
+        DrawIndexedInstanced
+    };
+
+    /// @brief  Meaning of args depends on op, resource is the buffer/shader/layout bound (if any). Resources are
+    ///         referenced, not owned, they have to outlive the list's execution
+    struct Command
+    {
+        Op op;
+        const GpuResource* pResource;
+        unsigned int args[4];
+    };
+
+    void Record(Op op, const GpuResource* pResource, unsigned int a0 = 0u, unsigned int a1 = 0u, unsigned int a2 = 0u, unsigned int a3 = 0u) noexcept;
+
+private:
+    std::vector<Command> m_Commands;
+};
@@ -0,0 +1,132 @@
+﻿#include "ConstantRing.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+ConstantRing::ConstantRing(RenderBackend& backend, unsigned int byteSize)
+    : m_Backend(backend)
+{
+    if (!m_Backend.SupportsConstantBufferOffsets())
+    {
+        return;
+    }
+
+    m_Size = (byteSize + s_Alignment - 1u) / s_Alignment * s_Alignment;
+    const BufferDesc cbd = { BufferType::Constant, BufferUsage::Dynamic, m_Size, 0u };
+    pBuffer = m_Backend.CreateBuffer(cbd, nullptr);
+}
+
+ConstantRing::~ConstantRing()
+{
+    Unmap();
+}
+
+bool ConstantRing::IsSupported() const noexcept
+{
+    return pBuffer != nullptr;
+}
+
+ConstantRing::Allocation ConstantRing::Write(const void* pData, size_t size)
+{
+    assert("Backend can't bind constant buffer ranges, check IsSupported" && IsSupported());
+    assert("Constant allocation larger than a constant buffer binding can be" && size <= s_MaxAllocation);
+
+    const unsigned int aligned = static_cast<unsigned int>((size + s_Alignment - 1u) / s_Alignment * s_Alignment);
+
+    // A frame's first write starts over at the beginning of a renamed buffer if what the last frame took won't fit
+    // in what's left (draws of the earlier frames keep reading the old one). Later in the frame wrapping would
+    // overwrite (or discard) allocations the frame hasn't drawn yet, so running out then grows the ring instead
+    const bool bFrameStart = m_Head == m_FrameStart;
+    if (m_Head + std::max<size_t>(aligned, bFrameStart ? m_LastFrame.bytesUsed : 0u) > m_Size)
+    {
+        if (bFrameStart)
+        {
+            Unmap();
+            m_Head = 0u;
+            m_FrameStart = 0u;
+        }
+        else
+        {
+            Grow(m_Head + aligned);
+        }
+    }
+    assert("Frame wrapped onto its own allocations" && m_Head >= m_FrameStart && m_Head + aligned <= m_Size);
+    if (!pMapped)
+    {
+        // Head at 0 means either the very first map or a wrap, both need a Discard
+        pMapped = static_cast<unsigned char*>(m_Backend.MapBuffer(*pBuffer, m_Head == 0u ? MapMode::Discard : MapMode::NoOverwrite));
+        m_CurrentFrame.maps++;
+    }
+
+    memcpy(pMapped + m_Head, pData, size);
+    const Allocation allocation = { m_Head / 16u, aligned / 16u };
+    m_Head += aligned;
+
+    m_CurrentFrame.bytesUsed += aligned;
+    m_CurrentFrame.bytesRequested += size;
+    m_CurrentFrame.allocations++;
+    return allocation;
+}
+
+void ConstantRing::Grow(unsigned int minSize)
+{
+    unsigned int size = m_Size;
+    while (size < minSize)
+    {
+        size *= 2u;
+    }
+
+    // Read back what the frame wrote so far. That's CPU memory for the Null/Software backends, and on D3D11 a rare
+    // (once per new high water mark) read of mapped memory
+    if (!pMapped)
+    {
+        pMapped = static_cast<unsigned char*>(m_Backend.MapBuffer(*pBuffer, MapMode::NoOverwrite));
+        m_CurrentFrame.maps++;
+    }
+    const std::vector<unsigned char> frame(pMapped + m_FrameStart, pMapped + m_Head);
+    Unmap();
+
+    m_Retired.push_back(std::move(pBuffer));
+    const BufferDesc cbd = { BufferType::Constant, BufferUsage::Dynamic, size, 0u };
+    pBuffer = m_Backend.CreateBuffer(cbd, nullptr);
+    m_Size = size;
+    pMapped = static_cast<unsigned char*>(m_Backend.MapBuffer(*pBuffer, MapMode::Discard));
+    std::copy(frame.begin(), frame.end(), pMapped + m_FrameStart);
+    m_CurrentFrame.maps++;
+    m_CurrentFrame.grows++;
+}
+
+void ConstantRing::Bind(RenderBackend& target, ShaderStage stage, unsigned int slot, const Allocation& allocation) const noexcept
+{
+    target.SetConstantBufferRange(stage, slot, *pBuffer, allocation.firstConstant, allocation.numConstants);
+}
+
+void ConstantRing::Unmap() noexcept
+{
+    if (pMapped)
+    {
+        m_Backend.UnmapBuffer(*pBuffer);
+        pMapped = nullptr;
+    }
+}
+
+void ConstantRing::EndFrame() noexcept
+{
+    Unmap();
+    m_Retired.clear();
+    m_FrameStart = m_Head;
+    m_FrameIndex++;
+    m_LastFrame = m_CurrentFrame;
+    m_CurrentFrame = {};
+}
+
+unsigned long long ConstantRing::GetFrameIndex() const noexcept
+{
+    return m_FrameIndex;
+}
+
+const ConstantRing::FrameStats& ConstantRing::GetLastFrameStats() const noexcept
+{
+    return m_LastFrame;
+}
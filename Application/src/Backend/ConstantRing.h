@@ -0,0 +1,86 @@
+﻿#pragma once
+#include <memory>
+#include <vector>
+
+#include "RenderBackend.h"
+
+/// @brief  One big dynamic constant buffer that every per frame constant (transforms, time...) gets suballocated
+///         from, instead of a Map(DISCARD)/Unmap per constant buffer per draw. Writes go in at an ever increasing
+///         head with MapMode::NoOverwrite, so nothing the GPU might still read from the previous frames gets touched,
+///         and only when the head wraps around the buffer is mapped with Discard (the driver renames it). Allocations
+///         are bound with constant offsets (SetConstantBufferRange).
+///         A frame's allocations all stay bindable until EndFrame (RenderQueue writes them all before drawing any), so
+///         a frame never wraps onto its own allocations: if they don't fit, the ring grows to twice the size instead,
+///         carrying them over at the same offsets.
+///         The ring stays mapped across writes and has to be unmapped before a draw reads it, Graphics does that right
+///         before every draw, so writing all of a frame's constants before the first draw costs a single map
+class ConstantRing
+{
+public:
+    /// @brief  Per frame counters, reset on EndFrame
+    struct FrameStats
+    {
+        size_t bytesUsed = 0u;          /* Ring space taken, including alignment padding */
+        size_t bytesRequested = 0u;     /* What was actually written */
+        unsigned int allocations = 0u;
+        unsigned int maps = 0u;
+        unsigned int grows = 0u;        /* Times the frame didn't fit and the ring doubled */
+    };
+
+    /// @brief  Where an allocation landed, in shader constants (16 bytes) which is what SetConstantBufferRange wants
+    struct Allocation
+    {
+        unsigned int firstConstant = 0u;
+        unsigned int numConstants = 0u;
+    };
+
+public:
+    /// @brief  byteSize gets rounded up to the allocation alignment. Does nothing (IsSupported is false) if the
+    ///         backend can't bind constant buffers at an offset
+    explicit ConstantRing(RenderBackend& backend, unsigned int byteSize = 1u << 20u);
+    ~ConstantRing();
+    ConstantRing(const ConstantRing&) = delete;
+    ConstantRing& operator=(const ConstantRing&) = delete;
+
+    bool IsSupported() const noexcept;
+
+    /// @brief  Copies size bytes into the ring, contents are valid for the rest of the frame. At most 64KB (the most
+    ///         a single constant buffer binding can see). Grows the ring if the frame has filled it
+    Allocation Write(const void* pData, size_t size);
+    /// @brief  Binds through target, which can be a CommandList recording on another thread (binding only reads
+    ///         the ring, Write/Unmap have to stay on the owning thread)
+    void Bind(RenderBackend& target, ShaderStage stage, unsigned int slot, const Allocation& allocation) const noexcept;
+
+    /// @brief  Unmaps the ring if a write left it mapped
+    void Unmap() noexcept;
+    /// @brief  Unmaps and rolls the frame stats/index over, call once the frame has been submitted
+    void EndFrame() noexcept;
+
+    /// @brief  Incremented on every EndFrame, allocations from an older frame must not be bound anymore
+    unsigned long long GetFrameIndex() const noexcept;
+    const FrameStats& GetLastFrameStats() const noexcept;
+
+private:
+    /// @brief  Replaces the buffer with one of at least minSize bytes (doubling), with this frame's allocations
+    ///         copied over to the same offsets. Leaves the new one mapped
+    void Grow(unsigned int minSize);
+
+private:
+    /// @brief  Constant offsets have to be multiples of 16 constants (256 bytes)
+    static constexpr unsigned int s_Alignment = 256u;
+    static constexpr unsigned int s_MaxAllocation = 4096u * 16u;
+
+    RenderBackend& m_Backend;
+    std::unique_ptr<GpuBuffer> pBuffer;
+    /* Buffers replaced by Grow this frame, kept until EndFrame since draws (or recorded lists) may still use them */
+    std::vector<std::unique_ptr<GpuBuffer>> m_Retired;
+    unsigned char* pMapped = nullptr;
+    unsigned int m_Size = 0u;
+    unsigned int m_Head = 0u;
+    /* Where the head was when the frame started, [m_FrameStart, m_Head) is what the frame has allocated */
+    unsigned int m_FrameStart = 0u;
+
+    unsigned long long m_FrameIndex = 0u;
+    FrameStats m_CurrentFrame;
+    FrameStats m_LastFrame;
+};
@@ -0,0 +1,688 @@
+﻿#include "D3D11Backend.h"
+
+#include <cassert>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <dxgitype.h>
+#include <winerror.h>
+#include <d3dcompiler.h>
+#include <dxgi.h>
+#include "CommandList.h"
+#include "Graphics.h"
+#include "ShaderCache.h"
+#include "Errors/GraphicsErrors.h"
+
+// namespace for our com ptrs
+namespace wrl = Microsoft::WRL;
+
+// Specify linking to d3d11 library (here instead of project settings)
+#pragma comment(lib, "d3d11.lib")
+#pragma comment(lib, "d3dcompiler.lib")
+#pragma comment(lib, "DXGI.lib")
+
+/*--------------------------------------------------------------------------------------------------------------
+* D3D11 Resources (what the backend hands out to bindables)
+*--------------------------------------------------------------------------------------------------------------*/
+
+namespace
+{
+    class D3D11Buffer : public GpuBuffer
+    {
+    public:
+        using GpuBuffer::GpuBuffer;
+        wrl::ComPtr<ID3D11Buffer> pBuffer;
+    };
+
+    class D3D11Shader : public GpuShader
+    {
+    public:
+        using GpuShader::GpuShader;
+        wrl::ComPtr<ID3DBlob> pBytecodeBlob;
+        wrl::ComPtr<ID3D11VertexShader> pVertexShader;
+        wrl::ComPtr<ID3D11PixelShader> pPixelShader;
+    };
+
+    class D3D11InputLayout : public GpuInputLayout
+    {
+    public:
+        wrl::ComPtr<ID3D11InputLayout> pInputLayout;
+    };
+
+    D3D11_PRIMITIVE_TOPOLOGY ToD3D(PrimitiveTopology topology) noexcept
+    {
+        switch (topology)
+        {
+            case PrimitiveTopology::PointList:      return D3D11_PRIMITIVE_TOPOLOGY_POINTLIST;
+            case PrimitiveTopology::LineList:       return D3D11_PRIMITIVE_TOPOLOGY_LINELIST;
+            case PrimitiveTopology::LineStrip:      return D3D11_PRIMITIVE_TOPOLOGY_LINESTRIP;
+            case PrimitiveTopology::TriangleList:   return D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+            case PrimitiveTopology::TriangleStrip:  return D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP;
+        }
+        return D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED;
+    }
+
+    DXGI_FORMAT ToDXGI(ElementFormat format) noexcept
+    {
+        switch (format)
+        {
+            case ElementFormat::Float1: return DXGI_FORMAT_R32_FLOAT;
+            case ElementFormat::Float2: return DXGI_FORMAT_R32G32_FLOAT;
+            case ElementFormat::Float3: return DXGI_FORMAT_R32G32B32_FLOAT;
+            case ElementFormat::Float4: return DXGI_FORMAT_R32G32B32A32_FLOAT;
+            case ElementFormat::Half2: return DXGI_FORMAT_R16G16_FLOAT;
+            case ElementFormat::Half4: return DXGI_FORMAT_R16G16B16A16_FLOAT;
+            case ElementFormat::ShortN2: return DXGI_FORMAT_R16G16_SNORM;
+            case ElementFormat::ShortN4: return DXGI_FORMAT_R16G16B16A16_SNORM;
+            case ElementFormat::UShortN4: return DXGI_FORMAT_R16G16B16A16_UNORM;
+            case ElementFormat::ByteN4: return DXGI_FORMAT_R8G8B8A8_SNORM;
+            case ElementFormat::UByteN4: return DXGI_FORMAT_R8G8B8A8_UNORM;
+            case ElementFormat::UDecN4: return DXGI_FORMAT_R10G10B10A2_UNORM;
+        }
+        return DXGI_FORMAT_UNKNOWN;
+    }
+
+    DXGI_FORMAT ToDXGI(IndexFormat format) noexcept
+    {
+        return format == IndexFormat::UInt32 ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT;
+    }
+
+    /// @brief  Pack of compiled shaders, next to the sources (loaded relative to the working directory as well)
+    constexpr const char* s_ShaderCachePath = "shaders/ShaderCache.bin";
+
+    UINT ToD3DBindFlags(BufferType type) noexcept
+    {
+        switch (type)
+        {
+            case BufferType::Vertex:    return D3D11_BIND_VERTEX_BUFFER;
+            case BufferType::Index:     return D3D11_BIND_INDEX_BUFFER;
+            case BufferType::Constant:  return D3D11_BIND_CONSTANT_BUFFER;
+        }
+        return 0u;
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------------------
+* Device & Swap Chain
+*--------------------------------------------------------------------------------------------------------------*/
+
+D3D11Backend::D3D11Backend(HWND hWnd)
+    : pShaderCache(std::make_unique<ShaderCache>(s_ShaderCachePath))
+{
+    // Set up configuration struct for our swap chain
+    DXGI_SWAP_CHAIN_DESC sd = {};
+    sd.BufferDesc.Width = 0;                                                /* Buffer Width, 0 to default to window */
+    sd.BufferDesc.Height = 0;                                               /* Buffer Height, 0 to default to window */
+    sd.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;                  /* Buffer Format, pixel layout (RGBA, 16) */
+    sd.BufferDesc.RefreshRate.Numerator = 0;                                /* Default refresh rate values for buffer front/back swap */
+    sd.BufferDesc.RefreshRate.Denominator = 0;
+    sd.BufferDesc.Scaling = DXGI_MODE_SCALING_UNSPECIFIED;                  /* Scaling method, none since we default to the window */
+    sd.BufferDesc.ScanlineOrdering = DXGI_MODE_SCANLINE_ORDER_UNSPECIFIED;  /* Scaline order, useful if display is interlaced */
+    sd.SampleDesc.Count = 1;                                                /* AntiAliasing, 1 sample with 0 quality meaning no AA */
+    sd.SampleDesc.Quality = 0;                                              /* AA quality 0, disabled */
+    sd.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;                       /* Buffer usage, to render target output */
+    sd.BufferCount = 2;                                                     /* = 1 means double buffering, front buffer and back buffer (set to 2 because using Flip for swap effect and it said i had to) */
+    sd.OutputWindow = hWnd;                                                 /* Window handle to draw on */
+    sd.Windowed = TRUE;
+    sd.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;                          /* How to handle front buffer after presenting a surface, we specify to discard it after */
+    sd.Flags = 0;
+
+    UINT swapCreateFlags = 0u;
+
+#ifndef NDEBUG
+    swapCreateFlags |= D3D11_CREATE_DEVICE_DEBUG;
+#endif
+
+    // Create the device now and swap chain
+    GFX_THROW_INFO(D3D11CreateDeviceAndSwapChain(
+        nullptr,                    /* Graphics adapter, setting to null lets it choose it for us */
+        D3D_DRIVER_TYPE_HARDWARE,   /* Driver type, whether software acceleration or hardware. Hardware for us */
+        nullptr,                    /* Must be null if DriverType is not software (its hardware for us). Handle to binary to our graphics driver to use */
+        swapCreateFlags,            /* Various creation flags, here we specify to create the device on the debug layer so we can retrieve detailed debug outputs */
+        nullptr,                    /* Feature level to support (D3D9, 10, 11, etc..), null results in a default feature level (see docs) */
+        0,                          /* Number of feature levels being used, guessing if the above is null, it'll auto this */
+        D3D11_SDK_VERSION,          /* SDK Version, self explanatory */
+        &sd,                        /* Configuration struct for our swap chain */
+        &pSwapChain,                /* Pointer to our swap chain, to be filled out upon creation */
+        &pDevice,                   /* Pointer to our ID3D11 device, to be filled out upon creation */
+        nullptr,                    /* Out Pointer, would fill out with the feature level actually secured */
+        &pContext                   /* Pointer to our device context, to be filled out upon creation */
+        ));
+
+    // Constant buffer offsets (*SetConstantBuffers1) + NO_OVERWRITE maps on constant buffers need the 11.1 runtime
+    // and driver support, without them the ConstantRing falls back to one buffer per constant buffer
+    if (SUCCEEDED(pContext.As(&pContext1)))
+    {
+        D3D11_FEATURE_DATA_D3D11_OPTIONS options = {};
+        if (SUCCEEDED(pDevice->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))))
+        {
+            b_ConstantBufferOffsets = options.ConstantBufferOffsetting && options.MapNoOverwriteOnDynamicConstantBuffer;
+        }
+    }
+
+    // Gain access to texture subresource in swap chain (back buffer)
+    // Similar to QueryInterface from COM in terms of inputs, except we're querying a resource on the interface
+    GFX_THROW_INFO(pSwapChain->GetBuffer(
+        0,                             /* Index of buffer we wanna get, 0 gives us the back buffer*/
+        UUID(ID3D11Resource),          /* UUID thing of COM interface, a D3D11 resource in our case */
+        (&pBackBuffer)                 /* PP to our resource to be filled out */
+        ));
+
+    // Create a reference to the render target view to access and modify later
+    GFX_THROW_INFO(pDevice->CreateRenderTargetView(
+        pBackBuffer.Get(),      /* Buffer in which to receive the render target from */
+        nullptr,                /* Config struct to specify how we wanna receive the RTV, default it */
+        &pTarget                /* ID3D11 Target to be filled out */
+        ));
+
+    // Create a depth stencil state
+    D3D11_DEPTH_STENCIL_DESC dsDesc = {};
+    dsDesc.DepthEnable = TRUE;
+    dsDesc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ALL;
+    dsDesc.DepthFunc = D3D11_COMPARISON_LESS;
+
+    GFX_THROW_INFO(pDevice->CreateDepthStencilState(&dsDesc, &pDSState));
+
+    // Set depth stencil state (Output merger, discards pixels before putting it into the frame buffer)
+    pContext->OMSetDepthStencilState(pDSState.Get(), 1u);
+
+    // Create a depth stencil texture
+    D3D11_TEXTURE2D_DESC dtDesc = {};
+    dtDesc.Format = DXGI_FORMAT_D32_FLOAT; // D32 is specific for depth values
+    dtDesc.Width = 800u; // Matching viewport
+    dtDesc.Height = 600u;
+    dtDesc.MipLevels = 1u; // no mipmapping
+    dtDesc.ArraySize = 1u; // no mipmapping
+    dtDesc.SampleDesc.Count = 1u; // no AA
+    dtDesc.SampleDesc.Quality = 0u; // no AA
+    dtDesc.Usage = D3D11_USAGE_DEFAULT;
+    dtDesc.BindFlags = D3D11_BIND_DEPTH_STENCIL;
+
+
+    // Depth generated every frame so no need to store its data
+    GFX_THROW_INFO(pDevice->CreateTexture2D(&dtDesc, nullptr, &pDSTexture));
+
+    // Create depth stencil view
+    D3D11_DEPTH_STENCIL_VIEW_DESC dsvDesc = {};
+    dsvDesc.Format = DXGI_FORMAT_D32_FLOAT;
+    dsvDesc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2D;
+    dsvDesc.Texture2D.MipSlice = 0u;
+
+    GFX_THROW_INFO(pDevice->CreateDepthStencilView(pDSTexture.Get(), &dsvDesc, &pDSV));
+
+    // Bind depth stencil view to the pipeline, output merger for same reason mentioned above
+    pContext->OMSetRenderTargets(1u, pTarget.GetAddressOf(), pDSV.Get());
+
+    // Configure viewport
+    m_ViewPort = {};
+    m_ViewPort.Width = 800;
+    m_ViewPort.Height = 600;
+    m_ViewPort.MinDepth = 0;
+    m_ViewPort.MaxDepth = 1;
+    m_ViewPort.TopLeftX = 0;
+    m_ViewPort.TopLeftY = 0;
+    pContext->RSSetViewports(1u, &m_ViewPort);
+}
+
+D3D11Backend::~D3D11Backend()
+{
+    if (pShaderCache)
+    {
+        pShaderCache->Save();
+    }
+}
+
+D3D11Backend::D3D11Backend(const D3D11Backend& immediate, DeferredTag)
+    : pDevice(immediate.pDevice), pImmediate(&immediate), m_ViewPort(immediate.m_ViewPort),
+    b_ConstantBufferOffsets(immediate.b_ConstantBufferOffsets)
+{
+    GFX_THROW_INFO(pDevice->CreateDeferredContext(0u, &pContext));
+    if (b_ConstantBufferOffsets)
+    {
+        GFX_THROW_INFO(pContext.As(&pContext1));
+    }
+}
+
+void D3D11Backend::Clear(float r, float g, float b) noexcept
+{
+    const D3D11Backend& views = pImmediate ? *pImmediate : *this;
+    const float Color[] = {r, g, b, 1.f};
+    pContext->ClearRenderTargetView(views.pTarget.Get(), Color);
+    // Clear depth buffer
+    pContext->ClearDepthStencilView(views.pDSV.Get(), D3D11_CLEAR_DEPTH, 1.f, 0u);
+}
+
+void D3D11Backend::Present()
+{
+#ifndef NDEBUG
+    m_InfoManager.Set(); // To only get latest debug messages
+#endif
+    GFX_DEVICE_REMOVED_EXCEPT(pSwapChain->Present(1, 0u))
+}
+
+void D3D11Backend::Resize(unsigned int width, unsigned int height)
+{
+    m_ViewPort.Width = float(width);
+    m_ViewPort.Height = float(height);
+
+    // Clear existing references to back buffer
+    ID3D11RenderTargetView* nullViews [] = { nullptr };
+    pContext->OMSetRenderTargets(ARRAYSIZE(nullViews), nullViews, nullptr);
+    pTarget.Reset();
+    pDSV.Reset();
+    pBackBuffer.Reset();
+    pContext->Flush();
+
+    // Resize existing swapchain
+    pSwapChain->ResizeBuffers(2u, width, height, DXGI_FORMAT_R8G8B8A8_UNORM, 0u);
+
+    // Get the new backbuffer texture to use as a render target
+    GFX_THROW_INFO(pSwapChain->GetBuffer(0, UUID(ID3D11Resource), (&pBackBuffer)));
+
+    GFX_THROW_INFO(pDevice->CreateRenderTargetView(pBackBuffer.Get(), nullptr, &pTarget));
+
+    // Create Depth/Stencil buffer and create the Depth Stencil View
+    {
+        D3D11_TEXTURE2D_DESC dtDesc = {};
+        dtDesc.Format = DXGI_FORMAT_D32_FLOAT; // D32 is specific for depth values
+        dtDesc.Width = width; // Matching viewport
+        dtDesc.Height = height;
+        dtDesc.MipLevels = 1u; // no mipmapping
+        dtDesc.ArraySize = 1u; // no mipmapping
+        dtDesc.SampleDesc.Count = 1u; // no AA
+        dtDesc.SampleDesc.Quality = 0u; // no AA
+        dtDesc.Usage = D3D11_USAGE_DEFAULT;
+        dtDesc.BindFlags = D3D11_BIND_DEPTH_STENCIL;
+
+        pDevice->CreateTexture2D(&dtDesc, nullptr, &pDSTexture);
+
+        // Create depth stencil view
+        D3D11_DEPTH_STENCIL_VIEW_DESC dsvDesc = {};
+        dsvDesc.Format = DXGI_FORMAT_D32_FLOAT;
+        dsvDesc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2D;
+        dsvDesc.Texture2D.MipSlice = 0u;
+
+        GFX_THROW_INFO(pDevice->CreateDepthStencilView(pDSTexture.Get(), &dsvDesc, &pDSV));
+    }
+
+    // Reset viewport to proper size
+    pContext->RSSetViewports(1, &m_ViewPort);
+
+    // Set render target view/dsv for rednering
+    pContext->OMSetRenderTargets(1, pTarget.GetAddressOf(), pDSV.Get());
+}
+
+unsigned int D3D11Backend::GetWidth() const noexcept
+{
+    return UINT(m_ViewPort.Width);
+}
+
+unsigned int D3D11Backend::GetHeight() const noexcept
+{
+    return UINT(m_ViewPort.Height);
+}
+
+/*--------------------------------------------------------------------------------------------------------------
+* Resource Creation
+*--------------------------------------------------------------------------------------------------------------*/
+
+std::unique_ptr<GpuBuffer> D3D11Backend::CreateBuffer(const BufferDesc& desc, const void* pInitialData)
+{
+    auto pBuffer = std::make_unique<D3D11Buffer>(desc);
+
+    D3D11_BUFFER_DESC bd = {};
+    bd.BindFlags = ToD3DBindFlags(desc.Type);
+    bd.Usage = desc.Usage == BufferUsage::Dynamic ? D3D11_USAGE_DYNAMIC : D3D11_USAGE_DEFAULT;
+    bd.CPUAccessFlags = desc.Usage == BufferUsage::Dynamic ? D3D11_CPU_ACCESS_WRITE : 0u;
+    bd.MiscFlags = 0u;
+    bd.ByteWidth = desc.ByteWidth;
+    bd.StructureByteStride = desc.StructureByteStride;
+
+    // Setup subresource that points to the buffer (no subresource means it'll be filled out later through Map)
+    D3D11_SUBRESOURCE_DATA sd = {};
+    sd.pSysMem = pInitialData;
+
+    GFX_THROW_INFO(pDevice->CreateBuffer(&bd, pInitialData ? &sd : nullptr, &pBuffer->pBuffer));
+
+    return pBuffer;
+}
+
+std::unique_ptr<GpuShader> D3D11Backend::CreateShader(ShaderStage stage, const std::wstring& path, const std::vector<ShaderMacro>& defines)
+{
+    auto pShader = std::make_unique<D3D11Shader>(stage);
+    pShader->pBytecodeBlob = LoadBytecode(stage, path, defines);
+
+    if (stage == ShaderStage::Vertex)
+    {
+        GFX_THROW_INFO(pDevice->CreateVertexShader(
+            pShader->pBytecodeBlob->GetBufferPointer(),
+            pShader->pBytecodeBlob->GetBufferSize(),
+            nullptr,
+            &pShader->pVertexShader));
+    }
+    else
+    {
+        GFX_THROW_INFO(pDevice->CreatePixelShader(
+            pShader->pBytecodeBlob->GetBufferPointer(),
+            pShader->pBytecodeBlob->GetBufferSize(),
+            nullptr,
+            &pShader->pPixelShader));
+    }
+
+    return pShader;
+}
+
+void D3D11Backend::PrecompileShaders(const std::vector<ShaderDesc>& shaders)
+{
+    // D3DCompile is thread safe, and cache hits cost next to nothing so they don't need sorting out first
+    std::vector<std::exception_ptr> errors(shaders.size());
+    std::vector<std::thread> compilers;
+    compilers.reserve(shaders.size());
+    for (size_t i = 0; i < shaders.size(); i++)
+    {
+        compilers.emplace_back([this, &shaders, &errors, i]
+        {
+            try
+            {
+                LoadBytecode(shaders[i].Stage, shaders[i].Path, shaders[i].Defines);
+            }
+            catch (...)
+            {
+                errors[i] = std::current_exception();
+            }
+        });
+    }
+    for (auto& compiler : compilers)
+    {
+        compiler.join();
+    }
+    for (const auto& error : errors)
+    {
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+    pShaderCache->Save();
+}
+
+wrl::ComPtr<ID3DBlob> D3D11Backend::LoadBytecode(ShaderStage stage, const std::wstring& path, const std::vector<ShaderMacro>& defines)
+{
+    assert("Shaders are created on the immediate backend" && pShaderCache);
+
+    // The source is hashed as part of the key, so it gets read either way and compiled from memory on a miss
+    std::ifstream file(std::filesystem::path(path), std::ios::binary);
+    if (!file)
+    {
+        throw Graphics::HrException(__LINE__, __FILE__, HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND));
+    }
+    const std::vector<unsigned char> source((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    const char* entryPoint = stage == ShaderStage::Vertex ? "VSMain" : "PSMain";
+    const char* profile = stage == ShaderStage::Vertex ? "vs_5_0" : "ps_5_0";
+    const UINT flags = 0u; //D3DCOMPILE_ENABLE_STRICTNESS;
+
+    // A different compiler can produce different bytecode for the same inputs
+    const uint64_t key = ShaderCache::MakeKey(source, defines, entryPoint, profile, (uint64_t(D3D_COMPILER_VERSION) << 32u) | flags);
+
+    wrl::ComPtr<ID3DBlob> pBytecode;
+    HRESULT blobHR = S_OK;
+    const bool bCached = pShaderCache->Find(key, [&pBytecode, &blobHR](std::span<const unsigned char> cached)
+    {
+        if (SUCCEEDED(blobHR = D3DCreateBlob(cached.size(), &pBytecode)))
+        {
+            memcpy(pBytecode->GetBufferPointer(), cached.data(), cached.size());
+        }
+    });
+    if (bCached)
+    {
+        GFX_THROW_NOINFO(blobHR);
+        return pBytecode;
+    }
+
+    // D3D wants a null terminated array of macros
+    std::vector<D3D_SHADER_MACRO> d3dDefines;
+    d3dDefines.reserve(defines.size() + 1);
+    for (const auto& d : defines)
+    {
+        d3dDefines.push_back({d.Name, d.Definition});
+    }
+    d3dDefines.push_back({nullptr, nullptr});
+
+    wrl::ComPtr<ID3DBlob> pErrorBlob;
+    const std::string sourceName = std::filesystem::path(path).string();
+
+    // Cant use throw macro, have to retrieve error msg from pErrorBlob
+    HRESULT compHR = D3DCompile(
+        source.data(),
+        source.size(),
+        sourceName.c_str(),
+        d3dDefines.data(),
+        nullptr,
+        entryPoint,
+        profile,
+        flags, 0u, &pBytecode, &pErrorBlob);
+
+    if (compHR < 0)
+    {
+        if (pErrorBlob)
+        {
+            auto err = (char*)pErrorBlob->GetBufferPointer();
+            throw Graphics::HrException(__LINE__, __FILE__, compHR, {err});
+        }
+        throw Graphics::HrException(__LINE__, __FILE__, compHR);
+    }
+
+    pShaderCache->Insert(key, pBytecode->GetBufferPointer(), pBytecode->GetBufferSize());
+    return pBytecode;
+}
+
+std::unique_ptr<GpuInputLayout> D3D11Backend::CreateInputLayout(const std::vector<VertexElementDesc>& elements, const GpuShader& vertexShader)
+{
+    assert("Input layouts must be created from vertex shader bytecode" && vertexShader.GetStage() == ShaderStage::Vertex);
+    auto pLayout = std::make_unique<D3D11InputLayout>();
+    const auto& vs = static_cast<const D3D11Shader&>(vertexShader);
+
+    std::vector<D3D11_INPUT_ELEMENT_DESC> ied;
+    ied.reserve(elements.size());
+    for (const auto& e : elements)
+    {
+        ied.push_back({
+            e.SemanticName,
+            e.SemanticIndex,
+            ToDXGI(e.Format),
+            e.InputSlot,
+            e.AlignedByteOffset == APPEND_ALIGNED_ELEMENT ? D3D11_APPEND_ALIGNED_ELEMENT : e.AlignedByteOffset,
+            e.bPerInstance ? D3D11_INPUT_PER_INSTANCE_DATA : D3D11_INPUT_PER_VERTEX_DATA,
+            e.InstanceDataStepRate
+        });
+    }
+
+    GFX_THROW_INFO(pDevice->CreateInputLayout(
+        ied.data(),
+        UINT(ied.size()),
+        vs.pBytecodeBlob->GetBufferPointer(),
+        vs.pBytecodeBlob->GetBufferSize(),
+        &pLayout->pInputLayout));
+
+    return pLayout;
+}
+
+void D3D11Backend::UpdateBuffer(GpuBuffer& buffer, const void* pData, size_t size)
+{
+    auto& d3dBuffer = static_cast<D3D11Buffer&>(buffer);
+
+    // Resource already sent to the GPU, we just need to modify it
+    D3D11_MAPPED_SUBRESOURCE msd;
+    GFX_THROW_INFO(pContext->Map(d3dBuffer.pBuffer.Get(), 0u, D3D11_MAP_WRITE_DISCARD, 0, &msd));
+
+    // We got the buffer data from the gpu, update its data
+    memcpy(msd.pData, pData, size);
+
+    pContext->Unmap(d3dBuffer.pBuffer.Get(), 0u);
+}
+
+void* D3D11Backend::MapBuffer(GpuBuffer& buffer, MapMode mode)
+{
+    auto& d3dBuffer = static_cast<D3D11Buffer&>(buffer);
+
+    D3D11_MAPPED_SUBRESOURCE msd;
+    GFX_THROW_INFO(pContext->Map(d3dBuffer.pBuffer.Get(), 0u,
+        mode == MapMode::Discard ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE, 0, &msd));
+    return msd.pData;
+}
+
+void D3D11Backend::UnmapBuffer(GpuBuffer& buffer) noexcept
+{
+    pContext->Unmap(static_cast<D3D11Buffer&>(buffer).pBuffer.Get(), 0u);
+}
+
+/*--------------------------------------------------------------------------------------------------------------
+* Pipeline State
+*--------------------------------------------------------------------------------------------------------------*/
+
+void D3D11Backend::SetVertexBuffer(unsigned int slot, const GpuBuffer& buffer, unsigned int stride, unsigned int offset) noexcept
+{
+    const auto& d3dBuffer = static_cast<const D3D11Buffer&>(buffer);
+    pContext->IASetVertexBuffers(slot, 1u, d3dBuffer.pBuffer.GetAddressOf(), &stride, &offset);
+}
+
+void D3D11Backend::SetIndexBuffer(const GpuBuffer& buffer, IndexFormat format) noexcept
+{
+    const auto& d3dBuffer = static_cast<const D3D11Buffer&>(buffer);
+    pContext->IASetIndexBuffer(d3dBuffer.pBuffer.Get(), ToDXGI(format), 0u);
+}
+
+void D3D11Backend::SetConstantBuffer(ShaderStage stage, unsigned int slot, const GpuBuffer& buffer) noexcept
+{
+    const auto& d3dBuffer = static_cast<const D3D11Buffer&>(buffer);
+    if (stage == ShaderStage::Vertex)
+    {
+        pContext->VSSetConstantBuffers(slot, 1u, d3dBuffer.pBuffer.GetAddressOf());
+    }
+    else
+    {
+        pContext->PSSetConstantBuffers(slot, 1u, d3dBuffer.pBuffer.GetAddressOf());
+    }
+}
+
+void D3D11Backend::SetConstantBufferRange(ShaderStage stage, unsigned int slot, const GpuBuffer& buffer, unsigned int firstConstant, unsigned int numConstants) noexcept
+{
+    assert("Constant buffer offsets aren't supported on this device" && b_ConstantBufferOffsets);
+    const auto& d3dBuffer = static_cast<const D3D11Buffer&>(buffer);
+    if (stage == ShaderStage::Vertex)
+    {
+        pContext1->VSSetConstantBuffers1(slot, 1u, d3dBuffer.pBuffer.GetAddressOf(), &firstConstant, &numConstants);
+    }
+    else
+    {
+        pContext1->PSSetConstantBuffers1(slot, 1u, d3dBuffer.pBuffer.GetAddressOf(), &firstConstant, &numConstants);
+    }
+}
+
+bool D3D11Backend::SupportsConstantBufferOffsets() const noexcept
+{
+    return b_ConstantBufferOffsets;
+}
+
+void D3D11Backend::SetShader(const GpuShader& shader) noexcept
+{
+    const auto& d3dShader = static_cast<const D3D11Shader&>(shader);
+    if (shader.GetStage() == ShaderStage::Vertex)
+    {
+        pContext->VSSetShader(d3dShader.pVertexShader.Get(), nullptr, 0u);
+    }
+    else
+    {
+        pContext->PSSetShader(d3dShader.pPixelShader.Get(), nullptr, 0u);
+    }
+}
+
+void D3D11Backend::SetInputLayout(const GpuInputLayout& layout) noexcept
+{
+    pContext->IASetInputLayout(static_cast<const D3D11InputLayout&>(layout).pInputLayout.Get());
+}
+
+void D3D11Backend::SetTopology(PrimitiveTopology topology) noexcept
+{
+    pContext->IASetPrimitiveTopology(ToD3D(topology));
+}
+
+void D3D11Backend::BindRenderTarget() noexcept
+{
+    // Output merger, flip model swap chains unbind the back buffer on every Present. Deferred contexts start out (and
+    // the immediate one ends up after ExecuteCommandList) with nothing set, so the depth state and viewport go too
+    const D3D11Backend& views = pImmediate ? *pImmediate : *this;
+    pContext->OMSetDepthStencilState(views.pDSState.Get(), 1u);
+    pContext->RSSetViewports(1u, &views.m_ViewPort);
+    pContext->OMSetRenderTargets(1u, views.pTarget.GetAddressOf(), views.pDSV.Get());
+}
+
+/*--------------------------------------------------------------------------------------------------------------
+* Draw
+*--------------------------------------------------------------------------------------------------------------*/
+
+void D3D11Backend::DrawIndexed(unsigned int count)
+{
+    pContext->DrawIndexed(count, 0u, 0u);
+    //GFX_THROW_INFO_ONLY(pContext->DrawIndexed(count, 0u, 0u));
+}
+
+void D3D11Backend::DrawIndexedInstanced(unsigned int count, unsigned int instanceCount)
+{
+    pContext->DrawIndexedInstanced(count, instanceCount, 0u, 0, 0u);
+}
+
+/*--------------------------------------------------------------------------------------------------------------
+* Command Lists
+*--------------------------------------------------------------------------------------------------------------*/
+
+/// @brief  Forwards state/draw calls to a deferred D3D11Backend, FinishCommandList turns them into an
+///         ID3D11CommandList for the immediate context
+class D3D11Backend::DeferredCommandList : public CommandList
+{
+public:
+    explicit DeferredCommandList(D3D11Backend& immediate)
+        : CommandList(immediate), m_Deferred(immediate, DeferredTag{})
+    {}
+
+    void Clear(float r, float g, float b) noexcept override { m_Deferred.Clear(r, g, b); }
+
+    void SetVertexBuffer(unsigned int slot, const GpuBuffer& buffer, unsigned int stride, unsigned int offset) noexcept override { m_Deferred.SetVertexBuffer(slot, buffer, stride, offset); }
+    void SetIndexBuffer(const GpuBuffer& buffer, IndexFormat format) noexcept override { m_Deferred.SetIndexBuffer(buffer, format); }
+    void SetConstantBuffer(ShaderStage stage, unsigned int slot, const GpuBuffer& buffer) noexcept override { m_Deferred.SetConstantBuffer(stage, slot, buffer); }
+    void SetConstantBufferRange(ShaderStage stage, unsigned int slot, const GpuBuffer& buffer, unsigned int firstConstant, unsigned int numConstants) noexcept override
+    {
+        m_Deferred.SetConstantBufferRange(stage, slot, buffer, firstConstant, numConstants);
+    }
+    void SetShader(const GpuShader& shader) noexcept override { m_Deferred.SetShader(shader); }
+    void SetInputLayout(const GpuInputLayout& layout) noexcept override { m_Deferred.SetInputLayout(layout); }
+    void SetTopology(PrimitiveTopology topology) noexcept override { m_Deferred.SetTopology(topology); }
+    void BindRenderTarget() noexcept override { m_Deferred.BindRenderTarget(); }
+
+    void DrawIndexed(unsigned int count) override { m_Deferred.DrawIndexed(count); }
+    void DrawIndexedInstanced(unsigned int count, unsigned int instanceCount) override { m_Deferred.DrawIndexedInstanced(count, instanceCount); }
+
+    ID3D11DeviceContext* GetContext() const noexcept { return m_Deferred.pContext.Get(); }
+
+private:
+    D3D11Backend m_Deferred;
+};
+
+std::unique_ptr<CommandList> D3D11Backend::CreateCommandList()
+{
+    assert("Command lists are created from the immediate backend" && !pImmediate);
+    return std::make_unique<DeferredCommandList>(*this);
+}
+
+void D3D11Backend::ExecuteCommandList(CommandList& list)
+{
+    auto& deferred = static_cast<DeferredCommandList&>(list);
+
+    // FALSE on both ends: the deferred context starts the next recording from scratch, and the immediate context's
+    // state gets cleared instead of saved/restored around the list (the StateCache forgets it all anyway)
+    wrl::ComPtr<ID3D11CommandList> pCommandList;
+    GFX_THROW_INFO(deferred.GetContext()->FinishCommandList(FALSE, &pCommandList));
+    pContext->ExecuteCommandList(pCommandList.Get(), FALSE);
+}
@@ -0,0 +1,90 @@
+﻿#pragma once
+
+#include "RomanceWin.h" // Include first for all our switch cases since d3d11 also includes Windows.h
+#include <d3d11_1.h>
+#include <wrl.h>
+#include "RenderBackend.h"
+#include "DxgiInfoManager.h"
+
+class ShaderCache;
+
+/// Rundown of the various parts of D3D11
+/// - DEVICE:   Must create a device, acts as an interface between the application and the graphics hardware. We use Device
+///             whenever we want to allocate resources like a texture, buffer, shader, etc...
+/// - CONTEXT:  We use a context to issue draw commands. Command lists are recorded on deferred contexts (one per list,
+///             any thread) and played back on the immediate one with ExecuteCommandList
+class D3D11Backend : public RenderBackend
+{
+public:
+    D3D11Backend(HWND hWnd);
+    /// @brief  Saves whatever got compiled into the shader cache
+    ~D3D11Backend() override;
+    D3D11Backend(const D3D11Backend&) = delete;
+    D3D11Backend& operator=(const D3D11Backend&) = delete;
+
+    void Clear(float r, float g, float b) noexcept override;
+    void Present() override;
+    void Resize(unsigned int width, unsigned int height) override;
+    unsigned int GetWidth() const noexcept override;
+    unsigned int GetHeight() const noexcept override;
+
+    std::unique_ptr<GpuBuffer> CreateBuffer(const BufferDesc& desc, const void* pInitialData) override;
+    std::unique_ptr<GpuShader> CreateShader(ShaderStage stage, const std::wstring& path, const std::vector<ShaderMacro>& defines) override;
+    std::unique_ptr<GpuInputLayout> CreateInputLayout(const std::vector<VertexElementDesc>& elements, const GpuShader& vertexShader) override;
+    /// @brief  Compiles every shader missing from the cache on a thread of its own and saves the cache
+    void PrecompileShaders(const std::vector<ShaderDesc>& shaders) override;
+    void UpdateBuffer(GpuBuffer& buffer, const void* pData, size_t size) override;
+    void* MapBuffer(GpuBuffer& buffer, MapMode mode) override;
+    void UnmapBuffer(GpuBuffer& buffer) noexcept override;
+
+    void SetVertexBuffer(unsigned int slot, const GpuBuffer& buffer, unsigned int stride, unsigned int offset) noexcept override;
+    void SetIndexBuffer(const GpuBuffer& buffer, IndexFormat format) noexcept override;
+    void SetConstantBuffer(ShaderStage stage, unsigned int slot, const GpuBuffer& buffer) noexcept override;
+    void SetConstantBufferRange(ShaderStage stage, unsigned int slot, const GpuBuffer& buffer, unsigned int firstConstant, unsigned int numConstants) noexcept override;
+    bool SupportsConstantBufferOffsets() const noexcept override;
+    void SetShader(const GpuShader& shader) noexcept override;
+    void SetInputLayout(const GpuInputLayout& layout) noexcept override;
+    void SetTopology(PrimitiveTopology topology) noexcept override;
+    void BindRenderTarget() noexcept override;
+
+    void DrawIndexed(unsigned int count) override;
+    void DrawIndexedInstanced(unsigned int count, unsigned int instanceCount) override;
+
+    std::unique_ptr<CommandList> CreateCommandList() override;
+    void ExecuteCommandList(CommandList& list) override;
+
+private:
+    class DeferredCommandList;
+    struct DeferredTag {};
+
+    /// @brief  Records on a new deferred context of immediate's device, drawing into immediate's back buffer. No swap
+    ///         chain, so it can't Present/Resize
+    D3D11Backend(const D3D11Backend& immediate, DeferredTag);
+
+    /// @brief  Bytecode out of the shader cache, compiled (and added to the cache) on a miss. Thread safe
+    Microsoft::WRL::ComPtr<ID3DBlob> LoadBytecode(ShaderStage stage, const std::wstring& path, const std::vector<ShaderMacro>& defines);
+
+private:
+    Microsoft::WRL::ComPtr<ID3D11Device> pDevice;
+    Microsoft::WRL::ComPtr<IDXGISwapChain> pSwapChain;
+    Microsoft::WRL::ComPtr<ID3D11DeviceContext> pContext;
+    /* D3D11.1 interface for binding constant buffers at an offset, null on runtimes that don't have it */
+    Microsoft::WRL::ComPtr<ID3D11DeviceContext1> pContext1;
+    Microsoft::WRL::ComPtr<ID3D11RenderTargetView> pTarget;
+    Microsoft::WRL::ComPtr<ID3D11DepthStencilView> pDSV;
+
+    Microsoft::WRL::ComPtr<ID3D11Texture2D> pBackBuffer;
+    Microsoft::WRL::ComPtr<ID3D11Texture2D> pDSTexture;
+    Microsoft::WRL::ComPtr<ID3D11DepthStencilState> pDSState;
+    /* Set on deferred backends, the render target/depth views and viewport are always the immediate backend's */
+    const D3D11Backend* pImmediate = nullptr;
+
+    D3D11_VIEWPORT m_ViewPort;
+    bool b_ConstantBufferOffsets = false;
+    /* Only the immediate backend creates shaders, deferred ones forward that to it */
+    std::unique_ptr<ShaderCache> pShaderCache;
+
+#ifndef NDEBUG
+    DxgiInfoManager m_InfoManager;
+#endif
+};
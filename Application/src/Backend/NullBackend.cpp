@@ -0,0 +1,194 @@
+﻿#include "NullBackend.h"
+
+#include <cassert>
+#include <cstring>
+
+/*--------------------------------------------------------------------------------------------------------------
+* Null Resources
+*--------------------------------------------------------------------------------------------------------------*/
+
+namespace
+{
+    class NullBuffer : public GpuBuffer
+    {
+    public:
+        NullBuffer(const BufferDesc& desc, const void* pInitialData)
+            : GpuBuffer(desc), m_Data(desc.ByteWidth)
+        {
+            if (pInitialData)
+            {
+                memcpy(m_Data.data(), pInitialData, desc.ByteWidth);
+            }
+        }
+        std::vector<unsigned char> m_Data;
+    };
+
+    class NullShader : public GpuShader
+    {
+    public:
+        NullShader(ShaderStage stage, const std::wstring& path, const std::vector<ShaderMacro>& defines)
+            : GpuShader(stage), m_Path(path), m_NumDefines(defines.size())
+        {}
+        std::wstring m_Path;
+        size_t m_NumDefines;
+    };
+
+    class NullInputLayout : public GpuInputLayout
+    {
+    public:
+        explicit NullInputLayout(const std::vector<VertexElementDesc>& elements)
+            : m_Elements(elements)
+        {}
+        std::vector<VertexElementDesc> m_Elements;
+    };
+}
+
+/*--------------------------------------------------------------------------------------------------------------
+* Frame
+*--------------------------------------------------------------------------------------------------------------*/
+
+NullBackend::NullBackend(unsigned int width, unsigned int height) noexcept
+    : m_Width(width), m_Height(height)
+{}
+
+void NullBackend::Clear(float r, float g, float b) noexcept
+{}
+
+void NullBackend::Present()
+{
+    m_LastFrame = m_CurrentFrame;
+    m_CurrentFrame = {};
+    m_FrameCount++;
+}
+
+void NullBackend::Resize(unsigned int width, unsigned int height)
+{
+    m_Width = width;
+    m_Height = height;
+}
+
+unsigned int NullBackend::GetWidth() const noexcept
+{
+    return m_Width;
+}
+
+unsigned int NullBackend::GetHeight() const noexcept
+{
+    return m_Height;
+}
+
+/*--------------------------------------------------------------------------------------------------------------
+* Resource Creation
+*--------------------------------------------------------------------------------------------------------------*/
+
+std::unique_ptr<GpuBuffer> NullBackend::CreateBuffer(const BufferDesc& desc, const void* pInitialData)
+{
+    return std::make_unique<NullBuffer>(desc, pInitialData);
+}
+
+std::unique_ptr<GpuShader> NullBackend::CreateShader(ShaderStage stage, const std::wstring& path, const std::vector<ShaderMacro>& defines)
+{
+    return std::make_unique<NullShader>(stage, path, defines);
+}
+
+std::unique_ptr<GpuInputLayout> NullBackend::CreateInputLayout(const std::vector<VertexElementDesc>& elements, const GpuShader& vertexShader)
+{
+    assert("Input layouts must be created from a vertex shader" && vertexShader.GetStage() == ShaderStage::Vertex);
+    return std::make_unique<NullInputLayout>(elements);
+}
+
+void NullBackend::UpdateBuffer(GpuBuffer& buffer, const void* pData, size_t size)
+{
+    auto& nullBuffer = static_cast<NullBuffer&>(buffer);
+    assert("Buffer update overflows the buffer" && size <= nullBuffer.m_Data.size());
+    memcpy(nullBuffer.m_Data.data(), pData, size);
+    m_CurrentFrame.bytesUploaded += size;
+}
+
+void* NullBackend::MapBuffer(GpuBuffer& buffer, MapMode mode)
+{
+    // Nothing reads the memory behind our back, so both modes just hand out the buffer
+    m_CurrentFrame.maps++;
+    return static_cast<NullBuffer&>(buffer).m_Data.data();
+}
+
+void NullBackend::UnmapBuffer(GpuBuffer& buffer) noexcept
+{}
+
+/*--------------------------------------------------------------------------------------------------------------
+* Pipeline State
+*--------------------------------------------------------------------------------------------------------------*/
+
+void NullBackend::SetVertexBuffer(unsigned int slot, const GpuBuffer& buffer, unsigned int stride, unsigned int offset) noexcept
+{
+    m_CurrentFrame.stateChanges++;
+}
+
+void NullBackend::SetIndexBuffer(const GpuBuffer& buffer, IndexFormat format) noexcept
+{
+    m_CurrentFrame.stateChanges++;
+}
+
+void NullBackend::SetConstantBuffer(ShaderStage stage, unsigned int slot, const GpuBuffer& buffer) noexcept
+{
+    m_CurrentFrame.stateChanges++;
+}
+
+void NullBackend::SetConstantBufferRange(ShaderStage stage, unsigned int slot, const GpuBuffer& buffer, unsigned int firstConstant, unsigned int numConstants) noexcept
+{
+    assert("Constant range runs past the end of the buffer" && (firstConstant + numConstants) * 16u <= buffer.GetDesc().ByteWidth);
+    m_CurrentFrame.stateChanges++;
+}
+
+bool NullBackend::SupportsConstantBufferOffsets() const noexcept
+{
+    return true;
+}
+
+void NullBackend::SetShader(const GpuShader& shader) noexcept
+{
+    m_CurrentFrame.stateChanges++;
+}
+
+void NullBackend::SetInputLayout(const GpuInputLayout& layout) noexcept
+{
+    m_CurrentFrame.stateChanges++;
+}
+
+void NullBackend::SetTopology(PrimitiveTopology topology) noexcept
+{
+    m_CurrentFrame.stateChanges++;
+}
+
+void NullBackend::BindRenderTarget() noexcept
+{
+    m_CurrentFrame.stateChanges++;
+}
+
+/*--------------------------------------------------------------------------------------------------------------
+* Draw
+*--------------------------------------------------------------------------------------------------------------*/
+
+void NullBackend::DrawIndexed(unsigned int count)
+{
+    m_CurrentFrame.drawCalls++;
+    m_CurrentFrame.indices += count;
+    m_CurrentFrame.instances++;
+}
+
+void NullBackend::DrawIndexedInstanced(unsigned int count, unsigned int instanceCount)
+{
+    m_CurrentFrame.drawCalls++;
+    m_CurrentFrame.indices += static_cast<unsigned long long>(count) * instanceCount;
+    m_CurrentFrame.instances += instanceCount;
+}
+
+const NullBackend::FrameStats& NullBackend::GetLastFrameStats() const noexcept
+{
+    return m_LastFrame;
+}
+
+unsigned long long NullBackend::GetFrameCount() const noexcept
+{
+    return m_FrameCount;
+}
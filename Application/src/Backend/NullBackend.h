@@ -0,0 +1,60 @@
+﻿#pragma once
+#include "RenderBackend.h"
+
+/// @brief  Headless backend, no device, no window. Buffers live in system memory (so updates still cost what a
+///         map + memcpy would) and every call is counted instead of executed. Lets App/Drawables/Bindables run on a
+///         build machine with no GPU for benchmarking and catching CPU side regressions
+class NullBackend : public RenderBackend
+{
+public:
+    /// @brief  Per frame counters, reset on Present()
+    struct FrameStats
+    {
+        unsigned int drawCalls = 0u;
+        unsigned long long indices = 0u;
+        unsigned int instances = 0u;
+        unsigned int stateChanges = 0u;
+        size_t bytesUploaded = 0u;
+        unsigned int maps = 0u;
+    };
+
+public:
+    NullBackend(unsigned int width, unsigned int height) noexcept;
+
+    void Clear(float r, float g, float b) noexcept override;
+    void Present() override;
+    void Resize(unsigned int width, unsigned int height) override;
+    unsigned int GetWidth() const noexcept override;
+    unsigned int GetHeight() const noexcept override;
+
+    std::unique_ptr<GpuBuffer> CreateBuffer(const BufferDesc& desc, const void* pInitialData) override;
+    std::unique_ptr<GpuShader> CreateShader(ShaderStage stage, const std::wstring& path, const std::vector<ShaderMacro>& defines) override;
+    std::unique_ptr<GpuInputLayout> CreateInputLayout(const std::vector<VertexElementDesc>& elements, const GpuShader& vertexShader) override;
+    void UpdateBuffer(GpuBuffer& buffer, const void* pData, size_t size) override;
+    void* MapBuffer(GpuBuffer& buffer, MapMode mode) override;
+    void UnmapBuffer(GpuBuffer& buffer) noexcept override;
+
+    void SetVertexBuffer(unsigned int slot, const GpuBuffer& buffer, unsigned int stride, unsigned int offset) noexcept override;
+    void SetIndexBuffer(const GpuBuffer& buffer, IndexFormat format) noexcept override;
+    void SetConstantBuffer(ShaderStage stage, unsigned int slot, const GpuBuffer& buffer) noexcept override;
+    void SetConstantBufferRange(ShaderStage stage, unsigned int slot, const GpuBuffer& buffer, unsigned int firstConstant, unsigned int numConstants) noexcept override;
+    bool SupportsConstantBufferOffsets() const noexcept override;
+    void SetShader(const GpuShader& shader) noexcept override;
+    void SetInputLayout(const GpuInputLayout& layout) noexcept override;
+    void SetTopology(PrimitiveTopology topology) noexcept override;
+    void BindRenderTarget() noexcept override;
+
+    void DrawIndexed(unsigned int count) override;
+    void DrawIndexedInstanced(unsigned int count, unsigned int instanceCount) override;
+
+    /// @brief  Stats of the last presented frame
+    const FrameStats& GetLastFrameStats() const noexcept;
+    unsigned long long GetFrameCount() const noexcept;
+
+private:
+    unsigned int m_Width;
+    unsigned int m_Height;
+    unsigned long long m_FrameCount = 0u;
+    FrameStats m_CurrentFrame;
+    FrameStats m_LastFrame;
+};
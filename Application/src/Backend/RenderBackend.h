@@ -0,0 +1,88 @@
+﻿#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "RenderTypes.h"
+
+class CommandList;
+
+/// @brief  Interface between Graphics and the actual device. Graphics owns one of these and bindables only ever go
+///         through it (via Bindable::GetBackend), never through a device/context directly.
+///         - D3D11Backend: the real thing, swap chain presenting to a window
+///         - NullBackend:  headless, keeps resources in system memory and records stats instead of drawing
+///         - SoftwareBackend: CPU rasterizer running C++ ports of the shaders, reference images & GPU free fallback
+///         State and draw calls can also be recorded into a CommandList on another thread and executed here later
+class RenderBackend
+{
+public:
+    virtual ~RenderBackend() = default;
+
+    /*--------------------------------------------------------------------------------------------------------------
+    * Frame
+    *--------------------------------------------------------------------------------------------------------------*/
+
+    /// @brief  Clears the render target with the specified color and resets depth
+    virtual void Clear(float r, float g, float b) noexcept = 0;
+    /// @brief  Presents the back buffer (or finishes the frame for offscreen backends)
+    virtual void Present() = 0;
+    virtual void Resize(unsigned int width, unsigned int height) = 0;
+    virtual unsigned int GetWidth() const noexcept = 0;
+    virtual unsigned int GetHeight() const noexcept = 0;
+
+    /*--------------------------------------------------------------------------------------------------------------
+    * Resource Creation
+    *--------------------------------------------------------------------------------------------------------------*/
+
+    /// @brief  pInitialData may be null for dynamic buffers, otherwise must point to desc.ByteWidth bytes
+    virtual std::unique_ptr<GpuBuffer> CreateBuffer(const BufferDesc& desc, const void* pInitialData) = 0;
+    virtual std::unique_ptr<GpuShader> CreateShader(ShaderStage stage, const std::wstring& path, const std::vector<ShaderMacro>& defines) = 0;
+    virtual std::unique_ptr<GpuInputLayout> CreateInputLayout(const std::vector<VertexElementDesc>& elements, const GpuShader& vertexShader) = 0;
+    /// @brief  Gets shaders that are about to be created ready up front, backends that compile them can do all of
+    ///         them at once (in parallel) instead of one by one in CreateShader. Nothing to do by default
+    virtual void PrecompileShaders(const std::vector<ShaderDesc>& /*shaders*/) {}
+    /// @brief  Overwrites the contents of a dynamic buffer
+    virtual void UpdateBuffer(GpuBuffer& buffer, const void* pData, size_t size) = 0;
+    /// @brief  Maps a dynamic buffer for writing, it has to be unmapped again before a draw that reads it
+    virtual void* MapBuffer(GpuBuffer& buffer, MapMode mode) = 0;
+    virtual void UnmapBuffer(GpuBuffer& buffer) noexcept = 0;
+
+    /*--------------------------------------------------------------------------------------------------------------
+    * Pipeline State
+    *--------------------------------------------------------------------------------------------------------------*/
+
+    /// @brief  Slot 0 holds per vertex data, slot 1 per instance data for instanced draws
+    virtual void SetVertexBuffer(unsigned int slot, const GpuBuffer& buffer, unsigned int stride, unsigned int offset) noexcept = 0;
+    virtual void SetIndexBuffer(const GpuBuffer& buffer, IndexFormat format) noexcept = 0;
+    virtual void SetConstantBuffer(ShaderStage stage, unsigned int slot, const GpuBuffer& buffer) noexcept = 0;
+    /// @brief  Binds numConstants shader constants (16 bytes each) of buffer starting at firstConstant, both have to
+    ///         be multiples of 16. Only valid if SupportsConstantBufferOffsets
+    virtual void SetConstantBufferRange(ShaderStage stage, unsigned int slot, const GpuBuffer& buffer, unsigned int firstConstant, unsigned int numConstants) noexcept = 0;
+    /// @brief  Whether constant buffers can be bound at an offset and mapped with MapMode::NoOverwrite (D3D11.1)
+    virtual bool SupportsConstantBufferOffsets() const noexcept = 0;
+    virtual void SetShader(const GpuShader& shader) noexcept = 0;
+    virtual void SetInputLayout(const GpuInputLayout& layout) noexcept = 0;
+    virtual void SetTopology(PrimitiveTopology topology) noexcept = 0;
+    /// @brief  Binds the back buffer + depth buffer as the output target. Has to be redone after Present/Resize
+    virtual void BindRenderTarget() noexcept = 0;
+
+    /*--------------------------------------------------------------------------------------------------------------
+    * Draw
+    *--------------------------------------------------------------------------------------------------------------*/
+
+    virtual void DrawIndexed(unsigned int count) = 0;
+    /// @brief  Draws the bound index buffer instanceCount times, per instance elements of the input layout advance
+    ///         once per instance
+    virtual void DrawIndexedInstanced(unsigned int count, unsigned int instanceCount) = 0;
+
+    /*--------------------------------------------------------------------------------------------------------------
+    * Command Lists
+    *--------------------------------------------------------------------------------------------------------------*/
+
+    /// @brief  A list to record state/draw calls into, each list can be filled on its own thread. Defaults to a
+    ///         RecordedCommandList (plain command stream replayed through this backend)
+    virtual std::unique_ptr<CommandList> CreateCommandList();
+    /// @brief  Runs everything recorded into list (which has to come from this backend's CreateCommandList) and
+    ///         empties it for the next recording. Bound state afterwards is undefined, rebind before drawing
+    virtual void ExecuteCommandList(CommandList& list);
+};
@@ -0,0 +1,177 @@
+﻿#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/// Platform neutral descriptions of everything a Bindable needs from the GPU. Backends translate these into their
+/// native types (D3D11_PRIMITIVE_TOPOLOGY, DXGI_FORMAT, D3D11_INPUT_ELEMENT_DESC...) so nothing outside of a backend
+/// has to include d3d11.h, which is what lets the renderer core build and run without Windows/a GPU.
+
+enum class PrimitiveTopology
+{
+    PointList,
+    LineList,
+    LineStrip,
+    TriangleList,
+    TriangleStrip
+};
+
+enum class IndexFormat
+{
+    UInt16,
+    UInt32
+};
+
+/// @brief  Format of a single vertex element (maps 1:1 to the DXGI formats we use). The packed ones are named after
+///         the DirectX::PackedVector type they're stored as (see VertexLayout.h), N ones read as [-1, 1] / [0, 1]
+enum class ElementFormat
+{
+    Float1,
+    Float2,
+    Float3,
+    Float4,
+    Half2,      /* R16G16_FLOAT */
+    Half4,      /* R16G16B16A16_FLOAT */
+    ShortN2,    /* R16G16_SNORM */
+    ShortN4,    /* R16G16B16A16_SNORM */
+    UShortN4,   /* R16G16B16A16_UNORM */
+    ByteN4,     /* R8G8B8A8_SNORM */
+    UByteN4,    /* R8G8B8A8_UNORM */
+    UDecN4      /* R10G10B10A2_UNORM */
+};
+
+/// @brief  Bytes one element of format takes up in a vertex, 0 for values that aren't a format (e.g. read from a file)
+constexpr unsigned int GetElementSize(ElementFormat format) noexcept
+{
+    switch (format)
+    {
+    case ElementFormat::Float1:     return 4u;
+    case ElementFormat::Float2:     return 8u;
+    case ElementFormat::Float3:     return 12u;
+    case ElementFormat::Float4:     return 16u;
+    case ElementFormat::Half2:      return 4u;
+    case ElementFormat::Half4:      return 8u;
+    case ElementFormat::ShortN2:    return 4u;
+    case ElementFormat::ShortN4:    return 8u;
+    case ElementFormat::UShortN4:   return 8u;
+    case ElementFormat::ByteN4:     return 4u;
+    case ElementFormat::UByteN4:    return 4u;
+    case ElementFormat::UDecN4:     return 4u;
+    }
+    return 0u;
+}
+
+enum class ShaderStage
+{
+    Vertex,
+    Pixel
+};
+
+enum class BufferType
+{
+    Vertex,
+    Index,
+    Constant
+};
+
+enum class BufferUsage
+{
+    Default,    /* GPU read/write, set once on creation */
+    Dynamic     /* CPU writes every frame through UpdateBuffer */
+};
+
+/// @brief  How a dynamic buffer gets mapped (D3D11_MAP_WRITE_DISCARD / D3D11_MAP_WRITE_NO_OVERWRITE)
+enum class MapMode
+{
+    Discard,    /* Previous contents are gone, the driver hands back fresh memory if the GPU still reads the old one */
+    NoOverwrite /* Contents are kept, caller promises not to touch anything the GPU might still be reading */
+};
+
+/// @brief  Equivalent of D3D11_APPEND_ALIGNED_ELEMENT, element directly follows the previous one
+constexpr unsigned int APPEND_ALIGNED_ELEMENT = 0xffffffffu;
+
+/// @brief  Mirror of D3D11_INPUT_ELEMENT_DESC
+struct VertexElementDesc
+{
+    const char*     SemanticName;
+    unsigned int    SemanticIndex;
+    ElementFormat   Format;
+    unsigned int    InputSlot;
+    unsigned int    AlignedByteOffset;
+    bool            bPerInstance;
+    unsigned int    InstanceDataStepRate;
+};
+
+/// @brief  Mirror of D3D_SHADER_MACRO, does NOT need a null terminator entry (backends add it if they need one)
+struct ShaderMacro
+{
+    const char* Name;
+    const char* Definition;
+};
+
+/// @brief  Everything CreateShader takes, for handing over a set of shaders at once
+struct ShaderDesc
+{
+    ShaderStage                 Stage;
+    std::wstring                Path;
+    std::vector<ShaderMacro>    Defines;
+};
+
+struct BufferDesc
+{
+    BufferType      Type;
+    BufferUsage     Usage;
+    unsigned int    ByteWidth;
+    unsigned int    StructureByteStride;
+};
+
+/*--------------------------------------------------------------------------------------------------------------
+* Backend owned GPU objects, bindables hold onto these and hand them back to the backend when binding. Each backend
+* derives its own versions holding the native resource
+*--------------------------------------------------------------------------------------------------------------*/
+
+/// @brief  Ids are never reused, so unlike addresses they can be compared against a resource that has since been
+///         destroyed (what the StateCache relies on)
+inline uint64_t NextGpuResourceId() noexcept
+{
+    static std::atomic<uint64_t> s_NextId = 1u;
+    return s_NextId++;
+}
+
+class GpuResource
+{
+public:
+    GpuResource() noexcept : m_Id(NextGpuResourceId()) {}
+    virtual ~GpuResource() = default;
+    GpuResource(const GpuResource&) = delete;
+    GpuResource& operator=(const GpuResource&) = delete;
+
+    uint64_t GetId() const noexcept { return m_Id; }
+private:
+    uint64_t m_Id;
+};
+
+class GpuBuffer : public GpuResource
+{
+public:
+    explicit GpuBuffer(const BufferDesc& desc) noexcept : m_Desc(desc) {}
+
+    const BufferDesc& GetDesc() const noexcept { return m_Desc; }
+protected:
+    BufferDesc m_Desc;
+};
+
+class GpuShader : public GpuResource
+{
+public:
+    explicit GpuShader(ShaderStage stage) noexcept : m_Stage(stage) {}
+
+    ShaderStage GetStage() const noexcept { return m_Stage; }
+protected:
+    ShaderStage m_Stage;
+};
+
+class GpuInputLayout : public GpuResource
+{
+};
@@ -0,0 +1,193 @@
+﻿#include "ShaderCache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "Utility/Hash.h"
+
+ShaderCache::ShaderCache(std::string path)
+    : m_Path(std::move(path))
+{
+    if (m_Pack.Open(m_Path))
+    {
+        ReadIndex();
+    }
+}
+
+ShaderCache::~ShaderCache() = default;
+
+uint64_t ShaderCache::MakeKey(std::span<const unsigned char> source, const std::vector<ShaderMacro>& defines,
+    const char* entryPoint, const char* profile, uint64_t compilerFlags) noexcept
+{
+    Fnv1a hash;
+    const uint64_t sourceSize = source.size();
+    hash.Add(&sourceSize, sizeof(sourceSize));
+    hash.Add(source.data(), source.size());
+    // Same defines in another order can compile differently (redefinitions), so the order counts
+    for (const auto& define : defines)
+    {
+        hash.Add(define.Name);
+        hash.Add(define.Definition);
+    }
+    hash.Add(entryPoint);
+    hash.Add(profile);
+    hash.Add(&compilerFlags, sizeof(compilerFlags));
+    return hash.Get();
+}
+
+bool ShaderCache::Find(uint64_t key, const std::function<void(std::span<const unsigned char>)>& read) const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    const auto it = std::lower_bound(m_Entries.begin(), m_Entries.end(), key,
+        [](const PackEntry& entry, uint64_t k) { return entry.key < k; });
+    if (it != m_Entries.end() && it->key == key)
+    {
+        m_Hits++;
+        read({ m_Pack.GetData() + it->offset, static_cast<size_t>(it->size) });
+        return true;
+    }
+    if (const auto pending = m_Pending.find(key); pending != m_Pending.end())
+    {
+        m_Hits++;
+        read(pending->second);
+        return true;
+    }
+    m_Misses++;
+    return false;
+}
+
+void ShaderCache::Insert(uint64_t key, const void* pBytecode, size_t size)
+{
+    const auto* pBytes = static_cast<const unsigned char*>(pBytecode);
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Pending.emplace(key, std::vector<unsigned char>(pBytes, pBytes + size));
+}
+
+bool ShaderCache::Save()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (m_Pending.empty())
+    {
+        return true;
+    }
+
+    // Old and new blobs merged into one index sorted by key
+    struct Blob
+    {
+        uint64_t key;
+        const unsigned char* pData;
+        size_t size;
+    };
+    std::vector<Blob> blobs;
+    blobs.reserve(m_Entries.size() + m_Pending.size());
+    for (const PackEntry& entry : m_Entries)
+    {
+        if (!m_Pending.contains(entry.key))
+        {
+            blobs.push_back({ entry.key, m_Pack.GetData() + entry.offset, static_cast<size_t>(entry.size) });
+        }
+    }
+    for (const auto& [key, bytecode] : m_Pending)
+    {
+        blobs.push_back({ key, bytecode.data(), bytecode.size() });
+    }
+    std::sort(blobs.begin(), blobs.end(), [](const Blob& a, const Blob& b) { return a.key < b.key; });
+
+    const auto Align = [](uint64_t offset) { return (offset + s_BlobAlignment - 1u) / s_BlobAlignment * s_BlobAlignment; };
+    std::vector<PackEntry> index(blobs.size());
+    uint64_t offset = Align(sizeof(PackHeader) + index.size() * sizeof(PackEntry));
+    for (size_t i = 0; i < blobs.size(); i++)
+    {
+        index[i] = { blobs[i].key, offset, blobs[i].size };
+        offset = Align(offset + blobs[i].size);
+    }
+
+    const std::string tempPath = m_Path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            return false;
+        }
+        PackHeader header = {};
+        memcpy(header.magic, s_Magic, sizeof(s_Magic));
+        header.version = s_Version;
+        header.count = index.size();
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(index.data()), static_cast<std::streamsize>(index.size() * sizeof(PackEntry)));
+        for (size_t i = 0; i < blobs.size(); i++)
+        {
+            const std::streamoff padding = static_cast<std::streamoff>(index[i].offset) - file.tellp();
+            for (std::streamoff p = 0; p < padding; p++)
+            {
+                file.put('\0');
+            }
+            file.write(reinterpret_cast<const char*>(blobs[i].pData), static_cast<std::streamsize>(blobs[i].size));
+        }
+        if (!file)
+        {
+            return false;
+        }
+    }
+
+    // Windows won't replace a file that's still mapped, and the old blobs were only needed for the copy above
+    m_Entries = {};
+    m_Pack.Close();
+    std::error_code error;
+    std::filesystem::rename(tempPath, m_Path, error);
+    if (m_Pack.Open(m_Path))
+    {
+        ReadIndex();
+    }
+    if (error)
+    {
+        return false;
+    }
+    m_Pending.clear();
+    return true;
+}
+
+size_t ShaderCache::GetHitCount() const noexcept
+{
+    return m_Hits;
+}
+
+size_t ShaderCache::GetMissCount() const noexcept
+{
+    return m_Misses;
+}
+
+void ShaderCache::ReadIndex() noexcept
+{
+    m_Entries = {};
+    const unsigned char* pData = m_Pack.GetData();
+    const size_t size = m_Pack.GetSize();
+    if (size < sizeof(PackHeader))
+    {
+        return;
+    }
+
+    PackHeader header;
+    memcpy(&header, pData, sizeof(header));
+    if (memcmp(header.magic, s_Magic, sizeof(s_Magic)) != 0 || header.version != s_Version ||
+        header.count > (size - sizeof(PackHeader)) / sizeof(PackEntry))
+    {
+        return;
+    }
+
+    // Index sits right after the header, 8 byte aligned since the mapping itself is page aligned
+    const auto* pEntries = reinterpret_cast<const PackEntry*>(pData + sizeof(PackHeader));
+    const std::span<const PackEntry> entries(pEntries, static_cast<size_t>(header.count));
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        const bool bInBounds = entries[i].offset <= size && entries[i].size <= size - entries[i].offset;
+        const bool bSorted = i == 0u || entries[i - 1u].key < entries[i].key;
+        if (!bInBounds || !bSorted)
+        {
+            return;
+        }
+    }
+    m_Entries = entries;
+}
@@ -0,0 +1,73 @@
+﻿#pragma once
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "RenderTypes.h"
+#include "Utility/MappedFile.h"
+
+/// @brief  Persistent cache of compiled shader bytecode, so a warm start creates its shaders without compiling any.
+///         Every blob lives in one pack file that gets memory mapped on load: a header, an index sorted by key and the
+///         blobs themselves. Keys hash everything the compiler output depends on (MakeKey), a changed source or define
+///         just makes a new key and the stale blob is never looked up again.
+///         Find/Insert/Save are safe from several threads at once, new blobs stay in memory until Save rewrites the pack
+class ShaderCache
+{
+public:
+    /// @brief  Maps the pack at path if there is one (a missing or unreadable pack is just an empty cache)
+    explicit ShaderCache(std::string path);
+    ~ShaderCache();
+    ShaderCache(const ShaderCache&) = delete;
+    ShaderCache& operator=(const ShaderCache&) = delete;
+
+    /// @brief  compilerFlags should also carry anything else that changes the output, like the compiler version
+    static uint64_t MakeKey(std::span<const unsigned char> source, const std::vector<ShaderMacro>& defines,
+        const char* entryPoint, const char* profile, uint64_t compilerFlags) noexcept;
+
+    /// @brief  Hands the bytecode for key to read, false (and read isn't called) if it isn't cached. The span is only
+    ///         valid inside read, it's called under the lock so a Save on another thread can't unmap it meanwhile
+    bool Find(uint64_t key, const std::function<void(std::span<const unsigned char>)>& read) const;
+    void Insert(uint64_t key, const void* pBytecode, size_t size);
+
+    /// @brief  Rewrites the pack with everything inserted since it was loaded, nothing happens if nothing was. Goes
+    ///         through a temporary file so a crash can't leave a half written pack. Returns false if that failed
+    bool Save();
+
+    size_t GetHitCount() const noexcept;
+    size_t GetMissCount() const noexcept;
+
+private:
+    struct PackHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t count;
+    };
+    struct PackEntry
+    {
+        uint64_t key;
+        uint64_t offset;    /* From the start of the file */
+        uint64_t size;
+    };
+
+    /// @brief  Points m_Entries at the mapped index, leaves it empty if the pack doesn't look right
+    void ReadIndex() noexcept;
+
+private:
+    static constexpr char s_Magic[4] = { 'R', 'D', 'S', 'C' };
+    static constexpr uint32_t s_Version = 1u;
+    static constexpr size_t s_BlobAlignment = 16u;
+
+    std::string m_Path;
+    MappedFile m_Pack;
+    std::span<const PackEntry> m_Entries;
+
+    mutable std::mutex m_Mutex;
+    std::unordered_map<uint64_t, std::vector<unsigned char>> m_Pending;
+    mutable size_t m_Hits = 0u;
+    mutable size_t m_Misses = 0u;
+};
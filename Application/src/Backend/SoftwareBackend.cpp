@@ -0,0 +1,1074 @@
+﻿#include "SoftwareBackend.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+using namespace SoftwareShaders;
+
+/*--------------------------------------------------------------------------------------------------------------
+* Software Resources
+*--------------------------------------------------------------------------------------------------------------*/
+
+class SoftwareBuffer : public GpuBuffer
+{
+public:
+    SoftwareBuffer(const BufferDesc& desc, const void* pInitialData)
+        : GpuBuffer(desc), m_Data(desc.ByteWidth)
+    {
+        if (pInitialData)
+        {
+            memcpy(m_Data.data(), pInitialData, desc.ByteWidth);
+        }
+    }
+    std::vector<unsigned char> m_Data;
+};
+
+class SoftwareShader : public GpuShader
+{
+public:
+    SoftwareShader(ShaderStage stage, const Kernel* pKernel) noexcept
+        : GpuShader(stage), pKernel(pKernel)
+    {}
+    const Kernel* pKernel;
+};
+
+class SoftwareInputLayout : public GpuInputLayout
+{
+public:
+    explicit SoftwareInputLayout(const std::vector<VertexElementDesc>& elements)
+    {
+        // Resolve append aligned offsets the same way the input assembler would (separately for every slot)
+        unsigned int offsets[2] = {};
+        for (const auto& e : elements)
+        {
+            assert(e.InputSlot < 2u && "Only slot 0 (vertex) and 1 (instance) are supported");
+            unsigned int& offset = offsets[e.InputSlot & 1u];
+            const unsigned int elementOffset = e.AlignedByteOffset == APPEND_ALIGNED_ELEMENT ? offset : e.AlignedByteOffset;
+            if (strcmp(e.SemanticName, "Position") == 0 && e.SemanticIndex == 0u)
+            {
+                m_PositionOffset = elementOffset;
+                m_PositionFormat = e.Format;
+            }
+            else if (strcmp(e.SemanticName, "InstanceTransform") == 0 && e.SemanticIndex == 0u)
+            {
+                // Rows 1-3 are expected to directly follow row 0
+                assert(e.bPerInstance && e.InputSlot == 1u && e.Format == ElementFormat::Float4);
+                m_InstanceTransformOffset = elementOffset;
+                b_HasInstanceTransform = true;
+            }
+            offset = elementOffset + GetElementSize(e.Format);
+        }
+    }
+    unsigned int m_PositionOffset = 0u;
+    ElementFormat m_PositionFormat = ElementFormat::Float3;
+    unsigned int m_InstanceTransformOffset = 0u;
+    bool b_HasInstanceTransform = false;
+};
+
+/*--------------------------------------------------------------------------------------------------------------
+* Setup Primitives
+*--------------------------------------------------------------------------------------------------------------*/
+
+struct SoftwareBackend::RasterTriangle
+{
+    // Screen space, snapped to 1/16th of a pixel
+    float x[3], y[3];
+    float z[3];
+    float invW[3];
+    /* Varyings pre-multiplied by 1/w so they can be interpolated linearly in screen space */
+    float varyings[3][MaxVaryings];
+    /* Edge i is the one opposite vertex i, inside when A * (px - x) + B * (py - y) >= bias */
+    float edgeA[3], edgeB[3], edgeBias[3];
+    float invArea;
+    int minX, minY, maxX, maxY;
+    PixelKernel pixelKernel;
+    unsigned int numVaryings;
+};
+
+struct SoftwareBackend::RasterLine
+{
+    float x[2], y[2];
+    float z[2];
+    float invW[2];
+    float varyings[2][MaxVaryings];
+    PixelKernel pixelKernel;
+    unsigned int numVaryings;
+};
+
+namespace
+{
+    /// @brief  Clip against |x|,|y| <= G * w instead of w, lets the rasterizer eat small overhangs without creating
+    ///         new vertices while keeping screen coords small enough for float edge functions
+    constexpr float s_GuardBand = 4.f;
+    constexpr unsigned int s_NumClipPlanes = 6u;
+    constexpr unsigned int s_MaxClipVerts = 3u + s_NumClipPlanes;
+
+    /// @brief  Signed distance to the clip plane, >= 0 is inside
+    float ClipDistance(const ClipVertex& v, unsigned int plane) noexcept
+    {
+        switch (plane)
+        {
+        case 0: return v.z;                         // Near
+        case 1: return v.w - v.z;                   // Far
+        case 2: return s_GuardBand * v.w - v.x;
+        case 3: return s_GuardBand * v.w + v.x;
+        case 4: return s_GuardBand * v.w - v.y;
+        default: return s_GuardBand * v.w + v.y;
+        }
+    }
+
+    unsigned int OutCode(const ClipVertex& v) noexcept
+    {
+        unsigned int code = 0u;
+        for (unsigned int p = 0; p < s_NumClipPlanes; p++)
+        {
+            code |= ClipDistance(v, p) < 0.f ? 1u << p : 0u;
+        }
+        return code;
+    }
+
+    ClipVertex Lerp(const ClipVertex& a, const ClipVertex& b, float t) noexcept
+    {
+        ClipVertex out;
+        out.x = a.x + (b.x - a.x) * t;
+        out.y = a.y + (b.y - a.y) * t;
+        out.z = a.z + (b.z - a.z) * t;
+        out.w = a.w + (b.w - a.w) * t;
+        for (unsigned int i = 0; i < MaxVaryings; i++)
+        {
+            out.varyings[i] = a.varyings[i] + (b.varyings[i] - a.varyings[i]) * t;
+        }
+        return out;
+    }
+
+    /// @brief  Packs 4 rgba pixels (one channel per register) into R8G8B8A8_UNORM
+    __m128i PackColor(const __m128* rgba) noexcept
+    {
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.f);
+        const __m128 scale = _mm_set1_ps(255.f);
+        __m128i packed = _mm_setzero_si128();
+        for (int c = 0; c < 4; c++)
+        {
+            const __m128 saturated = _mm_min_ps(_mm_max_ps(rgba[c], zero), one);
+            packed = _mm_or_si128(packed, _mm_slli_epi32(_mm_cvtps_epi32(_mm_mul_ps(saturated, scale)), c * 8));
+        }
+        return packed;
+    }
+
+    float SnapToSubPixel(float v) noexcept
+    {
+        return std::floor(v * 16.f + 0.5f) * (1.f / 16.f);
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------------------
+* Exception
+*--------------------------------------------------------------------------------------------------------------*/
+
+SoftwareBackend::ShaderException::ShaderException(int line, const char* file, const std::wstring& path) noexcept
+    : RomanceException(line, file)
+{
+    // Shader paths are plain ascii, narrow them for what()
+    for (const wchar_t c : path)
+    {
+        m_Path.push_back(static_cast<char>(c));
+    }
+}
+
+const char* SoftwareBackend::ShaderException::what() const noexcept
+{
+    m_whatBuffer = std::string(GetType()) + "\n[Shader] " + m_Path + " has no software implementation\n" + GetOriginString();
+    return m_whatBuffer.c_str();
+}
+
+const char* SoftwareBackend::ShaderException::GetType() const noexcept
+{
+    return "Romance Software Shader Exception";
+}
+
+/*--------------------------------------------------------------------------------------------------------------
+* Frame
+*--------------------------------------------------------------------------------------------------------------*/
+
+SoftwareBackend::SoftwareBackend(unsigned int width, unsigned int height, unsigned int numThreads)
+{
+    Resize(width, height);
+
+    if (numThreads == 0u)
+    {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // Calling thread takes part in every ParallelFor so it counts as one of the threads
+    for (unsigned int i = 1; i < numThreads; i++)
+    {
+        m_Workers.emplace_back(&SoftwareBackend::WorkerLoop, this);
+    }
+}
+
+SoftwareBackend::~SoftwareBackend()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        b_Quit = true;
+    }
+    m_WorkCV.notify_all();
+    for (auto& worker : m_Workers)
+    {
+        worker.join();
+    }
+}
+
+void SoftwareBackend::Clear(float r, float g, float b) noexcept
+{
+    // Clear covers the whole target so anything binned before it would be overwritten anyway. The clear itself is
+    // deferred to the tiles so it's done in parallel and while the tile is hot in cache
+    m_Triangles.clear();
+    m_Lines.clear();
+    for (auto& bin : m_Bins)
+    {
+        bin.clear();
+    }
+
+    const __m128 rgba[4] = { _mm_set1_ps(r), _mm_set1_ps(g), _mm_set1_ps(b), _mm_set1_ps(1.f) };
+    m_ClearColor = static_cast<uint32_t>(_mm_cvtsi128_si32(PackColor(rgba)));
+    b_ClearPending = true;
+}
+
+void SoftwareBackend::Present()
+{
+    Flush();
+    Resolve();
+    OnFramePresented(m_Resolved);
+}
+
+void SoftwareBackend::Resize(unsigned int width, unsigned int height)
+{
+    m_Width = std::max(1u, width);
+    m_Height = std::max(1u, height);
+    m_QuadsX = (m_Width + 1u) / 2u;
+    m_TilesX = (m_Width + s_TileSize - 1u) / s_TileSize;
+    m_TilesY = (m_Height + s_TileSize - 1u) / s_TileSize;
+
+    const size_t numPixels = size_t(m_QuadsX) * ((m_Height + 1u) / 2u) * 4u;
+    m_Color.assign(numPixels, 0u);
+    m_Depth.assign(numPixels, 1.f);
+    m_Resolved.assign(size_t(m_Width) * m_Height, 0u);
+
+    m_Triangles.clear();
+    m_Lines.clear();
+    m_Bins.assign(size_t(m_TilesX) * m_TilesY, {});
+}
+
+unsigned int SoftwareBackend::GetWidth() const noexcept
+{
+    return m_Width;
+}
+
+unsigned int SoftwareBackend::GetHeight() const noexcept
+{
+    return m_Height;
+}
+
+const std::vector<uint32_t>& SoftwareBackend::ReadBack() const noexcept
+{
+    return m_Resolved;
+}
+
+bool SoftwareBackend::SaveImage(const std::string& path) const
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+
+    file << "P6\n" << m_Width << " " << m_Height << "\n255\n";
+    std::vector<unsigned char> rgb(m_Resolved.size() * 3u);
+    for (size_t i = 0; i < m_Resolved.size(); i++)
+    {
+        rgb[i * 3 + 0] = static_cast<unsigned char>(m_Resolved[i]);
+        rgb[i * 3 + 1] = static_cast<unsigned char>(m_Resolved[i] >> 8);
+        rgb[i * 3 + 2] = static_cast<unsigned char>(m_Resolved[i] >> 16);
+    }
+    file.write(reinterpret_cast<const char*>(rgb.data()), std::streamsize(rgb.size()));
+    return bool(file);
+}
+
+/*--------------------------------------------------------------------------------------------------------------
+* Resource Creation
+*--------------------------------------------------------------------------------------------------------------*/
+
+std::unique_ptr<GpuBuffer> SoftwareBackend::CreateBuffer(const BufferDesc& desc, const void* pInitialData)
+{
+    return std::make_unique<SoftwareBuffer>(desc, pInitialData);
+}
+
+std::unique_ptr<GpuShader> SoftwareBackend::CreateShader(ShaderStage stage, const std::wstring& path, const std::vector<ShaderMacro>&)
+{
+    const Kernel* pKernel = SoftwareShaders::Find(stage, path);
+    if (!pKernel)
+    {
+        throw ShaderException(__LINE__, __FILE__, path);
+    }
+    return std::make_unique<SoftwareShader>(stage, pKernel);
+}
+
+std::unique_ptr<GpuInputLayout> SoftwareBackend::CreateInputLayout(const std::vector<VertexElementDesc>& elements, const GpuShader& vertexShader)
+{
+    return std::make_unique<SoftwareInputLayout>(elements);
+}
+
+void SoftwareBackend::UpdateBuffer(GpuBuffer& buffer, const void* pData, size_t size)
+{
+    auto& softwareBuffer = static_cast<SoftwareBuffer&>(buffer);
+    assert(size <= softwareBuffer.m_Data.size() && "Update larger than the buffer");
+    memcpy(softwareBuffer.m_Data.data(), pData, size);
+}
+
+void* SoftwareBackend::MapBuffer(GpuBuffer& buffer, MapMode mode)
+{
+    // Vertex work runs at draw time, nothing still reads a buffer once the draw call returned so there's nothing to
+    // rename on discard
+    return static_cast<SoftwareBuffer&>(buffer).m_Data.data();
+}
+
+void SoftwareBackend::UnmapBuffer(GpuBuffer& buffer) noexcept
+{}
+
+/*--------------------------------------------------------------------------------------------------------------
+* Pipeline State
+*--------------------------------------------------------------------------------------------------------------*/
+
+void SoftwareBackend::SetVertexBuffer(unsigned int slot, const GpuBuffer& buffer, unsigned int stride, unsigned int offset) noexcept
+{
+    assert(slot < s_NumVertexSlots);
+    if (slot >= s_NumVertexSlots)
+    {
+        return;
+    }
+    pVertexBuffers[slot] = &static_cast<const SoftwareBuffer&>(buffer);
+    m_VertexStrides[slot] = stride;
+    m_VertexOffsets[slot] = offset;
+}
+
+void SoftwareBackend::SetIndexBuffer(const GpuBuffer& buffer, IndexFormat format) noexcept
+{
+    pIndexBuffer = &static_cast<const SoftwareBuffer&>(buffer);
+    m_IndexFormat = format;
+}
+
+void SoftwareBackend::SetConstantBuffer(ShaderStage stage, unsigned int slot, const GpuBuffer& buffer) noexcept
+{
+    // Ported shaders only read cbuffer slot 0 of the vertex stage
+    if (stage == ShaderStage::Vertex && slot == 0u)
+    {
+        pVSConstants = &static_cast<const SoftwareBuffer&>(buffer);
+        m_VSConstantsOffset = 0u;
+        m_VSConstantsSize = pVSConstants->m_Data.size();
+    }
+}
+
+void SoftwareBackend::SetConstantBufferRange(ShaderStage stage, unsigned int slot, const GpuBuffer& buffer, unsigned int firstConstant, unsigned int numConstants) noexcept
+{
+    if (stage == ShaderStage::Vertex && slot == 0u)
+    {
+        pVSConstants = &static_cast<const SoftwareBuffer&>(buffer);
+        m_VSConstantsOffset = size_t(firstConstant) * 16u;
+        m_VSConstantsSize = size_t(numConstants) * 16u;
+    }
+}
+
+bool SoftwareBackend::SupportsConstantBufferOffsets() const noexcept
+{
+    return true;
+}
+
+void SoftwareBackend::SetShader(const GpuShader& shader) noexcept
+{
+    const auto& softwareShader = static_cast<const SoftwareShader&>(shader);
+    if (shader.GetStage() == ShaderStage::Vertex)
+    {
+        pVertexShader = &softwareShader;
+    }
+    else
+    {
+        pPixelShader = &softwareShader;
+    }
+}
+
+void SoftwareBackend::SetInputLayout(const GpuInputLayout& layout) noexcept
+{
+    pInputLayout = &static_cast<const SoftwareInputLayout&>(layout);
+}
+
+void SoftwareBackend::SetTopology(PrimitiveTopology topology) noexcept
+{
+    m_Topology = topology;
+}
+
+void SoftwareBackend::BindRenderTarget() noexcept
+{
+    // Single implicit target
+}
+
+/*--------------------------------------------------------------------------------------------------------------
+* Draw
+*--------------------------------------------------------------------------------------------------------------*/
+
+void SoftwareBackend::DrawIndexed(unsigned int count)
+{
+    DrawIndexedInstanced(count, 1u);
+}
+
+void SoftwareBackend::DrawIndexedInstanced(unsigned int count, unsigned int instanceCount)
+{
+    const SoftwareBuffer* pVertexBuffer = pVertexBuffers[0];
+    const unsigned int vertexStride = m_VertexStrides[0];
+    const unsigned int vertexOffset = m_VertexOffsets[0];
+    assert(pVertexBuffer && pIndexBuffer && pVertexShader && pInputLayout && "Incomplete pipeline state");
+    if (!pVertexBuffer || !pIndexBuffer || !pVertexShader || !pInputLayout || vertexStride == 0u)
+    {
+        return;
+    }
+
+    // Per instance world matrices (slot 1), only read when the layout actually feeds them to the shader
+    const SoftwareBuffer* pInstanceBuffer = pInputLayout->b_HasInstanceTransform ? pVertexBuffers[1] : nullptr;
+    assert((!pInputLayout->b_HasInstanceTransform || pInstanceBuffer) && "Layout expects an instance buffer in slot 1");
+    if (pInputLayout->b_HasInstanceTransform && !pInstanceBuffer)
+    {
+        return;
+    }
+    if (pInstanceBuffer)
+    {
+        const size_t instanceSize = pInstanceBuffer->m_Data.size();
+        const size_t instanceStart = size_t(m_VertexOffsets[1]) + pInputLayout->m_InstanceTransformOffset;
+        const size_t available = instanceSize >= instanceStart + 16u * sizeof(float) && m_VertexStrides[1] > 0u ?
+            (instanceSize - instanceStart - 16u * sizeof(float)) / m_VertexStrides[1] + 1u : 0u;
+        instanceCount = static_cast<unsigned int>(std::min<size_t>(instanceCount, available));
+    }
+
+    const Kernel& vs = *pVertexShader->pKernel;
+    const unsigned int numVaryings = pPixelShader ? std::min(vs.numVaryings, pPixelShader->pKernel->numVaryings) : 0u;
+    const PixelKernel pixelKernel = pPixelShader ? pPixelShader->pKernel->pixelKernel : nullptr;
+
+    // Vertex shader over the whole bound buffer up front, every index then just looks its vertex up
+    static const float s_ZeroConstants[64] = {};
+    const float* constants = s_ZeroConstants;
+    if (pVSConstants && m_VSConstantsSize >= vs.constantsSize && pVSConstants->m_Data.size() >= m_VSConstantsOffset + vs.constantsSize)
+    {
+        constants = reinterpret_cast<const float*>(pVSConstants->m_Data.data() + m_VSConstantsOffset);
+    }
+
+    const size_t vbSize = pVertexBuffer->m_Data.size();
+    const size_t numVertices = vbSize > vertexOffset ? (vbSize - vertexOffset) / vertexStride : 0u;
+    m_VertexCache.resize(numVertices);
+
+    VertexFetch fetch = { pVertexBuffer->m_Data.data() + vertexOffset, vertexStride, pInputLayout->m_PositionOffset, pInputLayout->m_PositionFormat, nullptr };
+    const auto ShadeVertices = [&]()
+    {
+        constexpr size_t vertexBatch = 1024u;
+        if (numVertices > vertexBatch * 4u && !m_Workers.empty())
+        {
+            const unsigned int numBatches = static_cast<unsigned int>((numVertices + vertexBatch - 1u) / vertexBatch);
+            ParallelFor(numBatches, [&](unsigned int batch)
+            {
+                const size_t begin = batch * vertexBatch;
+                vs.vertexKernel(fetch, constants, begin, std::min(begin + vertexBatch, numVertices), m_VertexCache.data());
+            });
+        }
+        else if (numVertices > 0u)
+        {
+            vs.vertexKernel(fetch, constants, 0u, numVertices, m_VertexCache.data());
+        }
+    };
+
+    // Primitive assembly, out of range indices read as a degenerate primitive (dropped) like D3D's zeroed fetch
+    const size_t indexSize = m_IndexFormat == IndexFormat::UInt16 ? 2u : 4u;
+    const uint32_t cutIndex = m_IndexFormat == IndexFormat::UInt16 ? 0xffffu : 0xffffffffu;
+    count = static_cast<unsigned int>(std::min<size_t>(count, pIndexBuffer->m_Data.size() / indexSize));
+    const unsigned char* pIndices = pIndexBuffer->m_Data.data();
+    const auto Index = [&](unsigned int i) -> uint32_t
+    {
+        if (indexSize == 2u)
+        {
+            uint16_t index;
+            memcpy(&index, pIndices + i * 2u, 2u);
+            return index;
+        }
+        uint32_t index;
+        memcpy(&index, pIndices + i * 4u, 4u);
+        return index;
+    };
+
+    const auto Triangle = [&](uint32_t i0, uint32_t i1, uint32_t i2)
+    {
+        if (i0 >= numVertices || i1 >= numVertices || i2 >= numVertices) return;
+        const ClipVertex tri[3] = { m_VertexCache[i0], m_VertexCache[i1], m_VertexCache[i2] };
+        const unsigned int oc[3] = { OutCode(tri[0]), OutCode(tri[1]), OutCode(tri[2]) };
+        if (oc[0] & oc[1] & oc[2]) return;
+
+        if ((oc[0] | oc[1] | oc[2]) == 0u)
+        {
+            SetupTriangle(tri, numVaryings, pixelKernel);
+            return;
+        }
+
+        // Sutherland-Hodgman against the planes the triangle actually crosses, then fan the polygon back out
+        ClipVertex polyA[s_MaxClipVerts], polyB[s_MaxClipVerts];
+        ClipVertex* pIn = polyA;
+        ClipVertex* pOut = polyB;
+        std::copy(tri, tri + 3, pIn);
+        unsigned int numIn = 3u;
+        const unsigned int crossed = oc[0] | oc[1] | oc[2];
+        for (unsigned int p = 0; p < s_NumClipPlanes && numIn >= 3u; p++)
+        {
+            if (!(crossed & (1u << p))) continue;
+
+            unsigned int numOut = 0u;
+            for (unsigned int v = 0; v < numIn; v++)
+            {
+                const ClipVertex& a = pIn[v];
+                const ClipVertex& b = pIn[(v + 1u) % numIn];
+                const float da = ClipDistance(a, p);
+                const float db = ClipDistance(b, p);
+                if (da >= 0.f) pOut[numOut++] = a;
+                if ((da >= 0.f) != (db >= 0.f)) pOut[numOut++] = Lerp(a, b, da / (da - db));
+            }
+            std::swap(pIn, pOut);
+            numIn = numOut;
+        }
+
+        for (unsigned int v = 1; v + 1u < numIn; v++)
+        {
+            const ClipVertex fan[3] = { pIn[0], pIn[v], pIn[v + 1u] };
+            SetupTriangle(fan, numVaryings, pixelKernel);
+        }
+    };
+
+    const auto Line = [&](uint32_t i0, uint32_t i1)
+    {
+        if (i0 >= numVertices || i1 >= numVertices) return;
+        ClipVertex a = m_VertexCache[i0];
+        ClipVertex b = m_VertexCache[i1];
+        const unsigned int oc0 = OutCode(a), oc1 = OutCode(b);
+        if (oc0 & oc1) return;
+
+        // Parametric clip, both ends pulled in towards the other
+        float t0 = 0.f, t1 = 1.f;
+        for (unsigned int p = 0; p < s_NumClipPlanes; p++)
+        {
+            if (!((oc0 | oc1) & (1u << p))) continue;
+            const float da = ClipDistance(a, p);
+            const float db = ClipDistance(b, p);
+            const float t = da / (da - db);
+            if (da < 0.f) t0 = std::max(t0, t);
+            else          t1 = std::min(t1, t);
+        }
+        if (t0 >= t1) return;
+
+        SetupLine(Lerp(a, b, t0), Lerp(a, b, t1), numVaryings, pixelKernel);
+    };
+
+    // Instances run back to back through the same vertex cache, a primitive is fully set up before the next
+    // instance overwrites it
+    for (unsigned int instance = 0; instance < instanceCount; instance++)
+    {
+        if (pInstanceBuffer)
+        {
+            fetch.pInstanceTransform = reinterpret_cast<const float*>(pInstanceBuffer->m_Data.data() + m_VertexOffsets[1] +
+                size_t(instance) * m_VertexStrides[1] + pInputLayout->m_InstanceTransformOffset);
+        }
+        ShadeVertices();
+
+        switch (m_Topology)
+        {
+        case PrimitiveTopology::TriangleList:
+            for (unsigned int i = 0; i + 2u < count; i += 3u)
+            {
+                Triangle(Index(i), Index(i + 1u), Index(i + 2u));
+            }
+            break;
+        case PrimitiveTopology::TriangleStrip:
+            // Every other triangle flips its winding, strip cut index restarts the strip
+            for (unsigned int i = 0, start = 0; i + 2u < count; i++)
+            {
+                const uint32_t i0 = Index(i), i1 = Index(i + 1u), i2 = Index(i + 2u);
+                if (i0 == cutIndex || i1 == cutIndex || i2 == cutIndex)
+                {
+                    start = i + 1u;
+                    continue;
+                }
+                if ((i - start) & 1u) Triangle(i1, i0, i2);
+                else                  Triangle(i0, i1, i2);
+            }
+            break;
+        case PrimitiveTopology::LineList:
+            for (unsigned int i = 0; i + 1u < count; i += 2u)
+            {
+                Line(Index(i), Index(i + 1u));
+            }
+            break;
+        case PrimitiveTopology::LineStrip:
+            for (unsigned int i = 0; i + 1u < count; i++)
+            {
+                const uint32_t i0 = Index(i), i1 = Index(i + 1u);
+                if (i0 != cutIndex && i1 != cutIndex) Line(i0, i1);
+            }
+            break;
+        default:
+            // Point lists aren't used by anything yet
+            break;
+        }
+    }
+}
+
+void SoftwareBackend::SetupTriangle(const ClipVertex* v, unsigned int numVaryings, PixelKernel pixelKernel)
+{
+    RasterTriangle tri;
+    for (int i = 0; i < 3; i++)
+    {
+        const float invW = 1.f / v[i].w;
+        tri.x[i] = SnapToSubPixel((v[i].x * invW * 0.5f + 0.5f) * float(m_Width));
+        tri.y[i] = SnapToSubPixel((0.5f - v[i].y * invW * 0.5f) * float(m_Height));
+        tri.z[i] = v[i].z * invW;
+        tri.invW[i] = invW;
+        for (unsigned int k = 0; k < numVaryings; k++)
+        {
+            tri.varyings[i][k] = v[i].varyings[k] * invW;
+        }
+    }
+
+    // Front faces are clockwise on screen (y down), which comes out as a positive area here. Back faces and
+    // degenerates are culled
+    const float area = (tri.x[1] - tri.x[0]) * (tri.y[2] - tri.y[0]) - (tri.x[2] - tri.x[0]) * (tri.y[1] - tri.y[0]);
+    if (!(area > 0.f))
+    {
+        return;
+    }
+    tri.invArea = 1.f / area;
+
+    for (int i = 0; i < 3; i++)
+    {
+        // Edge opposite vertex i, from vertex i + 1 to i + 2
+        const int a = (i + 1) % 3, b = (i + 2) % 3;
+        tri.edgeA[i] = -(tri.y[b] - tri.y[a]);
+        tri.edgeB[i] = tri.x[b] - tri.x[a];
+        // Top-left rule, pixels exactly on a right/bottom edge belong to the neighbour. Coordinates are on a 1/16th
+        // grid and sample points on 1/2, so any non zero edge value is at least 1/256
+        const bool bTopLeft = tri.edgeA[i] > 0.f || (tri.edgeA[i] == 0.f && tri.edgeB[i] > 0.f);
+        tri.edgeBias[i] = bTopLeft ? 0.f : 1.f / 512.f;
+    }
+
+    const float minX = std::min({ tri.x[0], tri.x[1], tri.x[2] });
+    const float minY = std::min({ tri.y[0], tri.y[1], tri.y[2] });
+    const float maxX = std::max({ tri.x[0], tri.x[1], tri.x[2] });
+    const float maxY = std::max({ tri.y[0], tri.y[1], tri.y[2] });
+    tri.minX = std::max(0, static_cast<int>(std::floor(minX)));
+    tri.minY = std::max(0, static_cast<int>(std::floor(minY)));
+    tri.maxX = std::min(static_cast<int>(m_Width) - 1, static_cast<int>(std::ceil(maxX)));
+    tri.maxY = std::min(static_cast<int>(m_Height) - 1, static_cast<int>(std::ceil(maxY)));
+    if (tri.minX > tri.maxX || tri.minY > tri.maxY)
+    {
+        return;
+    }
+
+    tri.pixelKernel = pixelKernel;
+    tri.numVaryings = numVaryings;
+    m_Triangles.push_back(tri);
+    BinPrimitive(static_cast<uint32_t>(m_Triangles.size() - 1u), tri.minX, tri.minY, tri.maxX, tri.maxY);
+}
+
+void SoftwareBackend::SetupLine(const ClipVertex& v0, const ClipVertex& v1, unsigned int numVaryings, PixelKernel pixelKernel)
+{
+    RasterLine line;
+    const ClipVertex* v[2] = { &v0, &v1 };
+    for (int i = 0; i < 2; i++)
+    {
+        const float invW = 1.f / v[i]->w;
+        line.x[i] = (v[i]->x * invW * 0.5f + 0.5f) * float(m_Width);
+        line.y[i] = (0.5f - v[i]->y * invW * 0.5f) * float(m_Height);
+        line.z[i] = v[i]->z * invW;
+        line.invW[i] = invW;
+        for (unsigned int k = 0; k < numVaryings; k++)
+        {
+            line.varyings[i][k] = v[i]->varyings[k] * invW;
+        }
+    }
+
+    const int minX = std::max(0, static_cast<int>(std::floor(std::min(line.x[0], line.x[1]))));
+    const int minY = std::max(0, static_cast<int>(std::floor(std::min(line.y[0], line.y[1]))));
+    const int maxX = std::min(static_cast<int>(m_Width) - 1, static_cast<int>(std::floor(std::max(line.x[0], line.x[1]))));
+    const int maxY = std::min(static_cast<int>(m_Height) - 1, static_cast<int>(std::floor(std::max(line.y[0], line.y[1]))));
+    if (minX > maxX || minY > maxY)
+    {
+        return;
+    }
+
+    line.pixelKernel = pixelKernel;
+    line.numVaryings = numVaryings;
+    m_Lines.push_back(line);
+    BinPrimitive(static_cast<uint32_t>(m_Lines.size() - 1u) | s_LineBit, minX, minY, maxX, maxY);
+}
+
+void SoftwareBackend::BinPrimitive(uint32_t primitive, int minX, int minY, int maxX, int maxY)
+{
+    // Binning is serial and in submission order, which is what makes tiles (and so the image) deterministic
+    const unsigned int tx0 = static_cast<unsigned int>(minX) / s_TileSize;
+    const unsigned int ty0 = static_cast<unsigned int>(minY) / s_TileSize;
+    const unsigned int tx1 = static_cast<unsigned int>(maxX) / s_TileSize;
+    const unsigned int ty1 = static_cast<unsigned int>(maxY) / s_TileSize;
+    for (unsigned int ty = ty0; ty <= ty1; ty++)
+    {
+        for (unsigned int tx = tx0; tx <= tx1; tx++)
+        {
+            m_Bins[ty * m_TilesX + tx].push_back(primitive);
+        }
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------------------
+* Rasterization
+*--------------------------------------------------------------------------------------------------------------*/
+
+size_t SoftwareBackend::PixelIndex(unsigned int x, unsigned int y) const noexcept
+{
+    return (size_t(y >> 1u) * m_QuadsX + (x >> 1u)) * 4u + (y & 1u) * 2u + (x & 1u);
+}
+
+void SoftwareBackend::Flush()
+{
+    ParallelFor(m_TilesX * m_TilesY, [this](unsigned int tile) { RasterizeTile(tile); });
+
+    m_Triangles.clear();
+    m_Lines.clear();
+    for (auto& bin : m_Bins)
+    {
+        bin.clear();
+    }
+    b_ClearPending = false;
+}
+
+void SoftwareBackend::Resolve()
+{
+    ParallelFor(m_Height, [this](unsigned int y)
+    {
+        uint32_t* pRow = m_Resolved.data() + size_t(y) * m_Width;
+        for (unsigned int x = 0; x < m_Width; x++)
+        {
+            pRow[x] = m_Color[PixelIndex(x, y)];
+        }
+    });
+}
+
+void SoftwareBackend::RasterizeTile(unsigned int tile)
+{
+    // Tiles are a multiple of 2 so quads never straddle two of them
+    const int minX = static_cast<int>((tile % m_TilesX) * s_TileSize);
+    const int minY = static_cast<int>((tile / m_TilesX) * s_TileSize);
+    const int maxX = std::min(minX + static_cast<int>(s_TileSize), static_cast<int>(m_Width)) - 1;
+    const int maxY = std::min(minY + static_cast<int>(s_TileSize), static_cast<int>(m_Height)) - 1;
+
+    if (b_ClearPending)
+    {
+        for (int y = minY; y <= maxY; y += 2)
+        {
+            const size_t begin = PixelIndex(static_cast<unsigned int>(minX), static_cast<unsigned int>(y));
+            const size_t end = PixelIndex(static_cast<unsigned int>(maxX & ~1), static_cast<unsigned int>(y)) + 4u;
+            std::fill(m_Color.begin() + begin, m_Color.begin() + end, m_ClearColor);
+            std::fill(m_Depth.begin() + begin, m_Depth.begin() + end, 1.f);
+        }
+    }
+
+    for (const uint32_t primitive : m_Bins[tile])
+    {
+        if (primitive & s_LineBit)
+        {
+            DrawLine(m_Lines[primitive & ~s_LineBit], minX, minY, maxX, maxY);
+        }
+        else
+        {
+            DrawTriangle(m_Triangles[primitive], minX, minY, maxX, maxY);
+        }
+    }
+}
+
+void SoftwareBackend::DrawTriangle(const RasterTriangle& tri, int minX, int minY, int maxX, int maxY)
+{
+    const int x0 = std::max(minX, tri.minX) & ~1;
+    const int y0 = std::max(minY, tri.minY) & ~1;
+    const int x1 = std::min(maxX, tri.maxX);
+    const int y1 = std::min(maxY, tri.maxY);
+
+    // Lane order matches the quad swizzle: (0,0) (1,0) (0,1) (1,1)
+    const __m128 laneX = _mm_setr_ps(0.5f, 1.5f, 0.5f, 1.5f);
+    const __m128 laneY = _mm_setr_ps(0.5f, 0.5f, 1.5f, 1.5f);
+    const __m128i laneXi = _mm_setr_epi32(0, 1, 0, 1);
+    const __m128i laneYi = _mm_setr_epi32(0, 0, 1, 1);
+    const __m128i width = _mm_set1_epi32(static_cast<int>(m_Width));
+    const __m128i height = _mm_set1_epi32(static_cast<int>(m_Height));
+    const __m128 invArea = _mm_set1_ps(tri.invArea);
+
+    __m128 edgeA[3], edgeB[3], edgeX[3], edgeY[3], edgeBias[3];
+    for (int e = 0; e < 3; e++)
+    {
+        const int a = (e + 1) % 3;
+        edgeA[e] = _mm_set1_ps(tri.edgeA[e]);
+        edgeB[e] = _mm_set1_ps(tri.edgeB[e]);
+        edgeX[e] = _mm_set1_ps(tri.x[a]);
+        edgeY[e] = _mm_set1_ps(tri.y[a]);
+        edgeBias[e] = _mm_set1_ps(tri.edgeBias[e]);
+    }
+
+    __m128 varyings[MaxVaryings];
+    __m128 rgba[4];
+
+    for (int y = y0; y <= y1; y += 2)
+    {
+        const __m128 py = _mm_add_ps(_mm_set1_ps(float(y)), laneY);
+        const __m128i rowValid = _mm_cmplt_epi32(_mm_add_epi32(_mm_set1_epi32(y), laneYi), height);
+
+        for (int x = x0; x <= x1; x += 2)
+        {
+            const __m128 px = _mm_add_ps(_mm_set1_ps(float(x)), laneX);
+
+            // Edge functions, weight[i] is the (unnormalized) barycentric weight of vertex i
+            __m128 weight[3];
+            __m128 mask = _mm_castsi128_ps(_mm_and_si128(rowValid, _mm_cmplt_epi32(_mm_add_epi32(_mm_set1_epi32(x), laneXi), width)));
+            for (int e = 0; e < 3; e++)
+            {
+                weight[e] = _mm_add_ps(_mm_mul_ps(edgeA[e], _mm_sub_ps(px, edgeX[e])), _mm_mul_ps(edgeB[e], _mm_sub_ps(py, edgeY[e])));
+                mask = _mm_and_ps(mask, _mm_cmpge_ps(weight[e], edgeBias[e]));
+            }
+            if (_mm_movemask_ps(mask) == 0)
+            {
+                continue;
+            }
+
+            const __m128 l0 = _mm_mul_ps(weight[0], invArea);
+            const __m128 l1 = _mm_mul_ps(weight[1], invArea);
+            const __m128 l2 = _mm_mul_ps(weight[2], invArea);
+            const auto Interpolate = [&](float a, float b, float c)
+            {
+                return _mm_add_ps(_mm_add_ps(_mm_mul_ps(l0, _mm_set1_ps(a)), _mm_mul_ps(l1, _mm_set1_ps(b))), _mm_mul_ps(l2, _mm_set1_ps(c)));
+            };
+
+            // Depth test (LESS) + write
+            const size_t index = PixelIndex(static_cast<unsigned int>(x), static_cast<unsigned int>(y));
+            const __m128 z = Interpolate(tri.z[0], tri.z[1], tri.z[2]);
+            const __m128 depth = _mm_loadu_ps(m_Depth.data() + index);
+            mask = _mm_and_ps(mask, _mm_cmplt_ps(z, depth));
+            if (_mm_movemask_ps(mask) == 0)
+            {
+                continue;
+            }
+            _mm_storeu_ps(m_Depth.data() + index, _mm_or_ps(_mm_and_ps(mask, z), _mm_andnot_ps(mask, depth)));
+
+            if (!tri.pixelKernel)
+            {
+                continue;
+            }
+
+            // Perspective correct interpolants
+            const __m128 w = _mm_div_ps(_mm_set1_ps(1.f), Interpolate(tri.invW[0], tri.invW[1], tri.invW[2]));
+            for (unsigned int k = 0; k < tri.numVaryings; k++)
+            {
+                varyings[k] = _mm_mul_ps(Interpolate(tri.varyings[0][k], tri.varyings[1][k], tri.varyings[2][k]), w);
+            }
+            tri.pixelKernel(varyings, rgba);
+
+            const __m128i colorMask = _mm_castps_si128(mask);
+            __m128i* pColor = reinterpret_cast<__m128i*>(m_Color.data() + index);
+            const __m128i color = _mm_loadu_si128(pColor);
+            _mm_storeu_si128(pColor, _mm_or_si128(_mm_and_si128(colorMask, PackColor(rgba)), _mm_andnot_si128(colorMask, color)));
+        }
+    }
+}
+
+void SoftwareBackend::DrawLine(const RasterLine& line, int minX, int minY, int maxX, int maxY)
+{
+    // DDA through pixel centers, last pixel excluded so connected lines don't double up on shared vertices
+    const float dx = line.x[1] - line.x[0];
+    const float dy = line.y[1] - line.y[0];
+    const int steps = std::max(1, static_cast<int>(std::ceil(std::max(std::abs(dx), std::abs(dy)))));
+    const float invSteps = 1.f / float(steps);
+
+    // Pixels are depth tested as we go, then shaded 4 at a time
+    size_t indices[4];
+    __m128 varyings[MaxVaryings];
+    __m128 rgba[4];
+    alignas(16) float laneVaryings[MaxVaryings][4] = {};
+    int numPending = 0;
+
+    const auto Shade = [&]()
+    {
+        for (unsigned int k = 0; k < line.numVaryings; k++)
+        {
+            varyings[k] = _mm_load_ps(laneVaryings[k]);
+        }
+        line.pixelKernel(varyings, rgba);
+
+        alignas(16) uint32_t colors[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(colors), PackColor(rgba));
+        for (int lane = 0; lane < numPending; lane++)
+        {
+            m_Color[indices[lane]] = colors[lane];
+        }
+        numPending = 0;
+    };
+
+    for (int i = 0; i < steps; i++)
+    {
+        const float t = float(i) * invSteps;
+        const int px = static_cast<int>(std::floor(line.x[0] + dx * t));
+        const int py = static_cast<int>(std::floor(line.y[0] + dy * t));
+        if (px < minX || px > maxX || py < minY || py > maxY)
+        {
+            continue;
+        }
+
+        const size_t index = PixelIndex(static_cast<unsigned int>(px), static_cast<unsigned int>(py));
+        const float z = line.z[0] + (line.z[1] - line.z[0]) * t;
+        if (!(z < m_Depth[index]))
+        {
+            continue;
+        }
+        m_Depth[index] = z;
+
+        if (!line.pixelKernel)
+        {
+            continue;
+        }
+
+        const float w = 1.f / (line.invW[0] + (line.invW[1] - line.invW[0]) * t);
+        for (unsigned int k = 0; k < line.numVaryings; k++)
+        {
+            laneVaryings[k][numPending] = (line.varyings[0][k] + (line.varyings[1][k] - line.varyings[0][k]) * t) * w;
+        }
+        indices[numPending++] = index;
+        if (numPending == 4)
+        {
+            Shade();
+        }
+    }
+
+    if (numPending > 0)
+    {
+        Shade();
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------------------
+* Workers
+*--------------------------------------------------------------------------------------------------------------*/
+
+void SoftwareBackend::ParallelFor(unsigned int count, const std::function<void(unsigned int)>& fn)
+{
+    if (m_Workers.empty() || count <= 1u)
+    {
+        for (unsigned int i = 0; i < count; i++) fn(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        pJob = &fn;
+        m_JobCount = count;
+        m_NextJob = 0u;
+        m_BusyWorkers = static_cast<unsigned int>(m_Workers.size());
+        m_Generation++;
+    }
+    m_WorkCV.notify_all();
+
+    for (unsigned int i = m_NextJob++; i < count; i = m_NextJob++)
+    {
+        fn(i);
+    }
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_DoneCV.wait(lock, [this] { return m_BusyWorkers == 0u; });
+    pJob = nullptr;
+}
+
+void SoftwareBackend::WorkerLoop()
+{
+    unsigned long long generation = 0u;
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    while (true)
+    {
+        m_WorkCV.wait(lock, [&] { return b_Quit || m_Generation != generation; });
+        if (b_Quit)
+        {
+            return;
+        }
+        generation = m_Generation;
+        const auto& fn = *pJob;
+        const unsigned int count = m_JobCount;
+        lock.unlock();
+
+        for (unsigned int i = m_NextJob++; i < count; i = m_NextJob++)
+        {
+            fn(i);
+        }
+
+        lock.lock();
+        if (--m_BusyWorkers == 0u)
+        {
+            m_DoneCV.notify_one();
+        }
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------------------
+* Window Presenter
+*--------------------------------------------------------------------------------------------------------------*/
+
+#ifdef _WIN32
+namespace
+{
+    unsigned int ClientWidth(HWND hWnd) noexcept
+    {
+        RECT rect = {};
+        GetClientRect(hWnd, &rect);
+        return static_cast<unsigned int>(rect.right - rect.left);
+    }
+
+    unsigned int ClientHeight(HWND hWnd) noexcept
+    {
+        RECT rect = {};
+        GetClientRect(hWnd, &rect);
+        return static_cast<unsigned int>(rect.bottom - rect.top);
+    }
+}
+
+SoftwareWindowBackend::SoftwareWindowBackend(HWND hWnd)
+    : SoftwareBackend(ClientWidth(hWnd), ClientHeight(hWnd)), m_hWnd(hWnd)
+{}
+
+void SoftwareWindowBackend::OnFramePresented(const std::vector<uint32_t>& image)
+{
+    m_BGRA.resize(image.size());
+    for (size_t i = 0; i < image.size(); i++)
+    {
+        const uint32_t c = image[i];
+        m_BGRA[i] = (c & 0xff00ff00u) | ((c & 0xffu) << 16u) | ((c >> 16u) & 0xffu);
+    }
+
+    BITMAPINFO bmi = {};
+    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth = static_cast<LONG>(GetWidth());
+    bmi.bmiHeader.biHeight = -static_cast<LONG>(GetHeight()); // Negative height = top down rows
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+
+    HDC hDC = GetDC(m_hWnd);
+    StretchDIBits(hDC, 0, 0, static_cast<int>(ClientWidth(m_hWnd)), static_cast<int>(ClientHeight(m_hWnd)),
+        0, 0, static_cast<int>(GetWidth()), static_cast<int>(GetHeight()),
+        m_BGRA.data(), &bmi, DIB_RGB_COLORS, SRCCOPY);
+    ReleaseDC(m_hWnd, hDC);
+}
+#endif
@@ -0,0 +1,169 @@
+﻿#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "RenderBackend.h"
+#include "RomanceException.h"
+#include "SoftwareShaders.h"
+
+/// @brief  CPU rasterizer, GPU free fallback and deterministic reference renderer.
+///         - Vertex work runs the C++ ports in SoftwareShaders at DrawIndexed, primitives get clipped/set up and binned
+///           into 64x64 screen tiles
+///         - On Present tiles are cleared and rasterized in parallel, each tile walks its bin in submission
+///           order so the output is identical no matter how many threads we run with
+///         - Triangles are rasterized a 2x2 quad at a time (one SSE lane per pixel), color/depth are stored quad
+///           swizzled so a quad is a single load/store
+class SoftwareBackend : public RenderBackend
+{
+public:
+    /// @brief  Thrown when a shader has no C++ port the software backend can run
+    class ShaderException : public RomanceException
+    {
+    public:
+        ShaderException(int line, const char* file, const std::wstring& path) noexcept;
+        const char* what() const noexcept override;
+        const char* GetType() const noexcept override;
+    private:
+        std::string m_Path;
+    };
+
+public:
+    /// @brief  numThreads = 0 uses every hardware thread
+    SoftwareBackend(unsigned int width, unsigned int height, unsigned int numThreads = 0u);
+    ~SoftwareBackend() override;
+    SoftwareBackend(const SoftwareBackend&) = delete;
+    SoftwareBackend& operator=(const SoftwareBackend&) = delete;
+
+    void Clear(float r, float g, float b) noexcept override;
+    void Present() override;
+    void Resize(unsigned int width, unsigned int height) override;
+    unsigned int GetWidth() const noexcept override;
+    unsigned int GetHeight() const noexcept override;
+
+    std::unique_ptr<GpuBuffer> CreateBuffer(const BufferDesc& desc, const void* pInitialData) override;
+    std::unique_ptr<GpuShader> CreateShader(ShaderStage stage, const std::wstring& path, const std::vector<ShaderMacro>& defines) override;
+    std::unique_ptr<GpuInputLayout> CreateInputLayout(const std::vector<VertexElementDesc>& elements, const GpuShader& vertexShader) override;
+    void UpdateBuffer(GpuBuffer& buffer, const void* pData, size_t size) override;
+    void* MapBuffer(GpuBuffer& buffer, MapMode mode) override;
+    void UnmapBuffer(GpuBuffer& buffer) noexcept override;
+
+    void SetVertexBuffer(unsigned int slot, const GpuBuffer& buffer, unsigned int stride, unsigned int offset) noexcept override;
+    void SetIndexBuffer(const GpuBuffer& buffer, IndexFormat format) noexcept override;
+    void SetConstantBuffer(ShaderStage stage, unsigned int slot, const GpuBuffer& buffer) noexcept override;
+    void SetConstantBufferRange(ShaderStage stage, unsigned int slot, const GpuBuffer& buffer, unsigned int firstConstant, unsigned int numConstants) noexcept override;
+    bool SupportsConstantBufferOffsets() const noexcept override;
+    void SetShader(const GpuShader& shader) noexcept override;
+    void SetInputLayout(const GpuInputLayout& layout) noexcept override;
+    void SetTopology(PrimitiveTopology topology) noexcept override;
+    void BindRenderTarget() noexcept override;
+
+    void DrawIndexed(unsigned int count) override;
+    void DrawIndexedInstanced(unsigned int count, unsigned int instanceCount) override;
+
+    /// @brief  Last presented image, row major R8G8B8A8 (same memory layout as DXGI_FORMAT_R8G8B8A8_UNORM)
+    const std::vector<uint32_t>& ReadBack() const noexcept;
+    /// @brief  Writes the last presented image as a binary PPM, returns false if the file couldn't be opened
+    bool SaveImage(const std::string& path) const;
+
+protected:
+    /// @brief  Hook for windowed subclasses, called with the finished frame (row major RGBA8)
+    virtual void OnFramePresented(const std::vector<uint32_t>& image) {}
+
+private:
+    struct RasterTriangle;
+    struct RasterLine;
+
+    /// @brief  Rasterizes everything binned so far
+    void Flush();
+    /// @brief  De-swizzles the color buffer into m_Resolved
+    void Resolve();
+    void RasterizeTile(unsigned int tile);
+    void DrawTriangle(const RasterTriangle& tri, int minX, int minY, int maxX, int maxY);
+    void DrawLine(const RasterLine& line, int minX, int minY, int maxX, int maxY);
+
+    /// @brief  Projects a clipped primitive to the screen and bins it
+    void SetupTriangle(const SoftwareShaders::ClipVertex* v, unsigned int numVaryings, SoftwareShaders::PixelKernel pixelKernel);
+    void SetupLine(const SoftwareShaders::ClipVertex& v0, const SoftwareShaders::ClipVertex& v1, unsigned int numVaryings, SoftwareShaders::PixelKernel pixelKernel);
+    /// @brief  Adds the primitive to every tile its (inclusive) pixel bounds touch
+    void BinPrimitive(uint32_t primitive, int minX, int minY, int maxX, int maxY);
+
+    /// @brief  Quad swizzled index of pixel (x, y) in the color/depth buffers
+    size_t PixelIndex(unsigned int x, unsigned int y) const noexcept;
+
+    /// @brief  Runs fn(0..count-1) across the worker threads (+ the calling thread) and waits for all of it
+    void ParallelFor(unsigned int count, const std::function<void(unsigned int)>& fn);
+    void WorkerLoop();
+
+private:
+    static constexpr unsigned int s_TileSize = 64u;
+    static constexpr uint32_t s_LineBit = 0x80000000u;
+
+    unsigned int m_Width = 0u;
+    unsigned int m_Height = 0u;
+    unsigned int m_TilesX = 0u;
+    unsigned int m_TilesY = 0u;
+    unsigned int m_QuadsX = 0u;
+
+    // Render targets, quad swizzled (see PixelIndex)
+    std::vector<uint32_t> m_Color;
+    std::vector<float> m_Depth;
+    bool b_ClearPending = false;
+    uint32_t m_ClearColor = 0u;
+    std::vector<uint32_t> m_Resolved;
+
+    // Frame primitives & per tile bins (index into triangles, or lines if s_LineBit is set)
+    std::vector<RasterTriangle> m_Triangles;
+    std::vector<RasterLine> m_Lines;
+    std::vector<std::vector<uint32_t>> m_Bins;
+    std::vector<SoftwareShaders::ClipVertex> m_VertexCache;
+
+    // Bound state
+    static constexpr unsigned int s_NumVertexSlots = 2u;
+    const class SoftwareBuffer* pVertexBuffers[s_NumVertexSlots] = {};
+    unsigned int m_VertexStrides[s_NumVertexSlots] = {};
+    unsigned int m_VertexOffsets[s_NumVertexSlots] = {};
+    const class SoftwareBuffer* pIndexBuffer = nullptr;
+    IndexFormat m_IndexFormat = IndexFormat::UInt16;
+    const class SoftwareBuffer* pVSConstants = nullptr;
+    /* Bytes of pVSConstants that are bound, starting at the offset (whole buffer unless bound through a range) */
+    size_t m_VSConstantsOffset = 0u;
+    size_t m_VSConstantsSize = 0u;
+    const class SoftwareShader* pVertexShader = nullptr;
+    const class SoftwareShader* pPixelShader = nullptr;
+    const class SoftwareInputLayout* pInputLayout = nullptr;
+    PrimitiveTopology m_Topology = PrimitiveTopology::TriangleList;
+
+    // Workers
+    std::vector<std::thread> m_Workers;
+    std::mutex m_Mutex;
+    std::condition_variable m_WorkCV;
+    std::condition_variable m_DoneCV;
+    const std::function<void(unsigned int)>* pJob = nullptr;
+    unsigned int m_JobCount = 0u;
+    std::atomic<unsigned int> m_NextJob = 0u;
+    unsigned int m_BusyWorkers = 0u;
+    unsigned long long m_Generation = 0u;
+    bool b_Quit = false;
+};
+
+#ifdef _WIN32
+#include "RomanceWin.h"
+
+/// @brief  GPU free fallback for a window, rasterizes on the CPU and blits the result with StretchDIBits
+class SoftwareWindowBackend : public SoftwareBackend
+{
+public:
+    SoftwareWindowBackend(HWND hWnd);
+
+protected:
+    void OnFramePresented(const std::vector<uint32_t>& image) override;
+
+private:
+    HWND m_hWnd;
+    /// @brief  DIBs are BGRA, image gets swizzled in here before the blit
+    std::vector<uint32_t> m_BGRA;
+};
+#endif
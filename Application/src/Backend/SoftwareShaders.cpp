@@ -0,0 +1,218 @@
+﻿#include "SoftwareShaders.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include "Utility/Maths.h"
+
+namespace SoftwareShaders
+{
+    namespace
+    {
+        float HalfToFloat(uint16_t h) noexcept
+        {
+            const uint32_t exponent = (h >> 10u) & 0x1fu;
+            const uint32_t mantissa = h & 0x3ffu;
+            uint32_t bits = (h & 0x8000u) << 16u;
+            if (exponent == 0u)
+            {
+                // Zero or denormal, too small for the float's exponent bias trick
+                const float value = std::ldexp(float(mantissa), -24);
+                return bits ? -value : value;
+            }
+            bits |= exponent == 0x1fu ? 0x7f800000u | (mantissa << 13u) : ((exponent + 112u) << 23u) | (mantissa << 13u);
+            float value;
+            memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        /// @brief  count components of T (int16_t, int8_t...) at pElement mapped to [-1, 1] or [0, 1]
+        template<class T>
+        void FetchNormalized(const unsigned char* pElement, unsigned int count, float* pOut) noexcept
+        {
+            constexpr float scale = 1.f / float(std::numeric_limits<T>::max());
+            for (unsigned int c = 0; c < count; c++)
+            {
+                T value;
+                memcpy(&value, pElement + c * sizeof(T), sizeof(T));
+                // SNORM has two encodings of -1, the input assembler clamps the extra one
+                pOut[c] = std::max(float(value) * scale, -1.f);
+            }
+        }
+
+        /*--------------------------------------------------------------------------------------------------------------
+        * shaders/VertexShader.hlsl
+        *--------------------------------------------------------------------------------------------------------------*/
+
+        void VertexShaderVS(const VertexFetch& input, const float* constants, size_t begin, size_t end, ClipVertex* pOut)
+        {
+            // cbuffer Transform is column_major in HLSL, so each register (4 floats) in memory is one column of the
+            // matrix. mul(float4(p, 1), transform) is then just a dot of p with each register
+            const __m128 m[16] = {
+                _mm_set1_ps(constants[0]),  _mm_set1_ps(constants[1]),  _mm_set1_ps(constants[2]),  _mm_set1_ps(constants[3]),
+                _mm_set1_ps(constants[4]),  _mm_set1_ps(constants[5]),  _mm_set1_ps(constants[6]),  _mm_set1_ps(constants[7]),
+                _mm_set1_ps(constants[8]),  _mm_set1_ps(constants[9]),  _mm_set1_ps(constants[10]), _mm_set1_ps(constants[11]),
+                _mm_set1_ps(constants[12]), _mm_set1_ps(constants[13]), _mm_set1_ps(constants[14]), _mm_set1_ps(constants[15])
+            };
+
+            const auto Position = [&input](size_t i) -> Math::XMFLOAT4
+            {
+                Math::XMFLOAT4 p;
+                FetchElement(input.positionFormat, input.pData + i * input.stride + input.positionOffset, &p.x);
+                return p;
+            };
+
+            // 4 vertices per iteration, the tail re-reads the last vertex in the unused lanes
+            for (size_t i = begin; i < end; i += 4)
+            {
+                const size_t i1 = std::min(i + 1, end - 1);
+                const size_t i2 = std::min(i + 2, end - 1);
+                const size_t i3 = std::min(i + 3, end - 1);
+                const Math::XMFLOAT4 p0 = Position(i);
+                const Math::XMFLOAT4 p1 = Position(i1);
+                const Math::XMFLOAT4 p2 = Position(i2);
+                const Math::XMFLOAT4 p3 = Position(i3);
+
+                __m128 x = _mm_setr_ps(p0.x, p1.x, p2.x, p3.x);
+                __m128 y = _mm_setr_ps(p0.y, p1.y, p2.y, p3.y);
+                __m128 z = _mm_setr_ps(p0.z, p1.z, p2.z, p3.z);
+
+                // vs.Offset = (0.7 sin(18x) + 0.5 sin(24y) + 0.6 sin(42x) + 0.2 sin(64y) + 2) / 4
+                __m128 offset = _mm_mul_ps(_mm_set1_ps(0.7f), Math::XMVectorSin(_mm_mul_ps(_mm_set1_ps(18.f), x)));
+                offset = _mm_add_ps(offset, _mm_mul_ps(_mm_set1_ps(0.5f), Math::XMVectorSin(_mm_mul_ps(_mm_set1_ps(24.f), y))));
+                offset = _mm_add_ps(offset, _mm_mul_ps(_mm_set1_ps(0.6f), Math::XMVectorSin(_mm_mul_ps(_mm_set1_ps(42.f), x))));
+                offset = _mm_add_ps(offset, _mm_mul_ps(_mm_set1_ps(0.2f), Math::XMVectorSin(_mm_mul_ps(_mm_set1_ps(64.f), y))));
+                offset = _mm_mul_ps(_mm_add_ps(offset, _mm_set1_ps(2.f)), _mm_set1_ps(0.25f));
+
+                // position += float3(0, 0, -1) * vs.Offset
+                z = _mm_sub_ps(z, offset);
+
+                // INSTANCED: position = mul(float4(position, 1), world).xyz
+                if (input.pInstanceTransform)
+                {
+                    const float* w = input.pInstanceTransform;
+                    const __m128 wx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(w[0])), _mm_mul_ps(y, _mm_set1_ps(w[4]))),
+                        _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(w[8])), _mm_set1_ps(w[12])));
+                    const __m128 wy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(w[1])), _mm_mul_ps(y, _mm_set1_ps(w[5]))),
+                        _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(w[9])), _mm_set1_ps(w[13])));
+                    const __m128 wz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(w[2])), _mm_mul_ps(y, _mm_set1_ps(w[6]))),
+                        _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(w[10])), _mm_set1_ps(w[14])));
+                    x = wx;
+                    y = wy;
+                    z = wz;
+                }
+
+                __m128 clip[4];
+                for (int r = 0; r < 4; r++)
+                {
+                    clip[r] = _mm_add_ps(
+                        _mm_add_ps(_mm_mul_ps(x, m[r * 4 + 0]), _mm_mul_ps(y, m[r * 4 + 1])),
+                        _mm_add_ps(_mm_mul_ps(z, m[r * 4 + 2]), m[r * 4 + 3]));
+                }
+
+                alignas(16) float cx[4], cy[4], cz[4], cw[4], off[4];
+                _mm_store_ps(cx, clip[0]);
+                _mm_store_ps(cy, clip[1]);
+                _mm_store_ps(cz, clip[2]);
+                _mm_store_ps(cw, clip[3]);
+                _mm_store_ps(off, offset);
+
+                const size_t count = std::min<size_t>(4u, end - i);
+                for (size_t lane = 0; lane < count; lane++)
+                {
+                    ClipVertex& v = pOut[i + lane];
+                    v.x = cx[lane];
+                    v.y = cy[lane];
+                    v.z = cz[lane];
+                    v.w = cw[lane];
+                    v.varyings[0] = off[lane];
+                }
+            }
+        }
+
+        /*--------------------------------------------------------------------------------------------------------------
+        * shaders/PixelShader.hlsl
+        *--------------------------------------------------------------------------------------------------------------*/
+
+        void PixelShaderPS(const __m128* varyings, __m128* rgbaOut)
+        {
+            // return float4(0, 0, 0.7, 1) * Offset
+            const __m128 offset = varyings[0];
+            rgbaOut[0] = _mm_setzero_ps();
+            rgbaOut[1] = _mm_setzero_ps();
+            rgbaOut[2] = _mm_mul_ps(_mm_set1_ps(0.7f), offset);
+            rgbaOut[3] = offset;
+        }
+
+        const Kernel s_Kernels[] =
+        {
+            { ShaderStage::Vertex, 1u, 16u * sizeof(float), &VertexShaderVS, nullptr },
+            { ShaderStage::Pixel,  1u, 0u,                  nullptr,         &PixelShaderPS },
+        };
+
+        const wchar_t* const s_KernelFiles[] =
+        {
+            L"VertexShader.hlsl",
+            L"PixelShader.hlsl",
+        };
+    }
+
+    void FetchElement(ElementFormat format, const unsigned char* pElement, float* pOut) noexcept
+    {
+        pOut[0] = pOut[1] = pOut[2] = 0.f;
+        pOut[3] = 1.f;
+        switch (format)
+        {
+        case ElementFormat::Float1:
+        case ElementFormat::Float2:
+        case ElementFormat::Float3:
+        case ElementFormat::Float4:
+            memcpy(pOut, pElement, GetElementSize(format));
+            break;
+        case ElementFormat::Half2:
+        case ElementFormat::Half4:
+            for (unsigned int c = 0; c < GetElementSize(format) / 2u; c++)
+            {
+                uint16_t half;
+                memcpy(&half, pElement + c * 2u, 2u);
+                pOut[c] = HalfToFloat(half);
+            }
+            break;
+        case ElementFormat::ShortN2:    FetchNormalized<int16_t>(pElement, 2u, pOut); break;
+        case ElementFormat::ShortN4:    FetchNormalized<int16_t>(pElement, 4u, pOut); break;
+        case ElementFormat::UShortN4:   FetchNormalized<uint16_t>(pElement, 4u, pOut); break;
+        case ElementFormat::ByteN4:     FetchNormalized<int8_t>(pElement, 4u, pOut); break;
+        case ElementFormat::UByteN4:    FetchNormalized<uint8_t>(pElement, 4u, pOut); break;
+        case ElementFormat::UDecN4:
+        {
+            uint32_t packed;
+            memcpy(&packed, pElement, 4u);
+            for (unsigned int c = 0; c < 3u; c++)
+            {
+                pOut[c] = float((packed >> (c * 10u)) & 0x3ffu) / 1023.f;
+            }
+            pOut[3] = float(packed >> 30u) / 3.f;
+            break;
+        }
+        }
+    }
+
+    const Kernel* Find(ShaderStage stage, const std::wstring& path) noexcept
+    {
+        // Only care about the file name, shaders get loaded relative to the working directory
+        const size_t slash = path.find_last_of(L"/\\");
+        const std::wstring fileName = slash == std::wstring::npos ? path : path.substr(slash + 1);
+
+        for (size_t i = 0; i < std::size(s_Kernels); i++)
+        {
+            if (s_Kernels[i].stage == stage && fileName == s_KernelFiles[i])
+            {
+                return &s_Kernels[i];
+            }
+        }
+        return nullptr;
+    }
+}
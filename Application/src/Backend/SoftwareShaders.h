@@ -0,0 +1,53 @@
+﻿#pragma once
+#include <string>
+#include <emmintrin.h>
+
+#include "RenderTypes.h"
+
+/// C++ ports of the HLSL shaders in shaders/, run by the SoftwareBackend. Vertex kernels transform a range of the
+/// bound vertex buffer into clip space, pixel kernels shade a 2x2 quad at a time (one pixel per SSE lane).
+
+namespace SoftwareShaders
+{
+    /// @brief  Max number of interpolants (TEXCOORDn floats) a vertex kernel can pass to a pixel kernel
+    constexpr unsigned int MaxVaryings = 4u;
+
+    /// @brief  Post vertex shader vertex (SV_Position + interpolants)
+    struct ClipVertex
+    {
+        float x, y, z, w;
+        float varyings[MaxVaryings];
+    };
+
+    /// @brief  Where to find the vertex shader inputs in the bound vertex buffer (resolved from the input layout)
+    struct VertexFetch
+    {
+        const unsigned char*    pData;
+        unsigned int            stride;
+        unsigned int            positionOffset;
+        ElementFormat           positionFormat;
+        /* Row major world matrix of the instance being drawn (InstanceTransform0-3), null when not instanced */
+        const float*            pInstanceTransform;
+    };
+
+    /// @brief  Transforms vertices [begin, end), constants is the vertex cbuffer bound to slot 0
+    using VertexKernel = void(*)(const VertexFetch& input, const float* constants, size_t begin, size_t end, ClipVertex* pOut);
+    /// @brief  Shades 4 pixels, varyings are already perspective corrected. Writes rgba (one __m128 per channel)
+    using PixelKernel = void(*)(const __m128* varyings, __m128* rgbaOut);
+
+    struct Kernel
+    {
+        ShaderStage     stage;
+        unsigned int    numVaryings;    /* Vertex: interpolants written, Pixel: interpolants read */
+        unsigned int    constantsSize;  /* Bytes of cbuffer slot 0 the kernel reads */
+        VertexKernel    vertexKernel;
+        PixelKernel     pixelKernel;
+    };
+
+    /// @brief  Reads one vertex element the way the input assembler would, components the format doesn't have are 0
+    ///         (w is 1)
+    void FetchElement(ElementFormat format, const unsigned char* pElement, float* pOut) noexcept;
+
+    /// @brief  Finds the kernel implementing the shader at path (matched on file name), nullptr if there's no port
+    const Kernel* Find(ShaderStage stage, const std::wstring& path) noexcept;
+}
@@ -0,0 +1,282 @@
+﻿#include "StateCache.h"
+
+#include "CommandList.h"
+
+StateCache::StateCache(std::unique_ptr<RenderBackend> backend) noexcept
+    : pBackend(std::move(backend))
+{}
+
+/*--------------------------------------------------------------------------------------------------------------
+* Frame
+*--------------------------------------------------------------------------------------------------------------*/
+
+void StateCache::Clear(float r, float g, float b) noexcept
+{
+    pBackend->Clear(r, g, b);
+}
+
+void StateCache::Present()
+{
+    pBackend->Present();
+
+    // Flip model swap chains unbind the back buffer, everything else stays bound on the context
+    b_RenderTargetBound = false;
+
+    m_LastFrame = m_CurrentFrame;
+    m_CurrentFrame = {};
+}
+
+void StateCache::Resize(unsigned int width, unsigned int height)
+{
+    pBackend->Resize(width, height);
+    b_RenderTargetBound = false;
+}
+
+unsigned int StateCache::GetWidth() const noexcept
+{
+    return pBackend->GetWidth();
+}
+
+unsigned int StateCache::GetHeight() const noexcept
+{
+    return pBackend->GetHeight();
+}
+
+/*--------------------------------------------------------------------------------------------------------------
+* Resource Creation
+*--------------------------------------------------------------------------------------------------------------*/
+
+std::unique_ptr<GpuBuffer> StateCache::CreateBuffer(const BufferDesc& desc, const void* pInitialData)
+{
+    return pBackend->CreateBuffer(desc, pInitialData);
+}
+
+std::unique_ptr<GpuShader> StateCache::CreateShader(ShaderStage stage, const std::wstring& path, const std::vector<ShaderMacro>& defines)
+{
+    return pBackend->CreateShader(stage, path, defines);
+}
+
+std::unique_ptr<GpuInputLayout> StateCache::CreateInputLayout(const std::vector<VertexElementDesc>& elements, const GpuShader& vertexShader)
+{
+    return pBackend->CreateInputLayout(elements, vertexShader);
+}
+
+void StateCache::PrecompileShaders(const std::vector<ShaderDesc>& shaders)
+{
+    pBackend->PrecompileShaders(shaders);
+}
+
+void StateCache::UpdateBuffer(GpuBuffer& buffer, const void* pData, size_t size)
+{
+    // Contents changing doesn't change what's bound
+    pBackend->UpdateBuffer(buffer, pData, size);
+}
+
+void* StateCache::MapBuffer(GpuBuffer& buffer, MapMode mode)
+{
+    return pBackend->MapBuffer(buffer, mode);
+}
+
+void StateCache::UnmapBuffer(GpuBuffer& buffer) noexcept
+{
+    pBackend->UnmapBuffer(buffer);
+}
+
+/*--------------------------------------------------------------------------------------------------------------
+* Pipeline State
+*--------------------------------------------------------------------------------------------------------------*/
+
+bool StateCache::Filter(bool bRedundant) noexcept
+{
+    if (b_Enabled && bRedundant)
+    {
+        m_CurrentFrame.skipped++;
+        return false;
+    }
+    m_CurrentFrame.issued++;
+    return true;
+}
+
+void StateCache::SetVertexBuffer(unsigned int slot, const GpuBuffer& buffer, unsigned int stride, unsigned int offset) noexcept
+{
+    if (slot >= s_MaxVertexSlots)
+    {
+        m_CurrentFrame.issued++;
+        pBackend->SetVertexBuffer(slot, buffer, stride, offset);
+        return;
+    }
+
+    VertexSlot& bound = m_VertexSlots[slot];
+    if (Filter(bound.id == buffer.GetId() && bound.stride == stride && bound.offset == offset))
+    {
+        bound = { buffer.GetId(), stride, offset };
+        pBackend->SetVertexBuffer(slot, buffer, stride, offset);
+    }
+}
+
+void StateCache::SetIndexBuffer(const GpuBuffer& buffer, IndexFormat format) noexcept
+{
+    if (Filter(m_IndexBuffer == buffer.GetId() && m_IndexFormat == format))
+    {
+        m_IndexBuffer = buffer.GetId();
+        m_IndexFormat = format;
+        pBackend->SetIndexBuffer(buffer, format);
+    }
+}
+
+void StateCache::SetConstantBuffer(ShaderStage stage, unsigned int slot, const GpuBuffer& buffer) noexcept
+{
+    if (slot >= s_MaxConstantSlots)
+    {
+        m_CurrentFrame.issued++;
+        pBackend->SetConstantBuffer(stage, slot, buffer);
+        return;
+    }
+
+    ConstantSlot& bound = m_ConstantSlots[static_cast<size_t>(stage)][slot];
+    if (Filter(bound.id == buffer.GetId() && bound.firstConstant == 0u && bound.numConstants == s_WholeBuffer))
+    {
+        bound = { buffer.GetId(), 0u, s_WholeBuffer };
+        pBackend->SetConstantBuffer(stage, slot, buffer);
+    }
+}
+
+void StateCache::SetConstantBufferRange(ShaderStage stage, unsigned int slot, const GpuBuffer& buffer, unsigned int firstConstant, unsigned int numConstants) noexcept
+{
+    if (slot >= s_MaxConstantSlots)
+    {
+        m_CurrentFrame.issued++;
+        pBackend->SetConstantBufferRange(stage, slot, buffer, firstConstant, numConstants);
+        return;
+    }
+
+    ConstantSlot& bound = m_ConstantSlots[static_cast<size_t>(stage)][slot];
+    if (Filter(bound.id == buffer.GetId() && bound.firstConstant == firstConstant && bound.numConstants == numConstants))
+    {
+        bound = { buffer.GetId(), firstConstant, numConstants };
+        pBackend->SetConstantBufferRange(stage, slot, buffer, firstConstant, numConstants);
+    }
+}
+
+bool StateCache::SupportsConstantBufferOffsets() const noexcept
+{
+    return pBackend->SupportsConstantBufferOffsets();
+}
+
+void StateCache::SetShader(const GpuShader& shader) noexcept
+{
+    uint64_t& bound = m_Shaders[static_cast<size_t>(shader.GetStage())];
+    if (Filter(bound == shader.GetId()))
+    {
+        bound = shader.GetId();
+        pBackend->SetShader(shader);
+    }
+}
+
+void StateCache::SetInputLayout(const GpuInputLayout& layout) noexcept
+{
+    if (Filter(m_InputLayout == layout.GetId()))
+    {
+        m_InputLayout = layout.GetId();
+        pBackend->SetInputLayout(layout);
+    }
+}
+
+void StateCache::SetTopology(PrimitiveTopology topology) noexcept
+{
+    if (Filter(b_TopologyBound && m_Topology == topology))
+    {
+        m_Topology = topology;
+        b_TopologyBound = true;
+        pBackend->SetTopology(topology);
+    }
+}
+
+void StateCache::BindRenderTarget() noexcept
+{
+    if (Filter(b_RenderTargetBound))
+    {
+        b_RenderTargetBound = true;
+        pBackend->BindRenderTarget();
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------------------
+* Draw
+*--------------------------------------------------------------------------------------------------------------*/
+
+void StateCache::DrawIndexed(unsigned int count)
+{
+    pBackend->DrawIndexed(count);
+}
+
+void StateCache::DrawIndexedInstanced(unsigned int count, unsigned int instanceCount)
+{
+    pBackend->DrawIndexedInstanced(count, instanceCount);
+}
+
+/*--------------------------------------------------------------------------------------------------------------
+* Command Lists
+*--------------------------------------------------------------------------------------------------------------*/
+
+std::unique_ptr<CommandList> StateCache::CreateCommandList()
+{
+    return pBackend->CreateCommandList();
+}
+
+void StateCache::ExecuteCommandList(CommandList& list)
+{
+    pBackend->ExecuteCommandList(list);
+    Invalidate();
+}
+
+/*--------------------------------------------------------------------------------------------------------------
+* Cache
+*--------------------------------------------------------------------------------------------------------------*/
+
+void StateCache::SetEnabled(bool bEnabled) noexcept
+{
+    b_Enabled = bEnabled;
+}
+
+bool StateCache::IsEnabled() const noexcept
+{
+    return b_Enabled;
+}
+
+void StateCache::Invalidate() noexcept
+{
+    for (auto& slot : m_VertexSlots)
+    {
+        slot = {};
+    }
+    m_IndexBuffer = s_Unbound;
+    for (auto& stage : m_ConstantSlots)
+    {
+        for (auto& slot : stage)
+        {
+            slot = {};
+        }
+    }
+    m_Shaders[0] = m_Shaders[1] = s_Unbound;
+    m_InputLayout = s_Unbound;
+    b_TopologyBound = false;
+    b_RenderTargetBound = false;
+}
+
+const StateCache::BindStats& StateCache::GetLastFrameStats() const noexcept
+{
+    return m_LastFrame;
+}
+
+void StateCache::MergeStats(StateCache& other) noexcept
+{
+    m_CurrentFrame.issued += other.m_CurrentFrame.issued;
+    m_CurrentFrame.skipped += other.m_CurrentFrame.skipped;
+    other.m_CurrentFrame = {};
+}
+
+RenderBackend& StateCache::GetBackend() noexcept
+{
+    return *pBackend;
+}
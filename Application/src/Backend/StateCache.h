@@ -0,0 +1,108 @@
+﻿#pragma once
+#include "RenderBackend.h"
+
+/// @brief  Sits between Graphics and the real backend and drops binds that wouldn't change anything. Every drawable
+///         rebinds all of its bindables each draw, so most of those calls are redundant (same shaders, same layout,
+///         same topology...). Tracks shaders, input layout, topology, vertex buffer slots, index buffer, constant
+///         buffer slots (and the range bound in them) and the render target. Resources are compared by id
+///         (GpuResource::GetId) so a freed resource whose address gets reused can't be mistaken for the one still
+///         bound
+class StateCache : public RenderBackend
+{
+public:
+    /// @brief  Bind calls that made it to the backend vs ones that were dropped, reset on Present
+    struct BindStats
+    {
+        unsigned int issued = 0u;
+        unsigned int skipped = 0u;
+    };
+
+public:
+    explicit StateCache(std::unique_ptr<RenderBackend> backend) noexcept;
+
+    void Clear(float r, float g, float b) noexcept override;
+    void Present() override;
+    void Resize(unsigned int width, unsigned int height) override;
+    unsigned int GetWidth() const noexcept override;
+    unsigned int GetHeight() const noexcept override;
+
+    std::unique_ptr<GpuBuffer> CreateBuffer(const BufferDesc& desc, const void* pInitialData) override;
+    std::unique_ptr<GpuShader> CreateShader(ShaderStage stage, const std::wstring& path, const std::vector<ShaderMacro>& defines) override;
+    std::unique_ptr<GpuInputLayout> CreateInputLayout(const std::vector<VertexElementDesc>& elements, const GpuShader& vertexShader) override;
+    void PrecompileShaders(const std::vector<ShaderDesc>& shaders) override;
+    void UpdateBuffer(GpuBuffer& buffer, const void* pData, size_t size) override;
+    void* MapBuffer(GpuBuffer& buffer, MapMode mode) override;
+    void UnmapBuffer(GpuBuffer& buffer) noexcept override;
+
+    void SetVertexBuffer(unsigned int slot, const GpuBuffer& buffer, unsigned int stride, unsigned int offset) noexcept override;
+    void SetIndexBuffer(const GpuBuffer& buffer, IndexFormat format) noexcept override;
+    void SetConstantBuffer(ShaderStage stage, unsigned int slot, const GpuBuffer& buffer) noexcept override;
+    void SetConstantBufferRange(ShaderStage stage, unsigned int slot, const GpuBuffer& buffer, unsigned int firstConstant, unsigned int numConstants) noexcept override;
+    bool SupportsConstantBufferOffsets() const noexcept override;
+    void SetShader(const GpuShader& shader) noexcept override;
+    void SetInputLayout(const GpuInputLayout& layout) noexcept override;
+    void SetTopology(PrimitiveTopology topology) noexcept override;
+    void BindRenderTarget() noexcept override;
+
+    void DrawIndexed(unsigned int count) override;
+    void DrawIndexedInstanced(unsigned int count, unsigned int instanceCount) override;
+
+    /// @brief  Lists come from the wrapped backend, so they're native ones (deferred contexts on D3D11). Put a
+    ///         StateCache of its own in front of each to filter what gets recorded
+    std::unique_ptr<CommandList> CreateCommandList() override;
+    /// @brief  Also forgets everything bound, a list leaves the state undefined
+    void ExecuteCommandList(CommandList& list) override;
+
+    /// @brief  When disabled every bind is forwarded (and counted as issued), for comparing against the cached path
+    void SetEnabled(bool bEnabled) noexcept;
+    bool IsEnabled() const noexcept;
+    /// @brief  Forget everything that's bound, next bind of every kind goes through
+    void Invalidate() noexcept;
+
+    const BindStats& GetLastFrameStats() const noexcept;
+    /// @brief  Moves the binds other counted so far this frame into this frame's stats (a command list's cache into
+    ///         the one of the backend executing it)
+    void MergeStats(StateCache& other) noexcept;
+    RenderBackend& GetBackend() noexcept;
+
+private:
+    /// @brief  Returns true (and counts it as issued) if the bind has to go through
+    bool Filter(bool bRedundant) noexcept;
+
+private:
+    static constexpr unsigned int s_MaxVertexSlots = 16u;
+    static constexpr unsigned int s_MaxConstantSlots = 14u;
+    static constexpr uint64_t s_Unbound = 0u;
+
+    struct VertexSlot
+    {
+        uint64_t id = s_Unbound;
+        unsigned int stride = 0u;
+        unsigned int offset = 0u;
+    };
+
+    /// @brief  Whole buffer binds are stored as the range [0, s_WholeBuffer)
+    struct ConstantSlot
+    {
+        uint64_t id = s_Unbound;
+        unsigned int firstConstant = 0u;
+        unsigned int numConstants = 0u;
+    };
+    static constexpr unsigned int s_WholeBuffer = 0xffffffffu;
+
+    std::unique_ptr<RenderBackend> pBackend;
+    bool b_Enabled = true;
+
+    VertexSlot m_VertexSlots[s_MaxVertexSlots];
+    uint64_t m_IndexBuffer = s_Unbound;
+    IndexFormat m_IndexFormat = IndexFormat::UInt16;
+    ConstantSlot m_ConstantSlots[2][s_MaxConstantSlots];
+    uint64_t m_Shaders[2] = {};
+    uint64_t m_InputLayout = s_Unbound;
+    PrimitiveTopology m_Topology = PrimitiveTopology::TriangleList;
+    bool b_TopologyBound = false;
+    bool b_RenderTargetBound = false;
+
+    BindStats m_CurrentFrame;
+    BindStats m_LastFrame;
+};
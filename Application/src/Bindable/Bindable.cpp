@@ -1,22 +1,11 @@
 ﻿#include "Bindable.h"
 
-#include <stdexcept>
-
-ID3D11DeviceContext* Bindable::GetContext(Graphics& gfx) noexcept
-{
-    return gfx.pContext.Get();
-}
-
-ID3D11Device* Bindable::GetDevice(Graphics& gfx) noexcept
+RenderBackend& Bindable::GetBackend(Graphics& gfx) noexcept
 {
-    return gfx.pDevice.Get();
+    return *gfx.pBackend;
 }
 
-DxgiInfoManager& Bindable::GetInfoManager(Graphics& gfx) noexcept(!IS_DEBUG)
+ConstantRing& Bindable::GetConstantRing(Graphics& gfx) noexcept
 {
-#ifndef NDEBUG
-    return gfx.m_InfoManager;
-#else
-    throw std::logic_error( "YouFuckedUp! (tried to access gfx.infoManager in Release config)" );
-#endif
+    return *gfx.pConstantRing;
 }
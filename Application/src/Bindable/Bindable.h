@@ -5,10 +5,16 @@ class Bindable
 {
 public:
     virtual void Bind(Graphics& gfx) noexcept = 0;
+    /// @brief  Writes whatever per frame data this needs (constants...) ahead of the frame's draws, so it all lands
+    ///         in one map of the ConstantRing. Bind still has to work if this wasn't called
+    virtual void Upload(Graphics& gfx) {}
+    /// @brief  Id of the GPU object this binds (0 if it doesn't own one), used to build render queue sort keys
+    virtual uint64_t GetResourceId() const noexcept { return 0u; }
+    /// @brief  Bytes of GPU memory this owns (buffer contents), what the Codex reports as live memory
+    virtual size_t GetMemorySize() const noexcept { return 0u; }
     virtual ~Bindable() = default;
 protected:
-    /* Static accessors to graphics objects, Bindable is a friend class of graphics so we can only access it through here */
-    static ID3D11DeviceContext* GetContext(Graphics& gfx) noexcept;
-    static ID3D11Device* GetDevice(Graphics& gfx) noexcept;
-    static DxgiInfoManager& GetInfoManager(Graphics& gfx) noexcept(!IS_DEBUG);
+    /* Static accessor to the render backend, Bindable is a friend class of graphics so we can only access it through here */
+    static RenderBackend& GetBackend(Graphics& gfx) noexcept;
+    static ConstantRing& GetConstantRing(Graphics& gfx) noexcept;
 };
@@ -1,12 +1,15 @@
 ﻿#pragma once
 
 // Includes of all bindables
+#include "Codex.h"
 #include "Topology.h"
 
 #include "Buffers/ConstantBuffers.h"
 #include "Buffers/IndexBuffer.h"
 #include "Buffers/VertexBuffer.h"
+#include "Buffers/VertexLayout.h"
 #include "Buffers/TransformCBuffer.h"
+#include "Buffers/InstanceBuffer.h"
 
 #include "Shaders/InputLayout.h"
 #include "Shaders/PixelShader.h"
@@ -1,7 +1,7 @@
 ﻿#pragma once
 
+#include <cassert>
 #include "Bindable/Bindable.h"
-#include "Errors/GraphicsErrors.h"
 
 template<typename C>
 class ConstantBuffer : public Bindable
@@ -9,64 +9,34 @@ class ConstantBuffer : public Bindable
 public:
     ConstantBuffer(Graphics& gfx, const C& cData)
     {
-        INFOMAN(gfx);
-    
-        D3D11_BUFFER_DESC cbd;
-        cbd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-        cbd.Usage = D3D11_USAGE_DYNAMIC;
-        cbd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-        cbd.MiscFlags = 0u;
-        cbd.ByteWidth = sizeof(cData);
-        cbd.StructureByteStride = 0u;
-
-        D3D11_SUBRESOURCE_DATA csd = {};
-        csd.pSysMem = cData;
-
-        GFX_THROW_INFO(GetDevice(gfx)->CreateBuffer(&cbd, &csd, &pCBuffer));
+        const BufferDesc cbd = { BufferType::Constant, BufferUsage::Dynamic, sizeof(cData), 0u };
+        pCBuffer = GetBackend(gfx).CreateBuffer(cbd, &cData);
     }
     ConstantBuffer(Graphics& gfx)
     {
-        INFOMAN(gfx);
-    
-        D3D11_BUFFER_DESC cbd;
-        cbd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-        cbd.Usage = D3D11_USAGE_DYNAMIC;
-        cbd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-        cbd.MiscFlags = 0u;
-        cbd.ByteWidth = sizeof(C);
-        cbd.StructureByteStride = 0u;
-
-        GFX_THROW_INFO(GetDevice(gfx)->CreateBuffer(&cbd, nullptr, &pCBuffer));
+        const BufferDesc cbd = { BufferType::Constant, BufferUsage::Dynamic, sizeof(C), 0u };
+        pCBuffer = GetBackend(gfx).CreateBuffer(cbd, nullptr);
     }
     void Update(Graphics& gfx, const C& cData)
     {
-        INFOMAN(gfx);
-    
         // Resource already sent to the GPU, we just need to modify it
-        D3D11_MAPPED_SUBRESOURCE msd;
-        
-        GFX_THROW_INFO(GetContext(gfx)->Map(pCBuffer.Get(), 0u, D3D11_MAP_WRITE_DISCARD, 0, &msd));
-
-        // We got the cbuffer data from the gpu, update its data
-        memcpy(msd.pData, &cData, sizeof(cData));
-
-        GetContext(gfx)->Unmap(pCBuffer.Get(), 0u);
+        GetBackend(gfx).UpdateBuffer(*pCBuffer, &cData, sizeof(cData));
     }
 
 protected:
-    Microsoft::WRL::ComPtr<ID3D11Buffer> pCBuffer;
+    std::unique_ptr<GpuBuffer> pCBuffer;
 };
 
 template<typename C>
 class VertexConstantBuffer : public ConstantBuffer<C>
 {
     using ConstantBuffer<C>::pCBuffer;
-    using Bindable::GetContext;
+    using Bindable::GetBackend;
 public:
     using ConstantBuffer<C>::ConstantBuffer;
     void Bind(Graphics& gfx) noexcept override
     {
-        Bindable::GetContext(gfx)->VSSetConstantBuffers(0u, 1u, pCBuffer.GetAddressOf());
+        GetBackend(gfx).SetConstantBuffer(ShaderStage::Vertex, 0u, *pCBuffer);
     }
 };
 
@@ -74,12 +44,84 @@ template<typename C>
 class PixelConstantBuffer : public ConstantBuffer<C>
 {
     using ConstantBuffer<C>::pCBuffer;
-    using Bindable::GetContext;
+    using Bindable::GetBackend;
 public:
     using ConstantBuffer<C>::ConstantBuffer;
     void Bind(Graphics& gfx) noexcept override
     {
-        Bindable::GetContext(gfx)->PSSetConstantBuffers(0u, 1u, pCBuffer.GetAddressOf());
+        GetBackend(gfx).SetConstantBuffer(ShaderStage::Pixel, 0u, *pCBuffer);
+    }
+};
+
+/// @brief  Constants rewritten every frame (transforms, time...). Instead of owning a buffer they get written into the
+///         Graphics ConstantRing and bound at their offset in it, so the data only lives until the end of the frame and
+///         Update has to happen each frame before Bind. Falls back to a buffer of its own if the backend can't bind
+///         constant buffer ranges
+template<typename C>
+class FrameConstantBuffer : public Bindable
+{
+public:
+    void Update(Graphics& gfx, const C& cData)
+    {
+        ConstantRing& ring = GetConstantRing(gfx);
+        m_Frame = ring.GetFrameIndex();
+        if (ring.IsSupported())
+        {
+            m_Allocation = ring.Write(&cData, sizeof(cData));
+            return;
+        }
+
+        if (!pCBuffer)
+        {
+            const BufferDesc cbd = { BufferType::Constant, BufferUsage::Dynamic, sizeof(C), 0u };
+            pCBuffer = GetBackend(gfx).CreateBuffer(cbd, nullptr);
+        }
+        GetBackend(gfx).UpdateBuffer(*pCBuffer, &cData, sizeof(cData));
+    }
+    /// @brief  Whether Update was called this frame (so Bind is valid)
+    bool IsCurrent(Graphics& gfx) const noexcept
+    {
+        return m_Frame == GetConstantRing(gfx).GetFrameIndex();
+    }
+
+protected:
+    void BindStage(Graphics& gfx, ShaderStage stage) noexcept
+    {
+        assert("Frame constants bound without being updated this frame" && IsCurrent(gfx));
+        if (pCBuffer)
+        {
+            GetBackend(gfx).SetConstantBuffer(stage, 0u, *pCBuffer);
+        }
+        else
+        {
+            GetConstantRing(gfx).Bind(GetBackend(gfx), stage, 0u, m_Allocation);
+        }
+    }
+
+private:
+    ConstantRing::Allocation m_Allocation;
+    unsigned long long m_Frame = ~0ull;
+    /* Only created when the ring isn't supported */
+    std::unique_ptr<GpuBuffer> pCBuffer;
+};
+
+template<typename C>
+class VertexFrameConstantBuffer : public FrameConstantBuffer<C>
+{
+public:
+    void Bind(Graphics& gfx) noexcept override
+    {
+        this->BindStage(gfx, ShaderStage::Vertex);
+    }
+};
+
+template<typename C>
+class PixelFrameConstantBuffer : public FrameConstantBuffer<C>
+{
+public:
+    void Bind(Graphics& gfx) noexcept override
+    {
+        this->BindStage(gfx, ShaderStage::Pixel);
     }
 };
 
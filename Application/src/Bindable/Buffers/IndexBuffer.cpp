@@ -1,36 +1,111 @@
 ﻿#include "IndexBuffer.h"
 
-#include "../../Errors/GraphicsErrors.h"
+#include <algorithm>
+#include <cassert>
+#include "Bindable/Codex.h"
+#include "Utility/IndexedTriangleList.h"
+
+namespace
+{
+    /// @brief  Largest index a 16 bit buffer can hold, 0xffff itself is the strip cut value
+    constexpr unsigned int s_MaxIndex16 = 0xfffeu;
+}
 
 IndexBuffer::IndexBuffer(Graphics& gfx, const std::vector<unsigned short>& indices)
-    : m_Count(UINT(indices.size()))
+    : m_Count(static_cast<unsigned int>(indices.size()))
+{
+    Create(gfx, indices.data(), IndexFormat::UInt16);
+}
+
+IndexBuffer::IndexBuffer(Graphics& gfx, const std::vector<unsigned int>& indices)
+    : m_Count(static_cast<unsigned int>(indices.size()))
+{
+    // Strip restarts don't count, they narrow to the 16 bit restart
+    unsigned int maxIndex = 0u;
+    for (const unsigned int i : indices)
+    {
+        if (i != StripRestartIndex<unsigned int>)
+        {
+            maxIndex = std::max(maxIndex, i);
+        }
+    }
+    if (maxIndex > s_MaxIndex16)
+    {
+        Create(gfx, indices.data(), IndexFormat::UInt32);
+        return;
+    }
+
+    // Everything fits, narrow down
+    std::vector<unsigned short> narrowed(indices.size());
+    std::transform(indices.begin(), indices.end(), narrowed.begin(), [](unsigned int i)
+    {
+        return i == StripRestartIndex<unsigned int> ? StripRestartIndex<unsigned short> : static_cast<unsigned short>(i);
+    });
+    Create(gfx, narrowed.data(), IndexFormat::UInt16);
+}
+
+IndexBuffer::IndexBuffer(Graphics& gfx, std::span<const unsigned char> indices, IndexFormat format)
+    : m_Count(static_cast<unsigned int>(indices.size() / (format == IndexFormat::UInt16 ? sizeof(unsigned short) : sizeof(unsigned int))))
+{
+    Create(gfx, indices.data(), format);
+}
+
+void IndexBuffer::Create(Graphics& gfx, const void* pIndices, IndexFormat format)
 {
-    INFOMAN(gfx);
+    assert("Index buffer has no indices" && m_Count > 0u);
+    m_Format = format;
+    const unsigned int indexSize = format == IndexFormat::UInt16 ? sizeof(unsigned short) : sizeof(unsigned int);
 
     // Setup the index buffer description
-    D3D11_BUFFER_DESC ibd = {};
-    ibd.Usage = D3D11_USAGE_DEFAULT;
-    ibd.BindFlags = D3D11_BIND_INDEX_BUFFER;
-    ibd.CPUAccessFlags = 0u;
-    ibd.MiscFlags = 0u;
-    ibd.ByteWidth = UINT(m_Count * sizeof(unsigned short));
-    ibd.StructureByteStride = sizeof(unsigned short);
-
-    // Setup subresource that points to the buffer
-    D3D11_SUBRESOURCE_DATA isd = {};
-    isd.pSysMem = indices.data();
+    BufferDesc ibd = {};
+    ibd.Type = BufferType::Index;
+    ibd.Usage = BufferUsage::Default;
+    ibd.ByteWidth = m_Count * indexSize;
+    ibd.StructureByteStride = indexSize;
 
     // Create the buffer
-    GFX_THROW_INFO(GetDevice(gfx)->CreateBuffer(&ibd, &isd, &pIndexBuffer));
+    pIndexBuffer = GetBackend(gfx).CreateBuffer(ibd, pIndices);
 }
 
 void IndexBuffer::Bind(Graphics& gfx) noexcept
 {
     // Basic binding
-    GetContext(gfx)->IASetIndexBuffer(pIndexBuffer.Get(), DXGI_FORMAT_R16_UINT, 0u);
+    GetBackend(gfx).SetIndexBuffer(*pIndexBuffer, m_Format);
 }
 
-UINT IndexBuffer::GetCount() const noexcept
+unsigned int IndexBuffer::GetCount() const noexcept
 {
     return m_Count;
 }
+
+IndexFormat IndexBuffer::GetFormat() const noexcept
+{
+    return m_Format;
+}
+
+uint64_t IndexBuffer::GetResourceId() const noexcept
+{
+    return pIndexBuffer->GetId();
+}
+
+size_t IndexBuffer::GetMemorySize() const noexcept
+{
+    return pIndexBuffer->GetDesc().ByteWidth;
+}
+
+std::string IndexBuffer::GenerateKey(const std::vector<unsigned short>& indices)
+{
+    return Codex::ContentKey(indices.data(), sizeof(unsigned short) * indices.size()) + "/16";
+}
+
+std::string IndexBuffer::GenerateKey(const std::vector<unsigned int>& indices)
+{
+    // Keyed on what was handed in (before narrowing), the same indices as 16 and 32 bit just end up as two buffers
+    return Codex::ContentKey(indices.data(), sizeof(unsigned int) * indices.size()) + "/32n";
+}
+
+std::string IndexBuffer::GenerateKey(std::span<const unsigned char> indices, IndexFormat format)
+{
+    // Raw 16 bit indices make the same buffer as a vector of them
+    return Codex::ContentKey(indices.data(), indices.size()) + (format == IndexFormat::UInt16 ? "/16" : "/32");
+}
@@ -1,13 +1,29 @@
 ﻿#pragma once
+#include <span>
 #include "../Bindable.h"
 
+/// @brief  Picks its format from the indices it's given: R16 whenever every index fits (half the memory and index
+///         fetch bandwidth), R32 otherwise. 0xffff is kept free as the 16 bit strip cut value.
+///         Copies share the GPU buffer, for drawables that use the same indices over different vertex buffers
 class IndexBuffer : public Bindable
 {
 public:
     IndexBuffer(Graphics& gfx, const std::vector<unsigned short>& indices);
+    IndexBuffer(Graphics& gfx, const std::vector<unsigned int>& indices);
+    /// @brief  Raw indices already in format (no narrowing), e.g. straight out of a memory mapped MeshFile
+    IndexBuffer(Graphics& gfx, std::span<const unsigned char> indices, IndexFormat format);
+    static std::string GenerateKey(const std::vector<unsigned short>& indices);
+    static std::string GenerateKey(const std::vector<unsigned int>& indices);
+    static std::string GenerateKey(std::span<const unsigned char> indices, IndexFormat format);
     void Bind(Graphics& gfx) noexcept override;
-    UINT GetCount() const noexcept;
+    uint64_t GetResourceId() const noexcept override;
+    size_t GetMemorySize() const noexcept override;
+    unsigned int GetCount() const noexcept;
+    IndexFormat GetFormat() const noexcept;
 protected:
-    UINT m_Count;
-    Microsoft::WRL::ComPtr<ID3D11Buffer> pIndexBuffer;
+    void Create(Graphics& gfx, const void* pIndices, IndexFormat format);
+protected:
+    unsigned int m_Count;
+    IndexFormat m_Format = IndexFormat::UInt16;
+    std::shared_ptr<GpuBuffer> pIndexBuffer;
 };
@@ -0,0 +1,49 @@
+﻿#include "InstanceBuffer.h"
+
+#include <algorithm>
+
+InstanceBuffer::InstanceBuffer(Graphics& gfx, unsigned int capacity)
+{
+    Allocate(gfx, capacity);
+}
+
+void InstanceBuffer::Update(Graphics& gfx, const std::vector<Math::XMFLOAT4X4>& transforms)
+{
+    m_Count = static_cast<unsigned int>(transforms.size());
+    if (m_Count > m_Capacity)
+    {
+        Allocate(gfx, std::max(m_Count, m_Capacity * 2u));
+    }
+
+    // One Map/Unmap for every instance instead of one per drawable
+    if (m_Count > 0u)
+    {
+        GetBackend(gfx).UpdateBuffer(*pInstanceBuffer, transforms.data(), transforms.size() * sizeof(Math::XMFLOAT4X4));
+    }
+    m_Vcbuf.Update(gfx, Math::XMMatrixTranspose(gfx.GetProjectionMat()));
+}
+
+void InstanceBuffer::Bind(Graphics& gfx) noexcept
+{
+    const unsigned int offset = 0u;
+    GetBackend(gfx).SetVertexBuffer(1u, *pInstanceBuffer, VertexLayout<InstanceVertex>::Stride, offset);
+    m_Vcbuf.Bind(gfx);
+}
+
+unsigned int InstanceBuffer::GetCount() const noexcept
+{
+    return m_Count;
+}
+
+void InstanceBuffer::Allocate(Graphics& gfx, unsigned int capacity)
+{
+    m_Capacity = std::max(1u, capacity);
+
+    BufferDesc ibd = {};
+    ibd.Type = BufferType::Vertex;
+    ibd.Usage = BufferUsage::Dynamic;
+    ibd.ByteWidth = static_cast<unsigned int>(m_Capacity * sizeof(Math::XMFLOAT4X4));
+    ibd.StructureByteStride = sizeof(Math::XMFLOAT4X4);
+
+    pInstanceBuffer = GetBackend(gfx).CreateBuffer(ibd, nullptr);
+}
@@ -0,0 +1,44 @@
+﻿#pragma once
+#include "ConstantBuffers.h"
+#include "VertexLayout.h"
+#include "Utility/Maths.h"
+
+/// @brief  Per instance vertex the InstanceBuffer holds, the world matrix rows as InstanceTransform0-3
+struct InstanceVertex
+{
+    Math::XMFLOAT4 row0;
+    Math::XMFLOAT4 row1;
+    Math::XMFLOAT4 row2;
+    Math::XMFLOAT4 row3;
+
+    static constexpr auto Elements()
+    {
+        return std::array{
+            VERTEX_ELEMENT_INDEXED(InstanceVertex, row0, "InstanceTransform", 0u, Float4),
+            VERTEX_ELEMENT_INDEXED(InstanceVertex, row1, "InstanceTransform", 1u, Float4),
+            VERTEX_ELEMENT_INDEXED(InstanceVertex, row2, "InstanceTransform", 2u, Float4),
+            VERTEX_ELEMENT_INDEXED(InstanceVertex, row3, "InstanceTransform", 3u, Float4)
+        };
+    }
+};
+static_assert(VertexLayout<InstanceVertex>::Stride == sizeof(Math::XMFLOAT4X4), "Instance transforms get uploaded as InstanceVertices");
+
+/// @brief  Instanced counterpart of the TransformCBuffer. Holds the world matrix of every instance in a dynamic
+///         vertex buffer bound to slot 1 (InstanceTransform0-3), the view projection goes through the usual transform
+///         cbuffer. Grows (doubling) when more instances are submitted than it has room for
+class InstanceBuffer : public Bindable
+{
+public:
+    InstanceBuffer(Graphics& gfx, unsigned int capacity = 64u);
+    /// @brief  Uploads the world matrices (row major, not transposed) and the current projection
+    void Update(Graphics& gfx, const std::vector<Math::XMFLOAT4X4>& transforms);
+    void Bind(Graphics& gfx) noexcept override;
+    unsigned int GetCount() const noexcept;
+private:
+    void Allocate(Graphics& gfx, unsigned int capacity);
+private:
+    unsigned int m_Count = 0u;
+    unsigned int m_Capacity = 0u;
+    std::unique_ptr<GpuBuffer> pInstanceBuffer;
+    VertexFrameConstantBuffer<Math::XMMATRIX> m_Vcbuf;
+};
@@ -2,20 +2,22 @@
 
 TransformCBuffer::TransformCBuffer(Graphics& gfx, const Drawable& parent)
     : parent(parent)
-{
-    if (!pVcbuf)
-    {
-        pVcbuf = std::make_unique<VertexConstantBuffer<Math::XMMATRIX>>(gfx);
-    }
-}
+{}
 
-void TransformCBuffer::Bind(Graphics& gfx) noexcept
+void TransformCBuffer::Upload(Graphics& gfx)
 {
-    pVcbuf->Update( gfx,
+    m_Vcbuf.Update( gfx,
     Math::XMMatrixTranspose(
         parent.GetTransformMat() * gfx.GetProjectionMat()
     ));
-    pVcbuf->Bind( gfx );
 }
 
-std::unique_ptr<VertexConstantBuffer<Math::XMMATRIX>> TransformCBuffer::pVcbuf;
\ No newline at end of file
+void TransformCBuffer::Bind(Graphics& gfx) noexcept
+{
+    // Drawn directly (not through a render queue), nothing uploaded the transform ahead of time
+    if (!m_Vcbuf.IsCurrent(gfx))
+    {
+        Upload(gfx);
+    }
+    m_Vcbuf.Bind( gfx );
+}
\ No newline at end of file
@@ -7,8 +7,10 @@ class TransformCBuffer : public Bindable
 {
 public:
     TransformCBuffer( Graphics& gfx,const Drawable& parent );
+    /// @brief  Writes this frame's transform into the constant ring
+    void Upload( Graphics& gfx ) override;
     void Bind( Graphics& gfx ) noexcept override;
 private:
-    static std::unique_ptr<VertexConstantBuffer<Math::XMMATRIX>> pVcbuf;
+    VertexFrameConstantBuffer<Math::XMMATRIX> m_Vcbuf;
     const Drawable& parent;
 };
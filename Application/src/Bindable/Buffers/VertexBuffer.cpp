@@ -1,29 +1,34 @@
 ﻿#include "VertexBuffer.h"
 
-#include "../../Errors/GraphicsErrors.h"
-/*
-template <class V>
-VertexBuffer::VertexBuffer(Graphics& gfx, const std::vector<V>& vertices)
-    : m_Stride(sizeof(V))
+VertexBuffer::VertexBuffer(Graphics& gfx, std::span<const unsigned char> vertices, unsigned int stride)
+    : m_Stride(stride)
 {
-    INFOMAN(gfx);
-
-    D3D11_BUFFER_DESC vbd;
-    vbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-    vbd.Usage = D3D11_USAGE_DEFAULT;
-    vbd.CPUAccessFlags = 0u;
-    vbd.MiscFlags = 0u;
-    vbd.ByteWidth = UINT(m_Stride * vertices.size());
+    BufferDesc vbd = {};
+    vbd.Type = BufferType::Vertex;
+    vbd.Usage = BufferUsage::Default;
+    vbd.ByteWidth = static_cast<unsigned int>(vertices.size());
     vbd.StructureByteStride = m_Stride;
 
-    D3D11_SUBRESOURCE_DATA vsd;
-    vsd.pSysMem = vertices.data();
+    pVertexBuffer = GetBackend(gfx).CreateBuffer(vbd, vertices.data());
+}
 
-    GFX_THROW_INFO(GetDevice(gfx)->CreateBuffer(&vbd, &vsd, &pVertexBuffer));
-}*/
+std::string VertexBuffer::GenerateKey(std::span<const unsigned char> vertices, unsigned int stride)
+{
+    return Codex::ContentKey(vertices.data(), vertices.size()) + '/' + std::to_string(stride);
+}
 
 void VertexBuffer::Bind(Graphics& gfx) noexcept
 {
-    const UINT offset = 0u;
-    GetContext(gfx)->IASetVertexBuffers(0u, 1u, pVertexBuffer.GetAddressOf(), &m_Stride, &offset);
-}
\ No newline at end of file
+    const unsigned int offset = 0u;
+    GetBackend(gfx).SetVertexBuffer(0u, *pVertexBuffer, m_Stride, offset);
+}
+
+uint64_t VertexBuffer::GetResourceId() const noexcept
+{
+    return pVertexBuffer->GetId();
+}
+
+size_t VertexBuffer::GetMemorySize() const noexcept
+{
+    return pVertexBuffer->GetDesc().ByteWidth;
+}
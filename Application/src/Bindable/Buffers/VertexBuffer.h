@@ -1,38 +1,68 @@
 ﻿#pragma once
+#include <span>
 #include "Bindable/Bindable.h"
-#include "Errors/GraphicsErrors.h"
+#include "Bindable/Codex.h"
+#include "VertexLayout.h"
 
 struct Vertex
 {
     Math::XMFLOAT3 pos;
+
+    static constexpr auto Elements()
+    {
+        return std::array{ VERTEX_ELEMENT(Vertex, pos, "Position", Float3) };
+    }
+};
+
+/// @brief  Full float position, normal and texcoord, the shape generators fill in all three for it
+struct LitVertex
+{
+    Math::XMFLOAT3 pos;
+    Math::XMFLOAT3 n;
+    Math::XMFLOAT2 tc;
+
+    static constexpr auto Elements()
+    {
+        return std::array{
+            VERTEX_ELEMENT(LitVertex, pos, "Position", Float3),
+            VERTEX_ELEMENT(LitVertex, n, "Normal", Float3),
+            VERTEX_ELEMENT(LitVertex, tc, "Texcoord", Float2)
+        };
+    }
 };
 
 class VertexBuffer : public Bindable
 {
 public:
+    /// @brief  Vertex types with Elements() get their layout checked here (see VertexLayout.h)
     template<class V>
     VertexBuffer(Graphics& gfx, const std::vector<V>& vertices)
-        : m_Stride(sizeof(V))
+        : VertexBuffer(gfx, AsBytes(vertices), sizeof(V))
     {
+        if constexpr (DescribedVertex<V>)
         {
-            INFOMAN(gfx);
-
-            D3D11_BUFFER_DESC vbd = {};
-            vbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-            vbd.Usage = D3D11_USAGE_DEFAULT;
-            vbd.CPUAccessFlags = 0u;
-            vbd.MiscFlags = 0u;
-            vbd.ByteWidth = UINT(m_Stride * vertices.size());
-            vbd.StructureByteStride = m_Stride;
-
-            D3D11_SUBRESOURCE_DATA vsd = {};
-            vsd.pSysMem = vertices.data();
-
-            GFX_THROW_INFO(GetDevice(gfx)->CreateBuffer(&vbd, &vsd, &pVertexBuffer));
+            static_assert(VertexLayout<V>::Stride == sizeof(V));
         }
     }
+    /// @brief  Raw vertices of stride bytes each, e.g. straight out of a memory mapped MeshFile
+    VertexBuffer(Graphics& gfx, std::span<const unsigned char> vertices, unsigned int stride);
+    /// @brief  The same vertices key the same whether they came as a vector or raw bytes
+    template<class V>
+    static std::string GenerateKey(const std::vector<V>& vertices)
+    {
+        return GenerateKey(AsBytes(vertices), sizeof(V));
+    }
+    static std::string GenerateKey(std::span<const unsigned char> vertices, unsigned int stride);
     void Bind(Graphics& gfx) noexcept override;
+    uint64_t GetResourceId() const noexcept override;
+    size_t GetMemorySize() const noexcept override;
+private:
+    template<class V>
+    static std::span<const unsigned char> AsBytes(const std::vector<V>& vertices) noexcept
+    {
+        return { reinterpret_cast<const unsigned char*>(vertices.data()), sizeof(V) * vertices.size() };
+    }
 protected:
-    UINT m_Stride;
-    Microsoft::WRL::ComPtr<ID3D11Buffer> pVertexBuffer;
+    unsigned int m_Stride;
+    std::unique_ptr<GpuBuffer> pVertexBuffer;
 };
@@ -0,0 +1,130 @@
+﻿#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <DirectXPackedVector.h>
+
+#include "Backend/RenderTypes.h"
+#include "Utility/Maths.h"
+
+/// Vertex structs describe their elements once, as a static Elements() listing a VERTEX_ELEMENT per member:
+///
+///     struct LitVertex
+///     {
+///         Math::XMFLOAT3 pos;
+///         Math::PackedVector::XMBYTEN4 n;
+///         static constexpr auto Elements()
+///         {
+///             return std::array{ VERTEX_ELEMENT(LitVertex, pos, "Position", Float3), VERTEX_ELEMENT(LitVertex, n, "Normal", ByteN4) };
+///         }
+///     };
+///
+/// VertexLayout<V> derives the stride, offsets and input element descs from that at compile time. A member whose type
+/// isn't what its format reads, overlapping elements, or bytes of V no element covers (padding the input assembler
+/// would fetch for nothing) all fail to compile. Elements() has to be a function since V is only complete (which
+/// offsetof needs) inside member function bodies
+
+/// @brief  The type an element of format F is stored as in a vertex
+template<ElementFormat F> struct ElementStorage;
+template<> struct ElementStorage<ElementFormat::Float1> { using Type = float; };
+template<> struct ElementStorage<ElementFormat::Float2> { using Type = Math::XMFLOAT2; };
+template<> struct ElementStorage<ElementFormat::Float3> { using Type = Math::XMFLOAT3; };
+template<> struct ElementStorage<ElementFormat::Float4> { using Type = Math::XMFLOAT4; };
+template<> struct ElementStorage<ElementFormat::Half2> { using Type = Math::PackedVector::XMHALF2; };
+template<> struct ElementStorage<ElementFormat::Half4> { using Type = Math::PackedVector::XMHALF4; };
+template<> struct ElementStorage<ElementFormat::ShortN2> { using Type = Math::PackedVector::XMSHORTN2; };
+template<> struct ElementStorage<ElementFormat::ShortN4> { using Type = Math::PackedVector::XMSHORTN4; };
+template<> struct ElementStorage<ElementFormat::UShortN4> { using Type = Math::PackedVector::XMUSHORTN4; };
+template<> struct ElementStorage<ElementFormat::ByteN4> { using Type = Math::PackedVector::XMBYTEN4; };
+template<> struct ElementStorage<ElementFormat::UByteN4> { using Type = Math::PackedVector::XMUBYTEN4; };
+template<> struct ElementStorage<ElementFormat::UDecN4> { using Type = Math::PackedVector::XMUDECN4; };
+
+struct VertexElement
+{
+    const char*     SemanticName;
+    unsigned int    SemanticIndex;
+    ElementFormat   Format;
+    unsigned int    Offset;
+};
+
+/// @brief  What VERTEX_ELEMENT expands to, M is the member's type
+template<class M, ElementFormat F>
+consteval VertexElement MakeVertexElement(const char* semanticName, unsigned int semanticIndex, size_t offset)
+{
+    static_assert(std::is_same_v<M, typename ElementStorage<F>::Type>, "Vertex member type doesn't match its element format");
+    static_assert(sizeof(M) == GetElementSize(F));
+    return { semanticName, semanticIndex, F, static_cast<unsigned int>(offset) };
+}
+
+/// @brief  Element for V::member, read by the shader as semantic (index 0 or index) in ElementFormat::format
+#define VERTEX_ELEMENT(V, member, semantic, format) VERTEX_ELEMENT_INDEXED(V, member, semantic, 0u, format)
+#define VERTEX_ELEMENT_INDEXED(V, member, semantic, index, format) \
+    MakeVertexElement<std::remove_cvref_t<decltype(std::declval<V&>().member)>, ElementFormat::format>(semantic, index, offsetof(V, member))
+
+template<class V>
+concept DescribedVertex = std::is_standard_layout_v<V> && requires { V::Elements(); };
+
+/// @brief  Elements start where the previous one (by offset) ended and together cover all of V
+template<DescribedVertex V>
+consteval bool IsTightVertex()
+{
+    auto elements = V::Elements();
+    std::sort(elements.begin(), elements.end(), [](const VertexElement& a, const VertexElement& b) { return a.Offset < b.Offset; });
+    unsigned int end = 0u;
+    for (const VertexElement& e : elements)
+    {
+        if (e.Offset != end)
+        {
+            return false;
+        }
+        end += GetElementSize(e.Format);
+    }
+    return end == sizeof(V);
+}
+
+template<DescribedVertex V>
+consteval bool IsAlignedVertex()
+{
+    const auto elements = V::Elements();
+    return std::all_of(elements.begin(), elements.end(), [](const VertexElement& e) { return e.Offset % 4u == 0u; });
+}
+
+template<DescribedVertex V>
+class VertexLayout
+{
+public:
+    static_assert(IsTightVertex<V>(), "Vertex elements overlap, or leave bytes of the vertex unread");
+    static_assert(IsAlignedVertex<V>(), "Vertex elements have to be 4 byte aligned");
+
+    static constexpr auto Elements = V::Elements();
+    static constexpr unsigned int Stride = sizeof(V);
+
+    /// @brief  Offset of an element, doesn't compile when used in a constant expression and V doesn't have it
+    static constexpr unsigned int GetOffset(std::string_view semanticName, unsigned int semanticIndex = 0u)
+    {
+        for (const VertexElement& e : Elements)
+        {
+            if (semanticName == e.SemanticName && semanticIndex == e.SemanticIndex)
+            {
+                return e.Offset;
+            }
+        }
+        throw "Vertex has no element with that semantic";
+    }
+
+    /// @brief  Input element descs reading V from slot, per instance ones step once every instance
+    static std::vector<VertexElementDesc> GetDescs(unsigned int slot = 0u, bool bPerInstance = false)
+    {
+        std::vector<VertexElementDesc> descs;
+        descs.reserve(Elements.size());
+        for (const VertexElement& e : Elements)
+        {
+            descs.push_back({ e.SemanticName, e.SemanticIndex, e.Format, slot, e.Offset, bPerInstance, bPerInstance ? 1u : 0u });
+        }
+        return descs;
+    }
+};
@@ -0,0 +1,95 @@
+﻿#include "Codex.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+    uint64_t Mix(uint64_t x)
+    {
+        // splitmix64's finalizer, every input bit reaches every output bit
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    }
+}
+
+Codex& Codex::Get()
+{
+    static Codex s_Codex;
+    return s_Codex;
+}
+
+std::shared_ptr<Bindable> Codex::Find(const std::string& key)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    const auto it = m_Binds.find(key);
+    return it != m_Binds.end() ? it->second.lock() : nullptr;
+}
+
+std::shared_ptr<Bindable> Codex::Store(const std::string& key, std::shared_ptr<Bindable> pBind)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto& entry = m_Binds[key];
+    if (auto pExisting = entry.lock())
+    {
+        return pExisting;
+    }
+    entry = pBind;
+    // Keys of freed bindables only pile up when new ones come in, so this is the place to clear them out
+    if (m_Binds.size() >= m_PruneAt)
+    {
+        Prune();
+    }
+    return pBind;
+}
+
+void Codex::Prune()
+{
+    std::erase_if(m_Binds, [](const auto& entry) { return entry.second.expired(); });
+    m_PruneAt = std::max(s_MinPruneSize, m_Binds.size() * 2u);
+}
+
+size_t Codex::GetLiveCount()
+{
+    Codex& codex = Get();
+    std::lock_guard<std::mutex> lock(codex.m_Mutex);
+    codex.Prune();
+    return codex.m_Binds.size();
+}
+
+size_t Codex::GetLiveMemory()
+{
+    Codex& codex = Get();
+    std::lock_guard<std::mutex> lock(codex.m_Mutex);
+    size_t bytes = 0u;
+    for (const auto& [key, pWeak] : codex.m_Binds)
+    {
+        if (const auto pBind = pWeak.lock())
+        {
+            bytes += pBind->GetMemorySize();
+        }
+    }
+    return bytes;
+}
+
+std::string Codex::ContentKey(const void* pData, size_t size)
+{
+    // Two independent 64 bit lanes over 8 byte words, the zero padded tail is told apart by the size in the key
+    const auto* pBytes = static_cast<const unsigned char*>(pData);
+    uint64_t a = 0x9e3779b97f4a7c15ull;
+    uint64_t b = 0xc2b2ae3d27d4eb4full;
+    for (size_t i = 0; i < size; i += sizeof(uint64_t))
+    {
+        uint64_t word = 0u;
+        std::memcpy(&word, pBytes + i, std::min(sizeof(uint64_t), size - i));
+        a = Mix(a ^ word);
+        b = (b ^ Mix(word + 0x9e3779b97f4a7c15ull)) * 0x100000001b3ull;
+    }
+    char key[56];
+    const int keySize = std::snprintf(key, sizeof(key), "%zx:%016llx%016llx", size, (unsigned long long)a,
+                                      (unsigned long long)Mix(b));
+    return std::string(key, size_t(keySize));
+}
@@ -0,0 +1,61 @@
+﻿#pragma once
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+#include "Bindable.h"
+#include "Utility/Hash.h"
+
+/// @brief  Registry of bindables keyed by what they're made from (shader path + defines, buffer contents, topology,
+///         layout...) so identical ones are created once and shared by everyone that resolves them, across drawable
+///         types. Only weak references are kept, a bindable is freed along with its last user and created again by
+///         the next Resolve.
+///         T has to provide a static GenerateKey taking the same parameters as its constructor (minus gfx)
+class Codex
+{
+public:
+    template<class T, typename... Params>
+    static std::shared_ptr<T> Resolve(Graphics& gfx, Params&&... p)
+    {
+        const std::string key = std::string(typeid(T).name()) + '#' + T::GenerateKey(std::as_const(p)...);
+        if (auto pBind = Get().Find(key))
+        {
+            return std::static_pointer_cast<T>(std::move(pBind));
+        }
+        // Created outside the lock so a shader compile doesn't hold up everyone else, if two threads race on the same
+        // key the first one stored wins and the other copy is dropped
+        return std::static_pointer_cast<T>(Get().Store(key, std::make_shared<T>(gfx, std::forward<Params>(p)...)));
+    }
+
+    /// @brief  Number of distinct bindables currently alive through the codex
+    static size_t GetLiveCount();
+    /// @brief  GPU memory held by them (see Bindable::GetMemorySize)
+    static size_t GetLiveMemory();
+
+    /// @brief  Key fragment for raw contents (vertices, indices...): their size and a 128 bit digest of the bytes,
+    ///         taken in a single pass. Short and fixed length whatever the size of the contents, which are neither
+    ///         copied nor kept. Two different contents only share a bindable if both the size and the digest match
+    static std::string ContentKey(const void* pData, size_t size);
+
+private:
+    static Codex& Get();
+    std::shared_ptr<Bindable> Find(const std::string& key);
+    std::shared_ptr<Bindable> Store(const std::string& key, std::shared_ptr<Bindable> pBind);
+    /// @brief  Drops the entries whose bindable has already been freed and moves m_PruneAt to twice what's left,
+    ///         m_Mutex has to be held
+    void Prune();
+
+private:
+    struct KeyHash
+    {
+        size_t operator()(const std::string& key) const noexcept { return static_cast<size_t>(Fnv1a::Of(key)); }
+    };
+
+    static constexpr size_t s_MinPruneSize = 64u;
+    std::mutex m_Mutex;
+    std::unordered_map<std::string, std::weak_ptr<Bindable>, KeyHash> m_Binds;
+    /* Store prunes once the map grows to this, so walking it is amortized over as many stores as it has entries */
+    size_t m_PruneAt = s_MinPruneSize;
+};
@@ -1,19 +1,32 @@
 ﻿#include "InputLayout.h"
 
-#include "../../Errors/GraphicsErrors.h"
+#include <string>
 
-InputLayout::InputLayout(Graphics& gfx, const std::vector<D3D11_INPUT_ELEMENT_DESC>& ied, ID3DBlob* pVertexShaderBytecode)
+InputLayout::InputLayout(Graphics& gfx, const std::vector<VertexElementDesc>& ied, const GpuShader& vertexShader)
 {
-    INFOMAN(gfx);
-    GFX_THROW_INFO(GetDevice(gfx)->CreateInputLayout(
-        ied.data(),
-        UINT(ied.size()),
-        pVertexShaderBytecode->GetBufferPointer(),
-        pVertexShaderBytecode->GetBufferSize(),
-        &pInputLayout));
+    pInputLayout = GetBackend(gfx).CreateInputLayout(ied, vertexShader);
+}
+
+std::string InputLayout::GenerateKey(const std::vector<VertexElementDesc>& ied, const GpuShader& vertexShader)
+{
+    std::string key = std::to_string(vertexShader.GetId());
+    for (const auto& element : ied)
+    {
+        key += '|';
+        key += element.SemanticName;
+        key += std::to_string(element.SemanticIndex) + ',' + std::to_string(static_cast<int>(element.Format)) + ','
+            + std::to_string(element.InputSlot) + ',' + std::to_string(element.AlignedByteOffset) + ','
+            + std::to_string(element.bPerInstance) + ',' + std::to_string(element.InstanceDataStepRate);
+    }
+    return key;
 }
 
 void InputLayout::Bind(Graphics& gfx) noexcept
 {
-    GetContext(gfx)->IASetInputLayout(pInputLayout.Get());
+    GetBackend(gfx).SetInputLayout(*pInputLayout);
+}
+
+uint64_t InputLayout::GetResourceId() const noexcept
+{
+    return pInputLayout->GetId();
 }
@@ -4,8 +4,11 @@
 class InputLayout : public Bindable
 {
 public:
-    InputLayout(Graphics& gfx, const std::vector<D3D11_INPUT_ELEMENT_DESC>& ied, ID3DBlob* pVertexShaderBytecode);
+    InputLayout(Graphics& gfx, const std::vector<VertexElementDesc>& ied, const GpuShader& vertexShader);
+    /// @brief  The elements and the shader they were validated against (layouts are tied to its input signature)
+    static std::string GenerateKey(const std::vector<VertexElementDesc>& ied, const GpuShader& vertexShader);
     void Bind(Graphics& gfx) noexcept override;
+    uint64_t GetResourceId() const noexcept override;
 protected:
-    Microsoft::WRL::ComPtr<ID3D11InputLayout> pInputLayout;
+    std::unique_ptr<GpuInputLayout> pInputLayout;
 };
@@ -1,31 +1,38 @@
 ﻿#include "Shader.h"
 
-#include <d3dcompiler.h>
+#include <filesystem>
 
-void Shader::SetDefines(const std::vector<D3D_SHADER_MACRO>& defines) noexcept
+std::string Shader::GenerateKey(const std::wstring& path, const std::vector<ShaderMacro>& defines)
+{
+    const auto u8Path = std::filesystem::path(path).lexically_normal().u8string();
+    std::string key(u8Path.begin(), u8Path.end());
+    for (const auto& define : defines)
+    {
+        key += '|';
+        key += define.Name;
+        key += '=';
+        key += define.Definition ? define.Definition : "";
+    }
+    return key;
+}
+
+void Shader::SetDefines(const std::vector<ShaderMacro>& defines) noexcept
 {
     m_Defines = defines;
 }
 
-void Shader::CompileShader(const std::wstring& path, const char* entryPoint, const char* profile,
-                           ID3DBlob** ppBlob)
+void Shader::Bind(Graphics& gfx) noexcept
 {
-    Microsoft::WRL::ComPtr<ID3DBlob> pErrorBlob;
-    
-    UINT flags = 0u; //D3DCOMPILE_ENABLE_STRICTNESS;
+    GetBackend(gfx).SetShader(*pShader);
+}
 
-    // Cant use throw macro, have to retrieve error msg from pErrorBlob
-    HRESULT compHR = D3DCompileFromFile(
-        path.c_str(),
-        m_Defines.data(),
-        nullptr,
-        entryPoint,
-        profile,
-        flags, 0u, ppBlob, &pErrorBlob);
+void Shader::CompileShader(Graphics& gfx, ShaderStage stage, const std::wstring& path)
+{
+    // Backend handles compiling (and reporting compile errors) for whatever API it targets
+    pShader = GetBackend(gfx).CreateShader(stage, path, m_Defines);
+}
 
-    if (compHR < 0)
-    {
-        auto err = (char*)pErrorBlob->GetBufferPointer();
-        throw Graphics::HrException(__LINE__, __FILE__, compHR, {err});
-    }
+uint64_t Shader::GetResourceId() const noexcept
+{
+    return pShader->GetId();
 }
@@ -4,9 +4,14 @@
 class Shader : public Bindable
 {
 public:
-    void SetDefines(const std::vector<D3D_SHADER_MACRO>& defines) noexcept;
+    /// @brief  Path + defines, which is everything that tells two compiles of the same stage apart
+    static std::string GenerateKey(const std::wstring& path, const std::vector<ShaderMacro>& defines = {});
+    void SetDefines(const std::vector<ShaderMacro>& defines) noexcept;
+    void Bind(Graphics& gfx) noexcept override;
+    uint64_t GetResourceId() const noexcept override;
     
 protected:
-    std::vector<D3D_SHADER_MACRO> m_Defines;
-    void CompileShader(const std::wstring& path, const char* entryPoint, const char* profile, ID3DBlob** ppBlob);
+    std::vector<ShaderMacro> m_Defines;
+    std::unique_ptr<GpuShader> pShader;
+    void CompileShader(Graphics& gfx, ShaderStage stage, const std::wstring& path);
 };
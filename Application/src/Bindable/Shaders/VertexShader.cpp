@@ -1,40 +1,20 @@
 ﻿#include "VertexShader.h"
 
-#include "../../Errors/GraphicsErrors.h"
-
 VertexShader::VertexShader(Graphics& gfx, const std::wstring& path)
 {
     SetDefines({});
     
-    CreateVertexShader(gfx, path);
+    CompileShader(gfx, ShaderStage::Vertex, path);
 }
 
-VertexShader::VertexShader(Graphics& gfx, const std::wstring& path, const std::vector<D3D_SHADER_MACRO>& defines)
+VertexShader::VertexShader(Graphics& gfx, const std::wstring& path, const std::vector<ShaderMacro>& defines)
 {
     SetDefines(defines);
     
-    CreateVertexShader(gfx, path);
+    CompileShader(gfx, ShaderStage::Vertex, path);
 }
 
-void VertexShader::Bind(Graphics& gfx) noexcept
+const GpuShader& VertexShader::GetBytecode() const noexcept
 {
-    GetContext(gfx)->VSSetShader(pVertexShader.Get(), nullptr, 0u);
-}
-
-ID3DBlob* VertexShader::GetBytecode() const noexcept
-{
-    return pBytecodeBlob.Get();
-}
-
-void VertexShader::CreateVertexShader(Graphics& gfx, const std::wstring& path)
-{
-    INFOMAN(gfx);
-
-    CompileShader(path, "VSMain", "vs_5_0", &pBytecodeBlob);
-
-    GFX_THROW_INFO(GetDevice(gfx)->CreateVertexShader(
-        pBytecodeBlob->GetBufferPointer(),
-        pBytecodeBlob->GetBufferSize(),
-        nullptr,
-        &pVertexShader));
+    return *pShader;
 }
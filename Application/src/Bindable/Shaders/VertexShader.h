@@ -5,12 +5,7 @@ class VertexShader : public Shader
 {
 public:
     VertexShader(Graphics& gfx, const std::wstring& path);
-    VertexShader(Graphics& gfx, const std::wstring& path, const std::vector<D3D_SHADER_MACRO>& defines);
-    void Bind(Graphics& gfx) noexcept override;
-    ID3DBlob* GetBytecode() const noexcept;
-protected:
-    Microsoft::WRL::ComPtr<ID3DBlob> pBytecodeBlob;
-    Microsoft::WRL::ComPtr<ID3D11VertexShader> pVertexShader;
-
-    void CreateVertexShader(Graphics& gfx, const std::wstring& path);
+    VertexShader(Graphics& gfx, const std::wstring& path, const std::vector<ShaderMacro>& defines);
+    /// @brief  Compiled shader, needed to create an InputLayout matching its signature
+    const GpuShader& GetBytecode() const noexcept;
 };
@@ -1,10 +1,17 @@
 ﻿#include "Topology.h"
 
-Topology::Topology(Graphics& gfx, D3D11_PRIMITIVE_TOPOLOGY topology)
+#include <string>
+
+Topology::Topology(Graphics& gfx, PrimitiveTopology topology)
     : m_Topology(topology)
 {}
 
+std::string Topology::GenerateKey(PrimitiveTopology topology)
+{
+    return std::to_string(static_cast<int>(topology));
+}
+
 void Topology::Bind(Graphics& gfx) noexcept
 {
-    GetContext(gfx)->IASetPrimitiveTopology(m_Topology);
+    GetBackend(gfx).SetTopology(m_Topology);
 }
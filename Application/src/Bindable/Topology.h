@@ -4,8 +4,9 @@
 class Topology : public Bindable
 {
 public:
-    Topology(Graphics& gfx, D3D11_PRIMITIVE_TOPOLOGY topology);
+    Topology(Graphics& gfx, PrimitiveTopology topology);
+    static std::string GenerateKey(PrimitiveTopology topology);
     void Bind(Graphics& gfx) noexcept override;
 protected:
-    D3D11_PRIMITIVE_TOPOLOGY m_Topology;
+    PrimitiveTopology m_Topology;
 };
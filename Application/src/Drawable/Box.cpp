@@ -1,82 +1,140 @@
 ﻿#include "Box.h"
 
+#include <cassert>
+
 #include "Bindable/BindableCommon.h"
 #include "Utility/IndexedTriangleList.h"
+#include "Utility/MeshFile.h"
+#include "Utility/MeshOptimizer.h"
 #include "Utility/ShapesCommon.h"
+#include "Utility/VertexQuantizer.h"
 
-Box::Box(Graphics& gfx, std::mt19937& rng, std::uniform_real_distribution<float>& adist,
-         std::uniform_real_distribution<float>& ddist, std::uniform_real_distribution<float>& odist,
-         std::uniform_real_distribution<float>& rdist)
-    :
-    r( rdist( rng ) ),
-    droll( ddist( rng ) ),
-    dpitch( ddist( rng ) ),
-    dyaw( ddist( rng ) ),
-    dphi( odist( rng ) ),
-    dtheta( odist( rng ) ),
-    dchi( odist( rng ) ),
-    chi( adist( rng ) ),
-    theta( adist( rng ) ),
-    phi( adist( rng ) )
+namespace
 {
-    if (!IsStaticInitialized())
+    BoxAnimation::Motion RandomMotion(std::mt19937& rng, std::uniform_real_distribution<float>& adist,
+        std::uniform_real_distribution<float>& ddist, std::uniform_real_distribution<float>& odist,
+        std::uniform_real_distribution<float>& rdist)
+    {
+        // Same draw order the box members used to initialize in
+        BoxAnimation::Motion m = {};
+        m.r = rdist(rng);
+        m.theta = adist(rng);
+        m.phi = adist(rng);
+        m.chi = adist(rng);
+        m.droll = ddist(rng);
+        m.dpitch = ddist(rng);
+        m.dyaw = ddist(rng);
+        m.dtheta = odist(rng);
+        m.dphi = odist(rng);
+        m.dchi = odist(rng);
+        return m;
+    }
+
+    /// @brief  The plane every box draws, vertex cache optimized
+    IndexedTriangleList<Vertex> MakeMesh()
     {
         IndexedTriangleList<Vertex> model = Plane::MakeTesselated<Vertex>(128, 128);
+        // Drawn as a wireframe, the edges inherit the vertex cache friendly triangle order
+        MeshOptimizer::Optimize(model);
+        return model;
+    }
+}
 
-        const std::vector<D3D11_INPUT_ELEMENT_DESC> ied =
+std::future<void> Box::LoadShared(Graphics& gfx, AsyncLoader& loader, const std::string& meshPath)
+{
+    return LoadSharedAsync(loader, [&gfx, meshPath](Shared& shared)
+    {
+        // Either straight from the mapped file or generated, the rest doesn't care which
+        MeshFile file;
+        std::vector<VertexElementDesc> ied;
+        AABB bounds;
+        if (!meshPath.empty())
         {
+            if (!file.Open(meshPath))
             {
-                "Position",
-                0u,
-                DXGI_FORMAT_R32G32B32_FLOAT,               // 3 Floats specifying a single element
-                0u,
-                D3D11_APPEND_ALIGNED_ELEMENT ,
-                D3D11_INPUT_PER_VERTEX_DATA,
-                0u
+                throw MeshFile::LoadException(__LINE__, __FILE__, meshPath);
             }
-        };
-
-        auto pVS = std::make_unique<VertexShader>(gfx, L"shaders/VertexShader.hlsl");
-        auto pVSB = pVS->GetBytecode();
+            ied = file.GetLayout();
+            bounds = file.GetBounds();
+            shared.AddBindable(Codex::Resolve<VertexBuffer>(gfx, file.GetVertexData(), file.GetVertexStride()));
+            shared.AddIndexBuffer(Codex::Resolve<IndexBuffer>(gfx, file.GetIndexData(0u), file.GetIndexFormat()));
+            shared.AddBindable(Codex::Resolve<Topology>(gfx, file.GetTopology()));
+        }
+        else
+        {
+            const IndexedTriangleList<Vertex> model = MakeMesh();
+            ied = VertexLayout<Vertex>::GetDescs();
+            bounds = AABB::FromVertices(model.m_Vertices);
+            shared.AddBindable(Codex::Resolve<VertexBuffer>(gfx, model.m_Vertices));
+            shared.AddIndexBuffer(Codex::Resolve<IndexBuffer>(gfx, model.MakeEdgeIndices()));
+            shared.AddBindable(Codex::Resolve<Topology>(gfx, PrimitiveTopology::LineList));
+        }
 
-        AddSharedBindable(std::make_unique<VertexBuffer>(gfx, model.m_Vertices));
+        // The vertex shader pushes the plane up to 1 along -z (vs.Offset)
+        bounds.min.z -= 1.f;
+        shared.SetBounds(bounds);
 
-        AddSharedBindable(std::move(pVS));
-        AddSharedBindable(std::make_unique<PixelShader>(gfx, L"shaders/PixelShader.hlsl"));
+        auto pVS = Codex::Resolve<VertexShader>(gfx, L"shaders/VertexShader.hlsl");
+        shared.AddBindable(Codex::Resolve<InputLayout>(gfx, ied, pVS->GetBytecode()));
+        shared.AddBindable(std::move(pVS));
+        shared.AddBindable(Codex::Resolve<PixelShader>(gfx, L"shaders/PixelShader.hlsl"));
 
-        AddSharedIndexBuffer(std::make_unique<IndexBuffer>(gfx, model.m_Indices));
+        // Instanced path, world matrix per instance from slot 1 (see DrawableBase::DrawInstanced)
+        std::vector<VertexElementDesc> instancedIed = ied;
+        for (const VertexElementDesc& desc : VertexLayout<InstanceVertex>::GetDescs(1u, true))
+        {
+            instancedIed.push_back(desc);
+        }
 
-        AddSharedBindable(std::make_unique<InputLayout>(gfx, ied, pVSB));
+        auto pInstancedVS = Codex::Resolve<VertexShader>(gfx, L"shaders/VertexShader.hlsl", std::vector<ShaderMacro>{ { "INSTANCED", "1" } });
+        shared.AddInstancedBindable(Codex::Resolve<InputLayout>(gfx, instancedIed, pInstancedVS->GetBytecode()));
+        shared.AddInstancedBindable(std::move(pInstancedVS));
+    });
+}
 
-        AddSharedBindable(std::make_unique<Topology>(gfx, D3D11_PRIMITIVE_TOPOLOGY_LINELIST));
-    }
-    else
+bool Box::WriteMesh(const std::string& path, bool bQuantize, bool bStrips)
+{
+    // The strips follow the generated vertex order row by row, which is already cache friendly, so those skip the
+    // optimizer (it would reorder the vertices under them). Under 64k vertices they're written as UInt16 with 0xffff
+    // as the restart index
+    const IndexedTriangleList<Vertex> model = bStrips ? Plane::MakeTesselated<Vertex>(128, 128) : MakeMesh();
+    const std::vector<unsigned int> indices = bStrips ? Plane::MakeTesselatedStripIndices(128, 128) : model.MakeEdgeIndices();
+    const PrimitiveTopology topology = bStrips ? PrimitiveTopology::TriangleStrip : PrimitiveTopology::LineList;
+    if (!bQuantize)
     {
-        SetIndexBufferFromSharedBindables();
+        return MeshFile::Write(path, model, VertexLayout<Vertex>::GetDescs(), { indices }, topology);
     }
 
-    AddBind( std::make_unique<TransformCBuffer>( gfx,*this ) );
+    // The plane is flat in z and spans [-1, 1], so x/y alone do and dequantizing is the identity: the vertex shader
+    // displaces the same positions as unquantized and there's nothing to fold into the box transforms
+    VertexQuantizer::Report report;
+    const IndexedTriangleList<PlanarVertex> quantized = VertexQuantizer::Quantize<PlanarVertex>(model, &report);
+    assert(report.dequantize._11 == 1.f && report.dequantize._41 == 0.f && report.dequantize._42 == 0.f && report.dequantize._43 == 0.f);
+
+    MeshFile::Contents contents = {};
+    contents.Vertices = { reinterpret_cast<const unsigned char*>(quantized.m_Vertices.data()), sizeof(PlanarVertex) * quantized.m_Vertices.size() };
+    contents.VertexStride = VertexLayout<PlanarVertex>::Stride;
+    contents.Layout = VertexLayout<PlanarVertex>::GetDescs();
+    contents.Topology = topology;
+    contents.Bounds = report.bounds;
+    contents.Lods = { indices };
+    return MeshFile::Write(path, contents);
 }
 
-void Box::Update(float dt) noexcept
+Box::Box(Graphics& gfx, BoxAnimation& animation, std::mt19937& rng, std::uniform_real_distribution<float>& adist,
+         std::uniform_real_distribution<float>& ddist, std::uniform_real_distribution<float>& odist,
+         std::uniform_real_distribution<float>& rdist)
+    :
+    m_Animation( animation ),
+    m_Index( animation.Add( RandomMotion( rng,adist,ddist,odist,rdist ) ) )
 {
-    roll += droll * dt;
-    pitch += dpitch * dt;
-    yaw += dyaw * dt;
-    theta += dtheta * dt;
-    phi += dphi * dt;
-    chi += dchi * dt;
+    AddBind( std::make_unique<TransformCBuffer>( gfx,*this ) );
 }
 
+void Box::Update(float dt) noexcept
+{}
+
 Math::XMMATRIX Box::GetTransformMat() const noexcept
 {
-    return
-    Math::XMMatrixScaling(10.f, 10.f, 1.f) *
-    Math::XMMatrixRotationRollPitchYaw( Math::PI/3.f,0.f,0.f ) *
-    Math::XMMatrixTranslation(0.f ,0.f, 20.f);
-    return
-        Math::XMMatrixRotationRollPitchYaw( pitch,yaw,roll ) *
-        Math::XMMatrixTranslation( r,0.0f,0.0f ) *
-        Math::XMMatrixRotationRollPitchYaw( theta,phi,chi ) *
-        Math::XMMatrixTranslation( 0.0f,0.0f,20.0f );
+    return m_Animation.GetTransform( m_Index );
 }
@@ -1,6 +1,8 @@
 ﻿#pragma once
 #include "DrawableBase.h"
+#include "BoxAnimation.h"
 #include <random>
+#include <string>
 
 /*
 *  Hey Chilli great videos.
@@ -23,27 +25,24 @@ Either way, thanks Chilli for taking the time to educate us. I have benefitted g
 class Box : public DrawableBase<Box>
 {
 public:
-    Box( Graphics& gfx,std::mt19937& rng,
+    /// @brief  Generates the plane mesh (or maps it from the MeshFile at meshPath if given) and creates the binds
+    ///         every box shares on loader. Boxes can be made while it runs, they're drawn once it's done (IsReady)
+    static std::future<void> LoadShared(Graphics& gfx, AsyncLoader& loader, const std::string& meshPath = {});
+    /// @brief  Writes the generated plane mesh to a MeshFile for LoadShared to read back, as PlanarVertex if
+    ///         bQuantize (a third of the vertex size). bStrips writes it filled as a TriangleStrip (a strip per row)
+    ///         instead of the wireframe. False if that failed
+    static bool WriteMesh(const std::string& path, bool bQuantize = false, bool bStrips = false);
+    /// @brief  Adds the box's (random) motion to animation, which owns its state and transform from then on. Only
+    ///         creates its own transform cbuffer, the rest comes from LoadShared
+    Box( Graphics& gfx,BoxAnimation& animation,std::mt19937& rng,
         std::uniform_real_distribution<float>& adist,
         std::uniform_real_distribution<float>& ddist,
         std::uniform_real_distribution<float>& odist,
         std::uniform_real_distribution<float>& rdist );
+    /// @brief  Nothing to do per box, BoxAnimation integrates every box at once
     void Update( float dt ) noexcept override;
     Math::XMMATRIX GetTransformMat() const noexcept override;
 private:
-    // positional
-    float r;
-    float roll = 0.0f;
-    float pitch = 0.0f;
-    float yaw = 0.0f;
-    float theta;
-    float phi;
-    float chi;
-    // speed (delta/s)
-    float droll;
-    float dpitch;
-    float dyaw;
-    float dtheta;
-    float dphi;
-    float dchi;
+    const BoxAnimation& m_Animation;
+    uint32_t m_Index;
 };
@@ -0,0 +1,136 @@
+﻿#include "BoxAnimation.h"
+
+#include <algorithm>
+#ifdef __AVX__
+#include <immintrin.h>
+#else
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+#ifdef __AVX__
+    constexpr size_t s_BatchSize = 8u;
+#else
+    constexpr size_t s_BatchSize = 4u;
+#endif
+    /// @brief  Boxes per job, a multiple of the batch size so no range of Integrate splits a batch
+    constexpr size_t s_Grain = 1024u;
+    static_assert(s_Grain % s_BatchSize == 0u);
+
+    /// @brief  angles[i] += speeds[i] * dT over count floats (a multiple of the batch size)
+    void IntegrateAngles(float* pAngles, const float* pSpeeds, size_t count, float dT) noexcept
+    {
+#ifdef __AVX__
+        const __m256 dt = _mm256_set1_ps(dT);
+        for (size_t i = 0; i < count; i += s_BatchSize)
+        {
+            _mm256_storeu_ps(pAngles + i, _mm256_add_ps(_mm256_loadu_ps(pAngles + i), _mm256_mul_ps(_mm256_loadu_ps(pSpeeds + i), dt)));
+        }
+#else
+        const __m128 dt = _mm_set1_ps(dT);
+        for (size_t i = 0; i < count; i += s_BatchSize)
+        {
+            _mm_storeu_ps(pAngles + i, _mm_add_ps(_mm_loadu_ps(pAngles + i), _mm_mul_ps(_mm_loadu_ps(pSpeeds + i), dt)));
+        }
+#endif
+    }
+}
+
+uint32_t BoxAnimation::Add(const Motion& motion)
+{
+    if (m_Count == m_Fields[0].size())
+    {
+        for (auto& field : m_Fields)
+        {
+            field.resize(m_Count + s_BatchSize, 0.f);
+        }
+    }
+
+    const float values[NumFields] = {
+        motion.r, motion.roll, motion.pitch, motion.yaw, motion.theta, motion.phi, motion.chi,
+        motion.droll, motion.dpitch, motion.dyaw, motion.dtheta, motion.dphi, motion.dchi };
+    for (int f = 0; f < NumFields; f++)
+    {
+        m_Fields[f][m_Count] = values[f];
+    }
+
+    b_TransformsDirty = true;
+    return static_cast<uint32_t>(m_Count++);
+}
+
+size_t BoxAnimation::GetCount() const noexcept
+{
+    return m_Count;
+}
+
+void BoxAnimation::SetAnimated(bool bAnimated) noexcept
+{
+    b_Animated = bAnimated;
+    b_TransformsDirty = true;
+}
+
+void BoxAnimation::Integrate(float dT, JobSystem& jobs)
+{
+    // Each angle only ever reads its own speed, six streaming passes and no gathers
+    jobs.ParallelFor(m_Fields[0].size(), s_Grain, [this, dT](size_t begin, size_t end)
+    {
+        const size_t count = end - begin;
+        IntegrateAngles(m_Fields[Roll].data() + begin, m_Fields[DRoll].data() + begin, count, dT);
+        IntegrateAngles(m_Fields[Pitch].data() + begin, m_Fields[DPitch].data() + begin, count, dT);
+        IntegrateAngles(m_Fields[Yaw].data() + begin, m_Fields[DYaw].data() + begin, count, dT);
+        IntegrateAngles(m_Fields[Theta].data() + begin, m_Fields[DTheta].data() + begin, count, dT);
+        IntegrateAngles(m_Fields[Phi].data() + begin, m_Fields[DPhi].data() + begin, count, dT);
+        IntegrateAngles(m_Fields[Chi].data() + begin, m_Fields[DChi].data() + begin, count, dT);
+    });
+}
+
+void BoxAnimation::ComputeTransforms(JobSystem& jobs)
+{
+    if (!b_Animated && !b_TransformsDirty)
+    {
+        return;
+    }
+    b_TransformsDirty = false;
+    m_Transforms.resize(m_Count);
+
+    if (!b_Animated)
+    {
+        Math::XMFLOAT4X4 pose;
+        Math::XMStoreFloat4x4(&pose,
+            Math::XMMatrixScaling(10.f, 10.f, 1.f) *
+            Math::XMMatrixRotationRollPitchYaw(Math::PI / 3.f, 0.f, 0.f) *
+            Math::XMMatrixTranslation(0.f, 0.f, 20.f));
+        std::fill(m_Transforms.begin(), m_Transforms.end(), pose);
+        return;
+    }
+
+    jobs.ParallelFor(m_Count, s_Grain, [this](size_t begin, size_t end)
+    {
+        const float* r = m_Fields[R].data();
+        const float* roll = m_Fields[Roll].data();
+        const float* pitch = m_Fields[Pitch].data();
+        const float* yaw = m_Fields[Yaw].data();
+        const float* theta = m_Fields[Theta].data();
+        const float* phi = m_Fields[Phi].data();
+        const float* chi = m_Fields[Chi].data();
+        for (size_t i = begin; i < end; i++)
+        {
+            Math::XMStoreFloat4x4(&m_Transforms[i],
+                Math::XMMatrixRotationRollPitchYaw(pitch[i], yaw[i], roll[i]) *
+                Math::XMMatrixTranslation(r[i], 0.0f, 0.0f) *
+                Math::XMMatrixRotationRollPitchYaw(theta[i], phi[i], chi[i]) *
+                Math::XMMatrixTranslation(0.0f, 0.0f, 20.0f));
+        }
+    });
+}
+
+Math::XMMATRIX BoxAnimation::GetTransform(uint32_t index) const noexcept
+{
+    return Math::XMLoadFloat4x4(&m_Transforms[index]);
+}
+
+const std::vector<Math::XMFLOAT4X4>& BoxAnimation::GetTransforms() const noexcept
+{
+    return m_Transforms;
+}
@@ -0,0 +1,51 @@
+﻿#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "Utility/JobSystem.h"
+#include "Utility/Maths.h"
+
+/// @brief  Animation state of every Box, stored SoA (one contiguous array per field) instead of inside each Box.
+///         Integrate advances all of them with one SIMD pass, ComputeTransforms then rebuilds the world matrices of
+///         every box into one array that Box::GetTransformMat just reads from. Both passes split the boxes into
+///         ranges run on the JobSystem, a box's state and transform only ever depend on itself.
+///         Not animated (the default) every box sits in the displaced plane pose, animated they orbit like
+///         the original box scene
+class BoxAnimation
+{
+public:
+    struct Motion
+    {
+        // positional
+        float r;
+        float roll, pitch, yaw;
+        float theta, phi, chi;
+        // speed (delta/s)
+        float droll, dpitch, dyaw;
+        float dtheta, dphi, dchi;
+    };
+
+public:
+    /// @brief  Returns the index of the box's state (and transform)
+    uint32_t Add(const Motion& motion);
+    size_t GetCount() const noexcept;
+
+    void SetAnimated(bool bAnimated) noexcept;
+    /// @brief  Advances every angle by its speed * dT
+    void Integrate(float dT, JobSystem& jobs);
+    /// @brief  Rebuilds the transforms, a no-op while not animated unless boxes got added
+    void ComputeTransforms(JobSystem& jobs);
+
+    Math::XMMATRIX GetTransform(uint32_t index) const noexcept;
+    const std::vector<Math::XMFLOAT4X4>& GetTransforms() const noexcept;
+
+private:
+    enum Field { R, Roll, Pitch, Yaw, Theta, Phi, Chi, DRoll, DPitch, DYaw, DTheta, DPhi, DChi, NumFields };
+
+    /* Padded to a whole SIMD batch so Integrate has no tail */
+    std::vector<float> m_Fields[NumFields];
+    size_t m_Count = 0u;
+    std::vector<Math::XMFLOAT4X4> m_Transforms;
+    bool b_Animated = false;
+    bool b_TransformsDirty = false;
+};
@@ -1,5 +1,8 @@
 ﻿#include "Drawable.h"
-#include "Bindable/Buffers/IndexBuffer.h"
+
+#include <cassert>
+#include <typeinfo>
+#include "Bindable/BindableCommon.h"
 
 
 void Drawable::Draw(Graphics& gfx) const noexcept(!IS_DEBUG)
@@ -14,18 +17,88 @@ void Drawable::Draw(Graphics& gfx) const noexcept(!IS_DEBUG)
     }
 
     // Call Draw
-    gfx.DrawIndexed(pIndexBuffer->GetCount());
+    gfx.DrawIndexed(GetIndexBuffer().GetCount());
+}
+
+BoundingSphere Drawable::GetViewSphere() const noexcept
+{
+    return Bounds::TransformSphere(GetLocalBounds().sphere, GetTransformMat());
+}
+
+AABB Drawable::GetViewBox() const noexcept
+{
+    return Bounds::TransformBox(GetLocalBounds().box, GetTransformMat());
+}
+
+void Drawable::Submit(RenderQueue& queue) const
+{
+    // Transform is object -> view (no separate camera yet), so the translation z is the view depth of the origin
+    const float viewDepth = Math::XMVectorGetZ(GetTransformMat().r[3]);
+    queue.Submit(queue.MakeKey(GetStateKey(queue), viewDepth), &Drawable::Execute, this, &Drawable::UploadPacket);
+}
+
+void Drawable::SubmitAt(RenderQueue& queue, size_t index) const
+{
+    const float viewDepth = Math::XMVectorGetZ(GetTransformMat().r[3]);
+    queue.SubmitAt(index, queue.MakeKey(GetStateKey(queue), viewDepth), &Drawable::Execute, this, &Drawable::UploadPacket);
+}
+
+uint64_t Drawable::GetStateKey(RenderQueue& queue) const
+{
+    if (pKeyQueue != &queue)
+    {
+        RenderQueue::StateIds ids;
+        GatherStateIds(GetStaticBinds(), ids);
+        GatherStateIds(m_Binds, ids);
+        m_StateKey = queue.MakeStateKey(ids);
+        pKeyQueue = &queue;
+    }
+    return m_StateKey;
+}
+
+void Drawable::Upload(Graphics& gfx) const
+{
+    // Shared binds are left to bind lazily, otherwise every drawable of a type would upload them again
+    for (auto& Bindable : m_Binds)
+    {
+        Bindable->Upload(gfx);
+    }
+}
+
+void Drawable::GatherStateIds(const std::vector<std::shared_ptr<Bindable>>& binds, RenderQueue::StateIds& ids) noexcept
+{
+    for (const auto& bind : binds)
+    {
+        const Bindable* pBind = bind.get();
+        if (dynamic_cast<const VertexShader*>(pBind))       ids.vertexShader = pBind->GetResourceId();
+        else if (dynamic_cast<const PixelShader*>(pBind))   ids.pixelShader = pBind->GetResourceId();
+        else if (dynamic_cast<const InputLayout*>(pBind))   ids.inputLayout = pBind->GetResourceId();
+        else if (dynamic_cast<const VertexBuffer*>(pBind))  ids.vertexBuffer = pBind->GetResourceId();
+        else if (dynamic_cast<const IndexBuffer*>(pBind))   ids.indexBuffer = pBind->GetResourceId();
+    }
+}
+
+void Drawable::Execute(Graphics& gfx, const void* pData)
+{
+    static_cast<const Drawable*>(pData)->Draw(gfx);
+}
+
+void Drawable::UploadPacket(Graphics& gfx, const void* pData)
+{
+    static_cast<const Drawable*>(pData)->Upload(gfx);
 }
 
-void Drawable::AddBind(std::unique_ptr<Bindable> bind) noexcept(!IS_DEBUG)
+void Drawable::AddBind(std::shared_ptr<Bindable> bind) noexcept(!IS_DEBUG)
 {
+    pKeyQueue = nullptr;
     assert("*MUST* use AddIndexBuffer to bind unique index buffer" && typeid(*bind) != typeid(IndexBuffer));
     m_Binds.push_back(std::move(bind));
 }
 
-void Drawable::AddIndexBuffer(std::unique_ptr<IndexBuffer> iBuffer) noexcept(!IS_DEBUG)
+void Drawable::AddIndexBuffer(std::shared_ptr<IndexBuffer> iBuffer) noexcept(!IS_DEBUG)
 {
     assert("Attempting to add index buffer a second time" && pIndexBuffer == nullptr);
+    pKeyQueue = nullptr;
     pIndexBuffer = iBuffer.get();
     m_Binds.push_back(std::move(iBuffer));
 }
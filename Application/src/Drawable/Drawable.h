@@ -1,8 +1,11 @@
 ﻿#pragma once
 
 #include <memory>
+#include <vector>
 
 #include "Graphics.h"
+#include "RenderQueue.h"
+#include "Utility/Bounds.h"
 #include "Utility/Maths.h"
 
 class Drawable
@@ -14,18 +17,45 @@ public:
     Drawable() = default;
     Drawable(const Drawable&) = delete;
     virtual Math::XMMATRIX GetTransformMat() const noexcept = 0;
+    /// @brief  Object space bounds, shared by every drawable of a DrawableBase type unless it overrides this
+    virtual const Bounds& GetLocalBounds() const noexcept = 0;
+    /// @brief  Bounding sphere in view space (transform is object -> view), what frustum culling tests
+    BoundingSphere GetViewSphere() const noexcept;
+    AABB GetViewBox() const noexcept;
     void Draw(Graphics& gfx) const noexcept(!IS_DEBUG);
+    /// @brief  Queues this drawable for the frame, sorted by its state and view depth. The queue calls Upload and
+    ///         Draw later
+    void Submit(RenderQueue& queue) const;
+    /// @brief  Same as Submit but fills packet index (see RenderQueue::Reserve), safe to call from several threads
+    void SubmitAt(RenderQueue& queue, size_t index) const;
+    /// @brief  Writes the per frame data of the drawable's own binds (see Bindable::Upload)
+    void Upload(Graphics& gfx) const;
     virtual void Update(float dT) noexcept = 0;
 
-    void AddBind(std::unique_ptr<class Bindable> bind) noexcept(!IS_DEBUG);
-    void AddIndexBuffer(std::unique_ptr<class IndexBuffer> iBuffer) noexcept(!IS_DEBUG);
+    /// @brief  Binds are shared references, so they can come straight from the Codex
+    void AddBind(std::shared_ptr<class Bindable> bind) noexcept(!IS_DEBUG);
+    void AddIndexBuffer(std::shared_ptr<class IndexBuffer> iBuffer) noexcept(!IS_DEBUG);
 
     virtual ~Drawable() = default;
 
+protected:
+    /// @brief  Fills in the ids of the shaders/layout/buffers found in binds, leaves the rest of ids as is
+    static void GatherStateIds(const std::vector<std::shared_ptr<Bindable>>& binds, RenderQueue::StateIds& ids) noexcept;
+
 private:
-    virtual const std::vector<std::unique_ptr<Bindable>>& GetStaticBinds() const noexcept = 0;
+    virtual const std::vector<std::shared_ptr<Bindable>>& GetStaticBinds() const noexcept = 0;
+    virtual const IndexBuffer& GetIndexBuffer() const noexcept { return *pIndexBuffer; }
+    static void Execute(Graphics& gfx, const void* pData);
+    static void UploadPacket(Graphics& gfx, const void* pData);
+
+    /// @brief  State bits of the sort key, looked up on first use for queue
+    uint64_t GetStateKey(RenderQueue& queue) const;
 
 private:
     const IndexBuffer* pIndexBuffer = nullptr;
-    std::vector<std::unique_ptr<Bindable>> m_Binds;
+    std::vector<std::shared_ptr<Bindable>> m_Binds;
+    /* Binds don't change after construction, so the state key only has to be made once per queue (pKeyQueue, null
+       until then). A drawable is submitted by one thread at a time so this needs no locking of its own */
+    mutable uint64_t m_StateKey = 0u;
+    mutable const RenderQueue* pKeyQueue = nullptr;
 };
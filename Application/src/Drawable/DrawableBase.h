@@ -1,45 +1,217 @@
 ﻿#pragma once
+#include <cassert>
+#include <typeinfo>
 #include "Drawable.h"
 #include "Bindable/BindableCommon.h"
+#include "Utility/AsyncLoader.h"
 
 template<typename T>
 class DrawableBase : public Drawable
 {
-protected:
-    bool IsStaticInitialized() const noexcept { return !s_Bindables.empty(); }
-    
-    void AddSharedBindable(std::unique_ptr<Bindable> bind) noexcept(!IS_DEBUG)
+public:
+    /// @brief  Draws the given drawables of this type (usually what survived culling) with a single
+    ///         DrawIndexedInstanced. Shared binds go first, then the instanced ones (instanced vertex shader + input
+    ///         layout) on top, then the world matrices of all the drawables through one instance buffer. Per drawable
+    ///         binds are skipped entirely
+    static void DrawInstanced(Graphics& gfx, const std::vector<const T*>& drawables) noexcept(!IS_DEBUG)
     {
-        assert("*MUST* use AddSharedIndexBuffer to bind shared index buffer" && typeid(*bind) != typeid(IndexBuffer));
-        s_Bindables.push_back(std::move(bind));   
+        if (drawables.empty())
+        {
+            return;
+        }
+        UploadInstances(gfx, drawables);
+        DrawUploadedInstances(gfx, drawables);
     }
-    void AddSharedIndexBuffer(std::unique_ptr<IndexBuffer> ibuf) noexcept(!IS_DEBUG)
+
+    /// @brief  Queues DrawInstanced for the frame. drawables has to stay alive until the queue executes. A batch has
+    ///         no single depth so it only sorts by state
+    static void SubmitInstanced(RenderQueue& queue, const std::vector<const T*>& drawables)
     {
-        assert("Attempting to add index buffer a second time" && pIndexBuffer == nullptr);
-        pIndexBuffer = ibuf.get();
-        s_Bindables.push_back(std::move(ibuf));
+        if (drawables.empty() || !drawables.front()->IsReady())
+        {
+            return;
+        }
+
+        const Shared& shared = GetShared(drawables);
+        RenderQueue::StateIds ids;
+        GatherStateIds(shared.m_Bindables, ids);
+        GatherStateIds(shared.m_InstancedBindables, ids);
+        queue.Submit(queue.MakeKey(ids, 0.f), &DrawableBase::ExecuteInstanced, &drawables, &DrawableBase::UploadInstanced);
     }
-    void SetIndexBufferFromSharedBindables() noexcept
+
+    /// @brief  Written by the shared load, only valid once IsReady
+    const Bounds& GetLocalBounds() const noexcept override { return pShared->m_Bounds; }
+
+    /// @brief  False while the shared binds are still loading (see LoadSharedAsync), the drawables of T must not be
+    ///         drawn or submitted until then
+    bool IsReady() const noexcept { return pShared->IsReady(); }
+
+protected:
+    /// @brief  Everything the drawables of T have in common. Each of them holds a reference, so it goes away with the
+    ///         last one and takes its binds along (freeing them unless the Codex handed them to someone else too)
+    class Shared
     {
-        assert("Attempting to set index buffer when it already exists" && pIndexBuffer == nullptr);
-        for (auto& Bindable : s_Bindables)
+        friend class DrawableBase;
+    public:
+        /// @brief  box is the object space bounds of the type's mesh (after whatever the vertex shader does to it)
+        void SetBounds(const AABB& box) noexcept
+        {
+            m_Bounds = Bounds::FromBox(box);
+        }
+        void AddBindable(std::shared_ptr<Bindable> bind) noexcept(!IS_DEBUG)
+        {
+            assert("*MUST* use AddIndexBuffer to bind shared index buffer" && typeid(*bind) != typeid(IndexBuffer));
+            m_Bindables.push_back(std::move(bind));
+        }
+        /// @brief  Only bound by DrawInstanced, overriding whatever shared bindable it replaces (e.g the vertex shader)
+        void AddInstancedBindable(std::shared_ptr<Bindable> bind) noexcept(!IS_DEBUG)
+        {
+            assert("Index buffer is shared between both paths, use AddIndexBuffer" && typeid(*bind) != typeid(IndexBuffer));
+            m_InstancedBindables.push_back(std::move(bind));
+        }
+        void AddIndexBuffer(std::shared_ptr<IndexBuffer> ibuf) noexcept(!IS_DEBUG)
+        {
+            assert("Attempting to add index buffer a second time" && pIndexBuffer == nullptr);
+            pIndexBuffer = ibuf.get();
+            m_Bindables.push_back(std::move(ibuf));
+        }
+        bool IsReady() const noexcept
         {
-            if (auto ibuf = dynamic_cast<IndexBuffer*>(Bindable.get()))
-            {
-                pIndexBuffer = ibuf;
-                return;
-            }
+            // Nothing else is touched until the load is over, the acquire makes what it wrote visible
+            return !b_Loading.load(std::memory_order_acquire) && !m_Bindables.empty();
         }
-        assert("Failed to find index buffer in static binds" && pIndexBuffer != nullptr);
+
+    private:
+        std::vector<std::shared_ptr<Bindable>> m_Bindables;
+        std::vector<std::shared_ptr<Bindable>> m_InstancedBindables;
+        const IndexBuffer* pIndexBuffer = nullptr;
+        std::unique_ptr<InstanceBuffer> pInstanceBuffer;
+        Bounds m_Bounds;
+        std::atomic<bool> b_Loading = false;
+    };
+
+    /// @brief  Joins the binds shared by the live drawables of T (or being loaded for them), or starts a new (empty) set
+    ///         if there are none
+    DrawableBase()
+        : pShared(AcquireShared())
+    {}
+
+    /// @brief  True once the shared binds were added, or are being loaded
+    bool IsStaticInitialized() const noexcept
+    {
+        return pShared->b_Loading.load(std::memory_order_acquire) || !pShared->m_Bindables.empty();
+    }
+
+    /// @brief  Runs load(Shared&) (mesh generation, shader compiles, buffer creation...) on one of loader's threads to
+    ///         fill in the shared binds, instead of in a constructor. Drawables of T made while it runs join the same
+    ///         binds and become ready once it's done, the future says when and holds whatever load threw. Backends
+    ///         create resources thread safely, binding still only happens on the frame's thread.
+    ///         Called from the frame's thread, like the constructors
+    template<class F>
+    static std::future<void> LoadSharedAsync(AsyncLoader& loader, F&& load)
+    {
+        std::shared_ptr<Shared> pState = AcquireShared();
+        assert("Shared binds are already loaded or loading" && !pState->b_Loading && pState->m_Bindables.empty());
+        pState->b_Loading.store(true, std::memory_order_relaxed);
+        return loader.Submit([pState, load = std::forward<F>(load)]() mutable
+        {
+            load(*pState);
+            pState->b_Loading.store(false, std::memory_order_release);
+        });
+    }
+
+    void SetSharedBounds(const AABB& box) noexcept
+    {
+        pShared->SetBounds(box);
+    }
+    void AddSharedBindable(std::shared_ptr<Bindable> bind) noexcept(!IS_DEBUG)
+    {
+        pShared->AddBindable(std::move(bind));
+    }
+    void AddSharedInstancedBindable(std::shared_ptr<Bindable> bind) noexcept(!IS_DEBUG)
+    {
+        pShared->AddInstancedBindable(std::move(bind));
+    }
+    void AddSharedIndexBuffer(std::shared_ptr<IndexBuffer> ibuf) noexcept(!IS_DEBUG)
+    {
+        pShared->AddIndexBuffer(std::move(ibuf));
     }
 
 private:
-    
-    const std::vector<std::unique_ptr<Bindable>>& GetStaticBinds() const noexcept override { return s_Bindables; }
+    const std::vector<std::shared_ptr<Bindable>>& GetStaticBinds() const noexcept override { return pShared->m_Bindables; }
+    /// @brief  The drawable's own index buffer if it added one, the shared one otherwise
+    const IndexBuffer& GetIndexBuffer() const noexcept override
+    {
+        return pIndexBuffer ? *pIndexBuffer : *pShared->pIndexBuffer;
+    }
+
+    /// @brief  The shared state of the live drawables of T, or a new (empty) one if there are none
+    static std::shared_ptr<Shared> AcquireShared()
+    {
+        std::shared_ptr<Shared> pState = s_pShared.lock();
+        if (!pState)
+        {
+            pState = std::make_shared<Shared>();
+            s_pShared = pState;
+        }
+        return pState;
+    }
+    static Shared& GetShared(const std::vector<const T*>& drawables) noexcept
+    {
+        return *static_cast<const DrawableBase*>(drawables.front())->pShared;
+    }
+
+    /// @brief  Gathers the world matrices into the instance buffer, which also writes the projection into the ring
+    static void UploadInstances(Graphics& gfx, const std::vector<const T*>& drawables)
+    {
+        s_InstanceTransforms.resize(drawables.size());
+        for (size_t i = 0; i < drawables.size(); i++)
+        {
+            Math::XMStoreFloat4x4(&s_InstanceTransforms[i], drawables[i]->GetTransformMat());
+        }
+
+        Shared& shared = GetShared(drawables);
+        if (!shared.pInstanceBuffer)
+        {
+            shared.pInstanceBuffer = std::make_unique<InstanceBuffer>(gfx, static_cast<unsigned int>(drawables.size()));
+        }
+        shared.pInstanceBuffer->Update(gfx, s_InstanceTransforms);
+    }
+    static void DrawUploadedInstances(Graphics& gfx, const std::vector<const T*>& drawables) noexcept(!IS_DEBUG)
+    {
+        const Shared& shared = GetShared(drawables);
+        assert("Instanced binds were never added for this drawable type" && !shared.m_InstancedBindables.empty());
+
+        for (auto& Bindable : shared.m_Bindables)
+        {
+            Bindable->Bind(gfx);
+        }
+        for (auto& Bindable : shared.m_InstancedBindables)
+        {
+            Bindable->Bind(gfx);
+        }
+        shared.pInstanceBuffer->Bind(gfx);
+
+        gfx.DrawIndexedInstanced(static_cast<const DrawableBase*>(drawables.front())->GetIndexBuffer().GetCount(), shared.pInstanceBuffer->GetCount());
+    }
+    static void ExecuteInstanced(Graphics& gfx, const void* pData)
+    {
+        DrawUploadedInstances(gfx, *static_cast<const std::vector<const T*>*>(pData));
+    }
+    static void UploadInstanced(Graphics& gfx, const void* pData)
+    {
+        UploadInstances(gfx, *static_cast<const std::vector<const T*>*>(pData));
+    }
     
 private:
-    static std::vector<std::unique_ptr<Bindable>> s_Bindables;
+    std::shared_ptr<Shared> pShared;
+    /* Only a weak reference at type level, so that a new drawable can find the shared state of the live ones */
+    static std::weak_ptr<Shared> s_pShared;
+    /* Scratch for gathering world matrices, kept around so DrawInstanced doesn't allocate every frame */
+    static std::vector<Math::XMFLOAT4X4> s_InstanceTransforms;
 };
 
 template<typename T>
-std::vector<std::unique_ptr<Bindable>> DrawableBase<T>::s_Bindables;
\ No newline at end of file
+std::weak_ptr<typename DrawableBase<T>::Shared> DrawableBase<T>::s_pShared;
+template<typename T>
+std::vector<Math::XMFLOAT4X4> DrawableBase<T>::s_InstanceTransforms;
@@ -0,0 +1,285 @@
+﻿#include "Terrain.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <utility>
+#include "DrawableBase.h"
+#include "Utility/IndexedTriangleList.h"
+#include "Utility/FrustumCuller.h"
+#include "Utility/MeshOptimizer.h"
+
+/// @brief  One chunk at one LOD. Shaders/layout are shared by all of them, the index buffer by the chunks of a level
+class Terrain::Chunk : public DrawableBase<Chunk>
+{
+public:
+    Chunk(Graphics& gfx, const Terrain& terrain, const Bounds& bounds, const std::vector<Vertex>& vertices, const IndexBuffer& lodIndices)
+        : m_Terrain(terrain), m_Bounds(bounds)
+    {
+        if (!IsStaticInitialized())
+        {
+            const std::vector<VertexElementDesc> ied = VertexLayout<Vertex>::GetDescs();
+
+            // Same shaders/layout as the boxes, the Codex hands back theirs if any are alive
+            auto pVS = Codex::Resolve<VertexShader>(gfx, L"shaders/VertexShader.hlsl");
+            AddSharedBindable(Codex::Resolve<InputLayout>(gfx, ied, pVS->GetBytecode()));
+            AddSharedBindable(std::move(pVS));
+            AddSharedBindable(Codex::Resolve<PixelShader>(gfx, L"shaders/PixelShader.hlsl"));
+            AddSharedBindable(Codex::Resolve<Topology>(gfx, PrimitiveTopology::LineList));
+        }
+
+        AddBind(std::make_unique<VertexBuffer>(gfx, vertices));
+        AddIndexBuffer(std::make_unique<IndexBuffer>(lodIndices));
+        AddBind(std::make_unique<TransformCBuffer>(gfx, *this));
+    }
+
+    void Update(float /*dT*/) noexcept override {}
+    Math::XMMATRIX GetTransformMat() const noexcept override { return m_Terrain.GetTransformMat(); }
+    const Bounds& GetLocalBounds() const noexcept override { return m_Bounds; }
+
+private:
+    const Terrain& m_Terrain;
+    const Bounds& m_Bounds;
+};
+
+namespace
+{
+    /// @brief  Grid coordinates of border vertex i of an n x n chunk, walking the border counter clockwise from (0, 0)
+    std::pair<unsigned int, unsigned int> BorderVertex(unsigned int i, unsigned int n) noexcept
+    {
+        const unsigned int t = i % n;
+        switch (i / n)
+        {
+        case 0:  return { t, 0u };
+        case 1:  return { n, t };
+        case 2:  return { n - t, n };
+        default: return { 0u, n - t };
+        }
+    }
+
+    /// @brief  Triangles of an n x n chunk over its vertex slots, (n + 1)^2 grid vertices (row major, same triangles as
+    ///         Plane::MakeTesselated) followed by the 4n skirt vertices hanging off the border
+    std::vector<unsigned int> MakeChunkTriangles(unsigned int n)
+    {
+        const unsigned int rowSize = n + 1u;
+        const unsigned int skirtBase = rowSize * rowSize;
+        std::vector<unsigned int> indices;
+        indices.reserve(size_t(n) * size_t(n) * 6u + size_t(n) * 24u);
+
+        for (unsigned int y = 0; y < n; y++)
+        {
+            for (unsigned int x = 0; x < n; x++)
+            {
+                const unsigned int i00 = y * rowSize + x;
+                const unsigned int i10 = i00 + 1u;
+                const unsigned int i01 = i00 + rowSize;
+                const unsigned int i11 = i01 + 1u;
+                indices.insert(indices.end(), { i00, i01, i10, i10, i01, i11 });
+            }
+        }
+
+        const unsigned int borderSize = 4u * n;
+        for (unsigned int i = 0; i < borderSize; i++)
+        {
+            const unsigned int next = (i + 1u) % borderSize;
+            const auto [ax, ay] = BorderVertex(i, n);
+            const auto [bx, by] = BorderVertex(next, n);
+            const unsigned int a = ay * rowSize + ax;
+            const unsigned int b = by * rowSize + bx;
+            indices.insert(indices.end(), { a, b, skirtBase + i, b, skirtBase + next, skirtBase + i });
+        }
+        return indices;
+    }
+}
+
+Terrain::Terrain(Graphics& gfx, const Desc& desc)
+    : m_Desc(desc)
+{
+    assert("LOD count out of range" && desc.numLods >= 1u && desc.numLods <= s_MaxLods);
+    assert("Chunk resolution has to halve down to every LOD" && desc.chunkResolution % (1u << (desc.numLods - 1u)) == 0u);
+    assert(desc.chunksPerSide >= 1u);
+
+    SetTransform(
+        Math::XMMatrixScaling(10.f, 10.f, 1.f) *
+        Math::XMMatrixRotationRollPitchYaw(Math::PI / 3.f, 0.f, 0.f) *
+        Math::XMMatrixTranslation(0.f, 0.f, 20.f));
+
+    const unsigned int numChunks = desc.chunksPerSide * desc.chunksPerSide;
+    const unsigned int n0 = desc.chunkResolution;
+    const float chunkSize = 2.f / float(desc.chunksPerSide);
+    const float fineStep = chunkSize / float(n0);
+
+    // Height error of every level against LOD 0, measured at the LOD 0 vertices. A coarse level is the linear
+    // interpolation of its own vertices over the same triangle split as the grid (diagonal from (1, 0) to (0, 1))
+    m_Chunks.resize(numChunks);
+    float maxError = 0.f;
+    std::vector<std::pair<float, float>> offsetRanges(numChunks);
+    std::vector<float> fine(size_t(n0 + 1u) * size_t(n0 + 1u));
+    for (unsigned int c = 0; c < numChunks; c++)
+    {
+        ChunkLods& chunk = m_Chunks[c];
+        const float x0 = -1.f + float(c % desc.chunksPerSide) * chunkSize;
+        const float y0 = -1.f + float(c / desc.chunksPerSide) * chunkSize;
+
+        float minOffset = 1.f;
+        float maxOffset = 0.f;
+        for (unsigned int j = 0; j <= n0; j++)
+        {
+            for (unsigned int i = 0; i <= n0; i++)
+            {
+                const float offset = Displacement(x0 + float(i) * fineStep, y0 + float(j) * fineStep);
+                fine[j * (n0 + 1u) + i] = offset;
+                minOffset = std::min(minOffset, offset);
+                maxOffset = std::max(maxOffset, offset);
+            }
+        }
+        const auto Fine = [&fine, n0](unsigned int i, unsigned int j) { return fine[j * (n0 + 1u) + i]; };
+
+        chunk.errors.assign(desc.numLods, 0.f);
+        for (unsigned int l = 1; l < desc.numLods; l++)
+        {
+            const unsigned int step = 1u << l;
+            const unsigned int n = n0 >> l;
+            float error = 0.f;
+            for (unsigned int j = 0; j <= n0; j++)
+            {
+                for (unsigned int i = 0; i <= n0; i++)
+                {
+                    const unsigned int ci = std::min(i / step, n - 1u);
+                    const unsigned int cj = std::min(j / step, n - 1u);
+                    const float u = float(i - ci * step) / float(step);
+                    const float v = float(j - cj * step) / float(step);
+                    const float h00 = Fine(ci * step, cj * step);
+                    const float h10 = Fine((ci + 1u) * step, cj * step);
+                    const float h01 = Fine(ci * step, (cj + 1u) * step);
+                    const float h11 = Fine((ci + 1u) * step, (cj + 1u) * step);
+                    const float coarse = u + v <= 1.f
+                        ? h00 + u * (h10 - h00) + v * (h01 - h00)
+                        : h11 + (1.f - u) * (h01 - h11) + (1.f - v) * (h10 - h11);
+                    error = std::max(error, std::abs(Fine(i, j) - coarse));
+                }
+            }
+            chunk.errors[l] = error;
+            maxError = std::max(maxError, error);
+        }
+
+        offsetRanges[c] = { minOffset, maxOffset };
+    }
+
+    // A crack is at most as wide as the coarser neighbour's error, one depth for every skirt covers any LOD pairing.
+    // Skirt vertices sit at +skirtDepth before displacement, i.e skirtDepth below the surface point they hang from
+    const float skirtDepth = maxError + 0.01f;
+    for (unsigned int c = 0; c < numChunks; c++)
+    {
+        // Surface spans z in [-maxOffset, -minOffset], the skirts reach skirtDepth below that
+        const float x0 = -1.f + float(c % desc.chunksPerSide) * chunkSize;
+        const float y0 = -1.f + float(c / desc.chunksPerSide) * chunkSize;
+        AABB box;
+        box.Grow({ x0, y0, -offsetRanges[c].second });
+        box.Grow({ x0 + chunkSize, y0 + chunkSize, -offsetRanges[c].first + skirtDepth });
+        m_Chunks[c].bounds = Bounds::FromBox(box);
+    }
+
+    // Build the levels, vertex order comes from the cache optimized template so the shared indices fit every chunk
+    for (unsigned int l = 0; l < desc.numLods; l++)
+    {
+        const unsigned int n = n0 >> l;
+        const unsigned int rowSize = n + 1u;
+        const size_t numSlots = size_t(rowSize) * rowSize + 4u * n;
+        const float step = chunkSize / float(n);
+
+        std::vector<unsigned int> triangles = MakeChunkTriangles(n);
+        MeshOptimizer::OptimizeVertexCache(triangles, numSlots);
+        const std::vector<unsigned int> remap = MeshOptimizer::MakeFetchRemap(triangles, numSlots);
+
+        const IndexedTriangleList<Vertex> lodTemplate(std::vector<Vertex>(numSlots), std::move(triangles));
+        const IndexBuffer lodIndices(gfx, lodTemplate.MakeEdgeIndices());
+        m_LodVertices.push_back(numSlots);
+        m_LodIndices.push_back(lodIndices.GetCount());
+
+        std::vector<Vertex> vertices(numSlots);
+        for (unsigned int c = 0; c < numChunks; c++)
+        {
+            const float x0 = -1.f + float(c % desc.chunksPerSide) * chunkSize;
+            const float y0 = -1.f + float(c / desc.chunksPerSide) * chunkSize;
+            for (unsigned int y = 0; y < rowSize; y++)
+            {
+                for (unsigned int x = 0; x < rowSize; x++)
+                {
+                    vertices[remap[y * rowSize + x]].pos = { x0 + float(x) * step, y0 + float(y) * step, 0.f };
+                }
+            }
+            for (unsigned int i = 0; i < 4u * n; i++)
+            {
+                const auto [x, y] = BorderVertex(i, n);
+                vertices[remap[rowSize * rowSize + i]].pos = { x0 + float(x) * step, y0 + float(y) * step, skirtDepth };
+            }
+            m_Chunks[c].lods.push_back(std::make_unique<Chunk>(gfx, *this, m_Chunks[c].bounds, vertices, lodIndices));
+        }
+    }
+}
+
+Terrain::~Terrain()
+{}
+
+void Terrain::Submit(Graphics& gfx, RenderQueue& queue)
+{
+    const Math::XMMATRIX transform = GetTransformMat();
+    // Height runs along object z, so that axis' scale is how much the transform stretches the height error
+    const float heightScale = Math::XMVectorGetX(Math::XMVector3Length(transform.r[2]));
+    // Projection [1][1] is cot(fovY / 2), which maps a view space unit at distance 1 to half the viewport height
+    const float pixelsPerUnit = Math::XMVectorGetY(gfx.GetProjectionMat().r[1]) * 0.5f * float(gfx.GetHeight());
+
+    // Transform is object -> view, so the frustum of the bare projection is the one to test against
+    const Frustum frustum = Frustum::FromMatrix(gfx.GetProjectionMat());
+
+    m_Stats = {};
+    for (const ChunkLods& chunk : m_Chunks)
+    {
+        const BoundingSphere sphere = Bounds::TransformSphere(chunk.bounds.sphere, transform);
+        if (!frustum.Intersects(sphere))
+        {
+            m_Stats.chunksCulled++;
+            continue;
+        }
+
+        // The eye is the view space origin, nearest point of the bounds is the worst case
+        const float distance = std::max(std::sqrt(Math::square(sphere.center.x) + Math::square(sphere.center.y) + Math::square(sphere.center.z)) - sphere.radius, 1e-3f);
+        const float errorToPixels = heightScale * pixelsPerUnit / distance;
+
+        unsigned int lod = 0u;
+        for (unsigned int l = m_Desc.numLods - 1u; l > 0u; l--)
+        {
+            if (chunk.errors[l] * errorToPixels <= m_Desc.maxPixelError)
+            {
+                lod = l;
+                break;
+            }
+        }
+
+        chunk.lods[lod]->Submit(queue);
+        m_Stats.chunksPerLod[lod]++;
+        m_Stats.vertices += m_LodVertices[lod];
+        m_Stats.indices += m_LodIndices[lod];
+    }
+}
+
+void Terrain::SetTransform(Math::FXMMATRIX transform) noexcept
+{
+    Math::XMStoreFloat4x4(&m_Transform, transform);
+}
+
+Math::XMMATRIX Terrain::GetTransformMat() const noexcept
+{
+    return Math::XMLoadFloat4x4(&m_Transform);
+}
+
+const Terrain::Stats& Terrain::GetLastStats() const noexcept
+{
+    return m_Stats;
+}
+
+float Terrain::Displacement(float x, float y) noexcept
+{
+    return (0.7f * std::sin(18.f * x) + 0.5f * std::sin(24.f * y) + 0.6f * std::sin(42.f * x) + 0.2f * std::sin(64.f * y) + 2.f) / 4.f;
+}
@@ -0,0 +1,77 @@
+﻿#pragma once
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "Graphics.h"
+#include "RenderQueue.h"
+#include "Utility/Bounds.h"
+
+/// @brief  The displaced plane of shaders/VertexShader.hlsl split into chunksPerSide x chunksPerSide chunks, each
+///         with numLods precomputed levels of detail (LOD 0 has chunkResolution quads per side, every level after
+///         halves it). Each frame every chunk in the frustum draws the coarsest level whose height error projects to
+///         at most maxPixelError pixels, so the vertex work follows how much of the screen the plane covers rather than its
+///         grid resolution.
+///         - Chunk borders hang a skirt (a strip dropped below the surface along the edge) as deep as the worst LOD
+///           error, which hides the cracks between neighbours drawn at different levels
+///         - Every chunk lays out a level's vertices the same way, so a level has one index buffer all chunks share
+///         - Level triangles are vertex cache optimized, then drawn as edges like Box
+class Terrain
+{
+public:
+    static constexpr unsigned int s_MaxLods = 8u;
+
+    struct Desc
+    {
+        unsigned int chunksPerSide = 4u;
+        unsigned int chunkResolution = 32u;     /* Has to stay divisible down to the last LOD */
+        unsigned int numLods = 4u;
+        float maxPixelError = 1.f;
+    };
+
+    struct Stats
+    {
+        std::array<unsigned int, s_MaxLods> chunksPerLod = {};
+        unsigned int chunksCulled = 0u;
+        size_t vertices = 0u;
+        size_t indices = 0u;
+    };
+
+public:
+    Terrain(Graphics& gfx, const Desc& desc);
+    ~Terrain();
+    Terrain(const Terrain&) = delete;
+    Terrain& operator=(const Terrain&) = delete;
+
+    /// @brief  Culls the chunks against the projection, picks a LOD for each one left and queues it
+    void Submit(Graphics& gfx, RenderQueue& queue);
+
+    void SetTransform(Math::FXMMATRIX transform) noexcept;
+    Math::XMMATRIX GetTransformMat() const noexcept;
+    /// @brief  What the last Submit queued
+    const Stats& GetLastStats() const noexcept;
+
+    /// @brief  Mirror of vs.Offset in shaders/VertexShader.hlsl, the surface sits at z = -Displacement(x, y)
+    static float Displacement(float x, float y) noexcept;
+
+private:
+    class Chunk;
+
+    struct ChunkLods
+    {
+        std::vector<std::unique_ptr<Chunk>> lods;
+        /* Max object space height error of each level against LOD 0 */
+        std::vector<float> errors;
+        /* Object space, covers the displaced surface and its skirts */
+        Bounds bounds;
+    };
+
+private:
+    Desc m_Desc;
+    std::vector<ChunkLods> m_Chunks;
+    /* Vertices/indices of a chunk at each level */
+    std::vector<size_t> m_LodVertices;
+    std::vector<size_t> m_LodIndices;
+    Math::XMFLOAT4X4 m_Transform;
+    Stats m_Stats;
+};
@@ -1,5 +1,6 @@
 ﻿#pragma once
 #include "RomanceWin.h"
+#include <atomic>
 #include <string>
 #include <vector>
 #include <wrl.h>
@@ -17,6 +18,8 @@ public:
     std::vector<std::string> GetMessages() const;
 
 private:
-    unsigned long long next = 0u;
+    /* Resources also get created on loader threads, their messages can end up in each other's reports but the index
+       itself has to be safe to share */
+    std::atomic<unsigned long long> next = 0u;
     Microsoft::WRL::ComPtr<IDXGIInfoQueue> pDxgiInfoQueue = nullptr;
 };
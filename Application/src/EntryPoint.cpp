@@ -1,9 +1,10 @@
 
 
 #include "App.h"
-#include "Window.h"
 #include "Log.h"
 
+#ifdef _WIN32
+#include "Window.h"
 
 /// <summary>
 /// For a "Windows" application, the default entry point is WinMain, NOT Main
@@ -33,4 +34,358 @@ int WINAPI WinMain(
 		MessageBox(nullptr, "No details available", "Unkown Exception", MB_OK | MB_ICONEXCLAMATION);
 	}
 	return -1;
-}
\ No newline at end of file
+}
+#else
+#include <charconv>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include "Backend/NullBackend.h"
+#include "Backend/SoftwareBackend.h"
+#include "Bindable/Buffers/VertexBuffer.h"
+#include "Bindable/Codex.h"
+#include "Drawable/Box.h"
+#include "Utility/MeshFile.h"
+#include "Utility/MeshImporter.h"
+#include "Utility/MeshOptimizer.h"
+#include "Utility/ShapesCommon.h"
+#include "Utility/VertexQuantizer.h"
+
+namespace
+{
+	constexpr const char* s_Usage =
+		"Usage: Application [frameCount] [--software [image.ppm]] [--boxes N] [--no-instancing] [--no-state-cache] [--mesh-report]\n"
+		"                   [--terrain [maxPixelError]] [--flat-cull] [--pick x y] [--animate] [--threads N] [--stream]\n"
+		"                   [--mesh file] [--quantize] [--strips] [--write-mesh file] [--import model.obj|model.glb file]\n";
+
+	/// @brief  Parses all of text as a T, false if it isn't one (or is out of range) instead of throwing like stoul
+	template<class T>
+	bool ParseNumber(const char* text, T& out)
+	{
+		const char* pEnd = text + std::char_traits<char>::length(text);
+		const auto [ptr, ec] = std::from_chars(text, pEnd, out);
+		return ec == std::errc{} && ptr == pEnd && ptr != text;
+	}
+
+	/// @brief  Vertex fetch bytes quantizing mesh to Q saves, and what it costs in precision
+	template<class Q, class V>
+	void PrintQuantizeReport(const char* name, const IndexedTriangleList<V>& mesh)
+	{
+		VertexQuantizer::Report report;
+		VertexQuantizer::Quantize<Q>(mesh, &report);
+		std::cout << name << ": " << sizeof(V) << " -> " << sizeof(Q) << " bytes/vertex, " << mesh.m_Vertices.size() * (sizeof(V) - sizeof(Q))
+			<< " bytes saved, max position error " << report.maxPositionError;
+		if constexpr (VertexHasNormal<V>)
+		{
+			std::cout << ", max normal error " << Math::XMConvertToDegrees(report.maxNormalError) << " deg";
+		}
+		if constexpr (VertexHasTexcoord<V>)
+		{
+			std::cout << ", max texcoord error " << report.maxTexcoordError;
+		}
+		std::cout << "\n";
+	}
+
+	/// @brief  Runs the mesh optimizer over the generated shapes and prints post transform cache stats before/after, then
+	///         what quantizing them saves
+	void PrintMeshReport()
+	{
+		const auto Report = [](const char* name, IndexedTriangleList<Vertex> mesh)
+		{
+			const auto report = MeshOptimizer::Optimize(mesh);
+			std::cout << name << ": ACMR " << report.before.acmr << " -> " << report.after.acmr
+				<< ", ATVR " << report.before.atvr << " -> " << report.after.atvr
+				<< ", overfetch " << report.before.overfetch << " -> " << report.after.overfetch << "\n";
+		};
+		Report("Plane 128x128", Plane::MakeTesselated<Vertex>(128, 128));
+		Report("Cube", Cube::Make<Vertex>());
+		Report("Sphere", Sphere::Make<Vertex>());
+		Report("Cone", Cone::Make<Vertex>());
+		PrintQuantizeReport<PlanarVertex>("Plane 128x128 as PlanarVertex", Plane::MakeTesselated<Vertex>(128, 128));
+		PrintQuantizeReport<QuantizedVertex>("Sphere as QuantizedVertex", Sphere::Make<Vertex>());
+		PrintQuantizeReport<QuantizedLitVertex>("Lit sphere as QuantizedLitVertex", Sphere::Make<LitVertex>());
+		std::cout.flush();
+	}
+
+	/// @brief  Imports an OBJ/glb and writes it as a mesh file the boxes can draw (wireframe, like Box::WriteMesh)
+	bool ImportMesh(const std::string& inPath, const std::string& outPath, unsigned int nThreads)
+	{
+		JobSystem jobs(nThreads);
+		OdaTimer timer;
+		const IndexedTriangleList<Vertex> model = MeshImporter::Import<Vertex>(inPath, jobs);
+		std::cout << "Imported " << inPath << " in " << timer.Peek() * 1000.f << "ms: " << model.m_Vertices.size() << " vertices, "
+			<< model.m_Indices.size() / 3u << " triangles" << std::endl;
+		return MeshFile::Write(outPath, model, VertexLayout<Vertex>::GetDescs(), { model.MakeEdgeIndices() }, PrimitiveTopology::LineList);
+	}
+
+	void PrintSceneStats(App& app, const std::optional<std::pair<int, int>>& pick)
+	{
+		if (pick)
+		{
+			const auto picked = app.Pick(pick->first, pick->second);
+			std::cout << "Picked at (" << pick->first << ", " << pick->second << "): ";
+			if (picked)
+			{
+				std::cout << "box " << *picked << "\n";
+			}
+			else
+			{
+				std::cout << "nothing\n";
+			}
+		}
+		std::cout << "[Last Frame] boxes visible: " << app.GetVisibleBoxCount() << ", BVH nodes visited: " << app.GetCullNodeCount() << std::endl;
+		std::cout << "[Resources] live bindables: " << Codex::GetLiveCount() << ", " << Codex::GetLiveMemory() << " bytes" << std::endl;
+		const Terrain* pTerrain = app.GetTerrain();
+		if (!pTerrain)
+		{
+			return;
+		}
+		const auto& stats = pTerrain->GetLastStats();
+		std::cout << "[Last Frame] terrain chunks per LOD:";
+		for (const unsigned int chunks : stats.chunksPerLod)
+		{
+			std::cout << " " << chunks;
+		}
+		std::cout << ", culled: " << stats.chunksCulled << ", vertices: " << stats.vertices << ", indices: " << stats.indices << std::endl;
+	}
+}
+
+/// <summary>
+/// Headless entry point, runs the frame loop against the NullBackend so the renderer core can be exercised (and timed)
+/// on machines with no window system or GPU.
+/// Usage: Application [frameCount] [--software [image.ppm]] [--boxes N] [--no-instancing] [--no-state-cache] [--mesh-report]
+///                    [--terrain [maxPixelError]] [--flat-cull] [--pick x y] [--animate] [--threads N] [--stream]
+///                    [--mesh file] [--quantize] [--strips] [--write-mesh file] [--import model.obj|model.glb file]
+/// --software rasterizes on the CPU instead and optionally dumps the last frame as the reference image
+/// --terrain adds the chunked LOD plane, maxPixelError is the screen space error its LOD selection allows
+/// --animate makes the boxes orbit instead of all sitting in the displaced plane pose
+/// --flat-cull tests every box against the frustum instead of walking the BVH, --pick prints the box under a pixel
+/// --threads sets how many threads the per frame box work runs on (default every hardware thread)
+/// --stream starts timing frames right away while the scene is still loading, instead of waiting for it first
+/// --mesh-report prints what the mesh optimizer and quantizer do to the generated shapes and exits
+/// --write-mesh saves the generated box mesh as a mesh file and exits (--quantize before it stores it as
+/// PlanarVertex, --strips as a filled triangle strip instead of the wireframe), --mesh draws the boxes from one
+/// --import converts an OBJ or binary glTF model into a mesh file --mesh can draw and exits (put --threads before it)
+/// </summary>
+int main(int argc, char** argv)
+{
+	// The frame count is optional, only a leading number is one
+	unsigned int nFrames = 1000u;
+	int firstFlag = 1;
+	if (argc > 1 && ParseNumber(argv[1], nFrames))
+	{
+		firstFlag = 2;
+	}
+	bool bSoftware = false;
+	std::string imagePath;
+	unsigned int nBoxes = 1u;
+	bool bInstanced = true;
+	bool bStateCache = true;
+	std::optional<Terrain::Desc> terrain;
+	bool bFlatCulling = false;
+	bool bAnimated = false;
+	std::optional<std::pair<int, int>> pick;
+	unsigned int nThreads = 0u;
+	bool bStream = false;
+	std::string boxMesh;
+	bool bQuantize = false;
+	bool bStrips = false;
+	const auto BadArgument = [](const std::string& what)
+	{
+		std::cerr << what << "\n" << s_Usage;
+		return -1;
+	};
+	for (int i = firstFlag; i < argc; i++)
+	{
+		const std::string arg = argv[i];
+		// Flags that take values: missing or malformed ones get reported instead of read past argc
+		const bool bHasValue = i + 1 < argc;
+		if (arg == "--software")
+		{
+			bSoftware = true;
+			if (i + 1 < argc && std::string(argv[i + 1]).rfind("--", 0) != 0)
+			{
+				imagePath = argv[++i];
+			}
+		}
+		else if (arg == "--boxes")
+		{
+			if (!bHasValue || !ParseNumber(argv[++i], nBoxes))
+			{
+				return BadArgument("--boxes needs a count");
+			}
+		}
+		else if (arg == "--no-instancing")
+		{
+			bInstanced = false;
+		}
+		else if (arg == "--no-state-cache")
+		{
+			bStateCache = false;
+		}
+		else if (arg == "--terrain")
+		{
+			terrain = Terrain::Desc{};
+			if (bHasValue && std::string(argv[i + 1]).rfind("--", 0) != 0 && !ParseNumber(argv[++i], terrain->maxPixelError))
+			{
+				return BadArgument("--terrain maxPixelError has to be a number");
+			}
+		}
+		else if (arg == "--animate")
+		{
+			bAnimated = true;
+		}
+		else if (arg == "--flat-cull")
+		{
+			bFlatCulling = true;
+		}
+		else if (arg == "--stream")
+		{
+			bStream = true;
+		}
+		else if (arg == "--threads")
+		{
+			if (!bHasValue || !ParseNumber(argv[++i], nThreads))
+			{
+				return BadArgument("--threads needs a count");
+			}
+		}
+		else if (arg == "--pick")
+		{
+			std::pair<int, int> pixel;
+			if (i + 2 >= argc || !ParseNumber(argv[i + 1], pixel.first) || !ParseNumber(argv[i + 2], pixel.second))
+			{
+				return BadArgument("--pick needs x and y");
+			}
+			pick = pixel;
+			i += 2;
+		}
+		else if (arg == "--mesh")
+		{
+			if (!bHasValue)
+			{
+				return BadArgument("--mesh needs a file");
+			}
+			boxMesh = argv[++i];
+		}
+		else if (arg == "--quantize")
+		{
+			bQuantize = true;
+		}
+		else if (arg == "--strips")
+		{
+			bStrips = true;
+		}
+		else if (arg == "--write-mesh")
+		{
+			if (!bHasValue)
+			{
+				return BadArgument("--write-mesh needs a file");
+			}
+			const std::string path = argv[++i];
+			if (!Box::WriteMesh(path, bQuantize, bStrips))
+			{
+				std::cerr << "Failed to write " << path << std::endl;
+				return -1;
+			}
+			return 0;
+		}
+		else if (arg == "--import")
+		{
+			if (i + 2 >= argc)
+			{
+				return BadArgument("--import needs a model and an output file");
+			}
+			const std::string inPath = argv[i + 1];
+			const std::string outPath = argv[i + 2];
+			try
+			{
+				if (!ImportMesh(inPath, outPath, nThreads))
+				{
+					std::cerr << "Failed to write " << outPath << std::endl;
+					return -1;
+				}
+			}
+			catch (const std::exception& e)
+			{
+				std::cerr << e.what() << std::endl;
+				return -1;
+			}
+			return 0;
+		}
+		else if (arg == "--mesh-report")
+		{
+			PrintMeshReport();
+			return 0;
+		}
+		else
+		{
+			return BadArgument("Unknown argument " + arg);
+		}
+	}
+
+	try
+	{
+		if (bSoftware)
+		{
+			auto backend = std::make_unique<SoftwareBackend>(800u, 600u);
+			const SoftwareBackend& software = *backend;
+			App app{std::make_unique<Graphics>(std::move(backend)), nBoxes, bInstanced, terrain, boxMesh};
+			app.SetFlatCulling(bFlatCulling);
+			app.SetAnimated(bAnimated);
+			app.SetThreadCount(nThreads);
+			if (!bStream)
+			{
+				app.WaitForResources();
+			}
+
+			OdaTimer timer;
+			app.RunFrames(nFrames);
+			const float elapsed = timer.Peek();
+
+			std::cout << nFrames << " frames in " << elapsed * 1000.f << "ms (" << elapsed * 1000.f / float(nFrames) << "ms/frame, software)" << std::endl;
+			PrintSceneStats(app, pick);
+			if (!imagePath.empty() && !software.SaveImage(imagePath))
+			{
+				std::cerr << "Failed to write " << imagePath << std::endl;
+				return -1;
+			}
+			return 0;
+		}
+
+		auto backend = std::make_unique<NullBackend>(800u, 600u);
+		const NullBackend& stats = *backend;
+		auto gfx = std::make_unique<Graphics>(std::move(backend));
+		Graphics& graphics = *gfx;
+		graphics.SetStateCacheEnabled(bStateCache);
+		App app{std::move(gfx), nBoxes, bInstanced, terrain, boxMesh};
+		app.SetFlatCulling(bFlatCulling);
+		app.SetAnimated(bAnimated);
+		app.SetThreadCount(nThreads);
+		if (!bStream)
+		{
+			app.WaitForResources();
+		}
+
+		OdaTimer timer;
+		app.RunFrames(nFrames);
+		const float elapsed = timer.Peek();
+
+		const auto& frame = stats.GetLastFrameStats();
+		std::cout << nFrames << " frames in " << elapsed * 1000.f << "ms (" << elapsed * 1000.f / float(nFrames) << "ms/frame)\n"
+			<< "[Last Frame] draws: " << frame.drawCalls << ", instances: " << frame.instances << ", indices: " << frame.indices
+			<< ", state changes: " << frame.stateChanges << ", bytes uploaded: " << frame.bytesUploaded << "\n"
+			<< "[Last Frame] binds issued: " << graphics.GetBindStats().issued << ", skipped: " << graphics.GetBindStats().skipped << "\n"
+			<< "[Last Frame] constant ring: " << graphics.GetConstantStats().bytesUsed << " bytes used (" << graphics.GetConstantStats().bytesRequested
+			<< " written) in " << graphics.GetConstantStats().allocations << " allocations, " << graphics.GetConstantStats().maps << " maps, "
+			<< graphics.GetConstantStats().grows << " grows" << std::endl;
+		PrintSceneStats(app, pick);
+		return 0;
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << e.what() << std::endl;
+	}
+	return -1;
+}
+#endif
@@ -1,23 +1,13 @@
 ﻿#include "Graphics.h"
 
+#include <cassert>
+
+#ifdef _WIN32
 #include <sstream>
-#include <dxgitype.h>
-#include <winerror.h>
-#include <d3dcompiler.h>
-#include <dxgi.h>
-#include <DirectXMath.h>
 #include "DxgiMessageMap.h"
-#include "Window.h"
 #include "Errors/ErrorUtilities.h"
-#include "Errors/GraphicsErrors.h"
-
-// namespace for our com ptrs
-namespace wrl = Microsoft::WRL;
-
-// Specify linking to d3d11 library (here instead of project settings)
-#pragma comment(lib, "d3d11.lib")
-#pragma comment(lib, "d3dcompiler.lib")
-#pragma comment(lib, "DXGI.lib")
+#include "Backend/D3D11Backend.h"
+#include "Backend/SoftwareBackend.h"
 
 /*--------------------------------------------------------------------------------------------------------------
 * Exception Class
@@ -41,7 +31,7 @@ Graphics::HrException::HrException(int line, const char* file, HRESULT hr, std::
     }
 }
 
-char const* Graphics::HrException::what() const
+char const* Graphics::HrException::what() const noexcept
 {
     std::ostringstream oss;
     oss << GetType() << std::endl
@@ -98,7 +88,7 @@ Graphics::InfoException::InfoException(int line, const char* file, std::vector<s
     }
 }
 
-char const* Graphics::InfoException::what() const
+char const* Graphics::InfoException::what() const noexcept
 {
     std::ostringstream oss;
     oss << GetType() << std::endl
@@ -123,146 +113,83 @@ const char* Graphics::DeviceRemovedException::GetType() const noexcept
     return "Romance Exception [DEVICE REMOVED] (DXGI_ERROR_DEVICE_REMOVED)";
 }
 
+#endif
+
 /*--------------------------------------------------------------------------------------------------------------
 * Graphics Object
 *--------------------------------------------------------------------------------------------------------------*/
 
+#ifdef _WIN32
+namespace
+{
+    /// @brief  D3D11 if we can get a device, otherwise fall back to rasterizing on the CPU so we still get a picture
+    std::unique_ptr<RenderBackend> CreateWindowBackend(HWND hWnd)
+    {
+        try
+        {
+            return std::make_unique<D3D11Backend>(hWnd);
+        }
+        catch (const Graphics::HrException&)
+        {
+            return std::make_unique<SoftwareWindowBackend>(hWnd);
+        }
+    }
+}
+
 Graphics::Graphics(HWND hWnd)
+    : Graphics(CreateWindowBackend(hWnd))
+{}
+#endif
+
+Graphics::Graphics(std::unique_ptr<RenderBackend> backend)
+    : pBackend(std::make_unique<StateCache>(std::move(backend))),
+    pConstantRing(std::make_shared<ConstantRing>(*pBackend))
+{}
+
+Graphics::Graphics(const Graphics& immediate, std::unique_ptr<CommandList> commandList)
+    : pConstantRing(immediate.pConstantRing), pCommandList(commandList.get()), pImmediate(&immediate),
+    m_ProjectionMat(immediate.m_ProjectionMat)
 {
-    // Set up configuration struct for our swap chain
-    DXGI_SWAP_CHAIN_DESC sd = {};
-    sd.BufferDesc.Width = 0;                                                /* Buffer Width, 0 to default to window */
-    sd.BufferDesc.Height = 0;                                               /* Buffer Height, 0 to default to window */
-    sd.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;                  /* Buffer Format, pixel layout (RGBA, 16) */
-    sd.BufferDesc.RefreshRate.Numerator = 0;                                /* Default refresh rate values for buffer front/back swap */
-    sd.BufferDesc.RefreshRate.Denominator = 0;
-    sd.BufferDesc.Scaling = DXGI_MODE_SCALING_UNSPECIFIED;                  /* Scaling method, none since we default to the window */
-    sd.BufferDesc.ScanlineOrdering = DXGI_MODE_SCANLINE_ORDER_UNSPECIFIED;  /* Scaline order, useful if display is interlaced */
-    sd.SampleDesc.Count = 1;                                                /* AntiAliasing, 1 sample with 0 quality meaning no AA */
-    sd.SampleDesc.Quality = 0;                                              /* AA quality 0, disabled */
-    sd.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;                       /* Buffer usage, to render target output */
-    sd.BufferCount = 2;                                                     /* = 1 means double buffering, front buffer and back buffer (set to 2 because using Flip for swap effect and it said i had to) */
-    sd.OutputWindow = hWnd;                                                 /* Window handle to draw on */
-    sd.Windowed = TRUE;
-    sd.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;                          /* How to handle front buffer after presenting a surface, we specify to discard it after */
-    sd.Flags = 0;
-
-    UINT swapCreateFlags = 0u;
-    
-#ifndef NDEBUG 
-    swapCreateFlags |= D3D11_CREATE_DEVICE_DEBUG;
-#endif 
-    
-    // Create the device now and swap chain
-    GFX_THROW_INFO(D3D11CreateDeviceAndSwapChain(
-        nullptr,                    /* Graphics adapter, setting to null lets it choose it for us */
-        D3D_DRIVER_TYPE_HARDWARE,   /* Driver type, whether software acceleration or hardware. Hardware for us */
-        nullptr,                    /* Must be null if DriverType is not software (its hardware for us). Handle to binary to our graphics driver to use */
-        swapCreateFlags,            /* Various creation flags, here we specify to create the device on the debug layer so we can retrieve detailed debug outputs */
-        nullptr,                    /* Feature level to support (D3D9, 10, 11, etc..), null results in a default feature level (see docs) */
-        0,                          /* Number of feature levels being used, guessing if the above is null, it'll auto this */
-        D3D11_SDK_VERSION,          /* SDK Version, self explanatory */
-        &sd,                        /* Configuration struct for our swap chain */
-        &pSwapChain,                /* Pointer to our swap chain, to be filled out upon creation */
-        &pDevice,                   /* Pointer to our ID3D11 device, to be filled out upon creation */
-        nullptr,                    /* Out Pointer, would fill out with the feature level actually secured */
-        &pContext                   /* Pointer to our device context, to be filled out upon creation */
-        ));
-
-
-    // Gain access to texture subresource in swap chain (back buffer)
-    //wrl::ComPtr<ID3D11Resource> pBackBuffer = nullptr;
-    // Similar to QueryInterface from COM in terms of inputs, except we're querying a resource on the interface
-    GFX_THROW_INFO(pSwapChain->GetBuffer(
-        0,                             /* Index of buffer we wanna get, 0 gives us the back buffer*/
-        UUID(ID3D11Resource),          /* UUID thing of COM interface, a D3D11 resource in our case */
-        (&pBackBuffer)                 /* PP to our resource to be filled out */
-        ));
-
-    // Create a reference to the render target view to access and modify later
-    GFX_THROW_INFO(pDevice->CreateRenderTargetView(
-        pBackBuffer.Get(),      /* Buffer in which to receive the render target from */
-        nullptr,                /* Config struct to specify how we wanna receive the RTV, default it */
-        &pTarget                /* ID3D11 Target to be filled out */
-        ));
-
-    // Create a depth stencil state
-    D3D11_DEPTH_STENCIL_DESC dsDesc = {};
-    dsDesc.DepthEnable = TRUE;
-    dsDesc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ALL;
-    dsDesc.DepthFunc = D3D11_COMPARISON_LESS;
-
-    wrl::ComPtr<ID3D11DepthStencilState> pDSState;
-    GFX_THROW_INFO(pDevice->CreateDepthStencilState(&dsDesc, &pDSState));
-
-    // Set depth stencil state (Output merger, discards pixels before putting it into the frame buffer)
-    pContext->OMSetDepthStencilState(pDSState.Get(), 1u);
-    
-    // Create a depth stencil texture
-    D3D11_TEXTURE2D_DESC dtDesc = {};
-    dtDesc.Format = DXGI_FORMAT_D32_FLOAT; // D32 is specific for depth values
-    dtDesc.Width = 800u; // Matching viewport
-    dtDesc.Height = 600u;
-    dtDesc.MipLevels = 1u; // no mipmapping
-    dtDesc.ArraySize = 1u; // no mipmapping
-    dtDesc.SampleDesc.Count = 1u; // no AA
-    dtDesc.SampleDesc.Quality = 0u; // no AA
-    dtDesc.Usage = D3D11_USAGE_DEFAULT;
-    dtDesc.BindFlags = D3D11_BIND_DEPTH_STENCIL;
-    
-    
-    // Depth generated every frame so no need to store its data
-    GFX_THROW_INFO(pDevice->CreateTexture2D(&dtDesc, nullptr, &pDSTexture));
-    
-    // Create depth stencil view
-    D3D11_DEPTH_STENCIL_VIEW_DESC dsvDesc = {};
-    dsvDesc.Format = DXGI_FORMAT_D32_FLOAT;
-    dsvDesc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2D;
-    dsvDesc.Texture2D.MipSlice = 0u;
-
-    GFX_THROW_INFO(pDevice->CreateDepthStencilView(pDSTexture.Get(), &dsvDesc, &pDSV));
-
-    // Bind depth stencil view to the pipeline, output merger for same reason mentioned above
-    pContext->OMSetRenderTargets(1u, pTarget.GetAddressOf(), pDSV.Get());
-
-    // Configure viewport
-    m_ViewPort = {};
-    m_ViewPort.Width = 800;
-    m_ViewPort.Height = 600;
-    m_ViewPort.MinDepth = 0;
-    m_ViewPort.MaxDepth = 1;
-    m_ViewPort.TopLeftX = 0;
-    m_ViewPort.TopLeftY = 0;
-    pContext->RSSetViewports(1u, &m_ViewPort);
-
-    // Create window associaton
-    //wrl::ComPtr<IDXGIFactory> pFactory;
-    //CreateDXGIFactory(__uuidof(IDXGIFactory), (&pFactory) );
-    //pFactory->MakeWindowAssociation(hWnd, 0u);
+    pBackend = std::make_unique<StateCache>(std::move(commandList));
+    pBackend->SetEnabled(immediate.pBackend->IsEnabled());
 }
 
 void Graphics::SwapBuffer()
 {
-#ifndef NDEBUG
-    m_InfoManager.Set(); // To only get latest debug messages
-#endif 
-    GFX_DEVICE_REMOVED_EXCEPT(pSwapChain->Present(1, 0u))
+    assert("Deferred Graphics can't present, execute it on the immediate one" && !IsDeferred());
+    pConstantRing->EndFrame();
+    pBackend->Present();
 }
 
 void Graphics::ClearBuffer(float r, float g, float b) noexcept
 {
-    const float Color[] = {r, g, b, 1.f};
-    pContext->ClearRenderTargetView(pTarget.Get(), Color);
-    // Clear depth buffer
-    pContext->ClearDepthStencilView(pDSV.Get(), D3D11_CLEAR_DEPTH, 1.f, 0u);
+    pBackend->Clear(r, g, b);
+}
+
+void Graphics::DrawIndexed(unsigned int count) noexcept(!IS_DEBUG)
+{
+    // Deferred draws only run once executed, ExecuteDeferred unmaps then
+    if (!IsDeferred())
+    {
+        pConstantRing->Unmap();
+    }
+    pBackend->BindRenderTarget();
+    pBackend->DrawIndexed(count);
 }
 
-void Graphics::DrawIndexed(UINT count) noexcept(!IS_DEBUG)
+void Graphics::DrawIndexedInstanced(unsigned int count, unsigned int instanceCount) noexcept(!IS_DEBUG)
 {
-    // Bind render target (Output merger)
-    pContext->OMSetRenderTargets(1u, pTarget.GetAddressOf(), pDSV.Get());
-    pContext->DrawIndexed(count, 0u, 0u);
-    //GFX_THROW_INFO_ONLY(pContext->DrawIndexed(count, 0u, 0u));
+    if (!IsDeferred())
+    {
+        pConstantRing->Unmap();
+    }
+    pBackend->BindRenderTarget();
+    pBackend->DrawIndexedInstanced(count, instanceCount);
+}
+
+void Graphics::PrecompileShaders(const std::vector<ShaderDesc>& shaders)
+{
+    pBackend->PrecompileShaders(shaders);
 }
 
 void Graphics::SetProjectionMat(Math::FXMMATRIX projectionMat) noexcept
@@ -272,74 +199,59 @@ void Graphics::SetProjectionMat(Math::FXMMATRIX projectionMat) noexcept
 
 Math::FXMMATRIX Graphics::GetProjectionMat() const noexcept
 {
-    return m_ProjectionMat;
+    return pImmediate ? pImmediate->m_ProjectionMat : m_ProjectionMat;
 }
 
 void Graphics::OnViewPortUpdate(float width, float height) noexcept(!IS_DEBUG)
 {
     SetProjectionMat( Math::XMMatrixPerspectiveLH( 1.0f,height / width,0.5f,40.0f ) );
 
-    m_ViewPort.Width = width;
-    m_ViewPort.Height = height;
-
-    // Clear existing references to back buffer
-    ID3D11RenderTargetView* nullViews [] = { nullptr };
-    pContext->OMSetRenderTargets(ARRAYSIZE(nullViews), nullViews, nullptr);
-    pTarget.Reset();
-    pDSV.Reset();
-    pContext->Flush();
-    
-    // Resize existing swapchain
-    pSwapChain->ResizeBuffers(2u, UINT(width), UINT(height), DXGI_FORMAT_R8G8B8A8_UNORM, 0u);
-    
-    // Get the new backbuffer texture to use as a render target
-    GFX_THROW_INFO(pSwapChain->GetBuffer(0, UUID(ID3D11Resource), (&pBackBuffer)));
-
-    GFX_THROW_INFO(pDevice->CreateRenderTargetView(pBackBuffer.Get(), nullptr, &pTarget));
-
-    // Create Depth/Stencil buffer and create the Depth Stencil View
-    {
-        D3D11_TEXTURE2D_DESC dtDesc = {};
-        dtDesc.Format = DXGI_FORMAT_D32_FLOAT; // D32 is specific for depth values
-        dtDesc.Width = UINT(width); // Matching viewport
-        dtDesc.Height = UINT(height);
-        dtDesc.MipLevels = 1u; // no mipmapping
-        dtDesc.ArraySize = 1u; // no mipmapping
-        dtDesc.SampleDesc.Count = 1u; // no AA
-        dtDesc.SampleDesc.Quality = 0u; // no AA
-        dtDesc.Usage = D3D11_USAGE_DEFAULT;
-        dtDesc.BindFlags = D3D11_BIND_DEPTH_STENCIL;
-
-        pDevice->CreateTexture2D(&dtDesc, nullptr, &pDSTexture);
-        
-        // Create depth stencil view
-        D3D11_DEPTH_STENCIL_VIEW_DESC dsvDesc = {};
-        dsvDesc.Format = DXGI_FORMAT_D32_FLOAT;
-        dsvDesc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2D;
-        dsvDesc.Texture2D.MipSlice = 0u;
-
-        GFX_THROW_INFO(pDevice->CreateDepthStencilView(pDSTexture.Get(), &dsvDesc, &pDSV));
-    }
+    pBackend->Resize(static_cast<unsigned int>(width), static_cast<unsigned int>(height));
+}
 
-    // Reset viewport to proper size
-    pContext->RSSetViewports(1, &m_ViewPort);
-
-    // Set render target view/dsv for rednering
-    pContext->OMSetRenderTargets(1, pTarget.GetAddressOf(), pDSV.Get());
-    
-    return;
-    /*
-    pSwapChain->ResizeBuffers(2u, m_ViewPort.Width, m_ViewPort.Height, DXGI_FORMAT_R8G8B8A8_UNORM, 0u);
-
-    DXGI_MODE_DESC spDesc = {};
-    spDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-    spDesc.Width = UINT(m_ViewPort.Width);
-    spDesc.Height = UINT(m_ViewPort.Height);
-    spDesc.RefreshRate.Numerator = 0;
-    spDesc.RefreshRate.Denominator = 0;
-    spDesc.ScanlineOrdering = DXGI_MODE_SCANLINE_ORDER_UNSPECIFIED;
-
-    pSwapChain->ResizeTarget(&spDesc);
-    
-    pContext->RSSetViewports(1u, &m_ViewPort);*/
+unsigned int Graphics::GetWidth() const noexcept
+{
+    return pBackend->GetWidth();
+}
+
+unsigned int Graphics::GetHeight() const noexcept
+{
+    return pBackend->GetHeight();
+}
+
+const StateCache::BindStats& Graphics::GetBindStats() const noexcept
+{
+    return pBackend->GetLastFrameStats();
+}
+
+void Graphics::SetStateCacheEnabled(bool bEnabled) noexcept
+{
+    pBackend->SetEnabled(bEnabled);
+    pBackend->Invalidate();
+}
+
+const ConstantRing::FrameStats& Graphics::GetConstantStats() const noexcept
+{
+    return pConstantRing->GetLastFrameStats();
+}
+
+std::unique_ptr<Graphics> Graphics::CreateDeferred()
+{
+    assert("Deferred Graphics are made from the immediate one" && !IsDeferred());
+    return std::unique_ptr<Graphics>(new Graphics(*this, pBackend->CreateCommandList()));
+}
+
+void Graphics::ExecuteDeferred(Graphics& deferred)
+{
+    assert("Only deferred Graphics made from this one can be executed" && deferred.pImmediate == this);
+    pConstantRing->Unmap();
+    pBackend->ExecuteCommandList(*deferred.pCommandList);
+    pBackend->MergeStats(*deferred.pBackend);
+    // The list starts over from nothing bound
+    deferred.pBackend->Invalidate();
+}
+
+bool Graphics::IsDeferred() const noexcept
+{
+    return pCommandList != nullptr;
 }
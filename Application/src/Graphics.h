@@ -1,28 +1,34 @@
 ﻿#pragma once
 
+#include <memory>
+#ifdef _WIN32
 #include "RomanceWin.h" // Include first for all our switch cases since d3d11 also includes Windows.h
-#include <d3d11.h>
-#include <wrl.h>
+#endif
 #include "Utility/Maths.h"
-#include "DxgiInfoManager.h"
 #include "RomanceException.h"
+#include "Backend/StateCache.h"
+#include "Backend/CommandList.h"
+#include "Backend/ConstantRing.h"
 
 
-/// Rundown of the various parts of D3D11
-/// - DEVICE:   Must create a device, acts as an interface between the application and the graphics hardware. We use Device
-///             whenever we want to allocate resources like a texture, buffer, shader, etc...
-/// - CONTEXT:  We use a context to issue draw commands
+/// @brief  Front end of the renderer, owns a RenderBackend which does the actual device work. Everything goes through
+///         a StateCache in front of it which drops redundant binds. Per frame constants are suballocated from a single
+///         ConstantRing, which gets unmapped before every draw and rolled over on SwapBuffer
+///         - Graphics(HWND):       D3D11Backend presenting to a window (SoftwareWindowBackend if there's no usable GPU)
+///         - Graphics(backend):    any backend, e.g a NullBackend for headless runs without a GPU
+///         CreateDeferred makes a Graphics that records into a CommandList instead, so bindables/drawables can be
+///         drawn into it from a worker thread as they are. ExecuteDeferred then plays it back on this one
 class Graphics
 {
     friend class Bindable;
 public:
-
+#ifdef _WIN32
     /// @brief  Exception class that handles HResults
     class HrException : public RomanceException
     {
     public:
         HrException(int line, const char* file, HRESULT hr, std::vector<std::string> infoMsgs = {}) noexcept;
-        char const* what() const override;
+        char const* what() const noexcept override;
         const char* GetType() const noexcept override;
         HRESULT GetErrorCode() const noexcept;
         std::string GetErrorString() const noexcept;
@@ -37,7 +43,7 @@ public:
     {
     public:
         InfoException(int line, const char* file, std::vector<std::string> infoMsgs = {}) noexcept;
-        char const* what() const override;
+        char const* what() const noexcept override;
         const char* GetType() const noexcept override;
         std::string GetErrorInfo() const noexcept;
     private:
@@ -53,9 +59,13 @@ public:
     private:
         std::string reason;
     };
-    
+#endif
+
 public:
+#ifdef _WIN32
     Graphics(HWND hWnd);
+#endif
+    Graphics(std::unique_ptr<RenderBackend> backend);
     ~Graphics() = default;
     Graphics(const Graphics&) = delete;
     Graphics& operator=(const Graphics&) const = delete;
@@ -66,28 +76,42 @@ public:
     /// @brief  Clears our RTV with the specified color
     void ClearBuffer(float r, float g, float b) noexcept;
 
-    void DrawIndexed(UINT count) noexcept(!IS_DEBUG);
+    void DrawIndexed(unsigned int count) noexcept(!IS_DEBUG);
+    void DrawIndexedInstanced(unsigned int count, unsigned int instanceCount) noexcept(!IS_DEBUG);
+
+    /// @brief  Lets the backend compile a set of shaders together before bindables create them one by one
+    void PrecompileShaders(const std::vector<ShaderDesc>& shaders);
 
     void SetProjectionMat(Math::FXMMATRIX projectionMat) noexcept;
     Math::FXMMATRIX GetProjectionMat() const noexcept;
 
     void OnViewPortUpdate(float width, float height) noexcept(!IS_DEBUG);
-    
+    /// @brief  Size of the render target in pixels
+    unsigned int GetWidth() const noexcept;
+    unsigned int GetHeight() const noexcept;
+
+    /// @brief  Binds issued to the backend vs filtered out by the state cache during the last frame
+    const StateCache::BindStats& GetBindStats() const noexcept;
+    void SetStateCacheEnabled(bool bEnabled) noexcept;
+    /// @brief  Constant ring usage (bytes, allocations, maps) during the last frame
+    const ConstantRing::FrameStats& GetConstantStats() const noexcept;
+
+    /// @brief  Graphics recording into a command list of this one's backend. Shares the constant ring and projection,
+    ///         so it can only draw things whose frame constants were already uploaded (see RenderQueue)
+    std::unique_ptr<Graphics> CreateDeferred();
+    /// @brief  Executes what deferred recorded since the last call and clears it for the next recording
+    void ExecuteDeferred(Graphics& deferred);
+    bool IsDeferred() const noexcept;
+
 private:
-    Microsoft::WRL::ComPtr<ID3D11Device> pDevice;
-    Microsoft::WRL::ComPtr<IDXGISwapChain> pSwapChain;
-    Microsoft::WRL::ComPtr<ID3D11DeviceContext> pContext;
-    Microsoft::WRL::ComPtr<ID3D11RenderTargetView> pTarget;
-    Microsoft::WRL::ComPtr<ID3D11DepthStencilView> pDSV;
-
-    Microsoft::WRL::ComPtr<ID3D11Texture2D> pBackBuffer;
-    Microsoft::WRL::ComPtr<ID3D11Texture2D> pDSTexture;
-    
-    Math::XMMATRIX m_ProjectionMat;
+    Graphics(const Graphics& immediate, std::unique_ptr<CommandList> commandList);
 
-    D3D11_VIEWPORT m_ViewPort;
-    
-#ifndef NDEBUG
-    DxgiInfoManager m_InfoManager;
-#endif 
+private:
+    std::unique_ptr<StateCache> pBackend;
+    std::shared_ptr<ConstantRing> pConstantRing;
+    /* Deferred only: the list pBackend forwards to and the Graphics it was made from */
+    CommandList* pCommandList = nullptr;
+    const Graphics* pImmediate = nullptr;
+
+    Math::XMMATRIX m_ProjectionMat;
 };
@@ -5,6 +5,8 @@
 class Keyboard
 {
     friend class Window;
+    /* Feeds the queues the way the message pump does, see Benchmarks/ */
+    friend class InputQueueBenchmark;
 
 public:
     /// @brief  Internal class for handling keyboard event types
@@ -1,5 +1,4 @@
 ﻿#include "Mouse.h"
-#include "RomanceWin.h"
 
 std::pair<int, int> Mouse::GetPos() const noexcept
 {
@@ -115,14 +114,14 @@ void Mouse::OnWheelDelta(int x, int y, int delta) noexcept
     m_wheelDeltaCarry += delta;
 
     // Generate events for every 120 delta, according to MSD, keep value between [-WHEEL_DELTA, WHEEL_DELTA]
-    while (m_wheelDeltaCarry >= WHEEL_DELTA)
+    while (m_wheelDeltaCarry >= s_WheelDelta)
     {
-        m_wheelDeltaCarry -= WHEEL_DELTA;
+        m_wheelDeltaCarry -= s_WheelDelta;
         OnWheelUp(x, y);
     }
-    while (m_wheelDeltaCarry <= -WHEEL_DELTA)
+    while (m_wheelDeltaCarry <= -s_WheelDelta)
     {
-        m_wheelDeltaCarry += WHEEL_DELTA;
+        m_wheelDeltaCarry += s_WheelDelta;
         OnWheelDown(x, y);
     }
 }
@@ -4,6 +4,8 @@
 class Mouse
 {
     friend class Window;
+    /* Feeds the queue the way the message pump does, see Benchmarks/ */
+    friend class InputQueueBenchmark;
 public:
     /// @brief  Internal class for handling mouse event types
     class Event
@@ -83,6 +85,8 @@ private:
 
 private:
     static constexpr unsigned int s_BufferSize = 16u;
+    /* WHEEL_DELTA from WinUser.h, one notch of a standard wheel. Kept here so the queue builds without Windows.h */
+    static constexpr int s_WheelDelta = 120;
     int m_xPos, m_yPos;
     int m_wheelDeltaCarry   = 0;
     bool b_LeftPressed      = false;
@@ -0,0 +1,208 @@
+﻿#include "RenderQueue.h"
+
+#include <algorithm>
+#include <cmath>
+#include "Graphics.h"
+#include "Utility/JobSystem.h"
+
+namespace
+{
+    constexpr unsigned int s_ProgramShift = 48u;
+    constexpr unsigned int s_LayoutShift = 40u;
+    constexpr unsigned int s_GeometryShift = 24u;
+    constexpr uint32_t s_MaxProgram = 0xffffu;
+    constexpr uint32_t s_MaxLayout = 0xffu;
+    constexpr uint32_t s_MaxGeometry = 0xffffu;
+    constexpr uint32_t s_MaxDepth = 0xffffffu;
+    /// @brief  Fewest packets worth recording into a command list of their own, below that the list costs more
+    ///         than drawing them straight away
+    constexpr size_t s_MinPacketsPerList = 256u;
+
+    /// @brief  Ids are handed out sequentially, so packing two of them by shifting one up keeps them unique
+    uint64_t Combine(uint64_t a, uint64_t b) noexcept
+    {
+        return (a << 32u) ^ b;
+    }
+}
+
+RenderQueue::RenderQueue(float maxDepth)
+    : m_MaxDepth(maxDepth)
+{}
+
+RenderQueue::~RenderQueue() = default;
+
+uint64_t RenderQueue::MakeKey(const StateIds& state, float viewDepth)
+{
+    return MakeKey(MakeStateKey(state), viewDepth);
+}
+
+uint64_t RenderQueue::MakeStateKey(const StateIds& state)
+{
+    std::lock_guard<std::mutex> lock(m_RemapMutex);
+    const uint64_t program = Remap(m_Programs, Combine(state.vertexShader, state.pixelShader), s_MaxProgram);
+    const uint64_t layout = Remap(m_Layouts, state.inputLayout, s_MaxLayout);
+    const uint64_t geometry = Remap(m_Geometry, Combine(state.vertexBuffer, state.indexBuffer), s_MaxGeometry);
+    return (program << s_ProgramShift) | (layout << s_LayoutShift) | (geometry << s_GeometryShift);
+}
+
+uint64_t RenderQueue::MakeKey(uint64_t stateKey, float viewDepth) const noexcept
+{
+    // Behind the camera clamps to 0, past maxDepth to the last bucket
+    const float normalized = std::clamp(viewDepth / m_MaxDepth, 0.f, 1.f);
+    const uint64_t depth = static_cast<uint64_t>(std::lround(normalized * float(s_MaxDepth)));
+    return stateKey | depth;
+}
+
+void RenderQueue::Submit(uint64_t key, ExecuteFn pExecute, const void* pData, UploadFn pUpload)
+{
+    m_Packets.push_back({ key, pExecute, pUpload, pData });
+}
+
+size_t RenderQueue::Reserve(size_t count)
+{
+    const size_t first = m_Packets.size();
+    m_Packets.resize(first + count);
+    return first;
+}
+
+void RenderQueue::SubmitAt(size_t index, uint64_t key, ExecuteFn pExecute, const void* pData, UploadFn pUpload) noexcept
+{
+    m_Packets[index] = { key, pExecute, pUpload, pData };
+}
+
+void RenderQueue::Execute(Graphics& gfx)
+{
+    Upload(gfx);
+    Sort();
+
+    for (const auto& entry : m_Order)
+    {
+        const Packet& packet = m_Packets[entry.packet];
+        packet.pExecute(gfx, packet.pData);
+    }
+
+    m_Packets.clear();
+}
+
+void RenderQueue::Execute(Graphics& gfx, JobSystem& jobs)
+{
+    const size_t numLists = std::min<size_t>(jobs.GetThreadCount(), m_Packets.size() / s_MinPacketsPerList);
+    if (numLists <= 1u)
+    {
+        Execute(gfx);
+        return;
+    }
+
+    // Uploads touch the constant ring and dynamic buffers, which only the immediate Graphics may write
+    Upload(gfx);
+    Sort();
+
+    const size_t perList = (m_Order.size() + numLists - 1u) / numLists;
+    while (m_Recorders.size() < numLists)
+    {
+        m_Recorders.push_back(gfx.CreateDeferred());
+    }
+
+    jobs.ParallelFor(m_Order.size(), perList, [this, perList](size_t begin, size_t end)
+    {
+        Graphics& recorder = *m_Recorders[begin / perList];
+        for (size_t i = begin; i < end; i++)
+        {
+            const Packet& packet = m_Packets[m_Order[i].packet];
+            packet.pExecute(recorder, packet.pData);
+        }
+    });
+
+    // Slices go in order, so this draws exactly what the serial Execute would
+    for (size_t list = 0; list * perList < m_Order.size(); list++)
+    {
+        gfx.ExecuteDeferred(*m_Recorders[list]);
+    }
+
+    m_Packets.clear();
+}
+
+size_t RenderQueue::GetPacketCount() const noexcept
+{
+    return m_Packets.size();
+}
+
+void RenderQueue::SetMaxDepth(float maxDepth) noexcept
+{
+    m_MaxDepth = maxDepth;
+}
+
+void RenderQueue::Upload(Graphics& gfx)
+{
+    // Nothing has been drawn yet, so the constant ring stays mapped through all of these
+    for (const auto& packet : m_Packets)
+    {
+        if (packet.pUpload)
+        {
+            packet.pUpload(gfx, packet.pData);
+        }
+    }
+}
+
+void RenderQueue::Sort()
+{
+    const size_t count = m_Packets.size();
+    m_Order.resize(count);
+    m_Scratch.resize(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        m_Order[i] = { m_Packets[i].key, static_cast<uint32_t>(i) };
+    }
+
+    // All 8 histograms in one pass over the keys
+    size_t histograms[8][256] = {};
+    for (const auto& entry : m_Order)
+    {
+        for (unsigned int pass = 0; pass < 8u; pass++)
+        {
+            histograms[pass][(entry.key >> (pass * 8u)) & 0xffu]++;
+        }
+    }
+
+    for (unsigned int pass = 0; pass < 8u; pass++)
+    {
+        size_t* histogram = histograms[pass];
+
+        // Every key has the same digit here (e.g unused high bits of the depth/geometry fields), nothing to do
+        if (histogram[(m_Order.empty() ? 0u : (m_Order[0].key >> (pass * 8u)) & 0xffu)] == count)
+        {
+            continue;
+        }
+
+        // Exclusive prefix sum, then scatter (stable, so lower digits keep their order)
+        size_t offset = 0u;
+        for (unsigned int digit = 0; digit < 256u; digit++)
+        {
+            const size_t bucket = histogram[digit];
+            histogram[digit] = offset;
+            offset += bucket;
+        }
+        for (const auto& entry : m_Order)
+        {
+            m_Scratch[histogram[(entry.key >> (pass * 8u)) & 0xffu]++] = entry;
+        }
+        m_Order.swap(m_Scratch);
+    }
+}
+
+uint64_t RenderQueue::Remap(std::unordered_map<uint64_t, uint32_t>& map, uint64_t id, uint32_t max)
+{
+    const auto it = map.find(id);
+    if (it != map.end())
+    {
+        return it->second;
+    }
+    // Saturated, don't keep growing the map with ids that would all land on the same index anyway
+    if (map.size() >= max)
+    {
+        return max;
+    }
+    const uint32_t index = static_cast<uint32_t>(map.size());
+    map.emplace(id, index);
+    return index;
+}
@@ -0,0 +1,103 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class Graphics;
+class JobSystem;
+
+/// @brief  Deferred draw submission. Drawables push packets (sort key + how to draw them) during the frame, Execute
+///         radix sorts them by key and runs them in order. Key layout, most significant first:
+///         - [63:48] program (vertex + pixel shader)
+///         - [47:40] input layout
+///         - [39:24] geometry (vertex + index buffer)
+///         - [23:0]  view depth, front to back
+///         So draws sharing state end up next to each other (the StateCache then drops the repeated binds) and within
+///         the same state they're drawn front to back for early-Z.
+///         Packets can also come with an upload function, all of those run (in submission order) before the first draw
+///         so every per frame constant of the frame gets written in a single map of the ConstantRing.
+///         Building keys from a state key and filling reserved packets (SubmitAt) is safe from several threads at once.
+///         Executing with a JobSystem records the sorted packets into one deferred Graphics per thread, each getting a
+///         contiguous slice of the order, and executes those in slice order, so the draw order doesn't change
+class RenderQueue
+{
+public:
+    using ExecuteFn = void(*)(Graphics& gfx, const void* pData);
+    using UploadFn = void(*)(Graphics& gfx, const void* pData);
+
+    /// @brief  GpuResource ids of the state a draw needs, 0 for anything it doesn't bind
+    struct StateIds
+    {
+        uint64_t vertexShader = 0u;
+        uint64_t pixelShader = 0u;
+        uint64_t inputLayout = 0u;
+        uint64_t vertexBuffer = 0u;
+        uint64_t indexBuffer = 0u;
+    };
+
+public:
+    /// @brief  maxDepth is the view depth mapped to the end of the depth bits (far plane of the projection)
+    explicit RenderQueue(float maxDepth);
+    ~RenderQueue();
+    RenderQueue(const RenderQueue&) = delete;
+    RenderQueue& operator=(const RenderQueue&) = delete;
+
+    /// @brief  Builds a sort key. Resource ids are remapped to small dense indices (first come first served) so they
+    ///         fit their bits, past 2^bits distinct combos they saturate, which only costs some coalescing
+    uint64_t MakeKey(const StateIds& state, float viewDepth);
+    /// @brief  The state bits of a key on their own. A given state always maps to the same bits in this queue so
+    ///         they can be cached
+    uint64_t MakeStateKey(const StateIds& state);
+    /// @brief  Adds the depth bits to a state key
+    uint64_t MakeKey(uint64_t stateKey, float viewDepth) const noexcept;
+    void Submit(uint64_t key, ExecuteFn pExecute, const void* pData, UploadFn pUpload = nullptr);
+    /// @brief  Makes room for count packets and returns the index of the first, fill them with SubmitAt
+    size_t Reserve(size_t count);
+    void SubmitAt(size_t index, uint64_t key, ExecuteFn pExecute, const void* pData, UploadFn pUpload = nullptr) noexcept;
+    /// @brief  Runs the uploads, then sorts and runs every packet submitted since the last Execute, then empties the
+    ///         queue
+    void Execute(Graphics& gfx);
+    /// @brief  Same, but the packets are drawn into command lists recorded across jobs. Packets have to be fine
+    ///         drawn from any thread once their upload ran (frame constants written, nothing created)
+    void Execute(Graphics& gfx, JobSystem& jobs);
+
+    size_t GetPacketCount() const noexcept;
+    void SetMaxDepth(float maxDepth) noexcept;
+
+private:
+    struct Packet
+    {
+        uint64_t key;
+        ExecuteFn pExecute;
+        UploadFn pUpload;
+        const void* pData;
+    };
+    struct SortEntry
+    {
+        uint64_t key;
+        uint32_t packet;
+    };
+
+    /// @brief  Runs every packet's upload, in submission order
+    void Upload(Graphics& gfx);
+    /// @brief  LSD radix sort of m_Order, 8 bits per pass, passes where every key has the same digit are skipped
+    void Sort();
+    static uint64_t Remap(std::unordered_map<uint64_t, uint32_t>& map, uint64_t id, uint32_t max);
+
+private:
+    float m_MaxDepth;
+    std::vector<Packet> m_Packets;
+    std::vector<SortEntry> m_Order;
+    std::vector<SortEntry> m_Scratch;
+    /* Deferred Graphics the parallel Execute records into, one per slice, kept around between frames */
+    std::vector<std::unique_ptr<Graphics>> m_Recorders;
+
+    /* Guards the remap tables, so state keys can be made from any thread */
+    std::mutex m_RemapMutex;
+    std::unordered_map<uint64_t, uint32_t> m_Programs;
+    std::unordered_map<uint64_t, uint32_t> m_Layouts;
+    std::unordered_map<uint64_t, uint32_t> m_Geometry;
+};
@@ -5,7 +5,7 @@ RomanceException::RomanceException(int line, const char* file) noexcept
     : m_line(line), m_file(file) 
 {}
 
-const char* RomanceException::what() const
+const char* RomanceException::what() const noexcept
 {
     std::ostringstream oss;
     oss << GetType() << std::endl
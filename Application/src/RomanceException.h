@@ -8,7 +8,7 @@ class RomanceException : public std::exception
 public:
     RomanceException(int line, const char* file) noexcept;
     /// @brief  std::exception virtual override
-    const char* what() const override;
+    const char* what() const noexcept override;
     /// @brief  Custom type of exception for base classes to override and specify
     virtual const char* GetType() const noexcept;
     int GetLine() const noexcept;
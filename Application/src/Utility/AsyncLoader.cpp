@@ -0,0 +1,61 @@
+﻿#include "AsyncLoader.h"
+
+#include <algorithm>
+
+AsyncLoader::AsyncLoader(unsigned int numThreads)
+{
+    numThreads = std::max(numThreads, 1u);
+    for (unsigned int i = 0; i < numThreads; i++)
+    {
+        m_Workers.emplace_back(&AsyncLoader::WorkerLoop, this);
+    }
+}
+
+AsyncLoader::~AsyncLoader()
+{
+    std::deque<std::function<void()>> dropped;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        b_Quit = true;
+        dropped.swap(m_Tasks);
+    }
+    m_WakeCV.notify_all();
+    for (auto& worker : m_Workers)
+    {
+        worker.join();
+    }
+}
+
+unsigned int AsyncLoader::GetThreadCount() const noexcept
+{
+    return static_cast<unsigned int>(m_Workers.size());
+}
+
+void AsyncLoader::Enqueue(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Tasks.push_back(std::move(task));
+    }
+    m_WakeCV.notify_one();
+}
+
+void AsyncLoader::WorkerLoop()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_WakeCV.wait(lock, [this] { return b_Quit || !m_Tasks.empty(); });
+            if (b_Quit)
+            {
+                return;
+            }
+            task = std::move(m_Tasks.front());
+            m_Tasks.pop_front();
+        }
+        // Exceptions never get here, Submit's wrapper hands them to the future
+        task();
+    }
+}
@@ -0,0 +1,69 @@
+﻿#pragma once
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/// @brief  Background threads for work that takes longer than a frame (mesh generation, shader compiles, resource
+///         creation). Unlike the JobSystem nobody waits on it: Submit hands back a future for the frame loop to poll,
+///         so whatever depends on the result shows up once it's done instead of stalling a frame.
+///         Tasks start in submission order
+class AsyncLoader
+{
+public:
+    explicit AsyncLoader(unsigned int numThreads = 2u);
+    /// @brief  Tasks that haven't started are dropped (their futures report a broken promise), running ones finish
+    ~AsyncLoader();
+    AsyncLoader(const AsyncLoader&) = delete;
+    AsyncLoader& operator=(const AsyncLoader&) = delete;
+
+    /// @brief  Queues fn to run on a loader thread. The future gets its result, or whatever it threw
+    template<class F>
+    std::future<std::invoke_result_t<F&>> Submit(F&& fn)
+    {
+        using R = std::invoke_result_t<F&>;
+        // Shared so the task stays copyable for std::function. The callable goes with the task once it ran, anything
+        // it captured doesn't live on in the future
+        auto pPromise = std::make_shared<std::promise<R>>();
+        auto future = pPromise->get_future();
+        Enqueue([pPromise, fn = std::forward<F>(fn)]() mutable
+        {
+            try
+            {
+                if constexpr (std::is_void_v<R>)
+                {
+                    fn();
+                    pPromise->set_value();
+                }
+                else
+                {
+                    pPromise->set_value(fn());
+                }
+            }
+            catch (...)
+            {
+                pPromise->set_exception(std::current_exception());
+            }
+        });
+        return future;
+    }
+
+    unsigned int GetThreadCount() const noexcept;
+
+private:
+    void Enqueue(std::function<void()> task);
+    void WorkerLoop();
+
+private:
+    std::vector<std::thread> m_Workers;
+    std::mutex m_Mutex;
+    std::condition_variable m_WakeCV;
+    std::deque<std::function<void()>> m_Tasks;
+    bool b_Quit = false;
+};
@@ -0,0 +1,115 @@
+﻿#pragma once
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+#include "Maths.h"
+
+struct AABB
+{
+    Math::XMFLOAT3 min = { FLT_MAX, FLT_MAX, FLT_MAX };
+    Math::XMFLOAT3 max = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+    void Grow(const Math::XMFLOAT3& p) noexcept
+    {
+        min = { std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z) };
+        max = { std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z) };
+    }
+    void Grow(const AABB& box) noexcept
+    {
+        Grow(box.min);
+        Grow(box.max);
+    }
+
+    bool IsValid() const noexcept { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+    float SurfaceArea() const noexcept
+    {
+        const float dx = max.x - min.x;
+        const float dy = max.y - min.y;
+        const float dz = max.z - min.z;
+        return IsValid() ? 2.f * (dx * dy + dy * dz + dz * dx) : 0.f;
+    }
+    bool operator==(const AABB& other) const noexcept
+    {
+        return min.x == other.min.x && min.y == other.min.y && min.z == other.min.z &&
+               max.x == other.max.x && max.y == other.max.y && max.z == other.max.z;
+    }
+
+    /// @brief  Bounds of the positions of any vertex type with a pos member
+    template<class V>
+    static AABB FromVertices(const std::vector<V>& vertices) noexcept
+    {
+        AABB box;
+        for (const V& v : vertices)
+        {
+            box.Grow(v.pos);
+        }
+        return box;
+    }
+};
+
+struct BoundingSphere
+{
+    Math::XMFLOAT3 center = { 0.f, 0.f, 0.f };
+    float radius = 0.f;
+};
+
+/// @brief  Object space bounds of a mesh, the sphere is the cheap one for culling and encloses the box
+struct Bounds
+{
+    AABB box;
+    BoundingSphere sphere;
+
+    static Bounds FromBox(const AABB& box) noexcept
+    {
+        const Math::XMFLOAT3 halfExtent = { 0.5f * (box.max.x - box.min.x), 0.5f * (box.max.y - box.min.y), 0.5f * (box.max.z - box.min.z) };
+        Bounds bounds;
+        bounds.box = box;
+        bounds.sphere.center = { box.min.x + halfExtent.x, box.min.y + halfExtent.y, box.min.z + halfExtent.z };
+        bounds.sphere.radius = std::sqrt(Math::square(halfExtent.x) + Math::square(halfExtent.y) + Math::square(halfExtent.z));
+        return bounds;
+    }
+
+    /// @brief  Box enclosing the transformed box (Arvo: each output axis takes the min/max contribution of every input
+    ///         axis, no need to transform the 8 corners)
+    static AABB TransformBox(const AABB& box, Math::FXMMATRIX transform) noexcept
+    {
+        Math::XMFLOAT4X4 m;
+        Math::XMStoreFloat4x4(&m, transform);
+        const float inMin[3] = { box.min.x, box.min.y, box.min.z };
+        const float inMax[3] = { box.max.x, box.max.y, box.max.z };
+        float outMin[3] = { m._41, m._42, m._43 };
+        float outMax[3] = { m._41, m._42, m._43 };
+        for (int i = 0; i < 3; i++)
+        {
+            for (int j = 0; j < 3; j++)
+            {
+                // Row vectors, input axis i lands on output axis j scaled by m[i][j]
+                const float a = m.m[i][j] * inMin[i];
+                const float b = m.m[i][j] * inMax[i];
+                outMin[j] += std::min(a, b);
+                outMax[j] += std::max(a, b);
+            }
+        }
+
+        AABB out;
+        out.min = { outMin[0], outMin[1], outMin[2] };
+        out.max = { outMax[0], outMax[1], outMax[2] };
+        return out;
+    }
+
+    /// @brief  Sphere moved by transform, the radius scales by the largest axis scale so it stays conservative
+    static BoundingSphere TransformSphere(const BoundingSphere& sphere, Math::FXMMATRIX transform) noexcept
+    {
+        const float scaleSq = std::max({
+            Math::XMVectorGetX(Math::XMVector3LengthSq(transform.r[0])),
+            Math::XMVectorGetX(Math::XMVector3LengthSq(transform.r[1])),
+            Math::XMVectorGetX(Math::XMVector3LengthSq(transform.r[2])) });
+
+        BoundingSphere out;
+        Math::XMStoreFloat3(&out.center, Math::XMVector3Transform(Math::XMLoadFloat3(&sphere.center), transform));
+        out.radius = sphere.radius * std::sqrt(scaleSq);
+        return out;
+    }
+};
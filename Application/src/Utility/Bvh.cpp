@@ -0,0 +1,445 @@
+﻿#include "Bvh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace
+{
+    float Axis(const Math::XMFLOAT3& v, int axis) noexcept
+    {
+        return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+    }
+
+    float Centroid(const AABB& box, int axis) noexcept
+    {
+        return 0.5f * (Axis(box.min, axis) + Axis(box.max, axis));
+    }
+
+    /// @brief  Planes of mask the box is partially in, or -1 if it's entirely outside one of them
+    int ClassifyBox(const AABB& box, const Frustum& frustum, int mask) noexcept
+    {
+        const float cx = 0.5f * (box.min.x + box.max.x);
+        const float cy = 0.5f * (box.min.y + box.max.y);
+        const float cz = 0.5f * (box.min.z + box.max.z);
+        const float ex = 0.5f * (box.max.x - box.min.x);
+        const float ey = 0.5f * (box.max.y - box.min.y);
+        const float ez = 0.5f * (box.max.z - box.min.z);
+
+        for (int p = 0; p < Frustum::NumPlanes; p++)
+        {
+            if (!(mask & (1 << p)))
+            {
+                continue;
+            }
+            const Math::XMFLOAT4& plane = frustum.planes[p];
+            const float distance = plane.x * cx + plane.y * cy + plane.z * cz + plane.w;
+            const float radius = std::abs(plane.x) * ex + std::abs(plane.y) * ey + std::abs(plane.z) * ez;
+            if (distance < -radius)
+            {
+                return -1;
+            }
+            if (distance >= radius)
+            {
+                mask &= ~(1 << p);
+            }
+        }
+        return mask;
+    }
+
+    /// @brief  Distance along the ray where it enters box (0 if it starts inside), or FLT_MAX if it misses it
+    float IntersectSlabs(const AABB& box, const Math::XMFLOAT3& origin, const Math::XMFLOAT3& invDirection, float maxT) noexcept
+    {
+        float tNear = 0.f;
+        float tFar = maxT;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            const float o = Axis(origin, axis);
+            const float inv = Axis(invDirection, axis);
+            const float t0 = (Axis(box.min, axis) - o) * inv;
+            const float t1 = (Axis(box.max, axis) - o) * inv;
+            tNear = std::max(tNear, std::min(t0, t1));
+            tFar = std::min(tFar, std::max(t0, t1));
+        }
+        return tNear <= tFar ? tNear : FLT_MAX;
+    }
+}
+
+void Bvh::Build(const std::vector<AABB>& boxes)
+{
+    m_Boxes = boxes;
+    const uint32_t count = static_cast<uint32_t>(m_Boxes.size());
+    m_LeafObjects.resize(count);
+    std::iota(m_LeafObjects.begin(), m_LeafObjects.end(), 0u);
+    m_LeafOf.assign(count, s_InvalidNode);
+    m_Nodes.clear();
+    b_Refitted = false;
+    m_BuiltCost = 0.f;
+    if (count == 0u)
+    {
+        return;
+    }
+
+    m_Centroids.resize(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        m_Centroids[i] = { Centroid(m_Boxes[i], 0), Centroid(m_Boxes[i], 1), Centroid(m_Boxes[i], 2) };
+    }
+
+    m_Nodes.reserve(2u * count);
+    m_Nodes.push_back({ AABB{}, s_InvalidNode, 0u, 0u });
+    Split(0u, 0u, count);
+    m_BuiltCost = Cost();
+}
+
+void Bvh::Split(uint32_t node, uint32_t begin, uint32_t end)
+{
+    AABB bounds;
+    AABB centroids;
+    for (uint32_t i = begin; i < end; i++)
+    {
+        bounds.Grow(m_Boxes[m_LeafObjects[i]]);
+        centroids.Grow(m_Centroids[m_LeafObjects[i]]);
+    }
+    m_Nodes[node].box = bounds;
+
+    const uint32_t count = end - begin;
+    const auto MakeLeaf = [&]()
+    {
+        m_Nodes[node].first = begin;
+        m_Nodes[node].count = count;
+        for (uint32_t i = begin; i < end; i++)
+        {
+            m_LeafOf[m_LeafObjects[i]] = node;
+        }
+    };
+    if (count == 1u)
+    {
+        MakeLeaf();
+        return;
+    }
+
+    // Binned SAH: cost of a split is traversal + each side's object count weighted by the chance (area ratio) a ray
+    // or frustum that hits the parent also hits that side. A leaf costs its object count
+    const float parentArea = bounds.SurfaceArea();
+    const float invParentArea = parentArea > 0.f ? 1.f / parentArea : 0.f;
+    float bestCost = FLT_MAX;
+    int bestAxis = -1;
+    uint32_t bestBin = 0u;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        const float cMin = Axis(centroids.min, axis);
+        const float extent = Axis(centroids.max, axis) - cMin;
+        if (extent <= 0.f)
+        {
+            continue;
+        }
+
+        struct Bin
+        {
+            AABB box;
+            uint32_t count = 0u;
+        } bins[s_NumBins];
+        const float scale = float(s_NumBins) / extent;
+        for (uint32_t i = begin; i < end; i++)
+        {
+            const uint32_t object = m_LeafObjects[i];
+            const uint32_t b = std::min(static_cast<uint32_t>((Axis(m_Centroids[object], axis) - cMin) * scale), s_NumBins - 1u);
+            bins[b].box.Grow(m_Boxes[object]);
+            bins[b].count++;
+        }
+
+        // Sweep from the right storing area * count, then from the left evaluating each split plane
+        float rightCost[s_NumBins] = {};
+        AABB right;
+        uint32_t rightCount = 0u;
+        for (uint32_t b = s_NumBins - 1u; b > 0u; b--)
+        {
+            right.Grow(bins[b].box);
+            rightCount += bins[b].count;
+            rightCost[b] = right.SurfaceArea() * float(rightCount);
+        }
+        AABB left;
+        uint32_t leftCount = 0u;
+        for (uint32_t b = 0u; b + 1u < s_NumBins; b++)
+        {
+            left.Grow(bins[b].box);
+            leftCount += bins[b].count;
+            if (leftCount == 0u || leftCount == count)
+            {
+                continue;
+            }
+            const float cost = s_TraversalCost + (left.SurfaceArea() * float(leftCount) + rightCost[b + 1u]) * invParentArea;
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestBin = b;
+            }
+        }
+    }
+
+    if (count <= s_MaxLeafSize && bestCost >= float(count))
+    {
+        MakeLeaf();
+        return;
+    }
+
+    uint32_t mid = begin + count / 2u;
+    if (bestAxis >= 0)
+    {
+        const float cMin = Axis(centroids.min, bestAxis);
+        const float scale = float(s_NumBins) / (Axis(centroids.max, bestAxis) - cMin);
+        const auto pivot = std::partition(m_LeafObjects.begin() + begin, m_LeafObjects.begin() + end, [&](uint32_t object)
+        {
+            const uint32_t b = std::min(static_cast<uint32_t>((Axis(m_Centroids[object], bestAxis) - cMin) * scale), s_NumBins - 1u);
+            return b <= bestBin;
+        });
+        mid = static_cast<uint32_t>(pivot - m_LeafObjects.begin());
+    }
+    // else every centroid is the same point, no plane separates them so just halve the range
+
+    const uint32_t children = static_cast<uint32_t>(m_Nodes.size());
+    m_Nodes.push_back({ AABB{}, node, 0u, 0u });
+    m_Nodes.push_back({ AABB{}, node, 0u, 0u });
+    m_Nodes[node].first = children;
+    m_Nodes[node].count = 0u;
+    Split(children, begin, mid);
+    Split(children + 1u, mid, end);
+}
+
+void Bvh::Update(uint32_t object, const AABB& box)
+{
+    if (m_Boxes[object] == box)
+    {
+        return;
+    }
+    m_Boxes[object] = box;
+    b_Refitted = true;
+
+    // Ancestors only depend on their children's boxes, so the first one that stays the same ends the walk
+    for (uint32_t node = m_LeafOf[object]; node != s_InvalidNode; node = m_Nodes[node].parent)
+    {
+        const AABB before = m_Nodes[node].box;
+        RefitNode(node);
+        if (m_Nodes[node].box == before)
+        {
+            break;
+        }
+    }
+}
+
+void Bvh::Refit(const std::vector<AABB>& boxes)
+{
+    if (boxes == m_Boxes)
+    {
+        return;
+    }
+    m_Boxes = boxes;
+    b_Refitted = true;
+    for (size_t node = m_Nodes.size(); node-- > 0u;)
+    {
+        RefitNode(static_cast<uint32_t>(node));
+    }
+}
+
+void Bvh::RefitNode(uint32_t node) noexcept
+{
+    Node& n = m_Nodes[node];
+    AABB box;
+    if (n.count > 0u)
+    {
+        for (uint32_t i = n.first; i < n.first + n.count; i++)
+        {
+            box.Grow(m_Boxes[m_LeafObjects[i]]);
+        }
+    }
+    else
+    {
+        box = m_Nodes[n.first].box;
+        box.Grow(m_Nodes[n.first + 1u].box);
+    }
+    n.box = box;
+}
+
+bool Bvh::RebuildIfDegraded()
+{
+    if (!b_Refitted)
+    {
+        return false;
+    }
+    b_Refitted = false;
+    if (Cost() <= m_BuiltCost * s_RebuildRatio)
+    {
+        return false;
+    }
+
+    const std::vector<AABB> boxes = std::move(m_Boxes);
+    Build(boxes);
+    return true;
+}
+
+float Bvh::Cost() const noexcept
+{
+    if (m_Nodes.empty() || m_Nodes[0].box.SurfaceArea() <= 0.f)
+    {
+        return 0.f;
+    }
+
+    float cost = 0.f;
+    for (const Node& node : m_Nodes)
+    {
+        cost += node.box.SurfaceArea() * (node.count > 0u ? float(node.count) : s_TraversalCost);
+    }
+    return cost / m_Nodes[0].box.SurfaceArea();
+}
+
+void Bvh::Cull(const Frustum& frustum, std::vector<uint32_t>& visible) const
+{
+    visible.clear();
+    m_LastCullNodes = 0u;
+    if (m_Nodes.empty())
+    {
+        return;
+    }
+
+    struct Entry
+    {
+        uint32_t node;
+        int planeMask;
+    };
+    std::vector<Entry> stack;
+    stack.reserve(64u);
+    stack.push_back({ 0u, (1 << Frustum::NumPlanes) - 1 });
+
+    while (!stack.empty())
+    {
+        const Entry entry = stack.back();
+        stack.pop_back();
+        m_LastCullNodes++;
+
+        const Node& node = m_Nodes[entry.node];
+        const int mask = ClassifyBox(node.box, frustum, entry.planeMask);
+        if (mask < 0)
+        {
+            continue;
+        }
+        if (mask == 0)
+        {
+            EmitSubtree(entry.node, visible);
+            continue;
+        }
+
+        if (node.count > 0u)
+        {
+            for (uint32_t i = node.first; i < node.first + node.count; i++)
+            {
+                const uint32_t object = m_LeafObjects[i];
+                if (ClassifyBox(m_Boxes[object], frustum, mask) >= 0)
+                {
+                    visible.push_back(object);
+                }
+            }
+            continue;
+        }
+        stack.push_back({ node.first, mask });
+        stack.push_back({ node.first + 1u, mask });
+    }
+}
+
+void Bvh::EmitSubtree(uint32_t root, std::vector<uint32_t>& visible) const
+{
+    std::vector<uint32_t> stack = { root };
+    while (!stack.empty())
+    {
+        const Node& node = m_Nodes[stack.back()];
+        stack.pop_back();
+        if (node.count > 0u)
+        {
+            visible.insert(visible.end(), m_LeafObjects.begin() + node.first, m_LeafObjects.begin() + node.first + node.count);
+        }
+        else
+        {
+            stack.push_back(node.first);
+            stack.push_back(node.first + 1u);
+        }
+    }
+}
+
+std::optional<Bvh::Hit> Bvh::Raycast(const Ray& ray, float maxT) const
+{
+    if (m_Nodes.empty())
+    {
+        return std::nullopt;
+    }
+
+    const Math::XMFLOAT3 invDirection = { 1.f / ray.direction.x, 1.f / ray.direction.y, 1.f / ray.direction.z };
+    std::optional<Hit> best;
+    float bestT = maxT;
+
+    struct Entry
+    {
+        uint32_t node;
+        float tNear;
+    };
+    std::vector<Entry> stack;
+    stack.reserve(64u);
+    const float tRoot = IntersectSlabs(m_Nodes[0].box, ray.origin, invDirection, bestT);
+    if (tRoot != FLT_MAX)
+    {
+        stack.push_back({ 0u, tRoot });
+    }
+
+    while (!stack.empty())
+    {
+        const Entry entry = stack.back();
+        stack.pop_back();
+        if (entry.tNear >= bestT)
+        {
+            continue;
+        }
+
+        const Node& node = m_Nodes[entry.node];
+        if (node.count > 0u)
+        {
+            for (uint32_t i = node.first; i < node.first + node.count; i++)
+            {
+                const uint32_t object = m_LeafObjects[i];
+                const float t = IntersectSlabs(m_Boxes[object], ray.origin, invDirection, bestT);
+                if (t < bestT)
+                {
+                    bestT = t;
+                    best = Hit{ object, t };
+                }
+            }
+            continue;
+        }
+
+        // Push the far child first so the near one gets popped (and can shrink bestT) first
+        const float tLeft = IntersectSlabs(m_Nodes[node.first].box, ray.origin, invDirection, bestT);
+        const float tRight = IntersectSlabs(m_Nodes[node.first + 1u].box, ray.origin, invDirection, bestT);
+        const Entry left = { node.first, tLeft };
+        const Entry right = { node.first + 1u, tRight };
+        const Entry& nearChild = tLeft <= tRight ? left : right;
+        const Entry& farChild = tLeft <= tRight ? right : left;
+        if (farChild.tNear != FLT_MAX)
+        {
+            stack.push_back(farChild);
+        }
+        if (nearChild.tNear != FLT_MAX)
+        {
+            stack.push_back(nearChild);
+        }
+    }
+    return best;
+}
+
+size_t Bvh::GetObjectCount() const noexcept
+{
+    return m_Boxes.size();
+}
+
+size_t Bvh::GetLastCullNodeCount() const noexcept
+{
+    return m_LastCullNodes;
+}
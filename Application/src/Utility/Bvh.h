@@ -0,0 +1,85 @@
+﻿#pragma once
+#include <cfloat>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "Bounds.h"
+#include "FrustumCuller.h"
+
+/// @brief  Dynamic AABB tree over a set of objects identified by their index (0..n-1), for hierarchical frustum
+///         culling and ray picking.
+///         - Build:    top down, binned SAH split per node, up to s_MaxLeafSize objects per leaf
+///         - Update:   refits in place, the object's leaf and then its ancestors until one doesn't change
+///         - Refit:    replaces every box and refits all nodes in one reverse pass (children always sit after
+///           their parent)
+///         - Refitting never changes the topology so the tree loosens as things move, RebuildIfDegraded rebuilds once
+///           its SAH cost is s_RebuildRatio times what it was right after the last build
+class Bvh
+{
+public:
+    struct Ray
+    {
+        Math::XMFLOAT3 origin;
+        Math::XMFLOAT3 direction;   /* Doesn't need to be normalized, hit distances are in units of it */
+    };
+
+    struct Hit
+    {
+        uint32_t object;
+        float t;
+    };
+
+public:
+    void Build(const std::vector<AABB>& boxes);
+    /// @brief  Moves object to box, cheap no-op when it didn't change
+    void Update(uint32_t object, const AABB& box);
+    /// @brief  Takes every object's box at once (boxes[i] for object i) and refits the whole tree bottom up. Cheaper
+    ///         than an Update per object once most of them move
+    void Refit(const std::vector<AABB>& boxes);
+    /// @brief  Returns true if it rebuilt, meant to be called once after a frame's updates
+    bool RebuildIfDegraded();
+
+    /// @brief  Replaces visible with every object whose box touches the frustum. Subtrees entirely inside get
+    ///         emitted without testing, planes a node is fully inside of aren't tested again below it
+    void Cull(const Frustum& frustum, std::vector<uint32_t>& visible) const;
+    /// @brief  Closest object box the ray enters (or starts in) within maxT, nodes get visited near child first and
+    ///         skipped once they start behind the best hit
+    std::optional<Hit> Raycast(const Ray& ray, float maxT = FLT_MAX) const;
+
+    size_t GetObjectCount() const noexcept;
+    /// @brief  Nodes the last Cull looked at, to check it stays sublinear
+    size_t GetLastCullNodeCount() const noexcept;
+
+private:
+    struct Node
+    {
+        AABB box;
+        uint32_t parent;
+        uint32_t first;     /* Internal: left child (right child is first + 1). Leaf: first entry in m_LeafObjects */
+        uint32_t count;     /* Objects in a leaf, 0 for internal nodes */
+    };
+
+    void Split(uint32_t node, uint32_t begin, uint32_t end);
+    void RefitNode(uint32_t node) noexcept;
+    void EmitSubtree(uint32_t node, std::vector<uint32_t>& visible) const;
+    float Cost() const noexcept;
+
+private:
+    static constexpr uint32_t s_MaxLeafSize = 4u;
+    static constexpr uint32_t s_NumBins = 12u;
+    static constexpr float s_TraversalCost = 1.f;   /* Relative to testing one object */
+    static constexpr float s_RebuildRatio = 1.5f;
+    static constexpr uint32_t s_InvalidNode = ~0u;
+
+    std::vector<Node> m_Nodes;
+    std::vector<AABB> m_Boxes;
+    /* Leaves own a range of this, objects sorted by leaf */
+    std::vector<uint32_t> m_LeafObjects;
+    std::vector<uint32_t> m_LeafOf;
+    /* Build scratch, object box centers */
+    std::vector<Math::XMFLOAT3> m_Centroids;
+    float m_BuiltCost = 0.f;
+    bool b_Refitted = false;
+    mutable size_t m_LastCullNodes = 0u;
+};
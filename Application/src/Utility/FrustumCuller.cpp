@@ -0,0 +1,224 @@
+﻿#include "FrustumCuller.h"
+
+#include <algorithm>
+#include <bit>
+#ifdef __AVX__
+#include <immintrin.h>
+#else
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+#ifdef __AVX__
+    constexpr size_t s_BatchSize = 8u;
+    using Batch = __m256;
+    inline Batch Load(const float* p) noexcept { return _mm256_loadu_ps(p); }
+    inline Batch Splat(float f) noexcept { return _mm256_set1_ps(f); }
+    inline Batch MulAdd(Batch a, Batch b, Batch c) noexcept { return _mm256_add_ps(_mm256_mul_ps(a, b), c); }
+    inline Batch Sum(Batch a, Batch b) noexcept { return _mm256_add_ps(a, b); }
+    inline Batch NotNegative(Batch a) noexcept { return _mm256_cmp_ps(a, _mm256_setzero_ps(), _CMP_GE_OQ); }
+    inline Batch And(Batch a, Batch b) noexcept { return _mm256_and_ps(a, b); }
+    inline Batch AllOnes() noexcept { return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+    inline unsigned int Mask(Batch a) noexcept { return static_cast<unsigned int>(_mm256_movemask_ps(a)); }
+#else
+    constexpr size_t s_BatchSize = 4u;
+    using Batch = __m128;
+    inline Batch Load(const float* p) noexcept { return _mm_loadu_ps(p); }
+    inline Batch Splat(float f) noexcept { return _mm_set1_ps(f); }
+    inline Batch MulAdd(Batch a, Batch b, Batch c) noexcept { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+    inline Batch Sum(Batch a, Batch b) noexcept { return _mm_add_ps(a, b); }
+    inline Batch NotNegative(Batch a) noexcept { return _mm_cmpge_ps(a, _mm_setzero_ps()); }
+    inline Batch And(Batch a, Batch b) noexcept { return _mm_and_ps(a, b); }
+    inline Batch AllOnes() noexcept { return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+    inline unsigned int Mask(Batch a) noexcept { return static_cast<unsigned int>(_mm_movemask_ps(a)); }
+#endif
+
+    float PlaneDistance(const Math::XMFLOAT4& plane, float x, float y, float z) noexcept
+    {
+        return plane.x * x + plane.y * y + plane.z * z + plane.w;
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------------------
+* Frustum
+*--------------------------------------------------------------------------------------------------------------*/
+
+Frustum Frustum::FromMatrix(Math::FXMMATRIX matrix) noexcept
+{
+    // Row vectors: clip = p * M, so clip.x is p dotted with the first column. Transposed, the columns are rows
+    const Math::XMMATRIX columns = Math::XMMatrixTranspose(matrix);
+    const Math::XMVECTOR c0 = columns.r[0];
+    const Math::XMVECTOR c1 = columns.r[1];
+    const Math::XMVECTOR c2 = columns.r[2];
+    const Math::XMVECTOR c3 = columns.r[3];
+
+    const Math::XMVECTOR planes[NumPlanes] =
+    {
+        Math::XMVectorAdd(c3, c0),          /* -w <= x */
+        Math::XMVectorSubtract(c3, c0),     /*  x <= w */
+        Math::XMVectorAdd(c3, c1),          /* -w <= y */
+        Math::XMVectorSubtract(c3, c1),     /*  y <= w */
+        c2,                                 /*  0 <= z */
+        Math::XMVectorSubtract(c3, c2)      /*  z <= w */
+    };
+
+    Frustum frustum;
+    for (int i = 0; i < NumPlanes; i++)
+    {
+        // Unit normals so plane distances compare against radii
+        const float length = Math::XMVectorGetX(Math::XMVector3Length(planes[i]));
+        Math::XMStoreFloat4(&frustum.planes[i], Math::XMVectorScale(planes[i], 1.f / length));
+    }
+    return frustum;
+}
+
+bool Frustum::Intersects(const BoundingSphere& sphere) const noexcept
+{
+    for (const Math::XMFLOAT4& plane : planes)
+    {
+        if (PlaneDistance(plane, sphere.center.x, sphere.center.y, sphere.center.z) < -sphere.radius)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Frustum::Intersects(const AABB& box) const noexcept
+{
+    for (const Math::XMFLOAT4& plane : planes)
+    {
+        // Corner furthest along the normal, if that one is outside the whole box is
+        const float x = plane.x >= 0.f ? box.max.x : box.min.x;
+        const float y = plane.y >= 0.f ? box.max.y : box.min.y;
+        const float z = plane.z >= 0.f ? box.max.z : box.min.z;
+        if (PlaneDistance(plane, x, y, z) < 0.f)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*--------------------------------------------------------------------------------------------------------------
+* FrustumCuller
+*--------------------------------------------------------------------------------------------------------------*/
+
+void FrustumCuller::Clear() noexcept
+{
+    m_Count = 0u;
+    m_X.clear();
+    m_Y.clear();
+    m_Z.clear();
+    m_Radius.clear();
+}
+
+void FrustumCuller::Reserve(size_t count)
+{
+    const size_t padded = (count + s_BatchSize - 1u) / s_BatchSize * s_BatchSize;
+    m_X.reserve(padded);
+    m_Y.reserve(padded);
+    m_Z.reserve(padded);
+    m_Radius.reserve(padded);
+}
+
+uint32_t FrustumCuller::Add(const BoundingSphere& sphere)
+{
+    if (m_Count == m_X.size())
+    {
+        m_X.resize(m_Count + s_BatchSize, 0.f);
+        m_Y.resize(m_Count + s_BatchSize, 0.f);
+        m_Z.resize(m_Count + s_BatchSize, 0.f);
+        m_Radius.resize(m_Count + s_BatchSize, 0.f);
+    }
+    m_X[m_Count] = sphere.center.x;
+    m_Y[m_Count] = sphere.center.y;
+    m_Z[m_Count] = sphere.center.z;
+    m_Radius[m_Count] = sphere.radius;
+    return static_cast<uint32_t>(m_Count++);
+}
+
+void FrustumCuller::Resize(size_t count)
+{
+    const size_t padded = (count + s_BatchSize - 1u) / s_BatchSize * s_BatchSize;
+    m_X.resize(padded, 0.f);
+    m_Y.resize(padded, 0.f);
+    m_Z.resize(padded, 0.f);
+    m_Radius.resize(padded, 0.f);
+    m_Count = count;
+}
+
+void FrustumCuller::Set(uint32_t index, const BoundingSphere& sphere) noexcept
+{
+    m_X[index] = sphere.center.x;
+    m_Y[index] = sphere.center.y;
+    m_Z[index] = sphere.center.z;
+    m_Radius[index] = sphere.radius;
+}
+
+size_t FrustumCuller::GetCount() const noexcept
+{
+    return m_Count;
+}
+
+size_t FrustumCuller::GetBatchSize() noexcept
+{
+    return s_BatchSize;
+}
+
+void FrustumCuller::Cull(const Frustum& frustum, std::vector<uint32_t>& visible) const
+{
+    Cull(frustum, 0u, m_Count, visible);
+}
+
+void FrustumCuller::Cull(const Frustum& frustum, size_t begin, size_t end, std::vector<uint32_t>& visible) const
+{
+    end = std::min(end, m_Count);
+    if (begin >= end)
+    {
+        visible.clear();
+        return;
+    }
+
+    // Sized for the worst case up front so the compaction below is just stores
+    visible.resize(end - begin + s_BatchSize);
+    size_t numVisible = 0u;
+
+    Batch planes[Frustum::NumPlanes][4];
+    for (int p = 0; p < Frustum::NumPlanes; p++)
+    {
+        planes[p][0] = Splat(frustum.planes[p].x);
+        planes[p][1] = Splat(frustum.planes[p].y);
+        planes[p][2] = Splat(frustum.planes[p].z);
+        planes[p][3] = Splat(frustum.planes[p].w);
+    }
+
+    for (size_t i = begin; i < end; i += s_BatchSize)
+    {
+        const Batch x = Load(&m_X[i]);
+        const Batch y = Load(&m_Y[i]);
+        const Batch z = Load(&m_Z[i]);
+        const Batch r = Load(&m_Radius[i]);
+
+        // Inside a plane while dot(n, c) + d + r >= 0, stop testing planes once every lane is out
+        Batch inside = AllOnes();
+        for (int p = 0; p < Frustum::NumPlanes && Mask(inside) != 0u; p++)
+        {
+            const Batch distance = MulAdd(x, planes[p][0], MulAdd(y, planes[p][1], MulAdd(z, planes[p][2], planes[p][3])));
+            inside = And(inside, NotNegative(Sum(distance, r)));
+        }
+
+        for (unsigned int mask = Mask(inside); mask != 0u; mask &= mask - 1u)
+        {
+            visible[numVisible++] = static_cast<uint32_t>(i + static_cast<size_t>(std::countr_zero(mask)));
+        }
+    }
+
+    // Lanes past the range (padding or the next range's) can pass, they'd be the last indices written
+    while (numVisible > 0u && visible[numVisible - 1u] >= end)
+    {
+        numVisible--;
+    }
+    visible.resize(numVisible);
+}
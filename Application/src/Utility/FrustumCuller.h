@@ -0,0 +1,51 @@
+﻿#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "Bounds.h"
+
+/// @brief  The 6 planes of a view frustum, normals point inside. Extracted from a projection (Gribb/Hartmann), so
+///         the frustum is in whatever space the matrix takes you from: view space for the bare projection
+struct Frustum
+{
+    enum Plane { Left, Right, Bottom, Top, Near, Far, NumPlanes };
+    /* (nx, ny, nz, d), a point p is inside a plane when dot(n, p) + d >= 0 */
+    Math::XMFLOAT4 planes[NumPlanes];
+
+    /// @brief  D3D clip space conventions (0 <= z <= w), row vector matrices like the rest of the renderer
+    static Frustum FromMatrix(Math::FXMMATRIX matrix) noexcept;
+
+    bool Intersects(const BoundingSphere& sphere) const noexcept;
+    bool Intersects(const AABB& box) const noexcept;
+};
+
+/// @brief  Culls a batch of bounding spheres against a frustum. Spheres are stored SoA (x, y, z, radius arrays) so a
+///         plane test covers 8 spheres at a time with AVX or 4 with SSE, the visible ones get their indices written out.
+///         Conservative: a sphere that straddles the corner of two planes can pass
+class FrustumCuller
+{
+public:
+    void Clear() noexcept;
+    void Reserve(size_t count);
+    /// @brief  Returns the index the sphere gets reported as
+    uint32_t Add(const BoundingSphere& sphere);
+    /// @brief  Sets the sphere count up front so Set can fill them in from several threads
+    void Resize(size_t count);
+    void Set(uint32_t index, const BoundingSphere& sphere) noexcept;
+    size_t GetCount() const noexcept;
+    /// @brief  Ranges handed to the ranged Cull have to start on a multiple of this
+    static size_t GetBatchSize() noexcept;
+
+    /// @brief  Replaces visible with the indices of every sphere touching the frustum, in ascending order
+    void Cull(const Frustum& frustum, std::vector<uint32_t>& visible) const;
+    /// @brief  Same but only for spheres [begin, end), so disjoint ranges can be culled in parallel
+    void Cull(const Frustum& frustum, size_t begin, size_t end, std::vector<uint32_t>& visible) const;
+
+private:
+    /* Padded to a whole SIMD batch, padding lanes never report */
+    size_t m_Count = 0u;
+    std::vector<float> m_X;
+    std::vector<float> m_Y;
+    std::vector<float> m_Z;
+    std::vector<float> m_Radius;
+};
@@ -0,0 +1,36 @@
+﻿#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+/// @brief  64 bit FNV-1a, folded over every input in turn. Cheap and stable across runs and platforms, which is what
+///         the shader pack keys and the Codex's map need. Not collision free, so anything keyed on it alone has to be
+///         able to live with a (very unlikely) false match
+class Fnv1a
+{
+public:
+    void Add(const void* pData, size_t size) noexcept
+    {
+        const auto* pBytes = static_cast<const unsigned char*>(pData);
+        for (size_t i = 0; i < size; i++)
+        {
+            m_Hash = (m_Hash ^ pBytes[i]) * 0x100000001b3ull;
+        }
+    }
+    /// @brief  Strings go in with their terminator so ("ab", "c") and ("a", "bc") don't collide
+    void Add(const char* pString) noexcept
+    {
+        Add(pString ? pString : "", (pString ? strlen(pString) : 0u) + 1u);
+    }
+    uint64_t Get() const noexcept { return m_Hash; }
+
+    static uint64_t Of(std::string_view bytes) noexcept
+    {
+        Fnv1a hash;
+        hash.Add(bytes.data(), bytes.size());
+        return hash.Get();
+    }
+
+private:
+    uint64_t m_Hash = 0xcbf29ce484222325ull;
+};
@@ -1,30 +1,105 @@
 ﻿#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "Maths.h"
 
-template<class T>
+/// @brief  Strip cut value for index type I, D3D always treats an index with every bit set as a restart in strip
+///         topologies (IndexBuffer keeps it a restart when narrowing 32 bit indices down to 16)
+template<class I>
+constexpr I StripRestartIndex = std::numeric_limits<I>::max();
+
+/// @brief  Optional attributes a vertex type can have next to pos. The shape generators, MeshImporter and Transform
+///         only touch the ones V actually has, so position only vertices never pay for them
+template<class V>
+concept VertexHasNormal = requires(V v) { v.n = Math::XMFLOAT3{}; };
+template<class V>
+concept VertexHasTexcoord = requires(V v) { v.tc = Math::XMFLOAT2{}; };
+/* xyz along +u, w is the bitangent (+v) sign relative to n x t */
+template<class V>
+concept VertexHasTangent = requires(V v) { v.tangent = Math::XMFLOAT4{}; };
+
+/// @brief  I is the index type the mesh is built with. Defaults to 32 bit so big meshes can't wrap, IndexBuffer
+///         narrows it back down to 16 bit on upload whenever the vertex count allows it
+template<class T, class I = unsigned int>
 class IndexedTriangleList
 {
+    static_assert(std::numeric_limits<I>::is_integer && !std::numeric_limits<I>::is_signed, "Index type has to be an unsigned integer");
 public:
+    using IndexType = I;
+
     IndexedTriangleList() = default;
-    IndexedTriangleList(std::vector<T> verts_in, std::vector<unsigned short> indices_in)
-        : m_Vertices(verts_in), m_Indices(indices_in)
+    IndexedTriangleList(std::vector<T> verts_in, std::vector<I> indices_in)
+        : m_Vertices(std::move(verts_in)), m_Indices(std::move(indices_in))
     {
         assert(m_Vertices.size() > 2);
         assert(m_Indices.size() % 3 == 0);
+        assert("Too many vertices for the index type" && m_Vertices.size() - 1u <= std::numeric_limits<I>::max());
+    }
+
+    /// @brief  Line list indices with every edge of the triangles exactly once (shared edges aren't drawn twice), in
+    ///         the order the triangles first reference them so the edges keep whatever vertex locality the triangle
+    ///         order had
+    std::vector<I> MakeEdgeIndices() const
+    {
+        std::vector<I> edges;
+        edges.reserve(m_Indices.size());
+        std::unordered_set<uint64_t> seen;
+        seen.reserve(m_Indices.size());
+
+        for (size_t t = 0; t + 2u < m_Indices.size(); t += 3u)
+        {
+            for (size_t k = 0; k < 3u; k++)
+            {
+                const I a = m_Indices[t + k];
+                const I b = m_Indices[t + (k + 1u) % 3u];
+                const uint64_t key = (uint64_t(std::min(a, b)) << 32u) | uint64_t(std::max(a, b));
+                if (a != b && seen.insert(key).second)
+                {
+                    edges.push_back(a);
+                    edges.push_back(b);
+                }
+            }
+        }
+        return edges;
     }
 
+    /// @brief  Normals go through the inverse transpose and tangents through the matrix itself, both renormalized.
+    ///         A mirroring matrix flips the tangent's bitangent sign along with it
     void Transform(Math::FXMMATRIX matrix)
     {
+        Math::XMMATRIX normalMatrix = matrix;
+        float handedness = 1.f;
+        if constexpr (VertexHasNormal<T> || VertexHasTangent<T>)
+        {
+            const Math::XMVECTOR det = Math::XMMatrixDeterminant(matrix);
+            normalMatrix = Math::XMMatrixTranspose(Math::XMMatrixInverse(nullptr, matrix));
+            handedness = Math::XMVectorGetX(det) < 0.f ? -1.f : 1.f;
+        }
+
         for (auto& v : m_Vertices)
         {
             const Math::XMVECTOR pos = Math::XMLoadFloat3(&v.pos);
             Math::XMStoreFloat3(&v.pos, Math::XMVector3Transform(pos, matrix));
+            if constexpr (VertexHasNormal<T>)
+            {
+                const Math::XMVECTOR n = Math::XMVector3TransformNormal(Math::XMLoadFloat3(&v.n), normalMatrix);
+                Math::XMStoreFloat3(&v.n, Math::XMVector3Normalize(n));
+            }
+            if constexpr (VertexHasTangent<T>)
+            {
+                const Math::XMVECTOR t = Math::XMVector3TransformNormal(Math::XMLoadFloat4(&v.tangent), matrix);
+                Math::XMStoreFloat4(&v.tangent, Math::XMVectorSetW(Math::XMVector3Normalize(t), v.tangent.w * handedness));
+            }
         }
     }
     
 public:
     std::vector<T> m_Vertices;
-    std::vector<unsigned short> m_Indices;
+    std::vector<I> m_Indices;
 };
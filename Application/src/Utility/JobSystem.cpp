@@ -0,0 +1,160 @@
+﻿#include "JobSystem.h"
+
+#include <algorithm>
+
+namespace
+{
+    /* Which JobSystem the current thread works for (if any) and which deque is its own */
+    thread_local const JobSystem* tl_pOwner = nullptr;
+    thread_local unsigned int tl_DequeIndex = 0u;
+}
+
+JobSystem::JobSystem(unsigned int numThreads)
+{
+    if (numThreads == 0u)
+    {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    m_Deques.reserve(numThreads);
+    for (unsigned int i = 0; i < numThreads; i++)
+    {
+        m_Deques.push_back(std::make_unique<Deque>());
+    }
+    // Calling thread takes part in every ParallelFor so it counts as one of the threads
+    for (unsigned int i = 1; i < numThreads; i++)
+    {
+        m_Workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_SleepMutex);
+        b_Quit = true;
+    }
+    m_WakeCV.notify_all();
+    for (auto& worker : m_Workers)
+    {
+        worker.join();
+    }
+}
+
+unsigned int JobSystem::GetThreadCount() const noexcept
+{
+    return static_cast<unsigned int>(m_Deques.size());
+}
+
+void JobSystem::ParallelFor(size_t count, size_t grain, const RangeFn& fn)
+{
+    grain = std::max<size_t>(grain, 1u);
+    const size_t numJobs = (count + grain - 1u) / grain;
+    if (numJobs == 0u)
+    {
+        return;
+    }
+    if (numJobs == 1u || m_Workers.empty())
+    {
+        for (size_t begin = 0; begin < count; begin += grain)
+        {
+            fn(begin, std::min(begin + grain, count));
+        }
+        return;
+    }
+
+    // Deal the pieces out round robin starting with our own deque, so every worker starts on local work and
+    // stealing only has to even out the difference
+    std::atomic<size_t> pending = numJobs;
+    const unsigned int self = CurrentDeque();
+    const unsigned int numDeques = GetThreadCount();
+    for (unsigned int d = 0; d < numDeques && d < numJobs; d++)
+    {
+        Deque& deque = *m_Deques[(self + d) % numDeques];
+        std::lock_guard<std::mutex> lock(deque.mutex);
+        for (size_t job = d; job < numJobs; job += numDeques)
+        {
+            const size_t begin = job * grain;
+            deque.jobs.push_back({ &fn, begin, std::min(begin + grain, count), &pending });
+        }
+    }
+
+    m_QueuedJobs.fetch_add(numJobs);
+    {
+        // Sleeping workers check m_QueuedJobs under this lock, taking it here means none of them can miss the wake up
+        std::lock_guard<std::mutex> lock(m_SleepMutex);
+    }
+    m_WakeCV.notify_all();
+
+    // Help out until every piece is done, ours or (when nested) anyone's
+    while (pending.load(std::memory_order_acquire) > 0u)
+    {
+        if (!RunOneJob(self))
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+bool JobSystem::RunOneJob(unsigned int self)
+{
+    Job job;
+    bool bFound = false;
+    {
+        Deque& own = *m_Deques[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.jobs.empty())
+        {
+            job = own.jobs.back();
+            own.jobs.pop_back();
+            bFound = true;
+        }
+    }
+
+    const unsigned int numDeques = GetThreadCount();
+    for (unsigned int d = 1; !bFound && d < numDeques; d++)
+    {
+        Deque& victim = *m_Deques[(self + d) % numDeques];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.jobs.empty())
+        {
+            job = victim.jobs.front();
+            victim.jobs.pop_front();
+            bFound = true;
+        }
+    }
+
+    if (!bFound)
+    {
+        return false;
+    }
+    m_QueuedJobs.fetch_sub(1u);
+    (*job.pFn)(job.begin, job.end);
+    job.pPending->fetch_sub(1u, std::memory_order_release);
+    return true;
+}
+
+unsigned int JobSystem::CurrentDeque() const noexcept
+{
+    return tl_pOwner == this ? tl_DequeIndex : 0u;
+}
+
+void JobSystem::WorkerLoop(unsigned int index)
+{
+    tl_pOwner = this;
+    tl_DequeIndex = index;
+    while (true)
+    {
+        if (RunOneJob(index))
+        {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_SleepMutex);
+        m_WakeCV.wait(lock, [this] { return b_Quit || m_QueuedJobs.load() > 0u; });
+        if (b_Quit)
+        {
+            return;
+        }
+    }
+}
@@ -0,0 +1,65 @@
+﻿#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// @brief  Fixed pool of worker threads with one job deque per thread. A thread pops its own newest job first and
+///         once it runs dry steals the oldest job of another thread, so the load evens out without a shared queue
+///         everybody contends on. Threads that aren't workers (the frame loop) share one extra deque.
+///         ParallelFor is the only way work gets in: the range is cut into grain sized pieces up front, the same way
+///         regardless of thread count or timing, so a body that only writes its own piece gives identical results
+///         single or multi threaded
+class JobSystem
+{
+public:
+    using RangeFn = std::function<void(size_t begin, size_t end)>;
+
+public:
+    /// @brief  numThreads counts the calling thread (it works during ParallelFor), 0 uses every hardware thread
+    explicit JobSystem(unsigned int numThreads = 0u);
+    ~JobSystem();
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    unsigned int GetThreadCount() const noexcept;
+
+    /// @brief  Runs fn over [0, count) in pieces of grain (the last one shorter) and returns once all of them ran.
+    ///         The caller runs pieces too, so nesting a ParallelFor inside a body is fine
+    void ParallelFor(size_t count, size_t grain, const RangeFn& fn);
+
+private:
+    struct Job
+    {
+        const RangeFn* pFn;
+        size_t begin;
+        size_t end;
+        std::atomic<size_t>* pPending;
+    };
+
+    struct alignas(64) Deque
+    {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    /// @brief  Own deque newest first, then the others oldest first. Returns false if there was nothing to run
+    bool RunOneJob(unsigned int self);
+    /// @brief  Deque of the calling thread, 0 unless it's one of our workers
+    unsigned int CurrentDeque() const noexcept;
+    void WorkerLoop(unsigned int index);
+
+private:
+    /* [0] is shared by every non worker thread, [i] belongs to worker i */
+    std::vector<std::unique_ptr<Deque>> m_Deques;
+    std::vector<std::thread> m_Workers;
+    std::atomic<size_t> m_QueuedJobs = 0u;
+
+    std::mutex m_SleepMutex;
+    std::condition_variable m_WakeCV;
+    bool b_Quit = false;
+};
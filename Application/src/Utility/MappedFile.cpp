@@ -0,0 +1,151 @@
+﻿#include "MappedFile.h"
+
+#include <utility>
+#ifdef _WIN32
+#include "RomanceWin.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+    Swap(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        Close();
+        Swap(other);
+    }
+    return *this;
+}
+
+bool MappedFile::Open(const std::string& path)
+{
+    Close();
+#ifdef _WIN32
+    HANDLE hFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (hFile == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(hFile, &size))
+    {
+        CloseHandle(hFile);
+        return false;
+    }
+    m_hFile = hFile;
+    b_Open = true;
+    if (size.QuadPart == 0)
+    {
+        return true;
+    }
+
+    m_hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0u, 0u, nullptr);
+    if (!m_hMapping)
+    {
+        Close();
+        return false;
+    }
+    pData = static_cast<const unsigned char*>(MapViewOfFile(m_hMapping, FILE_MAP_READ, 0u, 0u, 0u));
+    if (!pData)
+    {
+        Close();
+        return false;
+    }
+    m_Size = static_cast<size_t>(size.QuadPart);
+#else
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0)
+    {
+        close(fd);
+        return false;
+    }
+    b_Open = true;
+    if (info.st_size > 0)
+    {
+        // The mapping keeps the file referenced, the descriptor isn't needed past this
+        void* pMapped = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (pMapped == MAP_FAILED)
+        {
+            close(fd);
+            b_Open = false;
+            return false;
+        }
+        pData = static_cast<const unsigned char*>(pMapped);
+        m_Size = static_cast<size_t>(info.st_size);
+    }
+    close(fd);
+#endif
+    return true;
+}
+
+void MappedFile::Close() noexcept
+{
+#ifdef _WIN32
+    if (pData)
+    {
+        UnmapViewOfFile(pData);
+    }
+    if (m_hMapping)
+    {
+        CloseHandle(m_hMapping);
+        m_hMapping = nullptr;
+    }
+    if (m_hFile)
+    {
+        CloseHandle(m_hFile);
+        m_hFile = nullptr;
+    }
+#else
+    if (pData)
+    {
+        munmap(const_cast<unsigned char*>(pData), m_Size);
+    }
+#endif
+    pData = nullptr;
+    m_Size = 0u;
+    b_Open = false;
+}
+
+bool MappedFile::IsOpen() const noexcept
+{
+    return b_Open;
+}
+
+const unsigned char* MappedFile::GetData() const noexcept
+{
+    return pData;
+}
+
+size_t MappedFile::GetSize() const noexcept
+{
+    return m_Size;
+}
+
+void MappedFile::Swap(MappedFile& other) noexcept
+{
+    std::swap(pData, other.pData);
+    std::swap(m_Size, other.m_Size);
+    std::swap(b_Open, other.b_Open);
+#ifdef _WIN32
+    std::swap(m_hFile, other.m_hFile);
+    std::swap(m_hMapping, other.m_hMapping);
+#endif
+}
@@ -0,0 +1,37 @@
+﻿#pragma once
+#include <cstddef>
+#include <string>
+
+/// @brief  Read only memory mapping of a whole file (CreateFileMapping on Windows, mmap elsewhere). Pages get read
+///         in by the OS as they're touched, so opening is cheap no matter the size and nothing is copied
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// @brief  Maps path, closing whatever was mapped before. Returns false if it doesn't exist or can't be mapped
+    bool Open(const std::string& path);
+    void Close() noexcept;
+
+    bool IsOpen() const noexcept;
+    const unsigned char* GetData() const noexcept;
+    size_t GetSize() const noexcept;
+
+private:
+    void Swap(MappedFile& other) noexcept;
+
+private:
+    const unsigned char* pData = nullptr;
+    size_t m_Size = 0u;
+    /* Empty files can't be mapped, they count as open with no data */
+    bool b_Open = false;
+#ifdef _WIN32
+    void* m_hFile = nullptr;
+    void* m_hMapping = nullptr;
+#endif
+};
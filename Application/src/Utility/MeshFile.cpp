@@ -0,0 +1,278 @@
+﻿#include "MeshFile.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <utility>
+
+namespace
+{
+    static_assert(sizeof(float) == 4u, "Mesh files store 32 bit floats");
+
+    /// @brief  Largest index a 16 bit blob can hold, 0xffff itself is the strip cut value
+    constexpr unsigned int s_MaxIndex16 = 0xfffeu;
+
+    /// @brief  Where the element starts in the vertex (end is where the one before it ended, for append aligned ones),
+    ///         or nullopt if it's not a format or doesn't fit in stride
+    std::optional<uint32_t> PlaceElement(uint32_t alignedByteOffset, ElementFormat format, uint32_t end, uint32_t stride) noexcept
+    {
+        const uint32_t offset = alignedByteOffset == APPEND_ALIGNED_ELEMENT ? end : alignedByteOffset;
+        const uint32_t size = GetElementSize(format);
+        if (size == 0u || offset > stride || size > stride - offset)
+        {
+            return std::nullopt;
+        }
+        return offset;
+    }
+
+    uint64_t Align(uint64_t offset, uint64_t alignment) noexcept
+    {
+        return (offset + alignment - 1u) / alignment * alignment;
+    }
+
+    /// @brief  Zero fills up to offset, then writes size bytes of pData
+    void WriteAt(std::ofstream& file, uint64_t offset, const void* pData, size_t size)
+    {
+        for (std::streamoff p = file.tellp(); p < static_cast<std::streamoff>(offset); p++)
+        {
+            file.put('\0');
+        }
+        file.write(static_cast<const char*>(pData), static_cast<std::streamsize>(size));
+    }
+}
+
+MeshFile::LoadException::LoadException(int line, const char* file, std::string path) noexcept
+    : RomanceException(line, file), m_Path(std::move(path))
+{}
+
+const char* MeshFile::LoadException::what() const noexcept
+{
+    m_whatBuffer = std::string(GetType()) + "\n[Mesh] " + m_Path + " is missing or not a valid mesh file\n" + GetOriginString();
+    return m_whatBuffer.c_str();
+}
+
+const char* MeshFile::LoadException::GetType() const noexcept
+{
+    return "Romance Mesh File Exception";
+}
+
+bool MeshFile::Write(const std::string& path, const Contents& contents)
+{
+    assert("Vertex data isn't a whole number of vertices" && contents.VertexStride > 0u && contents.Vertices.size() % contents.VertexStride == 0u);
+    assert("Vertex stride has to be a multiple of 4" && contents.VertexStride % 4u == 0u);
+    assert("A mesh file needs at least one index list" && !contents.Lods.empty());
+
+    std::vector<FileElement> elements(contents.Layout.size());
+    uint32_t end = 0u;
+    for (size_t i = 0; i < elements.size(); i++)
+    {
+        const VertexElementDesc& desc = contents.Layout[i];
+        assert("Mesh files only hold per vertex elements of slot 0" && desc.InputSlot == 0u && !desc.bPerInstance);
+        const auto offset = PlaceElement(desc.AlignedByteOffset, desc.Format, end, contents.VertexStride);
+        assert("Element doesn't fit in the vertex stride" && offset);
+        end = offset.value_or(end) + GetElementSize(desc.Format);
+        assert("Semantic name too long" && strlen(desc.SemanticName) < sizeof(elements[i].semanticName));
+        strncpy(elements[i].semanticName, desc.SemanticName, sizeof(elements[i].semanticName) - 1u);
+        elements[i].semanticIndex = desc.SemanticIndex;
+        elements[i].format = static_cast<uint32_t>(desc.Format);
+        elements[i].alignedByteOffset = desc.AlignedByteOffset;
+    }
+
+    // LODs back to back in one blob, narrowed to 16 bit if every one of them fits
+    std::vector<Lod> lods(contents.Lods.size());
+    std::vector<unsigned int> indices;
+    unsigned int maxIndex = 0u;
+    for (size_t l = 0; l < lods.size(); l++)
+    {
+        lods[l] = { static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(contents.Lods[l].size()) };
+        for (const unsigned int i : contents.Lods[l])
+        {
+            if (i != StripRestartIndex<unsigned int>)
+            {
+                maxIndex = std::max(maxIndex, i);
+            }
+        }
+        indices.insert(indices.end(), contents.Lods[l].begin(), contents.Lods[l].end());
+    }
+    const IndexFormat indexFormat = maxIndex > s_MaxIndex16 ? IndexFormat::UInt32 : IndexFormat::UInt16;
+    std::vector<unsigned short> narrowed;
+    if (indexFormat == IndexFormat::UInt16)
+    {
+        narrowed.resize(indices.size());
+        std::transform(indices.begin(), indices.end(), narrowed.begin(), [](unsigned int i)
+        {
+            return i == StripRestartIndex<unsigned int> ? StripRestartIndex<unsigned short> : static_cast<unsigned short>(i);
+        });
+    }
+    const void* pIndices = narrowed.empty() ? static_cast<const void*>(indices.data()) : narrowed.data();
+    const size_t indicesSize = indices.size() * (narrowed.empty() ? sizeof(unsigned int) : sizeof(unsigned short));
+
+    FileHeader header = {};
+    memcpy(header.magic, s_Magic, sizeof(s_Magic));
+    header.version = s_Version;
+    header.topology = static_cast<uint32_t>(contents.Topology);
+    header.indexFormat = static_cast<uint32_t>(indexFormat);
+    header.vertexStride = contents.VertexStride;
+    header.vertexCount = static_cast<uint32_t>(contents.Vertices.size() / contents.VertexStride);
+    header.indexCount = static_cast<uint32_t>(indices.size());
+    header.elementCount = static_cast<uint32_t>(elements.size());
+    header.lodCount = static_cast<uint32_t>(lods.size());
+    header.boundsMin[0] = contents.Bounds.min.x;
+    header.boundsMin[1] = contents.Bounds.min.y;
+    header.boundsMin[2] = contents.Bounds.min.z;
+    header.boundsMax[0] = contents.Bounds.max.x;
+    header.boundsMax[1] = contents.Bounds.max.y;
+    header.boundsMax[2] = contents.Bounds.max.z;
+    header.elementsOffset = sizeof(FileHeader);
+    header.lodsOffset = header.elementsOffset + elements.size() * sizeof(FileElement);
+    header.verticesOffset = Align(header.lodsOffset + lods.size() * sizeof(Lod), s_BlobAlignment);
+    header.indicesOffset = Align(header.verticesOffset + contents.Vertices.size(), s_BlobAlignment);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        return false;
+    }
+    WriteAt(file, 0u, &header, sizeof(header));
+    WriteAt(file, header.elementsOffset, elements.data(), elements.size() * sizeof(FileElement));
+    WriteAt(file, header.lodsOffset, lods.data(), lods.size() * sizeof(Lod));
+    WriteAt(file, header.verticesOffset, contents.Vertices.data(), contents.Vertices.size());
+    WriteAt(file, header.indicesOffset, pIndices, indicesSize);
+    return static_cast<bool>(file);
+}
+
+bool MeshFile::Open(const std::string& path)
+{
+    Close();
+    if (!m_File.Open(path) || m_File.GetSize() < sizeof(FileHeader))
+    {
+        Close();
+        return false;
+    }
+
+    // Everything gets checked against the file size up front, the getters then trust the header
+    const unsigned char* pData = m_File.GetData();
+    const uint64_t size = m_File.GetSize();
+    const auto* pFileHeader = reinterpret_cast<const FileHeader*>(pData);
+    const uint64_t indexSize = pFileHeader->indexFormat == static_cast<uint32_t>(IndexFormat::UInt16) ? sizeof(unsigned short) : sizeof(unsigned int);
+    const auto Fits = [size](uint64_t offset, uint64_t count, uint64_t stride)
+    {
+        return offset <= size && count <= (size - offset) / stride;
+    };
+    if (memcmp(pFileHeader->magic, s_Magic, sizeof(s_Magic)) != 0 || pFileHeader->version != s_Version
+        || pFileHeader->indexFormat > static_cast<uint32_t>(IndexFormat::UInt32)
+        || pFileHeader->topology > static_cast<uint32_t>(PrimitiveTopology::TriangleStrip)
+        || pFileHeader->vertexStride == 0u || pFileHeader->vertexStride % 4u != 0u || pFileHeader->lodCount == 0u
+        || pFileHeader->verticesOffset % s_BlobAlignment != 0u || pFileHeader->indicesOffset % s_BlobAlignment != 0u
+        || !Fits(pFileHeader->elementsOffset, pFileHeader->elementCount, sizeof(FileElement))
+        || !Fits(pFileHeader->lodsOffset, pFileHeader->lodCount, sizeof(Lod))
+        || !Fits(pFileHeader->verticesOffset, pFileHeader->vertexCount, pFileHeader->vertexStride)
+        || !Fits(pFileHeader->indicesOffset, pFileHeader->indexCount, indexSize))
+    {
+        Close();
+        return false;
+    }
+
+    const auto* pElements = reinterpret_cast<const FileElement*>(pData + pFileHeader->elementsOffset);
+    const auto* pFileLods = reinterpret_cast<const Lod*>(pData + pFileHeader->lodsOffset);
+    for (uint32_t l = 0; l < pFileHeader->lodCount; l++)
+    {
+        if (pFileLods[l].firstIndex > pFileHeader->indexCount || pFileLods[l].indexCount > pFileHeader->indexCount - pFileLods[l].firstIndex)
+        {
+            Close();
+            return false;
+        }
+    }
+    // Every element has to be a format and lie within the stride, or the input layout would read past the vertex
+    m_Layout.reserve(pFileHeader->elementCount);
+    uint32_t end = 0u;
+    for (uint32_t e = 0; e < pFileHeader->elementCount; e++)
+    {
+        const FileElement& element = pElements[e];
+        const auto format = static_cast<ElementFormat>(element.format);
+        const auto offset = PlaceElement(element.alignedByteOffset, format, end, pFileHeader->vertexStride);
+        if (!memchr(element.semanticName, '\0', sizeof(element.semanticName)) || !offset)
+        {
+            Close();
+            return false;
+        }
+        end = *offset + GetElementSize(format);
+        m_Layout.push_back({ element.semanticName, element.semanticIndex, static_cast<ElementFormat>(element.format), 0u,
+            element.alignedByteOffset, false, 0u });
+    }
+
+    pHeader = pFileHeader;
+    pLods = pFileLods;
+    m_Bounds.min = { pHeader->boundsMin[0], pHeader->boundsMin[1], pHeader->boundsMin[2] };
+    m_Bounds.max = { pHeader->boundsMax[0], pHeader->boundsMax[1], pHeader->boundsMax[2] };
+    return true;
+}
+
+void MeshFile::Close() noexcept
+{
+    m_File.Close();
+    pHeader = nullptr;
+    pLods = nullptr;
+    m_Layout.clear();
+    m_Bounds = {};
+}
+
+bool MeshFile::IsOpen() const noexcept
+{
+    return pHeader != nullptr;
+}
+
+const std::vector<VertexElementDesc>& MeshFile::GetLayout() const noexcept
+{
+    return m_Layout;
+}
+
+PrimitiveTopology MeshFile::GetTopology() const noexcept
+{
+    return static_cast<PrimitiveTopology>(pHeader->topology);
+}
+
+const AABB& MeshFile::GetBounds() const noexcept
+{
+    return m_Bounds;
+}
+
+std::span<const unsigned char> MeshFile::GetVertexData() const noexcept
+{
+    return { m_File.GetData() + pHeader->verticesOffset, size_t(pHeader->vertexCount) * pHeader->vertexStride };
+}
+
+unsigned int MeshFile::GetVertexStride() const noexcept
+{
+    return pHeader->vertexStride;
+}
+
+unsigned int MeshFile::GetVertexCount() const noexcept
+{
+    return pHeader->vertexCount;
+}
+
+IndexFormat MeshFile::GetIndexFormat() const noexcept
+{
+    return static_cast<IndexFormat>(pHeader->indexFormat);
+}
+
+size_t MeshFile::GetLodCount() const noexcept
+{
+    return pHeader->lodCount;
+}
+
+const MeshFile::Lod& MeshFile::GetLod(size_t lod) const noexcept
+{
+    assert(lod < GetLodCount());
+    return pLods[lod];
+}
+
+std::span<const unsigned char> MeshFile::GetIndexData(size_t lod) const noexcept
+{
+    const size_t indexSize = GetIndexFormat() == IndexFormat::UInt16 ? sizeof(unsigned short) : sizeof(unsigned int);
+    const Lod& range = GetLod(lod);
+    return { m_File.GetData() + pHeader->indicesOffset + range.firstIndex * indexSize, range.indexCount * indexSize };
+}
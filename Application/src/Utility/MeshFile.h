@@ -0,0 +1,154 @@
+﻿#pragma once
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "RomanceException.h"
+#include "Backend/RenderTypes.h"
+#include "Bounds.h"
+#include "IndexedTriangleList.h"
+#include "MappedFile.h"
+
+/// @brief  Compact binary mesh: a header, the vertex layout (one entry per element, as VertexElementDesc), a LOD table
+///         and the vertex/index blobs, 16 byte aligned. Every LOD is a range of the one index blob over the same
+///         vertices. Opening memory maps the file and hands the blobs out as spans straight into the mapping, so they
+///         go to VertexBuffer/IndexBuffer creation without being copied or parsed.
+///         Indices are stored 16 bit whenever the vertex count allows it, like IndexBuffer does
+class MeshFile
+{
+public:
+    /// @brief  For callers that need the file, Open itself just returns false
+    class LoadException : public RomanceException
+    {
+    public:
+        LoadException(int line, const char* file, std::string path) noexcept;
+        const char* what() const noexcept override;
+        const char* GetType() const noexcept override;
+    private:
+        std::string m_Path;
+    };
+
+    struct Lod
+    {
+        uint32_t firstIndex;
+        uint32_t indexCount;
+    };
+
+    /// @brief  Everything that goes into a file, what the typed Write fills in
+    struct Contents
+    {
+        std::span<const unsigned char>      Vertices;
+        unsigned int                        VertexStride;
+        std::vector<VertexElementDesc>      Layout;
+        PrimitiveTopology                   Topology;
+        AABB                                Bounds;
+        /* Index lists, LOD 0 first */
+        std::vector<std::span<const unsigned int>> Lods;
+    };
+
+public:
+    /// @brief  Writes mesh with its layout (input slot 0, per vertex elements only). lods replaces mesh.m_Indices as
+    ///         the index lists when given (coarser LODs, the edges of a wireframe...), topology says what they hold.
+    ///         Returns false if the file couldn't be written
+    template<class T, class I>
+    static bool Write(const std::string& path, const IndexedTriangleList<T, I>& mesh, const std::vector<VertexElementDesc>& layout,
+        const std::vector<std::vector<I>>& lods = {}, PrimitiveTopology topology = PrimitiveTopology::TriangleList)
+    {
+        static_assert(sizeof(I) <= sizeof(unsigned int), "Index type doesn't fit a mesh file");
+        // Stored widened so the writer only has one index type to deal with, it narrows again on its own
+        const auto Widen = [](const std::vector<I>& indices)
+        {
+            std::vector<unsigned int> wide(indices.size());
+            std::transform(indices.begin(), indices.end(), wide.begin(), [](I i)
+            {
+                return i == StripRestartIndex<I> ? StripRestartIndex<unsigned int> : static_cast<unsigned int>(i);
+            });
+            return wide;
+        };
+        std::vector<std::vector<unsigned int>> wideLods;
+        if (lods.empty())
+        {
+            wideLods.push_back(Widen(mesh.m_Indices));
+        }
+        for (const auto& lod : lods)
+        {
+            wideLods.push_back(Widen(lod));
+        }
+
+        Contents contents = {};
+        contents.Vertices = { reinterpret_cast<const unsigned char*>(mesh.m_Vertices.data()), sizeof(T) * mesh.m_Vertices.size() };
+        contents.VertexStride = sizeof(T);
+        contents.Layout = layout;
+        contents.Topology = topology;
+        contents.Bounds = AABB::FromVertices(mesh.m_Vertices);
+        for (const auto& lod : wideLods)
+        {
+            contents.Lods.push_back(lod);
+        }
+        return Write(path, contents);
+    }
+    static bool Write(const std::string& path, const Contents& contents);
+
+    /// @brief  Maps path, closing whatever was open before. Returns false if it's missing, can't be mapped or isn't a
+    ///         valid mesh file (of this version)
+    bool Open(const std::string& path);
+    void Close() noexcept;
+    bool IsOpen() const noexcept;
+
+    /// @brief  Semantic names point into the mapping, valid as long as the file stays open
+    const std::vector<VertexElementDesc>& GetLayout() const noexcept;
+    PrimitiveTopology GetTopology() const noexcept;
+    /// @brief  Object space bounds of the vertices
+    const AABB& GetBounds() const noexcept;
+
+    std::span<const unsigned char> GetVertexData() const noexcept;
+    unsigned int GetVertexStride() const noexcept;
+    unsigned int GetVertexCount() const noexcept;
+
+    IndexFormat GetIndexFormat() const noexcept;
+    size_t GetLodCount() const noexcept;
+    const Lod& GetLod(size_t lod) const noexcept;
+    /// @brief  Indices of one LOD, in GetIndexFormat
+    std::span<const unsigned char> GetIndexData(size_t lod) const noexcept;
+
+private:
+    struct FileHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t topology;
+        uint32_t indexFormat;
+        uint32_t vertexStride;
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint32_t elementCount;
+        uint32_t lodCount;
+        uint32_t padding;
+        float boundsMin[3];
+        float boundsMax[3];
+        uint64_t elementsOffset;
+        uint64_t lodsOffset;
+        uint64_t verticesOffset;
+        uint64_t indicesOffset;
+    };
+    struct FileElement
+    {
+        char semanticName[32];
+        uint32_t semanticIndex;
+        uint32_t format;
+        uint32_t alignedByteOffset;
+        uint32_t padding;
+    };
+
+    static constexpr char s_Magic[4] = { 'R', 'D', 'M', 'H' };
+    static constexpr uint32_t s_Version = 1u;
+    static constexpr uint64_t s_BlobAlignment = 16u;
+
+private:
+    MappedFile m_File;
+    const FileHeader* pHeader = nullptr;
+    const Lod* pLods = nullptr;
+    std::vector<VertexElementDesc> m_Layout;
+    AABB m_Bounds;
+};
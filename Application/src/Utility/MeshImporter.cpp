@@ -0,0 +1,1333 @@
+﻿#include "MeshImporter.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <charconv>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+#include "MappedFile.h"
+
+#define IMPORT_EXCEPT(reason) MeshImporter::ImportException(__LINE__, __FILE__, path, reason)
+
+namespace
+{
+    /// @brief  Bytes of an OBJ chunk each parse job gets, small enough that every thread gets a few per chunk
+    constexpr size_t s_ObjPieceSize = 1u << 20u;
+    /// @brief  Triangles/vertices per job when generating normals and tangents
+    constexpr size_t s_Grain = 1u << 14u;
+    /// @brief  OBJ corner without a texcoord/normal index
+    constexpr int32_t s_NoIndex = INT32_MIN;
+
+    /// @brief  FNV-1a over a key's bytes, only for padding free keys (compared with ByteEqual)
+    struct ByteHash
+    {
+        template<class T>
+        size_t operator()(const T& key) const noexcept
+        {
+            const auto* pBytes = reinterpret_cast<const unsigned char*>(&key);
+            uint64_t hash = 14695981039346656037ull;
+            for (size_t i = 0; i < sizeof(T); i++)
+            {
+                hash = (hash ^ pBytes[i]) * 1099511628211ull;
+            }
+            return static_cast<size_t>(hash);
+        }
+    };
+
+    struct ByteEqual
+    {
+        template<class T>
+        bool operator()(const T& a, const T& b) const noexcept
+        {
+            return memcmp(&a, &b, sizeof(T)) == 0;
+        }
+    };
+
+    //------------------------------------------------------------------------------------------------------------------
+    // OBJ
+
+    /// @brief  Absolute, 0 based position/texcoord/normal indices of a face corner, what the OBJ vertices weld on
+    struct ObjCorner
+    {
+        int32_t v;
+        int32_t vt;
+        int32_t vn;
+    };
+
+    /// @brief  What a job parsed out of its piece of a chunk. Negative (relative) indices can point into an earlier
+    ///         piece, so they're kept relative to the piece's first element (bit k of relative set for component k)
+    ///         until the counts before it are known
+    struct ObjPiece
+    {
+        std::vector<Math::XMFLOAT3> positions;
+        std::vector<Math::XMFLOAT2> texcoords;
+        std::vector<Math::XMFLOAT3> normals;
+        std::vector<ObjCorner> corners;
+        std::vector<uint8_t> relative;
+        /* Corner count of every face in order */
+        std::vector<uint32_t> faces;
+        bool bValid = true;
+    };
+
+    bool IsSpace(char c) noexcept
+    {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    const char* SkipSpace(const char* p, const char* end) noexcept
+    {
+        while (p < end && IsSpace(*p))
+        {
+            p++;
+        }
+        return p;
+    }
+
+    /// @brief  Parses up to n whitespace separated floats, returns how many there were
+    size_t ParseFloats(const char*& p, const char* end, float* pOut, size_t n) noexcept
+    {
+        size_t i = 0;
+        for (; i < n; i++)
+        {
+            p = SkipSpace(p, end);
+            const auto [next, ec] = std::from_chars(p, end, pOut[i]);
+            if (ec != std::errc{})
+            {
+                break;
+            }
+            p = next;
+        }
+        return i;
+    }
+
+    /// @brief  One of v, v/vt, v//vn, v/vt/vn into out (raw 1 based or negative, s_NoIndex where left out)
+    bool ParseCorner(const char*& p, const char* end, int32_t (&out)[3]) noexcept
+    {
+        out[0] = out[1] = out[2] = s_NoIndex;
+        for (int k = 0; k < 3; k++)
+        {
+            if (p < end && *p != '/')
+            {
+                const auto [next, ec] = std::from_chars(p, end, out[k]);
+                if (ec != std::errc{} || out[k] == 0)
+                {
+                    return false;
+                }
+                p = next;
+            }
+            else if (k == 0)
+            {
+                return false;
+            }
+            if (p >= end || *p != '/')
+            {
+                break;
+            }
+            p++;
+        }
+        return p >= end || IsSpace(*p);
+    }
+
+    void ParseObjPiece(const char* p, const char* end, ObjPiece& piece)
+    {
+        while (p < end)
+        {
+            const char* eol = static_cast<const char*>(memchr(p, '\n', size_t(end - p)));
+            eol = eol ? eol : end;
+            const char* q = SkipSpace(p, eol);
+            const char* keyEnd = q;
+            while (keyEnd < eol && !IsSpace(*keyEnd))
+            {
+                keyEnd++;
+            }
+            const std::string_view key(q, size_t(keyEnd - q));
+            q = keyEnd;
+
+            if (key == "v")
+            {
+                Math::XMFLOAT3 v = { 0.f, 0.f, 0.f };
+                piece.bValid &= ParseFloats(q, eol, &v.x, 3u) == 3u;
+                piece.positions.push_back(v);
+            }
+            else if (key == "vt")
+            {
+                Math::XMFLOAT2 vt = { 0.f, 0.f };
+                piece.bValid &= ParseFloats(q, eol, &vt.x, 2u) >= 1u;
+                piece.texcoords.push_back(vt);
+            }
+            else if (key == "vn")
+            {
+                Math::XMFLOAT3 vn = { 0.f, 0.f, 0.f };
+                piece.bValid &= ParseFloats(q, eol, &vn.x, 3u) == 3u;
+                piece.normals.push_back(vn);
+            }
+            else if (key == "f")
+            {
+                const size_t counts[3] = { piece.positions.size(), piece.texcoords.size(), piece.normals.size() };
+                uint32_t nCorners = 0u;
+                for (q = SkipSpace(q, eol); q < eol; q = SkipSpace(q, eol), nCorners++)
+                {
+                    int32_t raw[3];
+                    if (!ParseCorner(q, eol, raw))
+                    {
+                        piece.bValid = false;
+                        break;
+                    }
+                    // Positive indices are absolute already, negative ones count back from the piece's current end
+                    uint8_t relative = 0u;
+                    for (int k = 0; k < 3; k++)
+                    {
+                        if (raw[k] == s_NoIndex)
+                        {
+                            continue;
+                        }
+                        if (raw[k] < 0)
+                        {
+                            raw[k] += int32_t(counts[k]);
+                            relative |= uint8_t(1u << k);
+                        }
+                        else
+                        {
+                            raw[k] -= 1;
+                        }
+                    }
+                    piece.corners.push_back({ raw[0], raw[1], raw[2] });
+                    piece.relative.push_back(relative);
+                }
+                piece.bValid &= nCorners >= 3u;
+                piece.faces.push_back(nCorners);
+            }
+            p = eol + 1;
+        }
+    }
+
+    /// @brief  Accumulates parsed pieces in file order, resolving and welding their corners as it goes
+    class ObjBuilder
+    {
+    public:
+        explicit ObjBuilder(MeshImporter::Mesh& mesh) : m_Mesh(mesh) {}
+
+        /// @brief  False if a face references something that doesn't exist
+        bool Add(ObjPiece& piece)
+        {
+            const int32_t bases[3] = { int32_t(m_Positions.size()), int32_t(m_Texcoords.size()), int32_t(m_Normals.size()) };
+            m_Positions.insert(m_Positions.end(), piece.positions.begin(), piece.positions.end());
+            m_Texcoords.insert(m_Texcoords.end(), piece.texcoords.begin(), piece.texcoords.end());
+            m_Normals.insert(m_Normals.end(), piece.normals.begin(), piece.normals.end());
+
+            size_t first = 0u;
+            for (const uint32_t nCorners : piece.faces)
+            {
+                uint32_t welded[3] = {};
+                for (uint32_t c = 0; c < nCorners; c++)
+                {
+                    ObjCorner corner = piece.corners[first + c];
+                    int32_t* pIndices[3] = { &corner.v, &corner.vt, &corner.vn };
+                    const size_t counts[3] = { m_Positions.size(), m_Texcoords.size(), m_Normals.size() };
+                    for (int k = 0; k < 3; k++)
+                    {
+                        if (*pIndices[k] == s_NoIndex)
+                        {
+                            continue;
+                        }
+                        if (piece.relative[first + c] & (1u << k))
+                        {
+                            *pIndices[k] += bases[k];
+                        }
+                        if (*pIndices[k] < 0 || size_t(*pIndices[k]) >= counts[k])
+                        {
+                            return false;
+                        }
+                    }
+
+                    // Fan out from the first corner
+                    welded[std::min(c, 2u)] = Weld(corner);
+                    if (c >= 2u)
+                    {
+                        m_Mesh.indices.insert(m_Mesh.indices.end(), { welded[0], welded[1], welded[2] });
+                        welded[1] = welded[2];
+                    }
+                }
+                first += nCorners;
+            }
+            return true;
+        }
+
+        /// @brief  Drops texcoords if no corner had one, normals if any corner went without (they'll be generated)
+        void Finish()
+        {
+            if (m_nMissingTexcoords == m_Mesh.positions.size())
+            {
+                m_Mesh.texcoords.clear();
+            }
+            if (m_nMissingNormals > 0u)
+            {
+                m_Mesh.normals.clear();
+            }
+        }
+
+    private:
+        uint32_t Weld(const ObjCorner& corner)
+        {
+            const auto [it, bInserted] = m_Welded.try_emplace(corner, uint32_t(m_Mesh.positions.size()));
+            if (bInserted)
+            {
+                m_Mesh.positions.push_back(m_Positions[corner.v]);
+                m_Mesh.texcoords.push_back(corner.vt != s_NoIndex ? m_Texcoords[corner.vt] : Math::XMFLOAT2{ 0.f, 0.f });
+                m_Mesh.normals.push_back(corner.vn != s_NoIndex ? m_Normals[corner.vn] : Math::XMFLOAT3{ 0.f, 0.f, 0.f });
+                m_nMissingTexcoords += corner.vt == s_NoIndex;
+                m_nMissingNormals += corner.vn == s_NoIndex;
+            }
+            return it->second;
+        }
+
+    private:
+        MeshImporter::Mesh& m_Mesh;
+        /* Every v/vt/vn so far, faces may reference any of them */
+        std::vector<Math::XMFLOAT3> m_Positions;
+        std::vector<Math::XMFLOAT2> m_Texcoords;
+        std::vector<Math::XMFLOAT3> m_Normals;
+        std::unordered_map<ObjCorner, uint32_t, ByteHash, ByteEqual> m_Welded;
+        size_t m_nMissingTexcoords = 0u;
+        size_t m_nMissingNormals = 0u;
+    };
+
+    //------------------------------------------------------------------------------------------------------------------
+    // glTF
+
+    /// @brief  Just enough of a JSON DOM for the glTF header. Lookups that miss return a static null value, so
+    ///         paths can be chained without checking every step
+    struct JsonValue
+    {
+        enum class Type { Null, Bool, Number, String, Array, Object };
+
+        const JsonValue& operator[](std::string_view key) const noexcept
+        {
+            for (size_t i = 0; type == Type::Object && i < keys.size(); i++)
+            {
+                if (keys[i] == key)
+                {
+                    return elements[i];
+                }
+            }
+            return Null();
+        }
+
+        const JsonValue& operator[](size_t i) const noexcept
+        {
+            return type == Type::Array && i < elements.size() ? elements[i] : Null();
+        }
+
+        bool Has(std::string_view key) const noexcept
+        {
+            return (*this)[key].type != Type::Null;
+        }
+
+        size_t Size() const noexcept
+        {
+            return type == Type::Array ? elements.size() : 0u;
+        }
+
+        double Number(double fallback) const noexcept
+        {
+            return type == Type::Number || type == Type::Bool ? number : fallback;
+        }
+
+        /// @brief  Non negative integers only, anything else (or nothing) is fallback
+        size_t Index(size_t fallback = SIZE_MAX) const noexcept
+        {
+            return type == Type::Number && number >= 0.0 && number == double(size_t(number)) ? size_t(number) : fallback;
+        }
+
+        static const JsonValue& Null() noexcept
+        {
+            static const JsonValue null;
+            return null;
+        }
+
+        Type type = Type::Null;
+        double number = 0.0;
+        std::string string;
+        /* Array elements or object values, keys holds the object's keys in the same order */
+        std::vector<JsonValue> elements;
+        std::vector<std::string> keys;
+    };
+
+    class JsonParser
+    {
+    public:
+        JsonParser(const char* p, const char* end) noexcept : p(p), end(end) {}
+
+        /// @brief  False if the text isn't one valid JSON value
+        bool Parse(JsonValue& out)
+        {
+            return ParseValue(out, 0u) && SkipSpace() == end;
+        }
+
+    private:
+        /// @brief  Deeper than any glTF header nests, keeps bad input from blowing the stack
+        static constexpr unsigned int s_MaxDepth = 64u;
+
+        const char* SkipSpace() noexcept
+        {
+            while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+            {
+                p++;
+            }
+            return p;
+        }
+
+        bool Consume(std::string_view literal) noexcept
+        {
+            if (size_t(end - p) < literal.size() || std::string_view(p, literal.size()) != literal)
+            {
+                return false;
+            }
+            p += literal.size();
+            return true;
+        }
+
+        bool ParseValue(JsonValue& out, unsigned int depth)
+        {
+            if (SkipSpace() == end || depth > s_MaxDepth)
+            {
+                return false;
+            }
+            switch (*p)
+            {
+            case '{':
+                out.type = JsonValue::Type::Object;
+                return ParseContainer(out, '}', depth);
+            case '[':
+                out.type = JsonValue::Type::Array;
+                return ParseContainer(out, ']', depth);
+            case '"':
+                out.type = JsonValue::Type::String;
+                return ParseString(out.string);
+            case 't':
+                out.type = JsonValue::Type::Bool;
+                out.number = 1.0;
+                return Consume("true");
+            case 'f':
+                out.type = JsonValue::Type::Bool;
+                return Consume("false");
+            case 'n':
+                return Consume("null");
+            default:
+            {
+                out.type = JsonValue::Type::Number;
+                const auto [next, ec] = std::from_chars(p, end, out.number);
+                p = next;
+                return ec == std::errc{};
+            }
+            }
+        }
+
+        bool ParseContainer(JsonValue& out, char close, unsigned int depth)
+        {
+            p++;
+            if (SkipSpace() < end && *p == close)
+            {
+                p++;
+                return true;
+            }
+            for (;;)
+            {
+                if (close == '}')
+                {
+                    out.keys.emplace_back();
+                    if (SkipSpace() == end || *p != '"' || !ParseString(out.keys.back()) || SkipSpace() == end || *p++ != ':')
+                    {
+                        return false;
+                    }
+                }
+                if (!ParseValue(out.elements.emplace_back(), depth + 1u) || SkipSpace() == end)
+                {
+                    return false;
+                }
+                if (*p == close)
+                {
+                    p++;
+                    return true;
+                }
+                if (*p++ != ',')
+                {
+                    return false;
+                }
+            }
+        }
+
+        bool ParseString(std::string& out)
+        {
+            for (p++; p < end && *p != '"'; p++)
+            {
+                if (*p != '\\')
+                {
+                    out += *p;
+                    continue;
+                }
+                if (++p == end)
+                {
+                    return false;
+                }
+                switch (*p)
+                {
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u':
+                {
+                    uint32_t code = 0u;
+                    if (!ParseHex4(code))
+                    {
+                        return false;
+                    }
+                    // Surrogate pair, the low half follows as another escape
+                    uint32_t low = 0u;
+                    if (code >= 0xd800u && code < 0xdc00u && Consume("\\u") && ParseHex4(low))
+                    {
+                        code = 0x10000u + ((code - 0xd800u) << 10u) + (low - 0xdc00u);
+                    }
+                    AppendUtf8(out, code);
+                    break;
+                }
+                default: out += *p; break;
+                }
+            }
+            if (p == end)
+            {
+                return false;
+            }
+            p++;
+            return true;
+        }
+
+        /// @brief  Reads the 4 hex digits after p (which is on the 'u'), leaves p on the last one
+        bool ParseHex4(uint32_t& out) noexcept
+        {
+            if (end - p < 5)
+            {
+                return false;
+            }
+            const auto [next, ec] = std::from_chars(p + 1, p + 5, out, 16);
+            p += 4;
+            return ec == std::errc{} && next == p + 1;
+        }
+
+        static void AppendUtf8(std::string& out, uint32_t code)
+        {
+            if (code < 0x80u)
+            {
+                out += char(code);
+            }
+            else if (code < 0x800u)
+            {
+                out += char(0xc0u | (code >> 6u));
+                out += char(0x80u | (code & 0x3fu));
+            }
+            else if (code < 0x10000u)
+            {
+                out += char(0xe0u | (code >> 12u));
+                out += char(0x80u | ((code >> 6u) & 0x3fu));
+                out += char(0x80u | (code & 0x3fu));
+            }
+            else
+            {
+                out += char(0xf0u | (code >> 18u));
+                out += char(0x80u | ((code >> 12u) & 0x3fu));
+                out += char(0x80u | ((code >> 6u) & 0x3fu));
+                out += char(0x80u | (code & 0x3fu));
+            }
+        }
+
+    private:
+        const char* p;
+        const char* end;
+    };
+
+    /// @brief  Vertex as decoded from a primitive, what glTF vertices weld on (no padding, see ByteHash)
+    struct GltfVertex
+    {
+        Math::XMFLOAT3 pos;
+        Math::XMFLOAT3 n;
+        Math::XMFLOAT2 tc;
+        Math::XMFLOAT4 tangent;
+    };
+
+    /// @brief  A primitive and the world transform of the node it's drawn by, decoded on its own job
+    struct GltfPrimitive
+    {
+        const JsonValue* pJson;
+        Math::XMFLOAT4X4 transform;
+
+        std::vector<GltfVertex> vertices;
+        std::vector<uint32_t> indices;
+        bool bNormals = false;
+        bool bTexcoords = false;
+        bool bTangents = false;
+        /* Reason it couldn't be decoded, null if it could */
+        const char* pError = nullptr;
+    };
+
+    class GlbReader
+    {
+    public:
+        GlbReader(const JsonValue& json, std::span<const unsigned char> bin) noexcept : m_Json(json), m_Bin(bin) {}
+
+        /// @brief  Every triangle list primitive of the default scene (or of every mesh if there are no scenes)
+        ///         with its node's world transform, other modes are skipped. Empty with pError set if the node graph
+        ///         isn't a forest or refers to nodes/meshes that don't exist
+        std::vector<GltfPrimitive> CollectPrimitives(const char*& pError) const
+        {
+            std::vector<GltfPrimitive> primitives;
+            const JsonValue& scenes = m_Json["scenes"];
+            if (scenes.Size() == 0u)
+            {
+                for (size_t m = 0; m < m_Json["meshes"].Size(); m++)
+                {
+                    AddMesh(primitives, m, Math::XMMatrixIdentity(), pError);
+                }
+                return primitives;
+            }
+
+            // Every node has at most one parent and roots have none, so a walk from a root only comes back to a
+            // node through a cycle
+            const JsonValue& nodes = m_Json["nodes"];
+            std::vector<unsigned char> parentCounts(nodes.Size(), 0u);
+            for (size_t n = 0; n < nodes.Size(); n++)
+            {
+                const JsonValue& children = nodes[n]["children"];
+                for (size_t i = 0; i < children.Size(); i++)
+                {
+                    const size_t child = children[i].Index();
+                    if (child >= nodes.Size())
+                    {
+                        pError = "node index out of range";
+                        return {};
+                    }
+                    if (++parentCounts[child] > 1u)
+                    {
+                        pError = "node is a child of more than one parent";
+                        return {};
+                    }
+                }
+            }
+            const size_t scene = m_Json["scene"].Index(0u);
+            if (scene >= scenes.Size())
+            {
+                pError = "scene index out of range";
+                return {};
+            }
+            const JsonValue& roots = scenes[scene]["nodes"];
+            std::vector<bool> visited(nodes.Size(), false);
+            for (size_t i = 0; i < roots.Size(); i++)
+            {
+                const size_t root = roots[i].Index();
+                if (root < nodes.Size() && parentCounts[root] > 0u)
+                {
+                    pError = "scene root is a child of another node";
+                    return {};
+                }
+                std::fill(visited.begin(), visited.end(), false);
+                if (!AddNode(primitives, root, Math::XMMatrixIdentity(), 0u, visited, pError))
+                {
+                    return {};
+                }
+            }
+            return primitives;
+        }
+
+        void Decode(GltfPrimitive& primitive) const
+        {
+            const JsonValue& attributes = (*primitive.pJson)["attributes"];
+            std::vector<float> positions, normals, texcoords, tangents;
+            if (!ReadFloats(attributes["POSITION"], 3u, positions, primitive.pError))
+            {
+                primitive.pError = primitive.pError ? primitive.pError : "primitive without positions";
+                return;
+            }
+            const size_t count = positions.size() / 3u;
+            primitive.bNormals = ReadFloats(attributes["NORMAL"], 3u, normals, primitive.pError) && normals.size() == count * 3u;
+            primitive.bTexcoords = ReadFloats(attributes["TEXCOORD_0"], 2u, texcoords, primitive.pError) && texcoords.size() == count * 2u;
+            primitive.bTangents = ReadFloats(attributes["TANGENT"], 4u, tangents, primitive.pError) && tangents.size() == count * 4u;
+            if (primitive.pError || !ReadIndices((*primitive.pJson)["indices"], count, primitive.indices, primitive.pError))
+            {
+                return;
+            }
+
+            // Into world space. Normals go through the inverse transpose, a mirroring transform flips the winding
+            // and the bitangent sign
+            const Math::XMMATRIX transform = Math::XMLoadFloat4x4(&primitive.transform);
+            const Math::XMMATRIX normalTransform = Math::XMMatrixTranspose(Math::XMMatrixInverse(nullptr, transform));
+            const bool bMirrored = Math::XMVectorGetX(Math::XMMatrixDeterminant(transform)) < 0.f;
+            primitive.vertices.resize(count);
+            for (size_t i = 0; i < count; i++)
+            {
+                GltfVertex& v = primitive.vertices[i];
+                v = {};
+                Math::XMStoreFloat3(&v.pos, Math::XMVector3TransformCoord(Math::XMVectorSet(positions[i * 3u], positions[i * 3u + 1u], positions[i * 3u + 2u], 1.f), transform));
+                if (primitive.bNormals)
+                {
+                    const auto n = Math::XMVectorSet(normals[i * 3u], normals[i * 3u + 1u], normals[i * 3u + 2u], 0.f);
+                    Math::XMStoreFloat3(&v.n, Math::XMVector3Normalize(Math::XMVector3TransformNormal(n, normalTransform)));
+                }
+                if (primitive.bTexcoords)
+                {
+                    v.tc = { texcoords[i * 2u], texcoords[i * 2u + 1u] };
+                }
+                if (primitive.bTangents)
+                {
+                    const auto t = Math::XMVectorSet(tangents[i * 4u], tangents[i * 4u + 1u], tangents[i * 4u + 2u], 0.f);
+                    Math::XMStoreFloat4(&v.tangent, Math::XMVector3Normalize(Math::XMVector3TransformNormal(t, transform)));
+                    v.tangent.w = (tangents[i * 4u + 3u] < 0.f) != bMirrored ? -1.f : 1.f;
+                }
+            }
+            if (bMirrored)
+            {
+                for (size_t t = 0; t + 2u < primitive.indices.size(); t += 3u)
+                {
+                    std::swap(primitive.indices[t + 1u], primitive.indices[t + 2u]);
+                }
+            }
+        }
+
+    private:
+        /// @brief  Bounds the recursion, a chain of nodes this deep is a broken (or hostile) file rather than a model
+        static constexpr unsigned int s_MaxNodeDepth = 256u;
+
+        /// @brief  False (with pError set) if the node doesn't exist, is reached again through visited (a cycle) or
+        ///         nests deeper than s_MaxNodeDepth
+        bool AddNode(std::vector<GltfPrimitive>& primitives, size_t index, Math::FXMMATRIX parent, unsigned int depth,
+            std::vector<bool>& visited, const char*& pError) const
+        {
+            const JsonValue& node = m_Json["nodes"][index];
+            if (node.type != JsonValue::Type::Object)
+            {
+                pError = "node index out of range";
+                return false;
+            }
+            if (visited[index])
+            {
+                pError = "node graph has a cycle";
+                return false;
+            }
+            if (depth > s_MaxNodeDepth)
+            {
+                pError = "node hierarchy too deep";
+                return false;
+            }
+            visited[index] = true;
+            const Math::XMMATRIX world = Math::XMMatrixMultiply(GetLocalTransform(node), parent);
+            if (node.Has("mesh") && !AddMesh(primitives, node["mesh"].Index(), world, pError))
+            {
+                return false;
+            }
+            const JsonValue& children = node["children"];
+            for (size_t i = 0; i < children.Size(); i++)
+            {
+                if (!AddNode(primitives, children[i].Index(), world, depth + 1u, visited, pError))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool AddMesh(std::vector<GltfPrimitive>& primitives, size_t index, Math::FXMMATRIX world, const char*& pError) const
+        {
+            if (index >= m_Json["meshes"].Size())
+            {
+                pError = "mesh index out of range";
+                return false;
+            }
+            const JsonValue& meshPrimitives = m_Json["meshes"][index]["primitives"];
+            for (size_t i = 0; i < meshPrimitives.Size(); i++)
+            {
+                if (meshPrimitives[i]["mode"].Index(4u) == 4u)
+                {
+                    GltfPrimitive& primitive = primitives.emplace_back();
+                    primitive.pJson = &meshPrimitives[i];
+                    Math::XMStoreFloat4x4(&primitive.transform, world);
+                }
+            }
+            return true;
+        }
+
+        /// @brief  glTF matrices are column major for column vectors, which read in order is the row vector form
+        ///         DirectXMath wants. TRS is T * R * S there, so S * R * T here
+        static Math::XMMATRIX GetLocalTransform(const JsonValue& node)
+        {
+            const JsonValue& matrix = node["matrix"];
+            if (matrix.Size() == 16u)
+            {
+                Math::XMFLOAT4X4 m;
+                for (size_t i = 0; i < 16u; i++)
+                {
+                    m.m[i / 4u][i % 4u] = float(matrix[i].Number(0.0));
+                }
+                return Math::XMLoadFloat4x4(&m);
+            }
+            const JsonValue& s = node["scale"];
+            const JsonValue& r = node["rotation"];
+            const JsonValue& t = node["translation"];
+            return Math::XMMatrixScaling(float(s[0].Number(1.0)), float(s[1].Number(1.0)), float(s[2].Number(1.0)))
+                * Math::XMMatrixRotationQuaternion(Math::XMVectorSet(float(r[0].Number(0.0)), float(r[1].Number(0.0)), float(r[2].Number(0.0)), float(r[3].Number(1.0))))
+                * Math::XMMatrixTranslation(float(t[0].Number(0.0)), float(t[1].Number(0.0)), float(t[2].Number(0.0)));
+        }
+
+        /// @brief  Where accessor's elements are in the BIN chunk: first element and the distance between elements.
+        ///         Null (with pError set) if it's out of bounds, sparse, or in a buffer other than the BIN chunk
+        const unsigned char* Locate(const JsonValue& accessor, size_t elementSize, size_t& stride, const char*& pError) const
+        {
+            const JsonValue& view = m_Json["bufferViews"][accessor["bufferView"].Index()];
+            const size_t count = accessor["count"].Index(0u);
+            if (accessor.Has("sparse") || !accessor.Has("bufferView"))
+            {
+                pError = "sparse or buffer view less accessors aren't supported";
+                return nullptr;
+            }
+            if (view.type != JsonValue::Type::Object)
+            {
+                pError = "buffer view index out of range";
+                return nullptr;
+            }
+            if (view["buffer"].Index() != 0u || m_Json["buffers"][0u].Has("uri"))
+            {
+                pError = "only buffers embedded in the .glb are supported";
+                return nullptr;
+            }
+            stride = view["byteStride"].Index(elementSize);
+            const size_t viewOffset = view["byteOffset"].Index(0u);
+            const size_t viewLength = view["byteLength"].Index(0u);
+            const size_t offset = accessor["byteOffset"].Index(0u);
+            if (count == 0u || stride < elementSize || viewOffset > m_Bin.size() || viewLength > m_Bin.size() - viewOffset
+                || offset > viewLength || (count - 1u) > (viewLength - offset - std::min(elementSize, viewLength - offset)) / stride
+                || offset + elementSize > viewLength)
+            {
+                pError = "accessor out of bounds";
+                return nullptr;
+            }
+            return m_Bin.data() + viewOffset + offset;
+        }
+
+        static size_t GetComponentSize(size_t componentType) noexcept
+        {
+            switch (componentType)
+            {
+            case 5120u: case 5121u: return 1u;
+            case 5122u: case 5123u: return 2u;
+            case 5125u: case 5126u: return 4u;
+            default: return 0u;
+            }
+        }
+
+        static size_t GetComponentCount(const std::string& type) noexcept
+        {
+            return type == "SCALAR" ? 1u : type == "VEC2" ? 2u : type == "VEC3" ? 3u : type == "VEC4" ? 4u : 0u;
+        }
+
+        /// @brief  Reads an attribute accessor as components floats per element, normalizing integer types (the
+        ///         only way glTF allows them for attributes). False without an error if there's no such attribute
+        bool ReadFloats(const JsonValue& index, size_t components, std::vector<float>& out, const char*& pError) const
+        {
+            if (index.type == JsonValue::Type::Null)
+            {
+                return false;
+            }
+            const JsonValue& accessor = m_Json["accessors"][index.Index()];
+            if (accessor.type != JsonValue::Type::Object)
+            {
+                pError = "accessor index out of range";
+                return false;
+            }
+            const size_t componentType = accessor["componentType"].Index(0u);
+            const size_t componentSize = GetComponentSize(componentType);
+            if (componentSize == 0u || GetComponentCount(accessor["type"].string) != components
+                || (componentType != 5126u && accessor["normalized"].Number(0.0) == 0.0))
+            {
+                pError = "unsupported attribute format";
+                return false;
+            }
+            size_t stride = 0u;
+            const unsigned char* pData = Locate(accessor, componentSize * components, stride, pError);
+            if (!pData)
+            {
+                return false;
+            }
+
+            const size_t count = accessor["count"].Index(0u);
+            out.resize(count * components);
+            for (size_t i = 0; i < count; i++)
+            {
+                for (size_t c = 0; c < components; c++)
+                {
+                    const unsigned char* pComponent = pData + i * stride + c * componentSize;
+                    out[i * components + c] = ReadComponent(pComponent, componentType);
+                }
+            }
+            return true;
+        }
+
+        static float ReadComponent(const unsigned char* pComponent, size_t componentType) noexcept
+        {
+            switch (componentType)
+            {
+            case 5120u: { int8_t v; memcpy(&v, pComponent, 1u); return std::max(float(v) / 127.f, -1.f); }
+            case 5121u: { uint8_t v; memcpy(&v, pComponent, 1u); return float(v) / 255.f; }
+            case 5122u: { int16_t v; memcpy(&v, pComponent, 2u); return std::max(float(v) / 32767.f, -1.f); }
+            case 5123u: { uint16_t v; memcpy(&v, pComponent, 2u); return float(v) / 65535.f; }
+            default: { float v; memcpy(&v, pComponent, 4u); return v; }
+            }
+        }
+
+        /// @brief  A primitive without indices draws its vertices in order
+        bool ReadIndices(const JsonValue& index, size_t vertexCount, std::vector<uint32_t>& out, const char*& pError) const
+        {
+            if (index.type == JsonValue::Type::Null)
+            {
+                out.resize(vertexCount - vertexCount % 3u);
+                for (size_t i = 0; i < out.size(); i++)
+                {
+                    out[i] = uint32_t(i);
+                }
+                return true;
+            }
+            const JsonValue& accessor = m_Json["accessors"][index.Index()];
+            if (accessor.type != JsonValue::Type::Object)
+            {
+                pError = "accessor index out of range";
+                return false;
+            }
+            const size_t componentType = accessor["componentType"].Index(0u);
+            if ((componentType != 5121u && componentType != 5123u && componentType != 5125u) || accessor["type"].string != "SCALAR")
+            {
+                pError = "unsupported index format";
+                return false;
+            }
+            const size_t size = GetComponentSize(componentType);
+            size_t stride = 0u;
+            const unsigned char* pData = Locate(accessor, size, stride, pError);
+            if (!pData)
+            {
+                return false;
+            }
+            const size_t count = accessor["count"].Index(0u);
+            out.resize(count - count % 3u);
+            for (size_t i = 0; i < out.size(); i++)
+            {
+                uint32_t v = 0u;
+                // Little endian like the file, the low bytes are the value
+                memcpy(&v, pData + i * stride, size);
+                if (v >= vertexCount)
+                {
+                    pError = "index out of range";
+                    return false;
+                }
+                out[i] = v;
+            }
+            return true;
+        }
+
+    private:
+        const JsonValue& m_Json;
+        std::span<const unsigned char> m_Bin;
+    };
+
+    //------------------------------------------------------------------------------------------------------------------
+    // Shared
+
+    Math::XMVECTOR LoadFloat3(const Math::XMFLOAT3& v) noexcept
+    {
+        return Math::XMLoadFloat3(&v);
+    }
+
+    /// @brief  Unit vector perpendicular to n, for when nothing else decides a tangent's direction
+    Math::XMVECTOR AnyPerpendicular(Math::FXMVECTOR n) noexcept
+    {
+        const auto axis = std::abs(Math::XMVectorGetY(n)) < 0.99f ? Math::XMVectorSet(0.f, 1.f, 0.f, 0.f) : Math::XMVectorSet(1.f, 0.f, 0.f, 0.f);
+        return Math::XMVector3Normalize(Math::XMVector3Cross(axis, n));
+    }
+}
+
+MeshImporter::ImportException::ImportException(int line, const char* file, std::string path, std::string reason) noexcept
+    : RomanceException(line, file), m_Path(std::move(path)), m_Reason(std::move(reason))
+{}
+
+const char* MeshImporter::ImportException::what() const noexcept
+{
+    m_whatBuffer = std::string(GetType()) + "\n[Import] " + m_Path + ": " + m_Reason + "\n" + GetOriginString();
+    return m_whatBuffer.c_str();
+}
+
+const char* MeshImporter::ImportException::GetType() const noexcept
+{
+    return "Romance Mesh Import Exception";
+}
+
+MeshImporter::Mesh MeshImporter::Load(const std::string& path, JobSystem& jobs, const Options& options)
+{
+    const size_t dot = path.find_last_of('.');
+    std::string extension = dot == std::string::npos ? std::string() : path.substr(dot + 1u);
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return char(std::tolower(c)); });
+    if (extension == "obj")
+    {
+        return LoadObj(path, jobs, options);
+    }
+    if (extension == "glb")
+    {
+        return LoadGlb(path, jobs, options);
+    }
+    throw IMPORT_EXCEPT("unknown extension, expected .obj or .glb");
+}
+
+MeshImporter::Mesh MeshImporter::LoadObj(const std::string& path, JobSystem& jobs, const Options& options)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        throw IMPORT_EXCEPT("can't be opened");
+    }
+
+    Mesh mesh;
+    ObjBuilder builder(mesh);
+    const size_t chunkSize = std::max<size_t>(options.chunkSize, 1u);
+    std::vector<char> buffer;
+    size_t carried = 0u;
+    for (bool bEnd = false; !bEnd;)
+    {
+        // Read on from the partial line the last chunk ended with
+        buffer.resize(carried + chunkSize);
+        file.read(buffer.data() + carried, std::streamsize(chunkSize));
+        const size_t size = carried + size_t(file.gcount());
+        bEnd = size_t(file.gcount()) < chunkSize;
+
+        size_t cut = size;
+        if (!bEnd)
+        {
+            const auto last = std::find(std::make_reverse_iterator(buffer.begin() + ptrdiff_t(size)), buffer.rend(), '\n');
+            if (last == buffer.rend())
+            {
+                // A line longer than a chunk, keep reading until it ends
+                carried = size;
+                continue;
+            }
+            cut = size_t(buffer.rend() - last);
+        }
+
+        // Pieces end at line ends too, each parsed by its own job and added in order
+        std::vector<std::pair<size_t, size_t>> ranges;
+        for (size_t begin = 0u; begin < cut;)
+        {
+            const char* pSplit = begin + s_ObjPieceSize < cut ? static_cast<const char*>(memchr(buffer.data() + begin + s_ObjPieceSize, '\n', cut - begin - s_ObjPieceSize)) : nullptr;
+            const size_t end = pSplit ? size_t(pSplit - buffer.data()) + 1u : cut;
+            ranges.emplace_back(begin, end);
+            begin = end;
+        }
+        std::vector<ObjPiece> pieces(ranges.size());
+        jobs.ParallelFor(pieces.size(), 1u, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                ParseObjPiece(buffer.data() + ranges[i].first, buffer.data() + ranges[i].second, pieces[i]);
+            }
+        });
+        for (ObjPiece& piece : pieces)
+        {
+            if (!piece.bValid)
+            {
+                throw IMPORT_EXCEPT("malformed v/vt/vn/f line");
+            }
+            if (!builder.Add(piece))
+            {
+                throw IMPORT_EXCEPT("face references a vertex that doesn't exist");
+            }
+            piece = {};
+        }
+
+        carried = size - cut;
+        memmove(buffer.data(), buffer.data() + cut, carried);
+    }
+    builder.Finish();
+    if (mesh.indices.empty() || mesh.positions.size() < 3u)
+    {
+        throw IMPORT_EXCEPT("no triangles");
+    }
+
+    // OBJ texcoords start at the bottom left, D3D's at the top left
+    Finish(mesh, jobs, options, true);
+    return mesh;
+}
+
+MeshImporter::Mesh MeshImporter::LoadGlb(const std::string& path, JobSystem& jobs, const Options& options)
+{
+    MappedFile file;
+    if (!file.Open(path))
+    {
+        throw IMPORT_EXCEPT("can't be opened");
+    }
+
+    // 12 byte header ("glTF", version 2, length) then chunks of (length, type, data), JSON first then optionally BIN
+    constexpr uint32_t glbMagic = 0x46546c67u;
+    constexpr uint32_t jsonChunk = 0x4e4f534au;
+    constexpr uint32_t binChunk = 0x004e4942u;
+    const unsigned char* pData = file.GetData();
+    const size_t size = file.GetSize();
+    uint32_t header[3] = {};
+    if (size < sizeof(header) || (memcpy(header, pData, sizeof(header)), header[0] != glbMagic) || header[1] != 2u || header[2] > size)
+    {
+        throw IMPORT_EXCEPT("not a glTF 2.0 binary file");
+    }
+    std::string_view jsonText;
+    std::span<const unsigned char> bin;
+    for (size_t offset = sizeof(header); offset + 8u <= header[2];)
+    {
+        uint32_t chunk[2];
+        memcpy(chunk, pData + offset, sizeof(chunk));
+        offset += sizeof(chunk);
+        if (chunk[0] > header[2] - offset)
+        {
+            throw IMPORT_EXCEPT("chunk runs past the end of the file");
+        }
+        if (chunk[1] == jsonChunk && jsonText.empty())
+        {
+            jsonText = { reinterpret_cast<const char*>(pData + offset), chunk[0] };
+        }
+        else if (chunk[1] == binChunk && bin.empty())
+        {
+            bin = { pData + offset, chunk[0] };
+        }
+        offset += (chunk[0] + 3u) & ~size_t(3u);
+    }
+    JsonValue json;
+    if (!JsonParser(jsonText.data(), jsonText.data() + jsonText.size()).Parse(json))
+    {
+        throw IMPORT_EXCEPT("invalid JSON chunk");
+    }
+
+    const GlbReader reader(json, bin);
+    const char* pError = nullptr;
+    std::vector<GltfPrimitive> primitives = reader.CollectPrimitives(pError);
+    if (pError)
+    {
+        throw IMPORT_EXCEPT(pError);
+    }
+    jobs.ParallelFor(primitives.size(), 1u, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            reader.Decode(primitives[i]);
+        }
+    });
+
+    // Attributes only count if every primitive has them, the rest get generated
+    bool bNormals = true;
+    bool bTexcoords = false;
+    bool bTangents = true;
+    for (const GltfPrimitive& primitive : primitives)
+    {
+        if (primitive.pError)
+        {
+            throw IMPORT_EXCEPT(primitive.pError);
+        }
+        bNormals &= primitive.bNormals;
+        bTexcoords |= primitive.bTexcoords;
+        bTangents &= primitive.bTangents;
+    }
+
+    Mesh mesh;
+    std::unordered_map<GltfVertex, uint32_t, ByteHash, ByteEqual> welded;
+    std::vector<uint32_t> remap;
+    for (GltfPrimitive& primitive : primitives)
+    {
+        remap.resize(primitive.vertices.size());
+        for (size_t i = 0; i < remap.size(); i++)
+        {
+            GltfVertex& v = primitive.vertices[i];
+            v.n = bNormals ? v.n : Math::XMFLOAT3{ 0.f, 0.f, 0.f };
+            v.tangent = bTangents ? v.tangent : Math::XMFLOAT4{ 0.f, 0.f, 0.f, 0.f };
+            const auto [it, bInserted] = welded.try_emplace(v, uint32_t(mesh.positions.size()));
+            if (bInserted)
+            {
+                mesh.positions.push_back(v.pos);
+                mesh.normals.push_back(v.n);
+                mesh.texcoords.push_back(v.tc);
+                mesh.tangents.push_back(v.tangent);
+            }
+            remap[i] = it->second;
+        }
+        for (const uint32_t index : primitive.indices)
+        {
+            mesh.indices.push_back(remap[index]);
+        }
+        primitive = {};
+    }
+    if (!bNormals)
+    {
+        mesh.normals.clear();
+    }
+    if (!bTexcoords)
+    {
+        mesh.texcoords.clear();
+    }
+    if (!bTangents)
+    {
+        mesh.tangents.clear();
+    }
+    if (mesh.indices.empty() || mesh.positions.size() < 3u)
+    {
+        throw IMPORT_EXCEPT("no triangle list primitives");
+    }
+
+    Finish(mesh, jobs, options, false);
+    return mesh;
+}
+
+void MeshImporter::GenerateNormals(Mesh& mesh, JobSystem& jobs)
+{
+    const size_t nTriangles = mesh.indices.size() / 3u;
+    std::vector<Math::XMFLOAT3> faceNormals(nTriangles);
+    jobs.ParallelFor(nTriangles, s_Grain, [&](size_t begin, size_t end)
+    {
+        for (size_t t = begin; t < end; t++)
+        {
+            // Unnormalized, so bigger faces weigh more
+            const auto p0 = LoadFloat3(mesh.positions[mesh.indices[t * 3u]]);
+            const auto e1 = Math::XMVectorSubtract(LoadFloat3(mesh.positions[mesh.indices[t * 3u + 1u]]), p0);
+            const auto e2 = Math::XMVectorSubtract(LoadFloat3(mesh.positions[mesh.indices[t * 3u + 2u]]), p0);
+            Math::XMStoreFloat3(&faceNormals[t], Math::XMVector3Cross(e1, e2));
+        }
+    });
+
+    // Vertices split only by their texcoords still share a normal
+    std::unordered_map<Math::XMFLOAT3, uint32_t, ByteHash, ByteEqual> groups;
+    groups.reserve(mesh.positions.size());
+    std::vector<uint32_t> group(mesh.positions.size());
+    for (size_t i = 0; i < group.size(); i++)
+    {
+        group[i] = groups.try_emplace(mesh.positions[i], uint32_t(groups.size())).first->second;
+    }
+    std::vector<Math::XMFLOAT3> sums(groups.size(), Math::XMFLOAT3{ 0.f, 0.f, 0.f });
+    for (size_t i = 0; i < nTriangles * 3u; i++)
+    {
+        Math::XMFLOAT3& sum = sums[group[mesh.indices[i]]];
+        Math::XMStoreFloat3(&sum, Math::XMVectorAdd(LoadFloat3(sum), LoadFloat3(faceNormals[i / 3u])));
+    }
+
+    mesh.normals.resize(mesh.positions.size());
+    jobs.ParallelFor(mesh.normals.size(), s_Grain, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            const auto sum = LoadFloat3(sums[group[i]]);
+            const bool bDegenerate = Math::XMVectorGetX(Math::XMVector3LengthSq(sum)) == 0.f;
+            Math::XMStoreFloat3(&mesh.normals[i], bDegenerate ? Math::XMVectorSet(0.f, 1.f, 0.f, 0.f) : Math::XMVector3Normalize(sum));
+        }
+    });
+}
+
+void MeshImporter::GenerateTangents(Mesh& mesh, JobSystem& jobs)
+{
+    assert("Tangents need normals" && mesh.normals.size() == mesh.positions.size());
+    std::vector<Math::XMFLOAT3> tangentSums(mesh.positions.size(), Math::XMFLOAT3{ 0.f, 0.f, 0.f });
+    std::vector<Math::XMFLOAT3> bitangentSums(mesh.positions.size(), Math::XMFLOAT3{ 0.f, 0.f, 0.f });
+    if (!mesh.texcoords.empty())
+    {
+        // Lengyel, the directions u and v increase in over each triangle, summed onto its vertices
+        const size_t nTriangles = mesh.indices.size() / 3u;
+        std::vector<std::pair<Math::XMFLOAT3, Math::XMFLOAT3>> faceFrames(nTriangles);
+        jobs.ParallelFor(nTriangles, s_Grain, [&](size_t begin, size_t end)
+        {
+            for (size_t t = begin; t < end; t++)
+            {
+                const unsigned int* i = &mesh.indices[t * 3u];
+                const auto p0 = LoadFloat3(mesh.positions[i[0]]);
+                const auto e1 = Math::XMVectorSubtract(LoadFloat3(mesh.positions[i[1]]), p0);
+                const auto e2 = Math::XMVectorSubtract(LoadFloat3(mesh.positions[i[2]]), p0);
+                const float du1 = mesh.texcoords[i[1]].x - mesh.texcoords[i[0]].x;
+                const float dv1 = mesh.texcoords[i[1]].y - mesh.texcoords[i[0]].y;
+                const float du2 = mesh.texcoords[i[2]].x - mesh.texcoords[i[0]].x;
+                const float dv2 = mesh.texcoords[i[2]].y - mesh.texcoords[i[0]].y;
+                const float det = du1 * dv2 - du2 * dv1;
+                const float r = det != 0.f ? 1.f / det : 0.f;
+                Math::XMStoreFloat3(&faceFrames[t].first, Math::XMVectorScale(Math::XMVectorSubtract(Math::XMVectorScale(e1, dv2), Math::XMVectorScale(e2, dv1)), r));
+                Math::XMStoreFloat3(&faceFrames[t].second, Math::XMVectorScale(Math::XMVectorSubtract(Math::XMVectorScale(e2, du1), Math::XMVectorScale(e1, du2)), r));
+            }
+        });
+        for (size_t i = 0; i < nTriangles * 3u; i++)
+        {
+            Math::XMFLOAT3& tangent = tangentSums[mesh.indices[i]];
+            Math::XMFLOAT3& bitangent = bitangentSums[mesh.indices[i]];
+            Math::XMStoreFloat3(&tangent, Math::XMVectorAdd(LoadFloat3(tangent), LoadFloat3(faceFrames[i / 3u].first)));
+            Math::XMStoreFloat3(&bitangent, Math::XMVectorAdd(LoadFloat3(bitangent), LoadFloat3(faceFrames[i / 3u].second)));
+        }
+    }
+
+    // Gram-Schmidt against the normal, w says which way the bitangent (n x t) has to point
+    mesh.tangents.resize(mesh.positions.size());
+    jobs.ParallelFor(mesh.tangents.size(), s_Grain, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            const auto n = LoadFloat3(mesh.normals[i]);
+            const auto t = LoadFloat3(tangentSums[i]);
+            auto ortho = Math::XMVectorSubtract(t, Math::XMVectorScale(n, Math::XMVectorGetX(Math::XMVector3Dot(n, t))));
+            const bool bDegenerate = Math::XMVectorGetX(Math::XMVector3LengthSq(ortho)) < 1e-12f;
+            ortho = bDegenerate ? AnyPerpendicular(n) : Math::XMVector3Normalize(ortho);
+            const float handedness = Math::XMVectorGetX(Math::XMVector3Dot(Math::XMVector3Cross(n, ortho), LoadFloat3(bitangentSums[i]))) < 0.f ? -1.f : 1.f;
+            Math::XMStoreFloat4(&mesh.tangents[i], Math::XMVectorSetW(ortho, handedness));
+        }
+    });
+}
+
+void MeshImporter::Finish(Mesh& mesh, JobSystem& jobs, const Options& options, bool bFlipTexcoordV)
+{
+    if (bFlipTexcoordV)
+    {
+        for (Math::XMFLOAT2& tc : mesh.texcoords)
+        {
+            tc.y = 1.f - tc.y;
+        }
+    }
+    const bool bNeedTangents = options.bGenerateTangents && mesh.tangents.empty();
+    if ((options.bGenerateNormals || bNeedTangents) && mesh.normals.empty())
+    {
+        GenerateNormals(mesh, jobs);
+    }
+    if (bNeedTangents)
+    {
+        GenerateTangents(mesh, jobs);
+    }
+
+    if (options.bFlipHandedness)
+    {
+        // Mirroring z flips the winding, and the bitangent along with it
+        for (size_t i = 0; i < mesh.positions.size(); i++)
+        {
+            mesh.positions[i].z = -mesh.positions[i].z;
+            if (!mesh.normals.empty())
+            {
+                mesh.normals[i].z = -mesh.normals[i].z;
+            }
+            if (!mesh.tangents.empty())
+            {
+                mesh.tangents[i].z = -mesh.tangents[i].z;
+                mesh.tangents[i].w = -mesh.tangents[i].w;
+            }
+        }
+        for (size_t t = 0; t + 2u < mesh.indices.size(); t += 3u)
+        {
+            std::swap(mesh.indices[t + 1u], mesh.indices[t + 2u]);
+        }
+    }
+}
@@ -0,0 +1,104 @@
+﻿#pragma once
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "RomanceException.h"
+#include "IndexedTriangleList.h"
+#include "JobSystem.h"
+#include "Maths.h"
+
+/// @brief  Imports OBJ (.obj) and binary glTF 2.0 (.glb) files into an IndexedTriangleList of any vertex type.
+///         OBJ text is read in fixed size chunks, each cut into line aligned pieces that get parsed across the
+///         JobSystem, so a multi hundred MB file never sits in memory whole. A .glb gets memory mapped and its
+///         primitives decoded in parallel. Either way vertices are welded through a hash table (an OBJ corner's
+///         position/texcoord/normal indices, the full attributes for glTF), and normals/tangents the file doesn't have
+///         are generated if the vertex type has room for them.
+///         V always needs pos (XMFLOAT3), n (XMFLOAT3), tc (XMFLOAT2) and tangent (XMFLOAT4, w = bitangent sign) are
+///         filled in if V has them
+class MeshImporter
+{
+public:
+    class ImportException : public RomanceException
+    {
+    public:
+        ImportException(int line, const char* file, std::string path, std::string reason) noexcept;
+        const char* what() const noexcept override;
+        const char* GetType() const noexcept override;
+    private:
+        std::string m_Path;
+        std::string m_Reason;
+    };
+
+    struct Options
+    {
+        /* Make whatever the file doesn't have (only when the vertex type wants them, see Import) */
+        bool bGenerateNormals = true;
+        bool bGenerateTangents = true;
+        /* Both formats are right handed, this mirrors z and the winding into the renderer's left handed space */
+        bool bFlipHandedness = true;
+        /* Bytes of OBJ text read (and parsed in parallel) at a time */
+        size_t chunkSize = 16u << 20u;
+    };
+
+    /// @brief  Welded attributes of everything in a file. normals/texcoords/tangents are either empty or one per
+    ///         position, indices are a triangle list
+    struct Mesh
+    {
+        std::vector<Math::XMFLOAT3> positions;
+        std::vector<Math::XMFLOAT3> normals;
+        std::vector<Math::XMFLOAT2> texcoords;
+        std::vector<Math::XMFLOAT4> tangents;
+        std::vector<unsigned int> indices;
+    };
+
+public:
+    /// @brief  Imports path as V vertices, only generating the attributes V actually has
+    template<class V, class I = unsigned int>
+    static IndexedTriangleList<V, I> Import(const std::string& path, JobSystem& jobs, Options options = {})
+    {
+        options.bGenerateNormals &= VertexHasNormal<V> || VertexHasTangent<V>;
+        options.bGenerateTangents &= VertexHasTangent<V>;
+        Mesh mesh = Load(path, jobs, options);
+        if (mesh.positions.size() - 1u > std::numeric_limits<I>::max())
+        {
+            throw ImportException(__LINE__, __FILE__, path, "too many vertices for the index type");
+        }
+
+        std::vector<V> vertices(mesh.positions.size());
+        for (size_t i = 0; i < vertices.size(); i++)
+        {
+            vertices[i].pos = mesh.positions[i];
+            if constexpr (VertexHasNormal<V>)
+            {
+                vertices[i].n = mesh.normals.empty() ? Math::XMFLOAT3{ 0.f, 0.f, 0.f } : mesh.normals[i];
+            }
+            if constexpr (VertexHasTexcoord<V>)
+            {
+                vertices[i].tc = mesh.texcoords.empty() ? Math::XMFLOAT2{ 0.f, 0.f } : mesh.texcoords[i];
+            }
+            if constexpr (VertexHasTangent<V>)
+            {
+                vertices[i].tangent = mesh.tangents.empty() ? Math::XMFLOAT4{ 0.f, 0.f, 0.f, 1.f } : mesh.tangents[i];
+            }
+        }
+        std::vector<I> indices(mesh.indices.begin(), mesh.indices.end());
+        return { std::move(vertices), std::move(indices) };
+    }
+
+    /// @brief  Picks the format from the extension. Throws an ImportException if the file can't be read, isn't
+    ///         valid, uses something that isn't supported or has no triangles
+    static Mesh Load(const std::string& path, JobSystem& jobs, const Options& options);
+    static Mesh LoadObj(const std::string& path, JobSystem& jobs, const Options& options);
+    static Mesh LoadGlb(const std::string& path, JobSystem& jobs, const Options& options);
+
+    /// @brief  Smooth area weighted normals, averaged over every vertex at the same position (so UV seams don't show)
+    static void GenerateNormals(Mesh& mesh, JobSystem& jobs);
+    /// @brief  Per vertex tangent frames from the texcoords, orthogonalized against the normals (which it needs).
+    ///         Without texcoords any tangent perpendicular to the normal is used
+    static void GenerateTangents(Mesh& mesh, JobSystem& jobs);
+
+private:
+    /// @brief  Generates what's missing and options asks for, then flips handedness
+    static void Finish(Mesh& mesh, JobSystem& jobs, const Options& options, bool bFlipTexcoordV);
+};
@@ -0,0 +1,427 @@
+﻿#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace MeshOptimizer
+{
+    namespace
+    {
+        /*--------------------------------------------------------------------------------------------------------------
+        * Forsyth scoring, see "Linear-Speed Vertex Cache Optimisation" (Tom Forsyth, 2006)
+        *--------------------------------------------------------------------------------------------------------------*/
+
+        constexpr unsigned int s_ScoreCacheSize = 32u;
+        constexpr unsigned int s_MaxValence = 32u;
+        constexpr float s_CacheDecayPower = 1.5f;
+        constexpr float s_LastTriangleScore = 0.75f;
+        constexpr float s_ValenceBoostScale = 2.f;
+        constexpr float s_ValenceBoostPower = 0.5f;
+
+        /* Overdraw sort keys spread less than this fraction of the mesh's extent count as all the same */
+        constexpr float s_DegenerateKeySpread = 1e-4f;
+
+        struct ScoreTables
+        {
+            float cache[s_ScoreCacheSize];
+            float valence[s_MaxValence + 1];
+
+            ScoreTables()
+            {
+                for (unsigned int i = 0; i < s_ScoreCacheSize; i++)
+                {
+                    // The 3 vertices of the last triangle get a fixed score, so it doesn't just pick a neighbour
+                    // sharing an edge with it every time (which would make long thin strips)
+                    cache[i] = i < 3u ? s_LastTriangleScore :
+                        std::pow(1.f - float(i - 3u) / float(s_ScoreCacheSize - 3u), s_CacheDecayPower);
+                }
+                valence[0] = 0.f;
+                for (unsigned int i = 1; i <= s_MaxValence; i++)
+                {
+                    // Boost vertices with few triangles left so they get finished off instead of lingering
+                    valence[i] = s_ValenceBoostScale * std::pow(float(i), -s_ValenceBoostPower);
+                }
+            }
+        };
+
+        float VertexScore(int cachePosition, unsigned int liveTriangles) noexcept
+        {
+            static const ScoreTables s_Tables;
+            if (liveTriangles == 0u)
+            {
+                return -1.f;
+            }
+            const float cacheScore = cachePosition >= 0 ? s_Tables.cache[cachePosition] : 0.f;
+            return cacheScore + s_Tables.valence[std::min(liveTriangles, s_MaxValence)];
+        }
+
+        /// @brief  FIFO cache, vertex v is still cached if less than cacheSize misses happened since it was loaded.
+        ///         timestamps has to start out zeroed and time at cacheSize + 1
+        bool CacheMiss(std::vector<unsigned int>& timestamps, unsigned int& time, unsigned int v, unsigned int cacheSize) noexcept
+        {
+            if (time - timestamps[v] > cacheSize)
+            {
+                timestamps[v] = time++;
+                return true;
+            }
+            return false;
+        }
+    }
+
+    Stats Analyze(const std::vector<unsigned int>& indices, size_t vertexCount, size_t vertexStride, unsigned int cacheSize)
+    {
+        Stats stats;
+        if (indices.empty() || vertexCount == 0u)
+        {
+            return stats;
+        }
+
+        constexpr size_t lineSize = 64u;
+        constexpr unsigned int lineCacheSize = 256u;    // 16KB worth of lines
+        const size_t numLines = (vertexCount * vertexStride + lineSize - 1u) / lineSize;
+
+        std::vector<unsigned int> timestamps(vertexCount, 0u);
+        std::vector<unsigned int> lineTimestamps(numLines, 0u);
+        std::vector<bool> referenced(vertexCount, false);
+        unsigned int time = cacheSize + 1u;
+        unsigned int lineTime = lineCacheSize + 1u;
+        size_t misses = 0u;
+        size_t linesFetched = 0u;
+        size_t unique = 0u;
+
+        for (const unsigned int v : indices)
+        {
+            if (!referenced[v])
+            {
+                referenced[v] = true;
+                unique++;
+            }
+            if (!CacheMiss(timestamps, time, v, cacheSize))
+            {
+                continue;
+            }
+            misses++;
+
+            // Only a vertex the shader actually runs for gets fetched
+            const size_t firstLine = v * vertexStride / lineSize;
+            const size_t lastLine = ((v + 1u) * vertexStride - 1u) / lineSize;
+            for (size_t line = firstLine; line <= lastLine; line++)
+            {
+                if (CacheMiss(lineTimestamps, lineTime, static_cast<unsigned int>(line), lineCacheSize))
+                {
+                    linesFetched++;
+                }
+            }
+        }
+
+        stats.acmr = float(misses) / float(indices.size() / 3u);
+        stats.atvr = float(misses) / float(unique);
+        stats.overfetch = float(linesFetched * lineSize) / float(unique * vertexStride);
+        return stats;
+    }
+
+    void OptimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount)
+    {
+        const size_t triCount = indices.size() / 3u;
+        if (triCount == 0u)
+        {
+            return;
+        }
+
+        // Vertex -> triangles adjacency, the first liveCount[v] entries of a vertex's range are its unemitted triangles
+        std::vector<unsigned int> liveCount(vertexCount, 0u);
+        for (const unsigned int v : indices)
+        {
+            liveCount[v]++;
+        }
+        std::vector<unsigned int> offsets(vertexCount + 1u, 0u);
+        for (size_t v = 0; v < vertexCount; v++)
+        {
+            offsets[v + 1u] = offsets[v] + liveCount[v];
+        }
+        std::vector<unsigned int> adjacency(indices.size());
+        {
+            std::vector<unsigned int> cursor(offsets.begin(), offsets.end() - 1);
+            for (size_t i = 0; i < indices.size(); i++)
+            {
+                adjacency[cursor[indices[i]]++] = static_cast<unsigned int>(i / 3u);
+            }
+        }
+
+        std::vector<int> cachePosition(vertexCount, -1);
+        std::vector<float> vertexScore(vertexCount);
+        for (size_t v = 0; v < vertexCount; v++)
+        {
+            vertexScore[v] = VertexScore(-1, liveCount[v]);
+        }
+
+        std::vector<float> triScore(triCount);
+        std::vector<bool> emitted(triCount, false);
+        size_t best = 0u;
+        for (size_t t = 0; t < triCount; t++)
+        {
+            triScore[t] = vertexScore[indices[t * 3u]] + vertexScore[indices[t * 3u + 1u]] + vertexScore[indices[t * 3u + 2u]];
+            if (triScore[t] > triScore[best])
+            {
+                best = t;
+            }
+        }
+
+        constexpr size_t noTriangle = ~size_t(0);
+        std::vector<unsigned int> output;
+        output.reserve(indices.size());
+        unsigned int cache[s_ScoreCacheSize + 3u];
+        unsigned int newCache[s_ScoreCacheSize + 3u];
+        size_t cacheCount = 0u;
+        size_t scan = 0u;
+
+        for (size_t n = 0; n < triCount; n++)
+        {
+            // Nothing in the cache has triangles left, carry on with the next one in the original order
+            if (best == noTriangle)
+            {
+                while (emitted[scan])
+                {
+                    scan++;
+                }
+                best = scan;
+            }
+
+            const unsigned int* tri = &indices[best * 3u];
+            emitted[best] = true;
+            output.insert(output.end(), tri, tri + 3);
+
+            size_t newCount = 0u;
+            for (unsigned int k = 0; k < 3u; k++)
+            {
+                const unsigned int v = tri[k];
+
+                // Drop the triangle from the vertex's live range
+                unsigned int* live = &adjacency[offsets[v]];
+                unsigned int* it = std::find(live, live + liveCount[v], static_cast<unsigned int>(best));
+                std::swap(*it, live[liveCount[v] - 1u]);
+                liveCount[v]--;
+
+                // Degenerate triangles reference the same vertex more than once
+                if (std::find(newCache, newCache + newCount, v) == newCache + newCount)
+                {
+                    newCache[newCount++] = v;
+                }
+            }
+            for (size_t i = 0; i < cacheCount; i++)
+            {
+                if (cache[i] != tri[0] && cache[i] != tri[1] && cache[i] != tri[2])
+                {
+                    newCache[newCount++] = cache[i];
+                }
+            }
+
+            // Entries past the cache size just got evicted, they're rescored (and their triangles) like the rest
+            for (size_t i = 0; i < newCount; i++)
+            {
+                const unsigned int v = newCache[i];
+                cachePosition[v] = i < s_ScoreCacheSize ? static_cast<int>(i) : -1;
+                vertexScore[v] = VertexScore(cachePosition[v], liveCount[v]);
+            }
+
+            best = noTriangle;
+            float bestScore = -1.f;
+            for (size_t i = 0; i < newCount; i++)
+            {
+                const unsigned int v = newCache[i];
+                for (unsigned int j = 0; j < liveCount[v]; j++)
+                {
+                    const unsigned int t = adjacency[offsets[v] + j];
+                    triScore[t] = vertexScore[indices[t * 3u]] + vertexScore[indices[t * 3u + 1u]] + vertexScore[indices[t * 3u + 2u]];
+                    if (triScore[t] > bestScore)
+                    {
+                        bestScore = triScore[t];
+                        best = t;
+                    }
+                }
+            }
+
+            cacheCount = std::min<size_t>(newCount, s_ScoreCacheSize);
+            std::copy(newCache, newCache + cacheCount, cache);
+        }
+
+        indices.swap(output);
+    }
+
+    void OptimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<Math::XMFLOAT3>& positions, float threshold, unsigned int cacheSize)
+    {
+        const size_t triCount = indices.size() / 3u;
+        if (triCount == 0u)
+        {
+            return;
+        }
+
+        // Misses per triangle of the current (cache optimized) order
+        std::vector<unsigned int> timestamps(positions.size(), 0u);
+        unsigned int time = cacheSize + 1u;
+        std::vector<unsigned char> misses(triCount);
+        for (size_t t = 0; t < triCount; t++)
+        {
+            unsigned char m = 0u;
+            for (unsigned int k = 0; k < 3u; k++)
+            {
+                m += CacheMiss(timestamps, time, indices[t * 3u + k], cacheSize) ? 1u : 0u;
+            }
+            misses[t] = m;
+        }
+
+        // Hard boundaries: all 3 vertices missed, so nothing before this triangle was still in use and reordering
+        // across it is free. Soft boundaries split those further wherever the cluster so far is within threshold of
+        // the cluster's ACMR and the next triangle mostly misses anyway
+        std::vector<size_t> clusters;
+        {
+            std::vector<size_t> hard;
+            for (size_t t = 0; t < triCount; t++)
+            {
+                if (t == 0u || misses[t] == 3u)
+                {
+                    hard.push_back(t);
+                }
+            }
+            hard.push_back(triCount);
+
+            for (size_t c = 0; c + 1u < hard.size(); c++)
+            {
+                const size_t begin = hard[c];
+                const size_t end = hard[c + 1u];
+                size_t clusterMisses = 0u;
+                for (size_t t = begin; t < end; t++)
+                {
+                    clusterMisses += misses[t];
+                }
+                const float clusterAcmr = float(clusterMisses) / float(end - begin);
+
+                clusters.push_back(begin);
+                size_t start = begin;
+                size_t runningMisses = 0u;
+                for (size_t t = begin; t + 1u < end; t++)
+                {
+                    runningMisses += misses[t];
+                    if (misses[t + 1u] >= 2u && float(runningMisses) / float(t + 1u - start) <= threshold * clusterAcmr)
+                    {
+                        clusters.push_back(t + 1u);
+                        start = t + 1u;
+                        runningMisses = 0u;
+                    }
+                }
+            }
+            clusters.push_back(triCount);
+        }
+
+        // Area weighted centroid + normal of every cluster, and of the whole mesh
+        struct Cluster
+        {
+            size_t begin;
+            size_t end;
+            float sortKey;
+        };
+        const size_t numClusters = clusters.size() - 1u;
+        std::vector<Cluster> order(numClusters);
+        std::vector<float> centroids(numClusters * 3u, 0.f);
+        std::vector<float> normals(numClusters * 3u, 0.f);
+        float meshCentroid[3] = {};
+        float meshArea = 0.f;
+
+        for (size_t c = 0; c < numClusters; c++)
+        {
+            float clusterArea = 0.f;
+            for (size_t t = clusters[c]; t < clusters[c + 1u]; t++)
+            {
+                const Math::XMFLOAT3& p0 = positions[indices[t * 3u]];
+                const Math::XMFLOAT3& p1 = positions[indices[t * 3u + 1u]];
+                const Math::XMFLOAT3& p2 = positions[indices[t * 3u + 2u]];
+                const float e1[3] = { p1.x - p0.x, p1.y - p0.y, p1.z - p0.z };
+                const float e2[3] = { p2.x - p0.x, p2.y - p0.y, p2.z - p0.z };
+                const float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+                const float area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+                const float centre[3] = { (p0.x + p1.x + p2.x) / 3.f, (p0.y + p1.y + p2.y) / 3.f, (p0.z + p1.z + p2.z) / 3.f };
+
+                for (unsigned int k = 0; k < 3u; k++)
+                {
+                    centroids[c * 3u + k] += centre[k] * area;
+                    normals[c * 3u + k] += n[k];
+                    meshCentroid[k] += centre[k] * area;
+                }
+                clusterArea += area;
+            }
+            meshArea += clusterArea;
+            for (unsigned int k = 0; k < 3u; k++)
+            {
+                centroids[c * 3u + k] /= clusterArea > 0.f ? clusterArea : 1.f;
+            }
+        }
+        for (unsigned int k = 0; k < 3u; k++)
+        {
+            meshCentroid[k] /= meshArea > 0.f ? meshArea : 1.f;
+        }
+
+        for (size_t c = 0; c < numClusters; c++)
+        {
+            const float* n = &normals[c * 3u];
+            const float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            float key = 0.f;
+            if (length > 0.f)
+            {
+                for (unsigned int k = 0; k < 3u; k++)
+                {
+                    key += (centroids[c * 3u + k] - meshCentroid[k]) * n[k] / length;
+                }
+            }
+            order[c] = { clusters[c], clusters[c + 1u], key };
+        }
+
+        // On a flat (or otherwise uniformly facing) mesh every key is 0 up to float noise, sorting on that would
+        // only shuffle the clusters and cost vertex locality for no overdraw gain. Keep the cache order then
+        float extentMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+        float extentMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        for (const unsigned int v : indices)
+        {
+            const float p[3] = { positions[v].x, positions[v].y, positions[v].z };
+            for (unsigned int k = 0; k < 3u; k++)
+            {
+                extentMin[k] = std::min(extentMin[k], p[k]);
+                extentMax[k] = std::max(extentMax[k], p[k]);
+            }
+        }
+        const float extent = std::sqrt(Math::square(extentMax[0] - extentMin[0]) + Math::square(extentMax[1] - extentMin[1])
+            + Math::square(extentMax[2] - extentMin[2]));
+        const auto [minKey, maxKey] = std::minmax_element(order.begin(), order.end(),
+            [](const Cluster& a, const Cluster& b) { return a.sortKey < b.sortKey; });
+        if (maxKey->sortKey - minKey->sortKey <= s_DegenerateKeySpread * extent)
+        {
+            return;
+        }
+
+        // Clusters facing away from the centre are the likely occluders, draw those first
+        std::stable_sort(order.begin(), order.end(), [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+        std::vector<unsigned int> output;
+        output.reserve(indices.size());
+        for (const Cluster& cluster : order)
+        {
+            output.insert(output.end(), indices.begin() + cluster.begin * 3u, indices.begin() + cluster.end * 3u);
+        }
+        indices.swap(output);
+    }
+
+    std::vector<unsigned int> MakeFetchRemap(std::vector<unsigned int>& indices, size_t vertexCount)
+    {
+        std::vector<unsigned int> remap(vertexCount, ~0u);
+        unsigned int next = 0u;
+        for (unsigned int& v : indices)
+        {
+            if (remap[v] == ~0u)
+            {
+                remap[v] = next++;
+            }
+            v = remap[v];
+        }
+        return remap;
+    }
+}
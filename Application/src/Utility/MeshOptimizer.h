@@ -0,0 +1,87 @@
+﻿#pragma once
+#include <vector>
+
+#include "IndexedTriangleList.h"
+
+/// Load time optimization of indexed triangle lists, in the order they should run:
+/// - OptimizeVertexCache:  Forsyth's greedy triangle reordering so vertices get reused while still in the post
+///                         transform cache, which directly cuts vertex shader invocations
+/// - OptimizeOverdraw:     Splits the cache optimized order into clusters and sorts those outside in (Sander et al.
+///                         "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw"), only where it costs
+///                         little cache efficiency
+/// - MakeFetchRemap:       Renumbers vertices in first use order so vertex fetch walks the buffer linearly
+/// Optimize runs all three on an IndexedTriangleList and reports the cache stats before and after.
+/// The cache order trades fetch locality for transform reuse: on a regular grid like the tessellated Plane, which is
+/// already scanned row by row (overfetch ~1.0), Forsyth's order comes back to rows after they left the fetch cache, so
+/// overfetch goes up (1.0003 -> 1.59 on the 128x128 plane) while ACMR drops by a third (1.008 -> 0.674). Whether that
+/// pays depends on whether vertex shading or fetch bandwidth is the bottleneck, check the report before switching a
+/// mesh over
+
+namespace MeshOptimizer
+{
+    /// @brief  Post transform cache size the analysis simulates (FIFO, roughly what current hardware behaves like)
+    constexpr unsigned int DefaultCacheSize = 16u;
+
+    struct Stats
+    {
+        float acmr = 0.f;       /* Average cache miss ratio, vertex shader invocations per triangle (0.5 ideal, 3 worst) */
+        float atvr = 0.f;       /* Average transformed vertex ratio, invocations per vertex (1 ideal) */
+        float overfetch = 0.f;  /* Bytes fetched from the vertex buffer in 64 byte lines / bytes of vertices used (1 ideal) */
+    };
+
+    struct Report
+    {
+        Stats before;
+        Stats after;
+    };
+
+    Stats Analyze(const std::vector<unsigned int>& indices, size_t vertexCount, size_t vertexStride, unsigned int cacheSize = DefaultCacheSize);
+
+    void OptimizeVertexCache(std::vector<unsigned int>& indices, size_t vertexCount);
+    /// @brief  threshold is how much worse (ACMR) than the cache optimized order a cluster is allowed to get
+    void OptimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<Math::XMFLOAT3>& positions, float threshold = 1.05f, unsigned int cacheSize = DefaultCacheSize);
+    /// @brief  Rewrites indices in first use order and returns the old -> new vertex mapping (~0u for vertices no
+    ///         triangle references, those get dropped)
+    std::vector<unsigned int> MakeFetchRemap(std::vector<unsigned int>& indices, size_t vertexCount);
+
+    /// @brief  Runs the whole pipeline on mesh. T needs a Math::XMFLOAT3 pos (same as IndexedTriangleList::Transform)
+    template<class T, class I>
+    Report Optimize(IndexedTriangleList<T, I>& mesh, float overdrawThreshold = 1.05f)
+    {
+        std::vector<unsigned int> indices(mesh.m_Indices.begin(), mesh.m_Indices.end());
+
+        Report report;
+        report.before = Analyze(indices, mesh.m_Vertices.size(), sizeof(T));
+
+        OptimizeVertexCache(indices, mesh.m_Vertices.size());
+
+        std::vector<Math::XMFLOAT3> positions(mesh.m_Vertices.size());
+        for (size_t i = 0; i < positions.size(); i++)
+        {
+            positions[i] = mesh.m_Vertices[i].pos;
+        }
+        OptimizeOverdraw(indices, positions, overdrawThreshold);
+
+        const std::vector<unsigned int> remap = MakeFetchRemap(indices, mesh.m_Vertices.size());
+        std::vector<T> vertices(mesh.m_Vertices.size());
+        size_t used = 0u;
+        for (size_t i = 0; i < remap.size(); i++)
+        {
+            if (remap[i] != ~0u)
+            {
+                vertices[remap[i]] = mesh.m_Vertices[i];
+                used++;
+            }
+        }
+        vertices.resize(used);
+        mesh.m_Vertices = std::move(vertices);
+
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            mesh.m_Indices[i] = static_cast<I>(indices[i]);
+        }
+
+        report.after = Analyze(indices, mesh.m_Vertices.size(), sizeof(T));
+        return report;
+    }
+}
@@ -1,22 +1,67 @@
 ﻿#pragma once
 #include "IndexedTriangleList.h"
+#include "JobSystem.h"
 #include <array>
+#include <cmath>
 
 // NOTE: Winding number is important, unless culling is disabled in RasterizerState, will auto cull back faces
+// NOTE: I is the index type of the generated list (see IndexedTriangleList), asserts if the shape has more vertices than
+//       it can address
+// NOTE: V always needs pos, n/tc/tangent get analytic values only if V has them (see VertexHasNormal etc.). Texcoords
+//       have v pointing down the texture, tangents are along +u. Shapes that need hard edges or UV seams for those
+//       split their vertices, position only vertices keep the smallest shared vertex set
+// NOTE: Tesselated shapes allocate their exact vertex/index counts up front and fill them row by row. Passing a
+//       JobSystem spreads the rows over it, every row only writes its own vertices/indices so the result is identical
+
+/// @brief  What the tesselated generators share: angle tables instead of a rotation matrix per vertex, and row loops
+///         that optionally run on a JobSystem
+class ShapeRows
+{
+public:
+    /// @brief  {cos, sin} of offset + i * step for i in [0, count)
+    static std::vector<Math::XMFLOAT2> CosSinTable(int count, float step, float offset = 0.f)
+    {
+        std::vector<Math::XMFLOAT2> table(static_cast<size_t>(count));
+        for (int i = 0; i < count; i++)
+        {
+            const float angle = offset + step * float(i);
+            table[i] = { std::cos(angle), std::sin(angle) };
+        }
+        return table;
+    }
+
+    /// @brief  Calls fn(beginRow, endRow) over [0, nRows), split across pJobs in pieces of about s_VerticesPerJob
+    ///         when there's a JobSystem, all at once otherwise
+    template<class F>
+    static void ForEach(size_t nRows, size_t rowSize, JobSystem* pJobs, const F& fn)
+    {
+        if (pJobs == nullptr || nRows * rowSize <= s_VerticesPerJob)
+        {
+            fn(size_t(0), nRows);
+            return;
+        }
+        const size_t rowsPerJob = std::max(size_t(1), s_VerticesPerJob / std::max(size_t(1), rowSize));
+        pJobs->ParallelFor(nRows, rowsPerJob, [&fn](size_t begin, size_t end) { fn(begin, end); });
+    }
+
+private:
+    static constexpr size_t s_VerticesPerJob = 1u << 14u;
+};
 
 class Plane
 {
 public:
-    template<class V>
-    static IndexedTriangleList<V> MakeTesselated(int divisions_x, int divisions_y)
+    template<class V, class I = unsigned int>
+    static IndexedTriangleList<V, I> MakeTesselated(int divisions_x, int divisions_y, JobSystem* pJobs = nullptr)
     {
         assert(divisions_x >= 1);
         assert(divisions_y >= 1);
         
         constexpr float width = 2.f;
         constexpr float height = 2.f;
-        const int nVertices_x = divisions_x + 1;
-        const int nVertices_y = divisions_y + 1;
+        const size_t nVertices_x = size_t(divisions_x) + 1u;
+        const size_t nVertices_y = size_t(divisions_y) + 1u;
+        assert("Too many vertices for the index type" && nVertices_x * nVertices_y - 1u <= std::numeric_limits<I>::max());
 
         std::vector<V> vertices(nVertices_x * nVertices_y);
 
@@ -24,59 +69,108 @@ public:
         constexpr float side_y = height / 2.f;
         const float divisionSize_x = width / float(divisions_x);
         const float divisionSize_y = height / float(divisions_y);
-        const auto bottomLeft = Math::XMVectorSet(-side_x, -side_y, 0.f, 0.f);
 
-        for (int y = 0, i = 0; y < nVertices_y; y++)
+        ShapeRows::ForEach(nVertices_y, nVertices_x, pJobs, [&](size_t yBegin, size_t yEnd)
         {
-            const float y_pos = float(y) * divisionSize_y;
-            for (int x = 0; x < nVertices_x; x++, i++)
+            for (size_t y = yBegin, i = yBegin * nVertices_x; y < yEnd; y++)
             {
-                const auto v = Math::XMVectorAdd(bottomLeft, Math::XMVectorSet(float(x) * divisionSize_x, y_pos, 0.f, 0.f));
-                Math::XMStoreFloat3(&vertices[i].pos, v);
+                const float y_pos = -side_y + float(y) * divisionSize_y;
+                for (size_t x = 0; x < nVertices_x; x++, i++)
+                {
+                    vertices[i].pos = { -side_x + float(x) * divisionSize_x, y_pos, 0.f };
+                    // Faces -z (the front with this winding), u along +x and v along -y
+                    if constexpr (VertexHasNormal<V>)
+                    {
+                        vertices[i].n = { 0.f, 0.f, -1.f };
+                    }
+                    if constexpr (VertexHasTexcoord<V>)
+                    {
+                        vertices[i].tc = { float(x) / float(divisions_x), 1.f - float(y) / float(divisions_y) };
+                    }
+                    if constexpr (VertexHasTangent<V>)
+                    {
+                        vertices[i].tangent = { 1.f, 0.f, 0.f, 1.f };
+                    }
+                }
             }
-        }
+        });
 
-        std::vector<unsigned short> indices;
-        indices.reserve(Math::square(divisions_x * divisions_y) * 6);
+        std::vector<I> indices(size_t(divisions_x) * size_t(divisions_y) * 6u);
+        ShapeRows::ForEach(size_t(divisions_y), size_t(divisions_x), pJobs, [&](size_t yBegin, size_t yEnd)
         {
             // vertex to index lambda
             const auto vxy2i = [nVertices_x](size_t x, size_t y)
             {
-                return (unsigned short)(y * nVertices_x + x);
+                return static_cast<I>(y * nVertices_x + x);
             };
 
-            for (size_t y = 0; y < divisions_y; y++)
+            I* pOut = indices.data() + yBegin * size_t(divisions_x) * 6u;
+            for (size_t y = yBegin; y < yEnd; y++)
             {
-                for (size_t x = 0; x < divisions_x; x++)
+                for (size_t x = 0; x < size_t(divisions_x); x++)
                 {
-                    const std::array<unsigned short, 4> indexArray =
+                    const std::array<I, 4> indexArray =
                     { vxy2i(x,y), vxy2i(x+1,y), vxy2i(x,y+1), vxy2i(x+1,y+1) };
-                    indices.push_back(indexArray[0]);
-                    indices.push_back(indexArray[2]);
-                    indices.push_back(indexArray[1]);
-                    indices.push_back(indexArray[1]);
-                    indices.push_back(indexArray[2]);
-                    indices.push_back(indexArray[3]);
+                    *pOut++ = indexArray[0];
+                    *pOut++ = indexArray[2];
+                    *pOut++ = indexArray[1];
+                    *pOut++ = indexArray[1];
+                    *pOut++ = indexArray[2];
+                    *pOut++ = indexArray[3];
                 }
             }
-        }
+        });
 
         return {std::move(vertices), std::move(indices)};
     }
 
-    template<class V>
-    static IndexedTriangleList<V> Make()
+    /// @brief  Same triangles as MakeTesselated (same vertices, same winding) as a TriangleStrip, one strip per row
+    ///         separated by StripRestartIndex. ~2 indices per quad instead of 6
+    template<class I = unsigned int>
+    static std::vector<I> MakeTesselatedStripIndices(int divisions_x, int divisions_y)
+    {
+        assert(divisions_x >= 1);
+        assert(divisions_y >= 1);
+
+        const size_t nVertices_x = size_t(divisions_x) + 1u;
+        assert("Too many vertices for the index type" && nVertices_x * (size_t(divisions_y) + 1u) - 1u < StripRestartIndex<I>);
+
+        std::vector<I> indices;
+        indices.reserve(size_t(divisions_y) * (nVertices_x * 2u + 1u));
+        for (size_t y = 0; y < size_t(divisions_y); y++)
+        {
+            if (y > 0u)
+            {
+                indices.push_back(StripRestartIndex<I>);
+            }
+            // Zig zag between the row and the one above, even triangles are (x,y) (x,y+1) (x+1,y) like the list
+            for (size_t x = 0; x < nVertices_x; x++)
+            {
+                indices.push_back(static_cast<I>(y * nVertices_x + x));
+                indices.push_back(static_cast<I>((y + 1u) * nVertices_x + x));
+            }
+        }
+        return indices;
+    }
+
+    template<class V, class I = unsigned int>
+    static IndexedTriangleList<V, I> Make()
     {
-        return MakeTesselated<V>(1, 1);
+        return MakeTesselated<V, I>(1, 1);
     }
 };
 
 class Cube
 {
 public:
-    template<class V>
-    static IndexedTriangleList<V> Make()
+    template<class V, class I = unsigned int>
+    static IndexedTriangleList<V, I> Make()
     {
+        if constexpr (VertexHasNormal<V> || VertexHasTexcoord<V> || VertexHasTangent<V>)
+        {
+            return MakeIndependentFaces<V, I>();
+        }
+
         constexpr float Size = 1.f/2.f;
         std::vector<Math::XMFLOAT3> vertices =
         {
@@ -96,7 +190,7 @@ public:
             verts[i].pos = vertices[i];
         }
 
-        std::vector<unsigned short> indices =
+        std::vector<I> indices =
         {
             // Front Face Quad (Fixed (-) Z)
             0, 2, 1,
@@ -120,153 +214,482 @@ public:
 
         return {std::move(verts), indices};
     }
+
+    /// @brief  Same triangles as Make<V> as a TriangleStrip, each face a 4 index strip separated by StripRestartIndex
+    template<class V, class I = unsigned int>
+    static std::vector<I> MakeStripIndices()
+    {
+        if constexpr (VertexHasNormal<V> || VertexHasTexcoord<V> || VertexHasTangent<V>)
+        {
+            std::vector<I> indices;
+            indices.reserve(6u * 5u);
+            for (unsigned int f = 0; f < 6u; f++)
+            {
+                if (f > 0u)
+                {
+                    indices.push_back(StripRestartIndex<I>);
+                }
+                for (const unsigned int k : { 0u, 1u, 2u, 3u })
+                {
+                    indices.push_back(static_cast<I>(f * 4u + k));
+                }
+            }
+            return indices;
+        }
+
+        // Every face starts with its first list triangle turned so the shared edge is in the middle
+        constexpr auto R = StripRestartIndex<I>;
+        return {
+            0, 2, 1, 3, R, // Front
+            5, 7, 4, 6, R, // Back
+            1, 3, 5, 7, R, // Right
+            0, 4, 2, 6, R, // Left
+            2, 6, 3, 7, R, // Top
+            0, 1, 4, 5     // Bottom
+        };
+    }
+
+private:
+    /// @brief  4 vertices per face so every face gets its own normal and full [0,1] texcoords, same faces in the same
+    ///         order (and facing the same way) as the shared vertex cube
+    template<class V, class I>
+    static IndexedTriangleList<V, I> MakeIndependentFaces()
+    {
+        constexpr float Size = 1.f/2.f;
+        struct Face
+        {
+            /* u x v = normal, so the texture isn't mirrored seen from outside */
+            Math::XMFLOAT3 normal, u, v;
+        };
+        constexpr std::array<Face, 6> faces =
+        {{
+            { {  0.f,  0.f, -1.f }, {  1.f, 0.f,  0.f }, { 0.f, -1.f,  0.f } }, // Front (-Z)
+            { {  0.f,  0.f,  1.f }, { -1.f, 0.f,  0.f }, { 0.f, -1.f,  0.f } }, // Back (+Z)
+            { {  1.f,  0.f,  0.f }, {  0.f, 0.f,  1.f }, { 0.f, -1.f,  0.f } }, // Right (+X)
+            { { -1.f,  0.f,  0.f }, {  0.f, 0.f, -1.f }, { 0.f, -1.f,  0.f } }, // Left (-X)
+            { {  0.f,  1.f,  0.f }, {  1.f, 0.f,  0.f }, { 0.f,  0.f, -1.f } }, // Top (+Y)
+            { {  0.f, -1.f,  0.f }, {  1.f, 0.f,  0.f }, { 0.f,  0.f,  1.f } }  // Bottom (-Y)
+        }};
+
+        std::vector<V> verts(faces.size() * 4u);
+        std::vector<I> indices;
+        indices.reserve(faces.size() * 6u);
+        for (size_t f = 0; f < faces.size(); f++)
+        {
+            const Face& face = faces[f];
+            // Corner k is at (u, v) = (k & 1, k >> 1)
+            for (size_t k = 0; k < 4u; k++)
+            {
+                const float su = (k & 1u) ? 1.f : -1.f;
+                const float sv = (k & 2u) ? 1.f : -1.f;
+                V& vert = verts[f * 4u + k];
+                vert.pos = {
+                    Size * (face.normal.x + su * face.u.x + sv * face.v.x),
+                    Size * (face.normal.y + su * face.u.y + sv * face.v.y),
+                    Size * (face.normal.z + su * face.u.z + sv * face.v.z) };
+                if constexpr (VertexHasNormal<V>)
+                {
+                    vert.n = face.normal;
+                }
+                if constexpr (VertexHasTexcoord<V>)
+                {
+                    vert.tc = { (su + 1.f) * 0.5f, (sv + 1.f) * 0.5f };
+                }
+                if constexpr (VertexHasTangent<V>)
+                {
+                    vert.tangent = { face.u.x, face.u.y, face.u.z, 1.f };
+                }
+            }
+
+            const auto base = static_cast<I>(f * 4u);
+            for (const unsigned int k : { 0u, 1u, 2u, 1u, 3u, 2u })
+            {
+                indices.push_back(static_cast<I>(base + k));
+            }
+        }
+
+        return {std::move(verts), std::move(indices)};
+    }
 };
 
 class Sphere
 {
 public:
-    template<class V>
-    static IndexedTriangleList<V> MakeTesselated(int latDiv, int longDiv)
+    template<class V, class I = unsigned int>
+    static IndexedTriangleList<V, I> MakeTesselated(int latDiv, int longDiv, JobSystem* pJobs = nullptr)
     {
         assert(latDiv >= 3);
         assert(longDiv >= 3);
 
+        const Layout<V> layout(latDiv, longDiv);
+        constexpr bool bSeams = Layout<V>::bSeams;
+        const size_t ringSize = layout.ringSize;
+        const size_t poleSize = layout.poleSize;
+        const size_t nRings = layout.nRings;
+        const size_t nBands = layout.nBands;
+        assert("Too many vertices for the index type" && layout.VertexCount() - 1u <= std::numeric_limits<I>::max());
+
         constexpr float radius = 1.f;
-        const auto base = Math::XMVectorSet(0.f, 0.f, radius, 0.f);
         const float lattitudeAngle = Math::PI / latDiv;
         const float longitudeAngle = 2.f * Math::PI / longDiv;
+        // Ring iLat is lattitudeAngle * (iLat + 1) down from the north pole, the seam column takes the first column's
+        // angle so their positions match exactly
+        const auto lattitudes = ShapeRows::CosSinTable(int(nRings), lattitudeAngle, lattitudeAngle);
+        auto longitudes = ShapeRows::CosSinTable(int(ringSize), longitudeAngle);
+        if constexpr (bSeams)
+        {
+            longitudes.back() = longitudes.front();
+        }
 
-        std::vector<V> vertices;
-        for (int iLat = 1; iLat < latDiv; iLat++)
+        std::vector<V> vertices(layout.VertexCount());
+        ShapeRows::ForEach(nRings, ringSize, pJobs, [&](size_t begin, size_t end)
         {
-            const auto latBase = Math::XMVector3Transform(base, Math::XMMatrixRotationX(lattitudeAngle * iLat));
-            for (int iLong = 0; iLong < longDiv; iLong++)
+            for (size_t iLat = begin; iLat < end; iLat++)
             {
-                vertices.emplace_back();
-                auto v = Math::XMVector3Transform(latBase, Math::XMMatrixRotationZ(longitudeAngle * iLong));
-                Math::XMStoreFloat3(&vertices.back().pos, v);
+                const Math::XMFLOAT2& lattitude = lattitudes[iLat];
+                V* pVertex = vertices.data() + iLat * ringSize;
+                for (size_t iLong = 0; iLong < ringSize; iLong++, pVertex++)
+                {
+                    // (0, 0, radius) rotated about x by the lattitude, then about z by the longitude
+                    const Math::XMFLOAT2& longitude = longitudes[iLong];
+                    pVertex->pos = { radius * lattitude.y * longitude.y, -radius * lattitude.y * longitude.x, radius * lattitude.x };
+                    SetAttributes(*pVertex, float(iLong) / float(longDiv), float(iLat + 1u) / float(latDiv), longitude);
+                }
             }
+        });
+
+        // add the cap vertices, centered on their slice
+        const auto sliceCenters = ShapeRows::CosSinTable(int(poleSize), longitudeAngle, longitudeAngle * 0.5f);
+        for (size_t iLong = 0; iLong < poleSize; iLong++)
+        {
+            const float u = (float(iLong) + 0.5f) / float(longDiv);
+            V& north = vertices[layout.NorthPole(iLong)];
+            north.pos = { 0.f, 0.f, radius };
+            SetAttributes(north, u, 0.f, sliceCenters[iLong]);
+            V& south = vertices[layout.SouthPole(iLong)];
+            south.pos = { 0.f, 0.f, -radius };
+            SetAttributes(south, u, 1.f, sliceCenters[iLong]);
         }
 
-        // add the cap vertices
-        const auto iNorthPole = (unsigned short)vertices.size();
-        vertices.emplace_back();
-        Math::XMStoreFloat3(&vertices.back().pos, base);
-        const auto iSouthPole = (unsigned short)vertices.size();
-        vertices.emplace_back();
-        Math::XMStoreFloat3(&vertices.back().pos, Math::XMVectorNegate(base));
+        const auto CalcIdx = [&layout](size_t iLat, size_t iLong){ return static_cast<I>(layout.Index(iLat, iLong)); };
+        const auto Next = [&layout](size_t iLong){ return layout.Next(iLong); };
 
-        const auto CalcIdx = [latDiv, longDiv](unsigned short iLat, unsigned short iLong){ return iLat * longDiv + iLong; };
-        std::vector<unsigned short> indices;
-        for (unsigned short iLat = 0; iLat < latDiv - 2; iLat++)
+        // Bands then the two cap fans
+        std::vector<I> indices((nBands + 1u) * size_t(longDiv) * 6u);
+        ShapeRows::ForEach(nBands, ringSize, pJobs, [&](size_t begin, size_t end)
         {
-            for (unsigned short iLong = 0; iLong < longDiv - 1; iLong++)
+            I* pOut = indices.data() + begin * size_t(longDiv) * 6u;
+            for (size_t iLat = begin; iLat < end; iLat++)
             {
-                // Tri 1
-                indices.push_back(CalcIdx(iLat, iLong));
-                indices.push_back(CalcIdx(iLat + 1, iLong));
-                indices.push_back(CalcIdx(iLat, iLong + 1));
-                // Tri 2
-                indices.push_back(CalcIdx(iLat, iLong + 1));
-                indices.push_back(CalcIdx(iLat + 1, iLong));
-                indices.push_back(CalcIdx(iLat + 1, iLong + 1));
+                for (size_t iLong = 0; iLong < size_t(longDiv); iLong++)
+                {
+                    // Tri 1
+                    *pOut++ = CalcIdx(iLat, iLong);
+                    *pOut++ = CalcIdx(iLat + 1u, iLong);
+                    *pOut++ = CalcIdx(iLat, Next(iLong));
+                    // Tri 2
+                    *pOut++ = CalcIdx(iLat, Next(iLong));
+                    *pOut++ = CalcIdx(iLat + 1u, iLong);
+                    *pOut++ = CalcIdx(iLat + 1u, Next(iLong));
+                }
             }
-            // Wrap band
-            // Tri 1
-            indices.push_back(CalcIdx(iLat, longDiv - 1));
-            indices.push_back(CalcIdx(iLat + 1, longDiv - 1));
-            indices.push_back(CalcIdx(iLat, 0));
-            // Tri 2
-            indices.push_back(CalcIdx(iLat, 0));
-            indices.push_back(CalcIdx(iLat + 1, longDiv - 1));
-            indices.push_back(CalcIdx(iLat + 1, 0));
-        }
+        });
 
-        // Cap fans
-        for (unsigned short iLong = 0; iLong < longDiv; iLong++)
+        I* pOut = indices.data() + nBands * size_t(longDiv) * 6u;
+        for (size_t iLong = 0; iLong < size_t(longDiv); iLong++)
         {
             // North
-            indices.push_back(iNorthPole);
-            indices.push_back(CalcIdx(0, iLong));
-            indices.push_back(CalcIdx(0, iLong+1));
+            *pOut++ = static_cast<I>(layout.NorthPole(iLong));
+            *pOut++ = CalcIdx(0u, iLong);
+            *pOut++ = CalcIdx(0u, Next(iLong));
             // South
-            indices.push_back(CalcIdx(latDiv - 2, iLong+1));
-            indices.push_back(CalcIdx(latDiv - 2, iLong));
-            indices.push_back(iSouthPole);
+            *pOut++ = CalcIdx(nBands, Next(iLong));
+            *pOut++ = CalcIdx(nBands, iLong);
+            *pOut++ = static_cast<I>(layout.SouthPole(iLong));
         }
 
-        // Wrap triangles
-        // North
-        indices.push_back(iNorthPole);
-        indices.push_back(CalcIdx(0, longDiv-1));
-        indices.push_back(CalcIdx(0,0));
-        // South
-        indices.push_back(CalcIdx(latDiv - 2, 0));
-        indices.push_back(CalcIdx(latDiv - 2, longDiv - 1));
-        indices.push_back(iSouthPole);
-
         return {std::move(vertices), std::move(indices)};
     }
 
+    /// @brief  Same triangles as MakeTesselated<V> (same vertices, same winding) as a TriangleStrip: one strip per
+    ///         band like the Plane's rows, then each cap as a strip zig zagging between the ring and the pole, where
+    ///         every other triangle is degenerate (the pole twice, or two pole vertices at the same spot)
+    template<class V, class I = unsigned int>
+    static std::vector<I> MakeTesselatedStripIndices(int latDiv, int longDiv)
+    {
+        assert(latDiv >= 3);
+        assert(longDiv >= 3);
+
+        const Layout<V> layout(latDiv, longDiv);
+        assert("Too many vertices for the index type" && layout.VertexCount() - 1u < StripRestartIndex<I>);
+        const auto Push = [](std::vector<I>& indices, size_t i) { indices.push_back(static_cast<I>(i)); };
+
+        std::vector<I> indices;
+        indices.reserve((layout.nBands + 2u) * (size_t(longDiv) * 2u + 3u));
+        for (size_t iLat = 0; iLat < layout.nBands; iLat++)
+        {
+            for (size_t iLong = 0; iLong < size_t(longDiv); iLong++)
+            {
+                Push(indices, layout.Index(iLat, iLong));
+                Push(indices, layout.Index(iLat + 1u, iLong));
+            }
+            Push(indices, layout.Index(iLat, layout.Next(size_t(longDiv) - 1u)));
+            Push(indices, layout.Index(iLat + 1u, layout.Next(size_t(longDiv) - 1u)));
+            indices.push_back(StripRestartIndex<I>);
+        }
+
+        // North: pole, ring 0, pole, ring 1... the odd triangles are (pole, ring i, ring i + 1)
+        Push(indices, layout.NorthPole(0u));
+        for (size_t iLong = 0; iLong < size_t(longDiv); iLong++)
+        {
+            Push(indices, layout.Index(0u, iLong));
+            Push(indices, layout.NorthPole(iLong));
+        }
+        Push(indices, layout.Index(0u, layout.Next(size_t(longDiv) - 1u)));
+        indices.push_back(StripRestartIndex<I>);
+
+        // South: ring 0, pole, ring 1, pole... the even triangles are (ring i, pole, ring i + 1)
+        for (size_t iLong = 0; iLong < size_t(longDiv); iLong++)
+        {
+            Push(indices, layout.Index(layout.nBands, iLong));
+            Push(indices, layout.SouthPole(iLong));
+        }
+        Push(indices, layout.Index(layout.nBands, layout.Next(size_t(longDiv) - 1u)));
+        return indices;
+    }
+
+    template<class V, class I = unsigned int>
+    static IndexedTriangleList<V, I> Make() { return MakeTesselated<V, I>(12, 24); }
+
+private:
+    /// @brief  Where MakeTesselated<V> puts its vertices: the rings from north to south, then the north and south
+    ///         pole vertices. Texcoords and tangents jump at the u seam and are different per slice at the poles, so
+    ///         those get a duplicated seam column and a pole vertex per longitude slice. Normals alone are continuous
+    ///         everywhere
     template<class V>
-    static IndexedTriangleList<V> Make() { return MakeTesselated<V>(12, 24); }
+    struct Layout
+    {
+        static constexpr bool bSeams = VertexHasTexcoord<V> || VertexHasTangent<V>;
+
+        Layout(int latDiv, int longDiv) noexcept
+            : longDiv(size_t(longDiv)), ringSize(bSeams ? size_t(longDiv) + 1u : size_t(longDiv)),
+            poleSize(bSeams ? size_t(longDiv) : 1u), nRings(size_t(latDiv) - 1u), nBands(size_t(latDiv) - 2u)
+        {}
+
+        size_t VertexCount() const noexcept { return nRings * ringSize + 2u * poleSize; }
+        size_t Index(size_t iLat, size_t iLong) const noexcept { return iLat * ringSize + iLong; }
+        /// @brief  Column after iLong, the seam column if there is one otherwise back around to the first
+        size_t Next(size_t iLong) const noexcept { return bSeams ? iLong + 1u : (iLong + 1u) % longDiv; }
+        size_t NorthPole(size_t iLong) const noexcept { return nRings * ringSize + (bSeams ? iLong : 0u); }
+        size_t SouthPole(size_t iLong) const noexcept { return nRings * ringSize + poleSize + (bSeams ? iLong : 0u); }
+
+        size_t longDiv;
+        size_t ringSize;
+        size_t poleSize;
+        size_t nRings;
+        size_t nBands;
+    };
+
+    /// @brief  Unit sphere so the normal is the position. u goes around with the longitude ({cos, sin}) and v from
+    ///         the north (+z) pole to the south one, which makes the bitangent point against n x t
+    template<class V>
+    static void SetAttributes(V& vertex, float u, float v, const Math::XMFLOAT2& longitude)
+    {
+        if constexpr (VertexHasNormal<V>)
+        {
+            vertex.n = vertex.pos;
+        }
+        if constexpr (VertexHasTexcoord<V>)
+        {
+            vertex.tc = { u, v };
+        }
+        if constexpr (VertexHasTangent<V>)
+        {
+            vertex.tangent = { longitude.x, longitude.y, 0.f, -1.f };
+        }
+    }
 };
 
 class Cone
 {
 public:
-    template<class V>
-    static IndexedTriangleList<V> MakeTesselated(int longDiv)
+    template<class V, class I = unsigned int>
+    static IndexedTriangleList<V, I> MakeTesselated(int longDiv)
     {
         assert(longDiv >= 3);
 
-        const auto base = Math::XMVectorSet(1.f, 0.f, -1.f, 0.f);
+        if constexpr (VertexHasNormal<V> || VertexHasTexcoord<V> || VertexHasTangent<V>)
+        {
+            return MakeIndependentFaces<V, I>(longDiv);
+        }
+
         const float longitudeAngle = 2.f * Math::PI / longDiv;
+        const auto longitudes = ShapeRows::CosSinTable(longDiv, longitudeAngle);
 
-        // base vertices
-        std::vector<V> vertices;
+        // base vertices, (1, 0, -1) rotated about z
+        std::vector<V> vertices(size_t(longDiv) + 2u);
         for (int iLong = 0; iLong < longDiv; iLong++)
         {
-            vertices.emplace_back();
-            auto v = Math::XMVector3Transform(
-                base,
-                Math::XMMatrixRotationZ(longitudeAngle * iLong));
-            Math::XMStoreFloat3(&vertices.back().pos, v);
+            vertices[iLong].pos = { longitudes[iLong].x, longitudes[iLong].y, -1.f };
         }
 
         // the center
-        vertices.emplace_back();
-        vertices.back().pos = {0.f, 0.f, -1.f};
-        const auto iCenter = (unsigned short)(vertices.size() - 1);
+        const auto iCenter = static_cast<I>(longDiv);
+        vertices[iCenter].pos = {0.f, 0.f, -1.f};
         // the tip
-        vertices.emplace_back();
-        vertices.back().pos = {0.f, 0.f, 1.f};
-        const auto iTip = (unsigned short)(vertices.size() - 1);
+        const auto iTip = static_cast<I>(longDiv + 1);
+        vertices[iTip].pos = {0.f, 0.f, 1.f};
 
         // base indices
-        std::vector<unsigned short> indices;
-        for (unsigned short iLong = 0; iLong < longDiv; iLong++)
+        std::vector<I> indices;
+        indices.reserve(size_t(longDiv) * 6u);
+        for (int iLong = 0; iLong < longDiv; iLong++)
         {
             indices.push_back(iCenter);
-            indices.push_back((iLong + 1) % longDiv);
-            indices.push_back(iLong);
+            indices.push_back(static_cast<I>((iLong + 1) % longDiv));
+            indices.push_back(static_cast<I>(iLong));
         }
 
         // cone indices
-        for (unsigned short iLong = 0; iLong < longDiv; iLong++)
+        for (int iLong = 0; iLong < longDiv; iLong++)
         {
-            indices.push_back(iLong);
-            indices.push_back((iLong + 1) % longDiv);
+            indices.push_back(static_cast<I>(iLong));
+            indices.push_back(static_cast<I>((iLong + 1) % longDiv));
             indices.push_back(iTip);
         }
 
         return {std::move(vertices), std::move(indices)};
     }
 
-    template<class V>
-    static IndexedTriangleList<V> Make()
+    template<class V, class I = unsigned int>
+    static IndexedTriangleList<V, I> Make()
+    {
+        return MakeTesselated<V, I>(24);
+    }
+
+    /// @brief  Same triangles as MakeTesselated<V> as a TriangleStrip: the base zig zags between the rim and the
+    ///         center, the side between the rim and the tip like the Sphere's caps, so every other triangle is
+    ///         degenerate
+    template<class V, class I = unsigned int>
+    static std::vector<I> MakeTesselatedStripIndices(int longDiv)
+    {
+        assert(longDiv >= 3);
+
+        constexpr bool bFaces = VertexHasNormal<V> || VertexHasTexcoord<V> || VertexHasTangent<V>;
+        const size_t n = size_t(longDiv);
+        // Where MakeTesselated<V> puts the rim, the center, the side rim (with the seam column) and the tips
+        const size_t iCenter = n;
+        const size_t iSide = bFaces ? n + 1u : 0u;
+        const auto Tip = [n](size_t iLong) { return bFaces ? n * 2u + 2u + iLong : n + 1u; };
+        assert("Too many vertices for the index type" && (bFaces ? n * 3u + 1u : n + 1u) < StripRestartIndex<I>);
+        const auto Push = [](std::vector<I>& indices, size_t i) { indices.push_back(static_cast<I>(i)); };
+
+        std::vector<I> indices;
+        indices.reserve(n * 4u + 4u);
+        // Base: rim 0, center, rim 1, center... the even triangles are (rim i, center, rim i + 1)
+        for (size_t iLong = 0; iLong < n; iLong++)
+        {
+            Push(indices, iLong);
+            Push(indices, iCenter);
+        }
+        Push(indices, 0u);
+        indices.push_back(StripRestartIndex<I>);
+
+        // Side: tip, rim 0, tip, rim 1... the odd triangles are (tip, rim i, rim i + 1)
+        Push(indices, Tip(0u));
+        for (size_t iLong = 0; iLong < n; iLong++)
+        {
+            Push(indices, iSide + iLong);
+            Push(indices, Tip(iLong));
+        }
+        Push(indices, bFaces ? iSide + n : 0u);
+        return indices;
+    }
+
+private:
+    /// @brief  Same cone with the base disc and the side split apart so the rim can have both normals. The side gets
+    ///         a seam column and a tip vertex per slice (normal halfway between the slice's edges), u goes around and
+    ///         v runs from the tip down to the rim. The base is mapped top down like the Plane
+    template<class V, class I>
+    static IndexedTriangleList<V, I> MakeIndependentFaces(int longDiv)
     {
-        return MakeTesselated<V>(24);
+        const float longitudeAngle = 2.f * Math::PI / longDiv;
+        // Slope of the side is 1/2 (radius 1 over height 2), so the side normal is (cos, sin, 1/2) normalized
+        const float sideNormalScale = 1.f / std::sqrt(1.25f);
+        // Rim angles with the seam column closing the circle exactly, and the slice centers for the tips
+        auto rim = ShapeRows::CosSinTable(longDiv + 1, longitudeAngle);
+        rim.back() = rim.front();
+        const auto sliceCenters = ShapeRows::CosSinTable(longDiv, longitudeAngle, longitudeAngle * 0.5f);
+
+        std::vector<V> vertices;
+        vertices.reserve(size_t(longDiv) * 3u + 2u);
+        const auto AddVertex = [&](Math::XMFLOAT3 pos, Math::XMFLOAT3 n, Math::XMFLOAT2 tc, Math::XMFLOAT4 tangent)
+        {
+            V& vertex = vertices.emplace_back();
+            vertex.pos = pos;
+            if constexpr (VertexHasNormal<V>)
+            {
+                vertex.n = n;
+            }
+            if constexpr (VertexHasTexcoord<V>)
+            {
+                vertex.tc = tc;
+            }
+            if constexpr (VertexHasTangent<V>)
+            {
+                vertex.tangent = tangent;
+            }
+        };
+        const auto AddSideVertex = [&](const Math::XMFLOAT2& angle, float z, Math::XMFLOAT2 tc)
+        {
+            const float c = angle.x;
+            const float s = angle.y;
+            const float radius = (1.f - z) * 0.5f;
+            AddVertex({ radius * c, radius * s, z }, { c * sideNormalScale, s * sideNormalScale, 0.5f * sideNormalScale },
+                tc, { -s, c, 0.f, -1.f });
+        };
+
+        // base rim and center
+        for (int iLong = 0; iLong < longDiv; iLong++)
+        {
+            const float c = rim[iLong].x;
+            const float s = rim[iLong].y;
+            AddVertex({ c, s, -1.f }, { 0.f, 0.f, -1.f }, { 0.5f + 0.5f * c, 0.5f - 0.5f * s }, { 1.f, 0.f, 0.f, 1.f });
+        }
+        const auto iCenter = static_cast<I>(vertices.size());
+        AddVertex({ 0.f, 0.f, -1.f }, { 0.f, 0.f, -1.f }, { 0.5f, 0.5f }, { 1.f, 0.f, 0.f, 1.f });
+
+        // side rim (with the seam column) and tips
+        const auto iSide = static_cast<I>(vertices.size());
+        for (int iLong = 0; iLong <= longDiv; iLong++)
+        {
+            AddSideVertex(rim[iLong], -1.f, { float(iLong) / float(longDiv), 1.f });
+        }
+        const auto iTip = static_cast<I>(vertices.size());
+        for (int iLong = 0; iLong < longDiv; iLong++)
+        {
+            AddSideVertex(sliceCenters[iLong], 1.f, { (float(iLong) + 0.5f) / float(longDiv), 0.f });
+        }
+
+        // base indices
+        std::vector<I> indices;
+        indices.reserve(size_t(longDiv) * 6u);
+        for (int iLong = 0; iLong < longDiv; iLong++)
+        {
+            indices.push_back(iCenter);
+            indices.push_back(static_cast<I>((iLong + 1) % longDiv));
+            indices.push_back(static_cast<I>(iLong));
+        }
+
+        // cone indices
+        for (int iLong = 0; iLong < longDiv; iLong++)
+        {
+            indices.push_back(static_cast<I>(iSide + iLong));
+            indices.push_back(static_cast<I>(iSide + iLong + 1));
+            indices.push_back(static_cast<I>(iTip + iLong));
+        }
+
+        return {std::move(vertices), std::move(indices)};
     }
 };
 
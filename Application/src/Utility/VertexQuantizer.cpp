@@ -0,0 +1,78 @@
+﻿#include "VertexQuantizer.h"
+
+using namespace Math::PackedVector;
+
+namespace
+{
+    float SignNotZero(float v) noexcept
+    {
+        return v >= 0.f ? 1.f : -1.f;
+    }
+}
+
+Math::XMFLOAT2 VertexQuantizer::OctahedralEncode(Math::FXMVECTOR n) noexcept
+{
+    Math::XMFLOAT3 v;
+    Math::XMStoreFloat3(&v, n);
+    // Project onto the octahedron |x| + |y| + |z| = 1, then fold the lower half over the diagonals
+    const float l1 = std::abs(v.x) + std::abs(v.y) + std::abs(v.z);
+    Math::XMFLOAT2 e = { v.x / l1, v.y / l1 };
+    if (v.z < 0.f)
+    {
+        e = { (1.f - std::abs(e.y)) * SignNotZero(e.x), (1.f - std::abs(e.x)) * SignNotZero(e.y) };
+    }
+    return e;
+}
+
+Math::XMVECTOR VertexQuantizer::OctahedralDecode(const Math::XMFLOAT2& e) noexcept
+{
+    Math::XMFLOAT3 v = { e.x, e.y, 1.f - std::abs(e.x) - std::abs(e.y) };
+    const float t = std::max(-v.z, 0.f);
+    v.x += v.x >= 0.f ? -t : t;
+    v.y += v.y >= 0.f ? -t : t;
+    return Math::XMVector3Normalize(Math::XMLoadFloat3(&v));
+}
+
+void VertexQuantizer::EncodePosition(Math::FXMVECTOR p, XMSHORTN4& out) noexcept
+{
+    XMStoreShortN4(&out, Math::XMVectorSetW(p, 0.f));
+}
+
+void VertexQuantizer::EncodePosition(Math::FXMVECTOR p, XMSHORTN2& out) noexcept
+{
+    XMStoreShortN2(&out, p);
+}
+
+Math::XMVECTOR VertexQuantizer::DecodePosition(const XMSHORTN4& in) noexcept
+{
+    return XMLoadShortN4(&in);
+}
+
+Math::XMVECTOR VertexQuantizer::DecodePosition(const XMSHORTN2& in) noexcept
+{
+    // z = 0 like the input assembler fills it in
+    return XMLoadShortN2(&in);
+}
+
+void VertexQuantizer::EncodeNormal(Math::FXMVECTOR n, XMSHORTN2& out) noexcept
+{
+    const Math::XMFLOAT2 e = OctahedralEncode(n);
+    XMStoreShortN2(&out, Math::XMLoadFloat2(&e));
+}
+
+Math::XMVECTOR VertexQuantizer::DecodeNormal(const XMSHORTN2& in) noexcept
+{
+    Math::XMFLOAT2 e;
+    Math::XMStoreFloat2(&e, XMLoadShortN2(&in));
+    return OctahedralDecode(e);
+}
+
+void VertexQuantizer::EncodeTexcoord(Math::FXMVECTOR tc, XMHALF2& out) noexcept
+{
+    XMStoreHalf2(&out, tc);
+}
+
+Math::XMVECTOR VertexQuantizer::DecodeTexcoord(const XMHALF2& in) noexcept
+{
+    return XMLoadHalf2(&in);
+}
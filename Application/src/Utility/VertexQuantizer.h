@@ -0,0 +1,136 @@
+﻿#pragma once
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <DirectXPackedVector.h>
+
+#include "Bindable/Buffers/VertexLayout.h"
+#include "Bounds.h"
+#include "IndexedTriangleList.h"
+#include "Maths.h"
+
+/// @brief  16 bit positions, 8 bytes instead of Vertex's 12
+struct QuantizedVertex
+{
+    Math::PackedVector::XMSHORTN4 pos;
+
+    static constexpr auto Elements()
+    {
+        return std::array{ VERTEX_ELEMENT(QuantizedVertex, pos, "Position", ShortN4) };
+    }
+};
+
+/// @brief  For meshes flat in z (the tessellated planes): only x/y, the input assembler fills in z = 0. 4 bytes
+struct PlanarVertex
+{
+    Math::PackedVector::XMSHORTN2 pos;
+
+    static constexpr auto Elements()
+    {
+        return std::array{ VERTEX_ELEMENT(PlanarVertex, pos, "Position", ShortN2) };
+    }
+};
+
+/// @brief  16 bit position, octahedral normal and half texcoords, 16 bytes instead of 32
+struct QuantizedLitVertex
+{
+    Math::PackedVector::XMSHORTN4 pos;
+    Math::PackedVector::XMSHORTN2 n;
+    Math::PackedVector::XMHALF2 tc;
+
+    static constexpr auto Elements()
+    {
+        return std::array{
+            VERTEX_ELEMENT(QuantizedLitVertex, pos, "Position", ShortN4),
+            VERTEX_ELEMENT(QuantizedLitVertex, n, "Normal", ShortN2),
+            VERTEX_ELEMENT(QuantizedLitVertex, tc, "Texcoord", Half2)
+        };
+    }
+};
+
+/// @brief  Converts full float vertices into one of the packed vertex types above (or any type using the same member
+///         names and storage types). Positions are stored relative to the mesh bounds, normals octahedral encoded,
+///         texcoords as halves. Whatever attributes both vertex types have get converted, the rest dropped
+class VertexQuantizer
+{
+public:
+    struct Report
+    {
+        /* Maps quantized positions back into the mesh's space, goes in front of the world transform. Scales every
+           axis the same so normals don't need a different transform */
+        Math::XMFLOAT4X4 dequantize;
+        /* Bounds of the quantized positions, what culling has to use along with the folded transform */
+        AABB bounds;
+        /* Largest error over every vertex, measured by decoding what got stored */
+        float maxPositionError = 0.f;
+        float maxNormalError = 0.f;     /* Radians */
+        float maxTexcoordError = 0.f;
+    };
+
+public:
+    template<class Q, class V, class I>
+    static IndexedTriangleList<Q, I> Quantize(const IndexedTriangleList<V, I>& mesh, Report* pReport = nullptr)
+    {
+        // Centered so positions use the whole [-1, 1] of the SNORM range
+        const AABB bounds = AABB::FromVertices(mesh.m_Vertices);
+        const Math::XMFLOAT3 center = { (bounds.min.x + bounds.max.x) * 0.5f, (bounds.min.y + bounds.max.y) * 0.5f, (bounds.min.z + bounds.max.z) * 0.5f };
+        const float halfExtent = std::max({ bounds.max.x - center.x, bounds.max.y - center.y, bounds.max.z - center.z });
+        const float scale = halfExtent > 0.f ? halfExtent : 1.f;
+        const Math::XMVECTOR vCenter = Math::XMLoadFloat3(&center);
+
+        Report report = {};
+        std::vector<Q> vertices(mesh.m_Vertices.size());
+        for (size_t i = 0; i < vertices.size(); i++)
+        {
+            const V& v = mesh.m_Vertices[i];
+            Q& q = vertices[i];
+
+            const Math::XMVECTOR p = Math::XMLoadFloat3(&v.pos);
+            EncodePosition(Math::XMVectorScale(Math::XMVectorSubtract(p, vCenter), 1.f / scale), q.pos);
+            const Math::XMVECTOR decoded = Math::XMVectorAdd(Math::XMVectorScale(DecodePosition(q.pos), scale), vCenter);
+            report.maxPositionError = std::max(report.maxPositionError, Math::XMVectorGetX(Math::XMVector3Length(Math::XMVectorSubtract(decoded, p))));
+
+            if constexpr (requires { q.n; v.n; })
+            {
+                const Math::XMVECTOR n = Math::XMVector3Normalize(Math::XMLoadFloat3(&v.n));
+                EncodeNormal(n, q.n);
+                const float cosine = std::clamp(Math::XMVectorGetX(Math::XMVector3Dot(n, DecodeNormal(q.n))), -1.f, 1.f);
+                report.maxNormalError = std::max(report.maxNormalError, std::acos(cosine));
+            }
+            if constexpr (requires { q.tc; v.tc; })
+            {
+                const Math::XMVECTOR tc = Math::XMLoadFloat2(&v.tc);
+                EncodeTexcoord(tc, q.tc);
+                const Math::XMVECTOR error = Math::XMVectorAbs(Math::XMVectorSubtract(DecodeTexcoord(q.tc), tc));
+                report.maxTexcoordError = std::max({ report.maxTexcoordError, Math::XMVectorGetX(error), Math::XMVectorGetY(error) });
+            }
+        }
+
+        Math::XMStoreFloat4x4(&report.dequantize, Math::XMMatrixScaling(scale, scale, scale) * Math::XMMatrixTranslation(center.x, center.y, center.z));
+        report.bounds.min = { (bounds.min.x - center.x) / scale, (bounds.min.y - center.y) / scale, (bounds.min.z - center.z) / scale };
+        report.bounds.max = { (bounds.max.x - center.x) / scale, (bounds.max.y - center.y) / scale, (bounds.max.z - center.z) / scale };
+        if (pReport)
+        {
+            *pReport = report;
+        }
+        return { std::move(vertices), mesh.m_Indices };
+    }
+
+    /// @brief  Octahedral mapping of a unit vector onto [-1, 1]^2 (Cigolle et al. "A Survey of Efficient
+    ///         Representations for Independent Unit Vectors"), decoding is a couple of adds and a normalize
+    static Math::XMFLOAT2 OctahedralEncode(Math::FXMVECTOR n) noexcept;
+    static Math::XMVECTOR OctahedralDecode(const Math::XMFLOAT2& e) noexcept;
+
+private:
+    /// @brief  p is already in [-1, 1]
+    static void EncodePosition(Math::FXMVECTOR p, Math::PackedVector::XMSHORTN4& out) noexcept;
+    static void EncodePosition(Math::FXMVECTOR p, Math::PackedVector::XMSHORTN2& out) noexcept;
+    static Math::XMVECTOR DecodePosition(const Math::PackedVector::XMSHORTN4& in) noexcept;
+    static Math::XMVECTOR DecodePosition(const Math::PackedVector::XMSHORTN2& in) noexcept;
+
+    static void EncodeNormal(Math::FXMVECTOR n, Math::PackedVector::XMSHORTN2& out) noexcept;
+    static Math::XMVECTOR DecodeNormal(const Math::PackedVector::XMSHORTN2& in) noexcept;
+
+    static void EncodeTexcoord(Math::FXMVECTOR tc, Math::PackedVector::XMHALF2& out) noexcept;
+    static Math::XMVECTOR DecodeTexcoord(const Math::PackedVector::XMHALF2& in) noexcept;
+};
@@ -16,7 +16,7 @@ Window::HrException::HrException(int line, const char* file, HRESULT hr) noexcep
     : RomanceException(line, file), m_hResult(hr)
 {}
 
-char const* Window::HrException::what() const
+char const* Window::HrException::what() const noexcept
 {
     std::ostringstream oss;
     oss << GetType() << std::endl
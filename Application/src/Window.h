@@ -18,7 +18,7 @@ public:
     {
     public:
         HrException(int line, const char* file, HRESULT hr) noexcept;
-        char const* what() const override;
+        char const* what() const noexcept override;
         const char* GetType() const noexcept override;
         HRESULT GetErrorCode() const noexcept;
         std::string GetErrorString() const noexcept;
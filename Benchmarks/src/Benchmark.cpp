@@ -0,0 +1,176 @@
+﻿#include "Benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <thread>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double Seconds(Clock::time_point begin, Clock::time_point end)
+    {
+        return std::chrono::duration<double>(end - begin).count();
+    }
+
+    /// @brief  Median of values, which gets reordered
+    double Median(std::vector<double>& values)
+    {
+        std::sort(values.begin(), values.end());
+        const size_t mid = values.size() / 2u;
+        return values.size() % 2u ? values[mid] : (values[mid - 1u] + values[mid]) * 0.5;
+    }
+
+    void WriteJsonString(std::ostream& out, const std::string& value)
+    {
+        out << '"';
+        for (const char c : value)
+        {
+            switch (c)
+            {
+            case '"':  out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20u)
+                {
+                    out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << int(c) << std::dec << std::setfill(' ');
+                }
+                else
+                {
+                    out << c;
+                }
+            }
+        }
+        out << '"';
+    }
+
+    const char* CompilerName()
+    {
+#if defined(__clang__)
+        return "clang " __clang_version__;
+#elif defined(__GNUC__)
+        return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+        return "msvc";
+#else
+        return "unknown";
+#endif
+    }
+}
+
+void BenchmarkSuite::Add(std::string name, std::string unit, size_t size, RunFn run)
+{
+    m_Cases.push_back({ std::move(name), std::move(unit), size, std::move(run) });
+}
+
+std::vector<BenchmarkSuite::Result> BenchmarkSuite::Run(const Options& options, std::ostream& log) const
+{
+    std::vector<Result> results;
+    for (const Case& benchCase : m_Cases)
+    {
+        if (!options.filter.empty() && benchCase.name.find(options.filter) == std::string::npos)
+        {
+            continue;
+        }
+
+        const Result& result = results.emplace_back(Measure(benchCase, options));
+        log << std::left << std::setw(40) << result.name << std::right
+            << std::setw(12) << std::setprecision(4) << result.ItemsPerSecond() / 1e6 << " M" << result.unit << "/s"
+            << "  median " << std::setprecision(4) << result.median * 1e3 << " ms"
+            << "  +/- " << std::setprecision(2) << (result.median > 0.0 ? 100.0 * result.mad / result.median : 0.0) << "%"
+            << std::endl;
+    }
+    return results;
+}
+
+BenchmarkSuite::Result BenchmarkSuite::Measure(const Case& benchCase, const Options& options)
+{
+    Result result;
+    result.name = benchCase.name;
+    result.unit = benchCase.unit;
+    result.size = benchCase.size;
+
+    // Warmup doubles as calibration, the fastest warmup run decides how many runs make up a sample
+    double fastest = 0.0;
+    for (unsigned int i = 0; i < std::max(1u, options.warmupRuns); i++)
+    {
+        const auto begin = Clock::now();
+        result.itemsPerRun = benchCase.run();
+        const double elapsed = Seconds(begin, Clock::now());
+        fastest = i == 0u ? elapsed : std::min(fastest, elapsed);
+    }
+    result.runsPerSample = fastest >= options.minSampleTime ? 1u
+        : size_t(std::ceil(options.minSampleTime / std::max(fastest, 1e-9)));
+
+    result.samples.reserve(options.samples);
+    for (unsigned int s = 0; s < std::max(1u, options.samples); s++)
+    {
+        const auto begin = Clock::now();
+        for (size_t r = 0; r < result.runsPerSample; r++)
+        {
+            DoNotOptimize(benchCase.run());
+        }
+        result.samples.push_back(Seconds(begin, Clock::now()) / double(result.runsPerSample));
+    }
+
+    std::vector<double> sorted = result.samples;
+    result.median = Median(sorted);
+    result.min = sorted.front();
+    double sum = 0.0;
+    for (const double sample : result.samples)
+    {
+        sum += sample;
+    }
+    result.mean = sum / double(result.samples.size());
+    double squares = 0.0;
+    std::vector<double> deviations;
+    deviations.reserve(result.samples.size());
+    for (const double sample : result.samples)
+    {
+        squares += (sample - result.mean) * (sample - result.mean);
+        deviations.push_back(std::abs(sample - result.median));
+    }
+    result.stddev = result.samples.size() > 1u ? std::sqrt(squares / double(result.samples.size() - 1u)) : 0.0;
+    result.mad = Median(deviations);
+    return result;
+}
+
+void BenchmarkSuite::WriteJson(std::ostream& out, const std::vector<Result>& results, const Options& options)
+{
+    out << std::setprecision(9);
+    out << "{\n  \"context\": {\n";
+    out << "    \"compiler\": ";
+    WriteJsonString(out, CompilerName());
+    out << ",\n    \"hardware_threads\": " << std::thread::hardware_concurrency();
+    out << ",\n    \"samples\": " << options.samples;
+    out << ",\n    \"min_sample_time\": " << options.minSampleTime;
+    out << "\n  },\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const Result& result = results[i];
+        out << (i ? ",\n" : "\n") << "    {\"name\": ";
+        WriteJsonString(out, result.name);
+        out << ", \"unit\": ";
+        WriteJsonString(out, result.unit);
+        out << ", \"size\": " << result.size
+            << ", \"items_per_run\": " << result.itemsPerRun
+            << ", \"runs_per_sample\": " << result.runsPerSample
+            << ", \"items_per_second\": " << result.ItemsPerSecond()
+            << ", \"seconds\": {\"min\": " << result.min
+            << ", \"median\": " << result.median
+            << ", \"mean\": " << result.mean
+            << ", \"stddev\": " << result.stddev
+            << ", \"mad\": " << result.mad << "}"
+            << ", \"samples\": [";
+        for (size_t s = 0; s < result.samples.size(); s++)
+        {
+            out << (s ? ", " : "") << result.samples[s];
+        }
+        out << "]}";
+    }
+    out << "\n  ]\n}\n";
+}
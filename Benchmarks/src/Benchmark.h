@@ -0,0 +1,85 @@
+﻿#pragma once
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/// @brief  Keeps the compiler from throwing away a result nothing reads
+template<class T>
+inline void DoNotOptimize(const T& value) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* s_pSink;
+    s_pSink = &value;
+#endif
+}
+
+/// @brief  Registry and runner for throughput benchmarks. A case's run function does the workload once and returns
+///         how many items (vertices, events, calls...) it processed. Runs shorter than the minimum sample time are
+///         repeated inside a sample, after a few warmup runs every case gets the same number of samples and reports
+///         their median (with the median absolute deviation next to it), so one noisy sample can't move the numbers
+class BenchmarkSuite
+{
+public:
+    using RunFn = std::function<size_t()>;
+
+    struct Options
+    {
+        /* Only cases whose name contains this */
+        std::string filter;
+        /* Seconds a sample has to last at least, short runs get repeated within one */
+        double minSampleTime = 0.02;
+        unsigned int samples = 15u;
+        unsigned int warmupRuns = 2u;
+    };
+
+    struct Result
+    {
+        std::string name;
+        /* What an item is, "verts", "events"... */
+        std::string unit;
+        /* Size parameter of the case (divisions, batch size...) */
+        size_t size = 0u;
+        size_t itemsPerRun = 0u;
+        size_t runsPerSample = 0u;
+        /* Seconds per run, one entry per sample */
+        std::vector<double> samples;
+        double min = 0.0;
+        double median = 0.0;
+        double mean = 0.0;
+        double stddev = 0.0;
+        /* Median absolute deviation of the samples from the median */
+        double mad = 0.0;
+
+        double ItemsPerSecond() const noexcept { return median > 0.0 ? double(itemsPerRun) / median : 0.0; }
+    };
+
+public:
+    void Add(std::string name, std::string unit, size_t size, RunFn run);
+
+    /// @brief  Runs every case matching the filter in registration order, one progress line each to log
+    std::vector<Result> Run(const Options& options, std::ostream& log) const;
+
+    static void WriteJson(std::ostream& out, const std::vector<Result>& results, const Options& options);
+
+private:
+    struct Case
+    {
+        std::string name;
+        std::string unit;
+        size_t size;
+        RunFn run;
+    };
+
+    static Result Measure(const Case& benchCase, const Options& options);
+
+private:
+    std::vector<Case> m_Cases;
+};
+
+/// @brief  Each registers its cases, see ShapeBenchmarks.cpp and CoreBenchmarks.cpp
+void RegisterShapeBenchmarks(BenchmarkSuite& suite);
+void RegisterCoreBenchmarks(BenchmarkSuite& suite);
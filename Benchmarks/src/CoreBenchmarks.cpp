@@ -0,0 +1,168 @@
+﻿#include "Benchmark.h"
+
+#include <memory>
+#include <vector>
+
+#include "Keyboard.h"
+#include "Mouse.h"
+#include "OdaTimer.h"
+#include "Utility/Maths.h"
+
+/// @brief  Drives Keyboard/Mouse through the same private handlers Window's message pump calls, then drains them like
+///         the frame loop does. Each returns how many times it called a handler
+class InputQueueBenchmark
+{
+public:
+    /// @brief  Puts the cursor in the window with a position set (events copy it, it's not set until the first move)
+    static void EnterWindow(Mouse& mouse)
+    {
+        mouse.OnMouseMove(0, 0);
+        mouse.OnMouseEnter();
+        mouse.Flush();
+    }
+
+    static size_t KeyEvents(Keyboard& kbd, size_t batch)
+    {
+        for (size_t i = 0; i < batch; i++)
+        {
+            const auto keycode = static_cast<unsigned char>(i);
+            if (i % 2u)
+            {
+                kbd.OnKeyReleased(keycode);
+            }
+            else
+            {
+                kbd.OnKeyPressed(keycode);
+            }
+        }
+        while (!kbd.KeyIsEmpty())
+        {
+            DoNotOptimize(kbd.ReadKey());
+        }
+        return batch;
+    }
+
+    static size_t CharEvents(Keyboard& kbd, size_t batch)
+    {
+        for (size_t i = 0; i < batch; i++)
+        {
+            kbd.OnChar(static_cast<char>('a' + i % 26u));
+        }
+        while (!kbd.CharIsEmpty())
+        {
+            DoNotOptimize(kbd.ReadChar());
+        }
+        return batch;
+    }
+
+    static size_t MouseMoves(Mouse& mouse, size_t batch)
+    {
+        for (size_t i = 0; i < batch; i++)
+        {
+            mouse.OnMouseMove(int(i), int(batch - i));
+        }
+        while (!mouse.IsEmpty())
+        {
+            DoNotOptimize(mouse.Read());
+        }
+        return batch;
+    }
+
+    /// @brief  Half notch deltas, so every other call crosses WHEEL_DELTA and pushes an event
+    static size_t WheelDeltas(Mouse& mouse, size_t batch)
+    {
+        for (size_t i = 0; i < batch; i++)
+        {
+            mouse.OnWheelDelta(0, 0, (i / 4u) % 2u ? -60 : 60);
+        }
+        while (!mouse.IsEmpty())
+        {
+            DoNotOptimize(mouse.Read());
+        }
+        return batch;
+    }
+};
+
+namespace
+{
+    void AddMaths(BenchmarkSuite& suite)
+    {
+        constexpr size_t count = 4096u;
+        auto pAngles = std::make_shared<std::vector<float>>(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            (*pAngles)[i] = (float(i) - float(count) * 0.5f) * 0.37f;
+        }
+
+        suite.Add("maths/wrap_angle", "calls", count, [pAngles]()
+        {
+            float sum = 0.f;
+            for (const float angle : *pAngles)
+            {
+                sum += Math::wrap_angle(angle);
+            }
+            DoNotOptimize(sum);
+            return pAngles->size();
+        });
+        suite.Add("maths/lerp", "calls", count, [pAngles]()
+        {
+            float sum = 0.f;
+            for (size_t i = 1; i < pAngles->size(); i++)
+            {
+                sum += Math::lerp((*pAngles)[i - 1u], (*pAngles)[i], 0.25f);
+            }
+            DoNotOptimize(sum);
+            return pAngles->size() - 1u;
+        });
+    }
+
+    void AddTimer(BenchmarkSuite& suite)
+    {
+        constexpr size_t count = 1024u;
+        auto pTimer = std::make_shared<OdaTimer>();
+        suite.Add("timer/mark", "calls", count, [pTimer]()
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                DoNotOptimize(pTimer->Mark());
+            }
+            return count;
+        });
+        suite.Add("timer/peek", "calls", count, [pTimer]()
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                DoNotOptimize(pTimer->Peek());
+            }
+            return count;
+        });
+    }
+
+    /// @brief  Batches below, at and past the queues' 16 entry buffer (past it every push trims)
+    void AddInput(BenchmarkSuite& suite)
+    {
+        auto pKbd = std::make_shared<Keyboard>();
+        auto pMouse = std::make_shared<Mouse>();
+        InputQueueBenchmark::EnterWindow(*pMouse);
+
+        for (const size_t batch : { size_t(1), size_t(16), size_t(256) })
+        {
+            const std::string size = std::to_string(batch);
+            suite.Add("input/keyboard/keys/" + size, "events", batch,
+                [pKbd, batch]() { return InputQueueBenchmark::KeyEvents(*pKbd, batch); });
+            suite.Add("input/keyboard/chars/" + size, "events", batch,
+                [pKbd, batch]() { return InputQueueBenchmark::CharEvents(*pKbd, batch); });
+            suite.Add("input/mouse/move/" + size, "events", batch,
+                [pMouse, batch]() { return InputQueueBenchmark::MouseMoves(*pMouse, batch); });
+            suite.Add("input/mouse/wheel/" + size, "events", batch,
+                [pMouse, batch]() { return InputQueueBenchmark::WheelDeltas(*pMouse, batch); });
+        }
+    }
+}
+
+void RegisterCoreBenchmarks(BenchmarkSuite& suite)
+{
+    AddMaths(suite);
+    AddTimer(suite);
+    AddInput(suite);
+}
@@ -0,0 +1,75 @@
+﻿#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "Benchmark.h"
+
+/// Microbenchmarks for the platform neutral core (shape generation, IndexedTriangleList::Transform, Maths.h, OdaTimer,
+/// the Keyboard/Mouse event queues). Builds with CMake on Linux as well as Windows, see Benchmarks/CMakeLists.txt.
+/// Command line options:
+///     --filter <text>     only run cases whose name contains text (e.g. shapes/sphere, input/)
+///     --json <path>       also write every case's statistics and raw samples as JSON, "-" for stdout
+///     --samples <n>       samples per case (default 15)
+///     --min-time <sec>    shortest sample, quicker runs get repeated within one (default 0.02)
+///     --quick             5 samples of 5ms, for a smoke run rather than a baseline
+int main(int argc, char** argv)
+{
+    BenchmarkSuite::Options options;
+    std::string jsonPath;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc)
+        {
+            options.filter = argv[++i];
+        }
+        else if (arg == "--json" && i + 1 < argc)
+        {
+            jsonPath = argv[++i];
+        }
+        else if (arg == "--samples" && i + 1 < argc)
+        {
+            options.samples = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (arg == "--min-time" && i + 1 < argc)
+        {
+            options.minSampleTime = std::strtod(argv[++i], nullptr);
+        }
+        else if (arg == "--quick")
+        {
+            options.samples = 5u;
+            options.minSampleTime = 0.005;
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--filter text] [--json path|-] [--samples n] [--min-time sec] [--quick]" << std::endl;
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    BenchmarkSuite suite;
+    RegisterShapeBenchmarks(suite);
+    RegisterCoreBenchmarks(suite);
+
+    // With the JSON on stdout the progress goes to stderr so the output stays parseable
+    const bool bJsonToStdout = jsonPath == "-";
+    const auto results = suite.Run(options, bJsonToStdout ? std::cerr : std::cout);
+
+    if (bJsonToStdout)
+    {
+        BenchmarkSuite::WriteJson(std::cout, results, options);
+    }
+    else if (!jsonPath.empty())
+    {
+        std::ofstream file(jsonPath);
+        if (!file)
+        {
+            std::cerr << "Can't write " << jsonPath << std::endl;
+            return 1;
+        }
+        BenchmarkSuite::WriteJson(file, results, options);
+    }
+    return 0;
+}
@@ -0,0 +1,110 @@
+﻿#include "Benchmark.h"
+
+#include <memory>
+
+#include "Utility/IndexedTriangleList.h"
+#include "Utility/JobSystem.h"
+#include "Utility/ShapesCommon.h"
+
+namespace
+{
+    /* The app's Vertex/LitVertex live with VertexBuffer (D3D), these have the same members */
+    struct PositionVertex
+    {
+        Math::XMFLOAT3 pos;
+    };
+
+    /* Every attribute the generators know, so the lit cases time the whole analytic path */
+    struct FullVertex
+    {
+        Math::XMFLOAT3 pos;
+        Math::XMFLOAT3 n;
+        Math::XMFLOAT2 tc;
+        Math::XMFLOAT4 tangent;
+    };
+
+    template<class V>
+    const char* VertexName()
+    {
+        return VertexHasNormal<V> ? "lit" : "position";
+    }
+
+    /* ShapeRows::ForEach runs shapes of up to 16k vertices inline even with a JobSystem, so the /jobs cases start
+       above that (a 256 plane is 66k vertices, a 256 sphere 131k) and each has a serial case of the same size */
+    constexpr int s_FirstJobsSize = 256;
+
+    template<class V>
+    void AddPlanes(BenchmarkSuite& suite, JobSystem* pJobs)
+    {
+        const std::string name = "shapes/plane/" + std::string(VertexName<V>()) + "/";
+        for (const int divisions : { 16, 64, 256, 1024, 2048 })
+        {
+            suite.Add(name + std::to_string(divisions), "verts", size_t(divisions),
+                [divisions]() { return Plane::MakeTesselated<V>(divisions, divisions).m_Vertices.size(); });
+            if (divisions >= s_FirstJobsSize)
+            {
+                suite.Add(name + std::to_string(divisions) + "/jobs", "verts", size_t(divisions),
+                    [divisions, pJobs]() { return Plane::MakeTesselated<V>(divisions, divisions, pJobs).m_Vertices.size(); });
+            }
+        }
+    }
+
+    template<class V>
+    void AddSpheres(BenchmarkSuite& suite, JobSystem* pJobs)
+    {
+        const std::string name = "shapes/sphere/" + std::string(VertexName<V>()) + "/";
+        for (const int latDiv : { 16, 64, 256, 1024 })
+        {
+            suite.Add(name + std::to_string(latDiv), "verts", size_t(latDiv),
+                [latDiv]() { return Sphere::MakeTesselated<V>(latDiv, latDiv * 2).m_Vertices.size(); });
+            if (latDiv >= s_FirstJobsSize)
+            {
+                suite.Add(name + std::to_string(latDiv) + "/jobs", "verts", size_t(latDiv),
+                    [latDiv, pJobs]() { return Sphere::MakeTesselated<V>(latDiv, latDiv * 2, pJobs).m_Vertices.size(); });
+            }
+        }
+    }
+
+    template<class V>
+    void AddSmallShapes(BenchmarkSuite& suite)
+    {
+        for (const int longDiv : { 24, 1024, 65536 })
+        {
+            suite.Add("shapes/cone/" + std::string(VertexName<V>()) + "/" + std::to_string(longDiv), "verts", size_t(longDiv),
+                [longDiv]() { return Cone::MakeTesselated<V>(longDiv).m_Vertices.size(); });
+        }
+        suite.Add("shapes/cube/" + std::string(VertexName<V>()), "verts", 1u,
+            []() { return Cube::Make<V>().m_Vertices.size(); });
+    }
+
+    /// @brief  Transform on a prebuilt plane, a rotation so the values stay bounded over millions of runs
+    template<class V>
+    void AddTransforms(BenchmarkSuite& suite)
+    {
+        for (const int divisions : { 64, 256, 1024 })
+        {
+            auto pMesh = std::make_shared<IndexedTriangleList<V>>(Plane::MakeTesselated<V>(divisions, divisions));
+            suite.Add("mesh/transform/" + std::string(VertexName<V>()) + "/" + std::to_string(divisions), "verts", size_t(divisions),
+                [pMesh]()
+                {
+                    pMesh->Transform(Math::XMMatrixRotationRollPitchYaw(0.1f, 0.2f, 0.3f));
+                    return pMesh->m_Vertices.size();
+                });
+        }
+    }
+}
+
+void RegisterShapeBenchmarks(BenchmarkSuite& suite)
+{
+    // Outlives the suite's cases, they only run from main
+    static JobSystem jobs;
+
+    AddPlanes<PositionVertex>(suite, &jobs);
+    AddPlanes<FullVertex>(suite, &jobs);
+    AddSpheres<PositionVertex>(suite, &jobs);
+    AddSpheres<FullVertex>(suite, &jobs);
+    AddSmallShapes<PositionVertex>(suite);
+    AddSmallShapes<FullVertex>(suite);
+    AddTransforms<PositionVertex>(suite);
+    AddTransforms<FullVertex>(suite);
+}